@@ -0,0 +1,344 @@
+#pragma once
+//һӵ趨ժύʱһд룬ҪôȫЧҪôһҲЧ
+//ʱͽ岢ÿҪдֽڣύʱȺ˶Ŀ괦ֽûбĶص
+//ٰ漰ҳԺϲ䣬ÿֻıһαԣдȫָ
+//д벹ʱִ߳едһָһ8ֽ֮ʱԭӵд룬
+//ԭӵдjmp $ִе߳ԭصȴдֽںдǰֽڡ
+//滮ƽ̨޹أı䱣HookMemoryɣWindowsVirtualProtectϵͳmprotect
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdio.h>
+#endif
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include "InstrDecoder.h"
+
+#define HOOK_JMPSIZE		5			//jmp rel32
+#define HOOK_COPYBYTES		6			//趨ʱٸƵԴֽ
+#define HOOK_PATCHMAX		32			//һֽ
+
+//ҳıд
+class HookMemory
+{
+public:
+#ifdef _WIN32
+	typedef DWORD Protect;
+	static inline size_t PageSize(void)
+	{
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		return si.dwPageSize;
+	}
+	static inline bool Query(const void* page,Protect& prot)
+	{
+		MEMORY_BASIC_INFORMATION mbi;
+		if(::VirtualQuery(page,&mbi,sizeof(mbi))==0 || mbi.State!=MEM_COMMIT)
+			return false;
+		prot=mbi.Protect;
+		return true;
+	}
+	static inline bool MakeWritable(void* p,size_t size)
+	{
+		DWORD old;
+		return ::VirtualProtect(p,size,PAGE_EXECUTE_READWRITE,&old)!=FALSE;
+	}
+	static inline bool Restore(void* p,size_t size,Protect prot)
+	{
+		DWORD old;
+		return ::VirtualProtect(p,size,prot,&old)!=FALSE;
+	}
+	static inline void Flush(const void* p,size_t size)
+	{
+		::FlushInstructionCache(::GetCurrentProcess(),p,size);
+	}
+	static inline void Store8(volatile __int64* p,__int64 v)
+	{
+		__int64 old=*p;
+		for(;;)
+		{
+			__int64 cur=_InterlockedCompareExchange64(p,v,old);
+			if(cur==old)
+				break;
+			old=cur;
+		}
+	}
+#else
+	typedef int Protect;
+	static inline size_t PageSize(void)
+	{
+		return (size_t)::sysconf(_SC_PAGESIZE);
+	}
+	//mprotectԭԣ/proc/self/mapsв
+	static bool Query(const void* page,Protect& prot)
+	{
+		FILE* fp=::fopen("/proc/self/maps","r");
+		if(!fp)
+			return false;
+		bool found=false;
+		char line[512];
+		while(::fgets(line,sizeof(line),fp))
+		{
+			unsigned long long low,high;
+			char perms[8];
+			if(::sscanf(line,"%llx-%llx %7s",&low,&high,perms)!=3)
+				continue;
+			if((size_t)page<low || (size_t)page>=high)
+				continue;
+			prot=PROT_NONE;
+			if(perms[0]=='r')
+				prot|=PROT_READ;
+			if(perms[1]=='w')
+				prot|=PROT_WRITE;
+			if(perms[2]=='x')
+				prot|=PROT_EXEC;
+			found=true;
+			break;
+		}
+		::fclose(fp);
+		return found;
+	}
+	static inline bool MakeWritable(void* p,size_t size)
+	{
+		return ::mprotect(p,size,PROT_READ|PROT_WRITE|PROT_EXEC)==0;
+	}
+	static inline bool Restore(void* p,size_t size,Protect prot)
+	{
+		return ::mprotect(p,size,prot)==0;
+	}
+	static inline void Flush(const void* p,size_t size)
+	{
+		__builtin___clear_cache((char*)p,(char*)p+size);
+	}
+	static inline void Store8(volatile long long* p,long long v)
+	{
+		__atomic_store_n(p,v,__ATOMIC_SEQ_CST);
+	}
+#endif
+	//sizeֽдdstִе̲߳ῴдһĵһָ
+	static void Write(unsigned char* dst,const unsigned char* src,int size)
+	{
+		size_t off=(size_t)dst&7;
+		if(off+size<=8)
+		{
+			StorePart(dst,src,size);
+			return;
+		}
+		if(off<=6 && size>2)
+		{
+			static const unsigned char spin[2]={0xeb,0xfe};
+			StorePart(dst,spin,2);
+			::memcpy(dst+2,src+2,size-2);
+			StorePart(dst,src,2);
+			return;
+		}
+		//һָǰֽڿԽ8ֽڱ߽ʱֻֽд
+		::memcpy(dst,src,size);
+	}
+private:
+	//dstڵĶ8ֽ֮ԭӵ滻sizeֽ
+	static inline void StorePart(unsigned char* dst,const unsigned char* src,int size)
+	{
+		unsigned char* base=(unsigned char*)((size_t)dst&~(size_t)7);
+		InstrInt64 v;
+		::memcpy(&v,base,8);
+		::memcpy((unsigned char*)&v+(dst-base),src,size);
+		Store8((volatile InstrInt64*)base,v);
+	}
+};
+
+class HookTransaction
+{
+	struct Patch
+	{
+		unsigned char* address;
+		int size;
+		unsigned char before[HOOK_PATCHMAX];	//ʱĿ괦ֽڣύʱ˶ԣعʱд
+		unsigned char after[HOOK_PATCHMAX];
+		inline bool operator<(const Patch& other) const
+		{
+			return address<other.address;
+		}
+	};
+	//ͬҳ
+	struct PageRun
+	{
+		unsigned char* base;
+		size_t size;
+		HookMemory::Protect prot;
+	};
+	typedef std::vector<Patch> Patches;
+	typedef std::vector<PageRun> PageRuns;
+public:
+	HookTransaction(void):pageRunNum(0)
+	{
+	}
+	//һӣtargetͷָƵtrampolineصjmpύʱtargetΪdetour
+	//trampolineSizeΪ۵ĴС۵һֽڼ±ǵԴֽЩԴֽԭǰ棬Uninstallдء
+	//ָ޷ơתƹŻ۷ŲʱfalseʱĹӲӰ졣
+	bool Install(unsigned char* target,unsigned char* trampoline,int trampolineSize,const void* detour)
+	{
+		bool x64=sizeof(void*)==8;
+		if(!FitsRel32(target+HOOK_JMPSIZE,(const unsigned char*)detour))
+			return false;
+		int used;
+		int count=InstrDecoder::Copy(trampoline,trampolineSize-HOOK_JMPSIZE-1,target,HOOK_COPYBYTES,x64,used);
+		if(count<0 || used>HOOK_PATCHMAX || count+HOOK_JMPSIZE+1+used>trampolineSize)
+			return false;
+		if(!FitsRel32(trampoline+count+HOOK_JMPSIZE,target+used))
+			return false;
+		PutJmp(trampoline+count,target+used);
+		unsigned char* saved=trampoline+trampolineSize-1;
+		*saved=(unsigned char)used;
+		::memcpy(saved-used,target,used);
+		//ȫߵָjmp֮ԭֽڣ˶ع
+		Patch patch;
+		patch.address=target;
+		patch.size=used;
+		::memcpy(patch.before,target,used);
+		::memcpy(patch.after,target,used);
+		PutJmp(patch.after,(const unsigned char*)detour,target);
+		patches.push_back(patch);
+		return true;
+	}
+	//һժInstallĩβԴֽԭдtargettrampolineSizeInstallʱͬ
+	//ûЧļ¼targetjmpʱfalse
+	bool Uninstall(unsigned char* target,const unsigned char* trampoline,int trampolineSize)
+	{
+		const unsigned char* saved=trampoline+trampolineSize-1;
+		int size=*saved;
+		if(size<HOOK_JMPSIZE || size>HOOK_PATCHMAX || size+1>trampolineSize || target[0]!=0xe9)
+			return false;
+		Patch patch;
+		patch.address=target;
+		patch.size=size;
+		::memcpy(patch.before,target,size);
+		::memcpy(patch.after,saved-size,size);
+		patches.push_back(patch);
+		return true;
+	}
+	//дȫκһʧʱָдֽ뱣Բfalse۳ɰܣĲ
+	bool Commit(void)
+	{
+		Patches todo;
+		todo.swap(patches);
+		return Apply(todo);
+	}
+	//Ĳѽɵ߻
+	inline void Abort(void)
+	{
+		patches.clear();
+	}
+	inline int GetPatchNum(void) const
+	{
+		return patches.size();
+	}
+	//ϴύʱı䱣ԵĴ
+	inline int GetPageRunNum(void) const
+	{
+		return pageRunNum;
+	}
+private:
+	bool Apply(Patches& todo)
+	{
+		pageRunNum=0;
+		if(todo.empty())
+			return true;
+		std::sort(todo.begin(),todo.end());
+		for(size_t i=0;i<todo.size();i++)
+		{
+			const Patch& p=todo[i];
+			if(i>0 && todo[i-1].address+todo[i-1].size>p.address)
+				return false;
+			if(::memcmp(p.address,p.before,p.size)!=0)
+				return false;
+		}
+		PageRuns runs;
+		if(!CollectPages(todo,runs))
+			return false;
+		size_t flipped=0;
+		for(;flipped<runs.size();flipped++)
+		{
+			if(!HookMemory::MakeWritable(runs[flipped].base,runs[flipped].size))
+				break;
+		}
+		bool ok=flipped==runs.size();
+		if(ok)
+		{
+			for(size_t i=0;i<todo.size();i++)
+				HookMemory::Write(todo[i].address,todo[i].after,todo[i].size);
+			for(size_t i=0;i<todo.size() && ok;i++)
+				ok=::memcmp(todo[i].address,todo[i].after,todo[i].size)==0;
+			if(!ok)
+			{
+				for(size_t i=0;i<todo.size();i++)
+					HookMemory::Write(todo[i].address,todo[i].before,todo[i].size);
+			}
+		}
+		for(size_t i=0;i<flipped;i++)
+		{
+			HookMemory::Flush(runs[i].base,runs[i].size);
+			HookMemory::Restore(runs[i].base,runs[i].size,runs[i].prot);
+		}
+		pageRunNum=flipped;
+		return ok;
+	}
+	//ַ˳ռ漰ҳұͬҳϲ
+	static bool CollectPages(const Patches& todo,PageRuns& runs)
+	{
+		size_t pageSize=HookMemory::PageSize();
+		for(size_t i=0;i<todo.size();i++)
+		{
+			size_t first=(size_t)todo[i].address&~(pageSize-1);
+			size_t last=((size_t)todo[i].address+todo[i].size-1)&~(pageSize-1);
+			for(size_t page=first;page<=last;page+=pageSize)
+			{
+				if(!runs.empty())
+				{
+					PageRun& run=runs.back();
+					size_t end=(size_t)run.base+run.size;
+					if(page<end)
+						continue;
+					HookMemory::Protect prot;
+					if(!HookMemory::Query((const void*)page,prot))
+						return false;
+					if(page==end && prot==run.prot)
+					{
+						run.size+=pageSize;
+						continue;
+					}
+					PageRun next={(unsigned char*)page,pageSize,prot};
+					runs.push_back(next);
+					continue;
+				}
+				PageRun run={(unsigned char*)page,pageSize,0};
+				if(!HookMemory::Query((const void*)page,run.prot))
+					return false;
+				runs.push_back(run);
+			}
+		}
+		return true;
+	}
+	static inline bool FitsRel32(const unsigned char* from,const unsigned char* to)
+	{
+		InstrInt64 d=(InstrInt64)(size_t)to-(InstrInt64)(size_t)from;
+		return d>=-(InstrInt64)0x80000000 && d<=(InstrInt64)0x7fffffff;
+	}
+	//pдtojmp rel32atΪִָʱĵַ
+	static inline void PutJmp(unsigned char* p,const unsigned char* to,const unsigned char* at=NULL)
+	{
+		if(!at)
+			at=p;
+		InstrInt64 rel=(InstrInt64)(size_t)to-((InstrInt64)(size_t)at+HOOK_JMPSIZE);
+		p[0]=0xe9;
+		for(int i=0;i<4;i++)
+			p[1+i]=(unsigned char)(rel>>(i*8));
+	}
+private:
+	Patches patches;
+	int pageRunNum;
+};
@@ -0,0 +1,503 @@
+#pragma once
+//x86x86-64ָȽõModRMתƵ޼С
+//ǰ׺VEX/EVEX/XOPǰ׺ModRM/SIBλư㣬Windowsͷļ
+//ָʱתx86-64RIPѰַrel8תƹʱչΪrel32ڽӵ塣
+#include <string.h>
+
+#define INSTR_MAXLENGTH		15
+
+#ifdef _MSC_VER
+typedef __int64 InstrInt64;
+#else
+typedef long long InstrInt64;
+#endif
+
+enum InstrKind
+{
+	INSTR_NORMAL=0,
+	INSTR_JMP,			//תƣEBE9
+	INSTR_JCC,			//תƣ70-7F0F 80-8F
+	INSTR_CALL,			//ԵãE8
+	INSTR_LOOP,			//LOOPJCXZֻrel8ʽתƣչ
+	INSTR_RET
+};
+
+struct InstrInfo
+{
+	int length;
+	int prefixLength;	//֮ǰֽǰ׺REX0FתֽVEX/EVEX/XOPǰ׺
+	int opcode;
+	int map;			//0ֽڣ1Ϊ0F2Ϊ0F383Ϊ0F3AVEX/EVEX/XOPΪǰ׺еӳ
+	int modrmOffset;	//ûModRMʱΪ-1
+	int dispOffset;
+	int dispSize;
+	int immOffset;
+	int immSize;
+	int relOffset;		//תƵλڵƫƣrelSizeΪ0ʾת
+	int relSize;
+	bool ripRelative;	//x86-64µRIPѰַλdispOffset
+	int kind;
+};
+
+class InstrDecoder
+{
+	enum
+	{
+		M=0x01,			//ModRM
+		I8=0x02,
+		I16=0x04,
+		IZ=0x08,		//16λʱΪ2ֽڣΪ4ֽ
+		R8=0x10,
+		RZ=0x20,		//32λģʽ16λʱΪrel16Ϊrel32
+		P=0x40,			//ǰ׺
+		X=0x80			//ڴ⴦0FӳбʾЧ
+	};
+public:
+	//һָسȣЧ򳬳sizeʱ0
+	static int Decode(const unsigned char* p,int size,bool x64,InstrInfo& info)
+	{
+		::memset(&info,0,sizeof(info));
+		info.modrmOffset=-1;
+		int limit=(size<INSTR_MAXLENGTH)?size:INSTR_MAXLENGTH;
+		const unsigned char* one=OneByte();
+		bool opsize16=false,addrOverride=false,repne=false,rexW=false;
+		int i=0;
+		//REXֻнʱãǰ׺ʱ
+		for(;i<limit;i++)
+		{
+			if(x64 && (p[i]&0xf0)==0x40)
+			{
+				rexW=(p[i]&0x08)!=0;
+				continue;
+			}
+			if(!(one[p[i]]&P))
+				break;
+			rexW=false;
+			if(p[i]==0x66)
+				opsize16=true;
+			else if(p[i]==0x67)
+				addrOverride=true;
+			else if(p[i]==0xf2)
+				repne=true;
+		}
+		if(i>=limit)
+			return 0;
+		if(rexW)
+			opsize16=false;
+		int op=p[i];
+		int map=0;
+		int flags;
+		if((op==0xc4 || op==0xc5 || op==0x62) && i+1<limit && (x64 || (p[i+1]&0xc0)==0xc0))
+		{
+			//VEXEVEX32λģʽµڶֽڵmodΪ11ʱLESLDSBOUND
+			if(op==0xc5)
+			{
+				map=1;
+				i+=2;
+			}
+			else if(op==0xc4)
+			{
+				if(i+2>=limit)
+					return 0;
+				map=p[i+1]&0x1f;
+				i+=3;
+			}
+			else
+			{
+				if(i+3>=limit)
+					return 0;
+				map=p[i+1]&0x07;
+				i+=4;
+			}
+			if(i>=limit)
+				return 0;
+			op=p[i];
+			if(map==1)
+				flags=TwoByte()[op]|M;
+			else if(map==3)
+				flags=M|I8;
+			else if(map==2 || map==5 || map==6)
+				flags=M;
+			else
+				return 0;
+			//VZEROUPPERVZEROALLûModRM
+			if(map==1 && op==0x77)
+				flags=0;
+			if(flags&X)
+				return 0;
+		}
+		else if(op==0x8f && i+1<limit && (p[i+1]&0x1f)>=8)
+		{
+			//AMD XOPӳ8imm8ӳAimm32
+			if(i+3>=limit)
+				return 0;
+			map=p[i+1]&0x1f;
+			i+=3;
+			op=p[i];
+			if(map==8)
+				flags=M|I8;
+			else if(map==9)
+				flags=M;
+			else if(map==10)
+				flags=M|IZ;
+			else
+				return 0;
+			opsize16=false;
+		}
+		else if(op==0x0f)
+		{
+			if(++i>=limit)
+				return 0;
+			op=p[i];
+			if(op==0x38)
+			{
+				map=2;
+				flags=M;
+				if(++i>=limit)
+					return 0;
+				op=p[i];
+			}
+			else if(op==0x3a)
+			{
+				map=3;
+				flags=M|I8;
+				if(++i>=limit)
+					return 0;
+				op=p[i];
+			}
+			else
+			{
+				map=1;
+				flags=TwoByte()[op];
+				if(flags&X)
+					return 0;
+				//AMDEXTRQINSERTQimm8
+				if(op==0x78 && (opsize16 || repne))
+					flags|=I16;
+			}
+		}
+		else
+		{
+			flags=one[op];
+			if(x64 && InvalidIn64(op))
+				return 0;
+		}
+		info.prefixLength=i;
+		info.opcode=op;
+		info.map=map;
+		i++;
+		int immSize=0;
+		int relSize=0;
+		if(map==0 && (flags&X))
+		{
+			switch(op)
+			{
+			case 0xf6:
+			case 0xf7:
+				//TEST/0/1
+				flags=M;
+				if(i<limit && ((p[i]>>3)&7)<2)
+					flags|=(op==0xf6)?I8:IZ;
+				break;
+			case 0x9a:
+			case 0xea:
+				flags=IZ|I16;
+				break;
+			default:
+				//A0-A3MOVԵַ֮䣬ַַС
+				flags=0;
+				if(x64)
+					immSize=addrOverride?4:8;
+				else
+					immSize=addrOverride?2:4;
+				break;
+			}
+		}
+		if(flags&M)
+		{
+			if(i>=limit)
+				return 0;
+			int modrm=p[i];
+			info.modrmOffset=i++;
+			int mod=modrm>>6;
+			//MOVƼĴԼĴǰĴʽ
+			if(map==1 && op>=0x20 && op<=0x23)
+				mod=3;
+			int rm=modrm&7;
+			int disp=0;
+			if(mod!=3)
+			{
+				if(!x64 && addrOverride)
+				{
+					if(mod==0 && rm==6)
+						disp=2;
+					else if(mod==1)
+						disp=1;
+					else if(mod==2)
+						disp=2;
+				}
+				else
+				{
+					if(rm==4)
+					{
+						if(i>=limit)
+							return 0;
+						if(mod==0 && (p[i]&7)==5)
+							disp=4;
+						i++;
+					}
+					if(mod==0 && rm==5)
+					{
+						disp=4;
+						info.ripRelative=x64;
+					}
+					else if(mod==1)
+						disp=1;
+					else if(mod==2)
+						disp=4;
+				}
+			}
+			info.dispOffset=i;
+			info.dispSize=disp;
+			i+=disp;
+		}
+		if(flags&I16)
+			immSize+=2;
+		if(flags&I8)
+			immSize+=1;
+		if(flags&IZ)
+			immSize+=opsize16?2:4;
+		if(map==0 && (op&0xf8)==0xb8 && rexW)
+			immSize=8;
+		if(flags&R8)
+			relSize=1;
+		if(flags&RZ)
+			relSize=(opsize16 && !x64)?2:4;
+		info.immOffset=i;
+		info.immSize=immSize;
+		i+=immSize;
+		info.relOffset=i;
+		info.relSize=relSize;
+		i+=relSize;
+		if(i>limit)
+			return 0;
+		info.kind=Kind(map,op);
+		info.length=i;
+		return i;
+	}
+	static inline int Length(const unsigned char* p,int size,bool x64)
+	{
+		InstrInfo info;
+		return Decode(p,size,x64,info);
+	}
+	//pʼnָoutЧָݲʱֹͣؽ
+	static int DecodeN(const unsigned char* p,int size,int n,bool x64,InstrInfo* out)
+	{
+		int count=0;
+		int pos=0;
+		while(count<n && pos<size)
+		{
+			int len=Decode(p+pos,size-pos,x64,out[count]);
+			if(len==0)
+				break;
+			pos+=len;
+			count++;
+		}
+		return count;
+	}
+	//srcһָƵdstתRIPѰַ
+	//rel8JMPJccʱչΪrel32compactΪtrueʱrel32JMPJccʱΪrel8
+	//ڰѸƳȥָƻԭatΪָҪִеĵַΪNULLʱdstڱ׼дʱʹá
+	//дֽsrcBytesΪԴָȣЧ޷ʱ-1
+	static int CopyOne(unsigned char* dst,int dstSize,const unsigned char* src,bool x64,int& srcBytes,bool compact=false,const unsigned char* at=NULL)
+	{
+		InstrInfo info;
+		InstrInt64 base=(InstrInt64)(size_t)(at?at:dst);
+		int len=Decode(src,INSTR_MAXLENGTH,x64,info);
+		srcBytes=len;
+		if(len==0)
+			return -1;
+		if(info.relSize>0)
+		{
+			InstrInt64 rel=ReadSigned(src+info.relOffset,info.relSize);
+			InstrInt64 target=(InstrInt64)(size_t)src+len+rel;
+			//дʱֻǰ׺0Fתֽ
+			int pre=info.prefixLength-((info.map==1)?1:0);
+			bool canShort=(info.kind==INSTR_JMP || info.kind==INSTR_JCC) && info.relSize==4;
+			if(compact && canShort)
+			{
+				//rel8ʽ
+				int shortLen=pre+2;
+				InstrInt64 r=target-(base+shortLen);
+				if(r>=-128 && r<=127)
+				{
+					if(shortLen>dstSize)
+						return -1;
+					::memcpy(dst,src,pre);
+					dst[pre]=(unsigned char)((info.kind==INSTR_JMP)?0xeb:(0x70|(info.opcode&0x0f)));
+					dst[pre+1]=(unsigned char)r;
+					return shortLen;
+				}
+			}
+			InstrInt64 r=target-(base+len);
+			if(Fits(r,info.relSize))
+			{
+				if(len>dstSize)
+					return -1;
+				::memcpy(dst,src,len);
+				WriteSigned(dst+info.relOffset,info.relSize,r);
+				return len;
+			}
+			if(info.relSize!=1 || (info.kind!=INSTR_JMP && info.kind!=INSTR_JCC))
+				return -1;
+			//չΪrel32EBΪE97xΪ0F 8xǰ׺
+			int longLen=pre+((info.kind==INSTR_JMP)?5:6);
+			if(longLen>dstSize)
+				return -1;
+			r=target-(base+longLen);
+			if(!Fits(r,4))
+				return -1;
+			::memcpy(dst,src,pre);
+			unsigned char* q=dst+pre;
+			if(info.kind==INSTR_JMP)
+				*q++=0xe9;
+			else
+			{
+				*q++=0x0f;
+				*q++=(unsigned char)(0x80|(info.opcode&0x0f));
+			}
+			WriteSigned(q,4,r);
+			return longLen;
+		}
+		if(len>dstSize)
+			return -1;
+		::memcpy(dst,src,len);
+		if(info.ripRelative)
+		{
+			InstrInt64 disp=ReadSigned(src+info.dispOffset,4);
+			InstrInt64 target=(InstrInt64)(size_t)src+len+disp;
+			InstrInt64 r=target-(base+len);
+			if(!Fits(r,4))
+				return -1;
+			WriteSigned(dst+info.dispOffset,4,r);
+		}
+		return len;
+	}
+	//srcʼֱָԴֽneedBytesдdstֽsrcBytesΪƵԴֽʧʱ-1
+	static int Copy(unsigned char* dst,int dstSize,const unsigned char* src,int needBytes,bool x64,int& srcBytes)
+	{
+		int written=0;
+		srcBytes=0;
+		while(srcBytes<needBytes)
+		{
+			int used;
+			int n=CopyOne(dst+written,dstSize-written,src+srcBytes,x64,used);
+			if(n<0)
+				return -1;
+			written+=n;
+			srcBytes+=used;
+		}
+		return written;
+	}
+private:
+	static inline bool InvalidIn64(int op)
+	{
+		switch(op)
+		{
+		case 0x06:case 0x07:case 0x0e:case 0x16:case 0x17:case 0x1e:case 0x1f:
+		case 0x27:case 0x2f:case 0x37:case 0x3f:case 0x60:case 0x61:case 0x82:
+		case 0x9a:case 0xce:case 0xd4:case 0xd5:case 0xd6:case 0xea:
+			return true;
+		}
+		return false;
+	}
+	static inline int Kind(int map,int op)
+	{
+		if(map==0)
+		{
+			if(op>=0x70 && op<=0x7f)
+				return INSTR_JCC;
+			if(op==0xeb || op==0xe9)
+				return INSTR_JMP;
+			if(op==0xe8)
+				return INSTR_CALL;
+			if(op>=0xe0 && op<=0xe3)
+				return INSTR_LOOP;
+			if(op==0xc2 || op==0xc3 || op==0xca || op==0xcb || op==0xcf)
+				return INSTR_RET;
+		}
+		else if(map==1 && op>=0x80 && op<=0x8f)
+			return INSTR_JCC;
+		return INSTR_NORMAL;
+	}
+	static inline InstrInt64 ReadSigned(const unsigned char* p,int size)
+	{
+		switch(size)
+		{
+		case 1:
+			return (signed char)p[0];
+		case 2:
+			return (short)(p[0]|(p[1]<<8));
+		default:
+			return (int)(p[0]|(p[1]<<8)|(p[2]<<16)|((unsigned int)p[3]<<24));
+		}
+	}
+	static inline void WriteSigned(unsigned char* p,int size,InstrInt64 v)
+	{
+		for(int i=0;i<size;i++)
+			p[i]=(unsigned char)(v>>(i*8));
+	}
+	static inline bool Fits(InstrInt64 v,int size)
+	{
+		InstrInt64 half=(InstrInt64)1<<(size*8-1);
+		return v>=-half && v<half;
+	}
+	//ֽڲ
+	static const unsigned char* OneByte(void)
+	{
+		static const unsigned char table[256]=
+		{
+			M,M,M,M,I8,IZ,0,0,M,M,M,M,I8,IZ,0,X,						//00
+			M,M,M,M,I8,IZ,0,0,M,M,M,M,I8,IZ,0,0,						//10
+			M,M,M,M,I8,IZ,P,0,M,M,M,M,I8,IZ,P,0,						//20
+			M,M,M,M,I8,IZ,P,0,M,M,M,M,I8,IZ,P,0,						//30
+			0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,							//40
+			0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,							//50
+			0,0,M,M,P,P,P,P,IZ,M|IZ,I8,M|I8,0,0,0,0,					//60
+			R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,R8,			//70
+			M|I8,M|IZ,M|I8,M|I8,M,M,M,M,M,M,M,M,M,M,M,M,				//80
+			0,0,0,0,0,0,0,0,0,0,X,0,0,0,0,0,							//90
+			X,X,X,X,0,0,0,0,I8,IZ,0,0,0,0,0,0,							//A0
+			I8,I8,I8,I8,I8,I8,I8,I8,IZ,IZ,IZ,IZ,IZ,IZ,IZ,IZ,			//B0
+			M|I8,M|I8,I16,0,M,M,M|I8,M|IZ,I16|I8,0,I16,0,0,I8,0,0,		//C0
+			M,M,M,M,I8,I8,0,0,M,M,M,M,M,M,M,M,							//D0
+			R8,R8,R8,R8,I8,I8,I8,I8,RZ,RZ,X,R8,0,0,0,0,					//E0
+			P,0,P,P,0,0,X,X,0,0,0,0,0,0,M,M								//F0
+		};
+		return table;
+	}
+	//0FӳĲXΪЧ
+	static const unsigned char* TwoByte(void)
+	{
+		static const unsigned char table[256]=
+		{
+			M,M,M,M,X,0,0,0,0,0,X,0,X,M,0,M|I8,							//00
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//10
+			M,M,M,M,X,X,X,X,M,M,M,M,M,M,M,M,							//20
+			0,0,0,0,0,0,X,0,X,X,X,X,X,X,X,X,							//30
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//40
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//50
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//60
+			M|I8,M|I8,M|I8,M|I8,M,M,M,0,M,M,X,X,M,M,M,M,				//70
+			RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,RZ,			//80
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//90
+			0,0,0,M,M|I8,M,M,M,0,0,0,M,M|I8,M,M,M,						//A0
+			M,M,M,M,M,M,M,M,M,M,M|I8,M,M,M,M,M,							//B0
+			M,M,M|I8,M,M|I8,M|I8,M|I8,M,0,0,0,0,0,0,0,0,				//C0
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//D0
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,							//E0
+			M,M,M,M,M,M,M,M,M,M,M,M,M,M,M,M								//F0
+		};
+		return table;
+	}
+};
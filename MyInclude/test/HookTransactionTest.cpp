@@ -0,0 +1,316 @@
+//HookTransactionĲԣLinuxmmapĴҳAPIWindowsͷļ
+//	g++ -O2 -pthread -o HookTransactionTest HookTransactionTest.cpp
+//˶趨ժֽڡȫƵԴֽڡصֻҳʱع
+//ڶ̲߳ͣõͬʱ趨ժӣȽϳύÿӵύĺʱ
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "../HookTransaction.h"
+
+#define SLOT_SIZE		40			//TRAMPOLINE_CODESIZEͬ
+#define FUNC_STRIDE		32
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+static unsigned char* MapCode(size_t size)
+{
+	void* p=::mmap(NULL,size,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	return (p==MAP_FAILED)?NULL:(unsigned char*)p;
+}
+
+typedef int (*IntFunc)(void);
+
+//дһvalueĺmov eax,value; ret
+static void PutReturn(unsigned char* p,int value)
+{
+	p[0]=0xb8;
+	::memcpy(p+1,&value,4);
+	p[5]=0xc3;
+}
+
+//дתƵļֺvalue趨ӺҪvalueժֽҪԭȫͬ
+static int PutPrologue(unsigned char* p,int kind,int value)
+{
+	::memset(p,0x90,FUNC_STRIDE);
+	switch(kind)
+	{
+	case 0:
+		{
+			//xor eax,eax; je rel32+14rel32rel8ժʱܱ
+			static const unsigned char code[]={0x31,0xc0,0x0f,0x84,0x06,0x00,0x00,0x00,0xb8,0x01,0x00,0x00,0x00,0xc3};
+			::memcpy(p,code,sizeof(code));
+			PutReturn(p+sizeof(code),value);
+			return sizeof(code)+6;
+		}
+	case 1:
+		{
+			//xor eax,eax; je rel8+11չΪrel32ժʱҪдrel8
+			static const unsigned char code[]={0x31,0xc0,0x74,0x07,0xb8,0x01,0x00,0x00,0x00,0xc3,0x90};
+			::memcpy(p,code,sizeof(code));
+			PutReturn(p+sizeof(code),value);
+			return sizeof(code)+6;
+		}
+	default:
+		//һָ5ֽ
+		PutReturn(p,value);
+		return 6;
+	}
+}
+
+//趨Ŀdetourִԭĺժֽ趨ǰȫͬ
+static void TestRoundTrip(void)
+{
+	const int kinds=3;
+	unsigned char* code=MapCode(4096);
+	unsigned char* slots=MapCode(4096);
+	unsigned char* detour=MapCode(4096);
+	PutReturn(detour,-1);
+	unsigned char original[kinds][FUNC_STRIDE];
+	for(int k=0;k<kinds;k++)
+	{
+		PutPrologue(code+k*FUNC_STRIDE,k,100+k);
+		::memcpy(original[k],code+k*FUNC_STRIDE,FUNC_STRIDE);
+	}
+	::mprotect(code,4096,PROT_READ|PROT_EXEC);
+	HookTransaction tx;
+	bool queued=true;
+	for(int k=0;k<kinds;k++)
+		queued=tx.Install(code+k*FUNC_STRIDE,slots+k*SLOT_SIZE,SLOT_SIZE,detour) && queued;
+	Check(queued && tx.Commit(),"趨дתƵĹ");
+	bool hooked=true;
+	for(int k=0;k<kinds;k++)
+	{
+		hooked=hooked && ((IntFunc)(code+k*FUNC_STRIDE))()==-1;
+		hooked=hooked && ((IntFunc)(slots+k*SLOT_SIZE))()==100+k;
+	}
+	Check(hooked,"Ŀdetour巵ԭĽ");
+	HookTransaction ux;
+	queued=true;
+	for(int k=0;k<kinds;k++)
+		queued=ux.Uninstall(code+k*FUNC_STRIDE,slots+k*SLOT_SIZE,SLOT_SIZE) && queued;
+	Check(queued && ux.Commit(),"ժ");
+	bool same=true;
+	for(int k=0;k<kinds;k++)
+		same=same && ::memcmp(code+k*FUNC_STRIDE,original[k],FUNC_STRIDE)==0;
+	Check(same,"ժֽ趨ǰȫͬ");
+	//ûм¼ʱܾժ
+	unsigned char empty[SLOT_SIZE];
+	::memset(empty,0,sizeof(empty));
+	HookTransaction bad;
+	Check(!bad.Uninstall(code,empty,SLOT_SIZE),"ûм¼Ĳ۲ժ");
+	//֮ύ֮ǰƵĵ6ԺԴֽڱĶʱύʧ
+	::mprotect(code,4096,PROT_READ|PROT_WRITE|PROT_EXEC);
+	HookTransaction late;
+	late.Install(code,slots,SLOT_SIZE,detour);
+	code[6]^=0xff;
+	unsigned char changed[FUNC_STRIDE];
+	::memcpy(changed,code,FUNC_STRIDE);
+	Check(!late.Commit() && ::memcmp(code,changed,FUNC_STRIDE)==0,"ƵβֽڸĶύʧҲд");
+	::munmap(code,4096);
+	::munmap(slots,4096);
+	::munmap(detour,4096);
+}
+
+//صĲ벻дҳЧ
+static void TestRollback(void)
+{
+	const int n=10;
+	unsigned char* code=MapCode(4096);
+	unsigned char* slots=MapCode(n*SLOT_SIZE+SLOT_SIZE);
+	unsigned char* detour=MapCode(4096);
+	PutReturn(detour,-1);
+	for(int i=0;i<n;i++)
+		PutPrologue(code+i*FUNC_STRIDE,2,i);
+	::mprotect(code,4096,PROT_READ|PROT_EXEC);
+	unsigned char before[n*FUNC_STRIDE];
+	::memcpy(before,code,sizeof(before));
+
+	HookTransaction same;
+	same.Install(code,slots,SLOT_SIZE,detour);
+	same.Install(code,slots+SLOT_SIZE,SLOT_SIZE,detour);
+	Check(!same.Commit() && ::memcmp(before,code,sizeof(before))==0,"ͬһĿʱύʧҲд");
+
+	char path[]="/tmp/HookTransactionTestXXXXXX";
+	int fd=::mkstemp(path);
+	unsigned char page[4096];
+	::memset(page,0x90,sizeof(page));
+	PutReturn(page,7);
+	if(fd<0 || ::write(fd,page,sizeof(page))!=(int)sizeof(page))
+	{
+		Check(false,"ֻӳļ");
+		return;
+	}
+	::close(fd);
+	//ֻ򿪵ļӳ޷mprotectΪд
+	fd=::open(path,O_RDONLY);
+	unsigned char* ro=(unsigned char*)::mmap(NULL,4096,PROT_READ|PROT_EXEC,MAP_SHARED,fd,0);
+	::close(fd);
+	::unlink(path);
+	HookTransaction tx;
+	for(int i=0;i<n;i++)
+		tx.Install(code+i*FUNC_STRIDE,slots+i*SLOT_SIZE,SLOT_SIZE,detour);
+	tx.Install(ro,slots+n*SLOT_SIZE,SLOT_SIZE,detour);
+	Check(!tx.Commit() && ::memcmp(before,code,sizeof(before))==0 && ro[0]==0xb8,"ֻҳһύʧȫ");
+	::munmap(ro,4096);
+	::munmap(code,4096);
+	::munmap(slots,n*SLOT_SIZE+SLOT_SIZE);
+	::munmap(detour,4096);
+}
+
+//̲߳ͣʱ趨ժ㲻룬ýֻԭֵdetourֵ
+struct StressState
+{
+	unsigned char* code;
+	int num;
+	volatile int stop;
+	long calls;
+	long bad;
+};
+
+static void* StressCaller(void* param)
+{
+	StressState* s=(StressState*)param;
+	unsigned seed=(unsigned)(size_t)&seed;
+	long calls=0,bad=0;
+	while(!s->stop)
+	{
+		int i=rand_r(&seed)%s->num;
+		int r=((IntFunc)(s->code+i*FUNC_STRIDE+i%7))();
+		if(r!=i && r!=1000000+i)
+			bad++;
+		calls++;
+	}
+	__sync_fetch_and_add(&s->calls,calls);
+	__sync_fetch_and_add(&s->bad,bad);
+	return NULL;
+}
+
+static void TestStress(int rounds)
+{
+	const int n=2000;
+	const int threads=4;
+	size_t codeSize=n*FUNC_STRIDE+4096;
+	StressState s;
+	s.code=MapCode(codeSize);
+	s.num=n;
+	s.stop=0;
+	s.calls=0;
+	s.bad=0;
+	unsigned char* slots=MapCode(n*SLOT_SIZE);
+	unsigned char* detours=MapCode(n*8);
+	for(int i=0;i<n;i++)
+	{
+		::memset(s.code+i*FUNC_STRIDE,0x90,FUNC_STRIDE);
+		PutReturn(s.code+i*FUNC_STRIDE+i%7,i);
+		PutReturn(detours+i*8,1000000+i);
+	}
+	::mprotect(s.code,codeSize,PROT_READ|PROT_EXEC);
+	pthread_t th[threads];
+	for(int t=0;t<threads;t++)
+		::pthread_create(&th[t],NULL,StressCaller,&s);
+	int failed=0;
+	int pageRuns=0;
+	for(int r=0;r<rounds;r++)
+	{
+		HookTransaction tx;
+		for(int i=0;i<n;i++)
+		{
+			if(!tx.Install(s.code+i*FUNC_STRIDE+i%7,slots+i*SLOT_SIZE,SLOT_SIZE,detours+i*8))
+				failed++;
+		}
+		if(!tx.Commit())
+			failed++;
+		pageRuns=tx.GetPageRunNum();
+		HookTransaction ux;
+		for(int i=0;i<n;i++)
+		{
+			if(!ux.Uninstall(s.code+i*FUNC_STRIDE+i%7,slots+i*SLOT_SIZE,SLOT_SIZE))
+				failed++;
+		}
+		if(!ux.Commit())
+			failed++;
+	}
+	s.stop=1;
+	for(int t=0;t<threads;t++)
+		::pthread_join(th[t],NULL);
+	printf("%d֣ÿ%dӣ%d̵߳%ldΣ%ldΣÿύı䱣%d\n",
+		rounds,n,threads,s.calls,s.bad,pageRuns);
+	Check(failed==0 && s.bad==0,"г趨ժ");
+	::munmap(s.code,codeSize);
+	::munmap(slots,n*SLOT_SIZE);
+	::munmap(detours,n*8);
+}
+
+static double Seconds(clock_t start)
+{
+	return (double)(::clock()-start)/CLOCKS_PER_SEC;
+}
+
+static void Bench(void)
+{
+	const int n=2000;
+	const int rounds=20;
+	unsigned char* code=MapCode(n*FUNC_STRIDE);
+	unsigned char* slots=MapCode(n*SLOT_SIZE);
+	for(int i=0;i<n;i++)
+		PutPrologue(code+i*FUNC_STRIDE,2,i);
+	::mprotect(code,n*FUNC_STRIDE,PROT_READ|PROT_EXEC);
+	clock_t start=::clock();
+	for(int r=0;r<rounds;r++)
+	{
+		HookTransaction tx;
+		for(int i=0;i<n;i++)
+			tx.Install(code+i*FUNC_STRIDE,slots+i*SLOT_SIZE,SLOT_SIZE,code);
+		tx.Commit();
+		HookTransaction ux;
+		for(int i=0;i<n;i++)
+			ux.Uninstall(code+i*FUNC_STRIDE,slots+i*SLOT_SIZE,SLOT_SIZE);
+		ux.Commit();
+	}
+	double batch=Seconds(start)/rounds/n/2*1e6;
+	start=::clock();
+	for(int r=0;r<rounds;r++)
+	{
+		for(int i=0;i<n;i++)
+		{
+			HookTransaction tx;
+			tx.Install(code+i*FUNC_STRIDE,slots+i*SLOT_SIZE,SLOT_SIZE,code);
+			tx.Commit();
+		}
+		for(int i=0;i<n;i++)
+		{
+			HookTransaction ux;
+			ux.Uninstall(code+i*FUNC_STRIDE,slots+i*SLOT_SIZE,SLOT_SIZE);
+			ux.Commit();
+		}
+	}
+	double single=Seconds(start)/rounds/n/2*1e6;
+	printf("ύ%.2f΢/ӣÿӵύ%.2f΢/\n",batch,single);
+	::munmap(code,n*FUNC_STRIDE);
+	::munmap(slots,n*SLOT_SIZE);
+}
+
+int main(int argc,char* argv[])
+{
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench();
+		return 0;
+	}
+	TestRoundTrip();
+	TestRollback();
+	TestStress((argc>1)?::atoi(argv[1]):50);
+	return failures?1:0;
+}
@@ -0,0 +1,353 @@
+//InstrDecoderĲԣWindowsͷļVCg++ɱ룺
+//	g++ -O2 -o InstrDecoderTest InstrDecoderTest.cpp
+//ʱInstrCorpus.txt˶ָȣתRIPѰַָ˶ԸƺתĿ겻䡣
+//	-fuzz  		ֽУobjdumpĽȽָȣҪobjdump
+//	-bench				ϲDecodeNٶ
+//InstrCorpus.txtÿһָģʽ3264ʮƵָֽڣobjdumpΪ׼
+//ȡgccڸŻɵ32λ64λ롢lspython3g++ĴֽУ
+//ȥobjdump봦벻һµļࣺREXһָϲfwait386ĲԼĴ0F 24/26͵еǰ׺
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "../InstrDecoder.h"
+
+#ifdef _WIN32
+#define popen	_popen
+#define pclose	_pclose
+#endif
+
+struct CorpusItem
+{
+	bool x64;
+	int length;
+	unsigned char bytes[INSTR_MAXLENGTH];
+};
+
+static bool LoadCorpus(const char* path,std::vector<CorpusItem>& items)
+{
+	FILE* fp=::fopen(path,"r");
+	if(!fp)
+		return false;
+	char line[256];
+	while(::fgets(line,sizeof(line),fp))
+	{
+		char* p=line;
+		int mode=(int)::strtol(p,&p,10);
+		if(mode!=32 && mode!=64)
+			continue;
+		CorpusItem item;
+		item.x64=mode==64;
+		item.length=0;
+		for(;;)
+		{
+			char* next;
+			long v=::strtol(p,&next,16);
+			if(next==p || item.length>=INSTR_MAXLENGTH)
+				break;
+			item.bytes[item.length++]=(unsigned char)v;
+			p=next;
+		}
+		if(item.length>0)
+			items.push_back(item);
+	}
+	::fclose(fp);
+	return true;
+}
+
+//ָ֮nopΪֽڶı䳤
+static int CheckCorpus(const std::vector<CorpusItem>& items)
+{
+	int bad=0;
+	for(size_t k=0;k<items.size();k++)
+	{
+		const CorpusItem& item=items[k];
+		unsigned char buf[32];
+		::memset(buf,0x90,sizeof(buf));
+		::memcpy(buf,item.bytes,item.length);
+		int len=InstrDecoder::Length(buf,sizeof(buf),item.x64);
+		//ǡýָֹĩβʱҲҪܽ
+		int exact=InstrDecoder::Length(item.bytes,item.length,item.x64);
+		if(len!=item.length || exact!=item.length)
+		{
+			if(bad<20)
+			{
+				printf("Ȳ(%dλ): õ%d/%d ӦΪ%d:",item.x64?64:32,len,exact,item.length);
+				for(int i=0;i<item.length;i++)
+					printf(" %02x",item.bytes[i]);
+				printf("\n");
+			}
+			bad++;
+		}
+	}
+	printf("%dȲ%d\n",(int)items.size(),bad);
+	return bad;
+}
+
+static InstrInt64 ReadRel(const unsigned char* p,int size)
+{
+	if(size==1)
+		return (signed char)p[0];
+	if(size==2)
+		return (short)(p[0]|(p[1]<<8));
+	int v;
+	::memcpy(&v,p,4);
+	return v;
+}
+
+//pָתĿRIPѰַĵַûʱ-1
+static InstrInt64 Target(const unsigned char* p,bool x64)
+{
+	InstrInfo info;
+	int len=InstrDecoder::Decode(p,INSTR_MAXLENGTH,x64,info);
+	if(info.relSize)
+		return (InstrInt64)(size_t)p+len+ReadRel(p+info.relOffset,info.relSize);
+	if(info.ripRelative)
+		return (InstrInt64)(size_t)p+len+ReadRel(p+info.dispOffset,4);
+	return -1;
+}
+
+//ѴתƻRIPѰַָƵԶͬλãƺĿ벻䣬ʱCopyOne뷵-1
+static int CheckRelocation(int rounds)
+{
+	static const unsigned char templates[][8]=
+	{
+		{2,0x74,0x10},					//je rel8
+		{2,0xeb,0x80},					//jmp rel8
+		{5,0xe9,0x01,0x02,0x00,0x00},	//jmp rel32
+		{5,0xe8,0x10,0x00,0x00,0x00},	//call rel32
+		{6,0x0f,0x85,0x00,0x01,0x00,0x00},	//jne rel32
+		{2,0xe2,0x05},					//loop rel8չ
+		{7,0x48,0x8b,0x05,0x10,0x00,0x00},	//mov rax,[rip+disp32]ֻ64λ
+		{3,0x3e,0x75,0x7f},				//ǰ׺jne rel8
+		{6,0xff,0x25,0x04,0x00,0x00,0x00}	//jmp [disp32]64λΪRIP
+	};
+	const int templateNum=sizeof(templates)/sizeof(templates[0]);
+	const int memSize=1<<24;
+	std::vector<unsigned char> mem(memSize);
+	unsigned char* base=&mem[0];
+	srand(1);
+	int copied=0,grown=0,refused=0,bad=0;
+	for(int n=0;n<rounds;n++)
+	{
+		int t=rand()%templateNum;
+		bool x64=(rand()&1)!=0;
+		if(t==6 && !x64)
+			continue;
+		unsigned char* src=base+memSize/2+rand()%1000;
+		unsigned char* dst=(rand()&1)?src+rand()%4000-2000:base+rand()%(memSize-64);
+		if(dst+32>src && dst<src+32)
+			continue;
+		int len=templates[t][0];
+		::memcpy(src,templates[t]+1,len);
+		::memset(src+len,0x90,16);
+		if(t<2)
+			src[1]=(unsigned char)rand();
+		InstrInt64 before=Target(src,x64);
+		int used;
+		int written=InstrDecoder::CopyOne(dst,32,src,x64,used);
+		if(written<0)
+		{
+			//ֻlooprel8Ŀ̫Զʱʧ
+			if(t!=5)
+				bad++;
+			refused++;
+			continue;
+		}
+		if(used!=len || Target(dst,x64)!=before)
+		{
+			if(bad<20)
+				printf("ƺתĿı: ģ%d %dλ\n",t,x64?64:32);
+			bad++;
+			continue;
+		}
+		if(written>used)
+			grown++;
+		copied++;
+	}
+	printf("%dչΪrel32 %dܾ%d%d\n",copied,grown,refused,bad);
+	return bad;
+}
+
+//objdump봦벻һµУREX֮ǰ׺ʱobjdumpREXһfwaitĸָϳһ
+//32λ0F 24/26386ĲԼĴ룬64λ66ǰ׺תưrel16
+static bool ObjdumpDiffers(const unsigned char* b,bool x64)
+{
+	static const unsigned char prefixes[]={0x66,0x67,0xf2,0xf3,0xf0,0x2e,0x3e,0x26,0x64,0x65,0x36};
+	bool rex=false;
+	int i=0;
+	for(;i<INSTR_MAXLENGTH-1;i++)
+	{
+		bool isRex=x64 && (b[i]&0xf0)==0x40;
+		if(!isRex && !::memchr(prefixes,b[i],sizeof(prefixes)))
+			break;
+		if(rex || (x64 && b[i]==0x66))
+			return true;
+		rex=isRex;
+	}
+	if(b[i]==0x9b)
+		return true;
+	return !x64 && b[i]==0x0f && (b[i+1]==0x24 || b[i+1]==0x26);
+}
+
+//ֽobjdumpȽϣ췽ʽƫ0Fǰ׺REXVEXͷ
+static int Fuzz(int count,int seed,bool x64)
+{
+	static const unsigned char prefixes[]={0x66,0x67,0xf2,0xf3,0xf0,0x2e,0x3e,0x26,0x64,0x65,0x36};
+	const int stride=32;
+	std::vector<unsigned char> data(count*stride,0x90);
+	srand(seed);
+	for(int k=0;k<count;k++)
+	{
+		unsigned char* b=&data[k*stride];
+		for(int i=0;i<INSTR_MAXLENGTH;i++)
+			b[i]=(unsigned char)rand();
+		int r=rand()%10;
+		if(r<3)
+			b[0]=0x0f;
+		else if(r<4)
+		{
+			b[0]=prefixes[rand()%sizeof(prefixes)];
+			if(rand()&1)
+				b[1]=0x0f;
+		}
+		else if(r<5 && x64)
+			b[0]=(unsigned char)(0x40|(rand()&15));
+		else if(r<6)
+			b[0]=(rand()&1)?0xc4:0xc5;
+	}
+	const char* path="InstrFuzz.bin";
+	FILE* fp=::fopen(path,"wb");
+	if(!fp)
+		return -1;
+	::fwrite(&data[0],1,data.size(),fp);
+	::fclose(fp);
+	char cmd[256];
+	::sprintf(cmd,"objdump -D -b binary -m %s --insn-width=16 %s",x64?"i386:x86-64":"i386",path);
+	FILE* pipe=::popen(cmd,"r");
+	if(!pipe)
+		return -1;
+	//objdumpÿһָַָֽǷ֮Ʊָ
+	std::vector<int> lengths(count,-1);
+	std::vector<bool> skip(count,false);
+	char line[512];
+	while(::fgets(line,sizeof(line),pipe))
+	{
+		char* p=line;
+		char* next;
+		unsigned long addr=::strtoul(p,&next,16);
+		if(next==p || *next!=':' || next[1]!='\t')
+			continue;
+		p=next+2;
+		char* tab=::strchr(p,'\t');
+		if(!tab)
+			continue;
+		int len=0;
+		for(;p<tab;p++)
+		{
+			if(*p!=' ' && p[1]!=' ' && p+1<tab)
+			{
+				len++;
+				p++;
+			}
+		}
+		if(addr%stride)
+			continue;
+		int k=(int)(addr/stride);
+		if(k>=count)
+			continue;
+		lengths[k]=len;
+		const char* text=tab+1;
+		if(::strstr(text,"(bad)") || ::strncmp(text,"rex",3)==0 || ::strncmp(text,".byte",5)==0
+			|| ObjdumpDiffers(&data[k*stride],x64))
+			skip[k]=true;
+	}
+	::pclose(pipe);
+	::remove(path);
+	int compared=0,bad=0;
+	for(int k=0;k<count;k++)
+	{
+		if(lengths[k]<0 || skip[k])
+			continue;
+		compared++;
+		int len=InstrDecoder::Length(&data[k*stride],stride,x64);
+		if(len!=lengths[k])
+		{
+			if(bad<20)
+			{
+				printf("objdump(%dλ): õ%d ӦΪ%d:",x64?64:32,len,lengths[k]);
+				for(int i=0;i<INSTR_MAXLENGTH;i++)
+					printf(" %02x",data[k*stride+i]);
+				printf("\n");
+			}
+			bad++;
+		}
+	}
+	printf("%dλ%dȽ%d%d\n",x64?64:32,count,compared,bad);
+	return bad;
+}
+
+static void Bench(const std::vector<CorpusItem>& items)
+{
+	std::vector<unsigned char> code[2];
+	for(size_t k=0;k<items.size();k++)
+		code[items[k].x64].insert(code[items[k].x64].end(),items[k].bytes,items[k].bytes+items[k].length);
+	InstrInfo out[64];
+	for(int mode=0;mode<2;mode++)
+	{
+		const std::vector<unsigned char>& c=code[mode];
+		if(c.empty())
+			continue;
+		InstrInt64 total=0;
+		const int rounds=200;
+		clock_t start=::clock();
+		for(int r=0;r<rounds;r++)
+		{
+			size_t pos=0;
+			while(pos<c.size())
+			{
+				int n=InstrDecoder::DecodeN(&c[pos],(int)(c.size()-pos),64,mode!=0,out);
+				if(n==0)
+				{
+					pos++;
+					continue;
+				}
+				for(int i=0;i<n;i++)
+					pos+=out[i].length;
+				total+=n;
+			}
+		}
+		double seconds=(double)(::clock()-start)/CLOCKS_PER_SEC;
+		if(seconds<=0)
+			seconds=1e-6;
+		printf("%dλ: %.0fָ%.1f/룬%.1fMB/\n",mode?64:32,(double)total,
+			total/seconds/1e6,(double)c.size()*rounds/seconds/1e6);
+	}
+}
+
+int main(int argc,char* argv[])
+{
+	if(argc>1 && ::strcmp(argv[1],"-fuzz")==0)
+	{
+		int count=(argc>2)?::atoi(argv[2]):100000;
+		int seed=(argc>3)?::atoi(argv[3]):1;
+		int bad32=Fuzz(count,seed,false);
+		int bad64=Fuzz(count,seed,true);
+		return (bad32==0 && bad64==0)?0:1;
+	}
+	std::vector<CorpusItem> items;
+	if(!LoadCorpus("InstrCorpus.txt",items))
+	{
+		printf("޷InstrCorpus.txt\n");
+		return 2;
+	}
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench(items);
+		return 0;
+	}
+	int bad=CheckCorpus(items);
+	bad+=CheckRelocation(200000);
+	return bad?1:0;
+}
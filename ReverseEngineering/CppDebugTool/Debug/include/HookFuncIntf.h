@@ -46,7 +46,7 @@ class HookUI : public IDispatch
 		virtual BSTR __stdcall CompileScript(BSTR scpFile);//SCűapp=HookUI,window=window
 		virtual VARIANT __stdcall CallScript(VARIANT vals);
 		virtual int __stdcall CreateHook(VARIANT func,VARIANT api,VARIANT module);
-		virtual void __stdcall RemoveHook(int index);
+		virtual int __stdcall RemoveHook(int index);//ɹʱ0ʧʱ-1ӱЧ
 		virtual IDispatch* __stdcall get_ExtObject(void);
 		virtual BSTR __stdcall get_HookPath(void);
 };
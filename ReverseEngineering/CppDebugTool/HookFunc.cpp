@@ -9,6 +9,9 @@
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
+HookFramePool* HookFramePool::instance=NULL;
+HookFrameSlot* HookFrameSlot::instance=NULL;
+
 void __stdcall HookFunc::ShowUI(void)
 {
 	::ShowUI();
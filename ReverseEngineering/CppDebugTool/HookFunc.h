@@ -9,8 +9,11 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
-#include <vector>
-#define MAXTHREADNUM 100
+#include <malloc.h>
+#include "TraceRing.h"
+#include "../scriptc/FiberSlot.h"
+#define HOOKFRAME_POOLSIZE	64			//֡ౣĿ֡
+#define TRACE_SCRIPTHOOK	0x10000		//ű趨Ĺڸټ¼еű־16λΪ
 
 #define bAlreadyRun			0  //־
 #define orginReturnAddr		4
@@ -19,33 +22,172 @@
 #define regECX				16	
 
 extern long GetBaseAddr(void);
+extern void LogTrace(int hook,unsigned short channel,const char* mess);
+class HookFunc;
 
+//һιӵõļĴ뷵ؿϢͬһ߳Ƕ׵Ĺӵøռһ֡prev
+struct HookFrame
+{
+	SLIST_ENTRY entry;		//ڿʱʹãΪһԱMEMORY_ALLOCATION_ALIGNMENT
+	HookFrame* prev;
+	unsigned int segCs,segDs,segEs,segFs,segGs,segSs;
+	unsigned int edx,ebx,ebp,esi,edi,eax,esp,eFlags;
+	unsigned int eip,paramPtr,thisPtr;
+	unsigned int originalAPI;
+	unsigned int directReturn;
+	unsigned int popNBytes;
+	unsigned int beforeExitScript;
+	int hookIndex;
+	DWORD owner;			//ʹṇ̃֡߳֡ʱΪ0
+	HookFunc* func;			//󶨵֡Ľűӿڶ֡һ𻺴֡
+	inline void PutCallData(unsigned int eip_,unsigned int thisPtr_,unsigned int paramPtr_)
+	{
+		eip=eip_;
+		thisPtr=thisPtr_;
+		paramPtr=paramPtr_;
+	}
+	inline void PutSegmentRegister(unsigned int segcs,unsigned int segds,unsigned int seges,unsigned int segss,unsigned int segfs,unsigned int seggs)
+	{
+		segCs=segcs;
+		segDs=segds;
+		segEs=seges;
+		segSs=segss;
+		segFs=segfs;
+		segGs=seggs;
+	}
+	inline void PutGeneralRegister(unsigned int regedx,unsigned int regebx,unsigned int regebp,unsigned int regesi,unsigned int regedi,unsigned int regeax,unsigned int regesp,unsigned int regeflags)
+	{
+		edx=regedx;
+		ebx=regebx;
+		ebp=regebp;
+		esi=regesi;
+		edi=regedi;
+		eax=regeax;
+		esp=regesp;
+		eFlags=regeflags;
+	}
+};
+
+//֡Ľڹأ֡УౣHOOKFRAME_POOLSIZEֱ֡ͷš
+//ΨһʵHookFunc::StartupDLLװʱúڵľ̬ΪVC2005ĳʼ̰߳ȫ
+class HookFramePool
+{
+public:
+	HookFramePool(void)
+	{
+		::InitializeSListHead(&freeList);
+		pooled=0;
+	}
+	~HookFramePool()
+	{
+		HookFrame* p;
+		while((p=(HookFrame*)::InterlockedPopEntrySList(&freeList))!=NULL)
+			Destroy(p);
+	}
+	static inline HookFramePool& Instance(void)
+	{
+		return *instance;
+	}
+	inline HookFrame* Acquire(void)
+	{
+		HookFrame* p=(HookFrame*)::InterlockedPopEntrySList(&freeList);
+		if(p)
+		{
+			::InterlockedDecrement(&pooled);
+			return p;
+		}
+		p=(HookFrame*)::_aligned_malloc(sizeof(HookFrame),MEMORY_ALLOCATION_ALIGNMENT);
+		if(p)
+		{
+			p->func=NULL;
+			p->owner=0;
+		}
+		return p;
+	}
+	//黹֡κ̣߳űµĽӿڶӴֻ֡
+	inline void Release(HookFrame* p)
+	{
+		p->owner=0;
+		if(::InterlockedIncrement(&pooled)>HOOKFRAME_POOLSIZE)
+		{
+			::InterlockedDecrement(&pooled);
+			Destroy(p);
+			return;
+		}
+		::InterlockedPushEntrySList(&freeList,&p->entry);
+	}
+private:
+	friend class HookFunc;
+	static HookFramePool* instance;
+	inline void Destroy(HookFrame* p);
+private:
+	SLIST_HEADER freeList;
+	volatile LONG pooled;
+};
+
+//߳ڲ㹳֡ڵĲλDLL֪߳ͨFiberSlotĻص߳˳ʱ黹֡
+//֡ڲλڲλ٣FlsFreeĻصҪ黹֡
+class HookFrameSlot
+{
+public:
+	HookFrameSlot(void):slot(ThreadExit)
+	{
+	}
+	static inline HookFrameSlot& Instance(void)
+	{
+		return *instance;
+	}
+	inline HookFrame* Get(void)
+	{
+		return (HookFrame*)slot.Get();
+	}
+	inline void Set(HookFrame* p)
+	{
+		slot.Set(p);
+	}
+private:
+	//߳ڹӵ˳ʱ繳סExitThread黹֡ջ
+	static VOID WINAPI ThreadExit(PVOID p)
+	{
+		HookFrame* frame=(HookFrame*)p;
+		while(frame)
+		{
+			HookFrame* prev=frame->prev;
+			HookFramePool::Instance().Release(frame);
+			frame=prev;
+		}
+	}
+private:
+	friend class HookFunc;
+	static HookFrameSlot* instance;
+	FiberSlot slot;
+};
+
+//űӿڶÿ֡һ֡棬ӵʱ֡Ķ󽻸ű
+//Ĵȡȷֱʹð󶨵֡ٲ̲߳λڹӵʱȫĿ֡
 class HookFunc : public IDispatch 
 {
-	struct Data
-	{
-		unsigned int segCs,segDs,segEs,segFs,segGs,segSs;
-		unsigned int edx,ebx,ebp,esi,edi,eax,esp,eFlags;
-		unsigned int eip,paramPtr,thisPtr;
-		unsigned int originalAPI;
-		unsigned int directReturn;
-		unsigned int popNBytes;
-		unsigned int beforeExitScript;
-	};
-	typedef std::vector<Data> Datas;
 public:
+	HookFunc(void)
+	{
+		frame=NULL;
+		::memset(&idle,0,sizeof(idle));
+		idle.hookIndex=TRACE_NOHOOK;
+	}
 	virtual void __stdcall DirectReturnInt32(unsigned int int32Val, unsigned int popn)
 	{
-		DataRef().directReturn=1;		
-		DataRef().popNBytes=popn;
+		HookFrame& frame=Frame();
+		frame.directReturn=1;		
+		frame.popNBytes=popn;
 		long baseAddr=GetBaseAddr();
 		*(int*)(baseAddr+regEAX)=int32Val;
 	}
 	
 	virtual void __stdcall DirectReturnInt64(unsigned int low32Val,unsigned int high32Val, unsigned int popn)
 	{
-		DataRef().directReturn=1;		
-		DataRef().popNBytes=popn;
+		HookFrame& frame=Frame();
+		frame.directReturn=1;		
+		frame.popNBytes=popn;
 		long baseAddr=GetBaseAddr();
 		*(int*)(baseAddr+regEAX)=low32Val;
 		*(int*)(baseAddr+regEDX)=high32Val;
@@ -53,8 +195,9 @@ public:
 
 	virtual void __stdcall CallBeforeExit(UINT script)
 	{
-		DataRef().directReturn=2;
-		DataRef().beforeExitScript=script;
+		HookFrame& frame=Frame();
+		frame.directReturn=2;
+		frame.beforeExitScript=script;
 	}
 	
 	virtual void __stdcall BeforeExitReturnInt32(unsigned int int32Val)
@@ -72,97 +215,97 @@ public:
 	
 	virtual unsigned int __stdcall get_Edx(void)
 	{
-		return DataRef().edx;
+		return Frame().edx;
 	}
 
 	virtual unsigned int __stdcall get_Ebx(void)
 	{
-		return DataRef().ebx;
+		return Frame().ebx;
 	}
 
 	virtual unsigned int __stdcall get_Ebp(void)
 	{
-		return DataRef().ebp;
+		return Frame().ebp;
 	}
 
 	virtual unsigned int __stdcall get_Esi(void)
 	{
-		return DataRef().esi;
+		return Frame().esi;
 	}
 
 	virtual unsigned int __stdcall get_Edi(void)
 	{
-		return DataRef().edi;
+		return Frame().edi;
 	}
 
 	virtual unsigned int __stdcall get_Eax(void)
 	{
-		return DataRef().eax;
+		return Frame().eax;
 	}
 
 	virtual unsigned int __stdcall get_Esp(void)
 	{
-		return DataRef().esp;
+		return Frame().esp;
 	}
 
 	virtual unsigned int __stdcall get_EFlags(void)
 	{
-		return DataRef().eFlags;
+		return Frame().eFlags;
 	}
 	
 	virtual unsigned int __stdcall get_SegCs(void)
 	{
-		return DataRef().segCs;
+		return Frame().segCs;
 	}
 
 	virtual unsigned int __stdcall get_SegDs(void)
 	{
-		return DataRef().segDs;	
+		return Frame().segDs;	
 	}
 	
 	virtual unsigned int __stdcall get_SegEs(void)
 	{
-		return DataRef().segEs;	
+		return Frame().segEs;	
 	}
 	
 	virtual unsigned int __stdcall get_SegSs(void)
 	{
-		return DataRef().segSs;	
+		return Frame().segSs;	
 	}
 	
 	virtual unsigned int __stdcall get_SegFs(void)
 	{
-		return DataRef().segFs;	
+		return Frame().segFs;	
 	}
 	
 	virtual unsigned int __stdcall get_SegGs(void)
 	{
-		return DataRef().segGs;	
+		return Frame().segGs;	
 	}
 	
 	virtual unsigned int __stdcall get_Eip(void)
 	{
-		return DataRef().eip;	
+		return Frame().eip;	
 	}
 	
 	virtual unsigned int __stdcall get_ParamPtr(void)
 	{
-		return DataRef().paramPtr;	
+		return Frame().paramPtr;	
 	}
 	
 	virtual unsigned int __stdcall get_ThisPtr(void)
 	{
-		return DataRef().thisPtr;
+		return Frame().thisPtr;
 	}
 	
 	virtual unsigned int __stdcall get_OriginalAPI(void)
 	{
-		return DataRef().originalAPI;
+		return Frame().originalAPI;
 	}
 
 	virtual unsigned int __stdcall get_DirectReturn(void)
 	{
-		return DataRef().directReturn;	
+		return Frame().directReturn;	
 	}
 	
 	virtual unsigned int __stdcall get_ReturnLowInt32(void)
@@ -179,36 +322,25 @@ public:
 	
 	virtual unsigned int __stdcall get_PopNBytes(void)
 	{
-		return DataRef().popNBytes;	
+		return Frame().popNBytes;	
 	}
 	
 	virtual UINT __stdcall get_BeforeExitScript(void)
 	{
-		return DataRef().beforeExitScript;	
+		return Frame().beforeExitScript;	
 	}	
 
 	virtual void __stdcall Log(const char* mess)
 	{
-		char*s=(LPSTR)mess;
-		HWND hWnd=::FindWindow(NULL,"ScriptHook");
-		if(::IsWindow(hWnd))
-		{
-			COPYDATASTRUCT data={0x5656,::strlen(s)+1,(LPVOID)s};
-			::SendMessage(hWnd,WM_COPYDATA,NULL,(LPARAM)&data);
-		}		
+		::LogTrace(HookIndex(),0x5656,mess);
 	}
 
 	virtual void __stdcall LogStdInfo(const char* name)
 	{
+		HookFrame& frame=Frame();
 		CString mess;
-		mess.Format("%s run, EIP:%8.8X, ParamPtr:%8.8X \r\nCS:%4.4X, DS:%4.4X, ES:%4.4X, SS:%4.4X, FS:%4.4X, GS:%4.4X\r\n",name,DataRef().eip,DataRef().paramPtr,DataRef().segCs,DataRef().segDs,DataRef().segEs,DataRef().segSs,DataRef().segFs,DataRef().segGs);
-		char*s=(LPSTR)(LPCSTR)mess;		
-		HWND hWnd=::FindWindow(NULL,"ScriptHook");
-		if(::IsWindow(hWnd))
-		{
-			COPYDATASTRUCT data={0x5656,::strlen(s)+1,(LPVOID)s};
-			::SendMessage(hWnd,WM_COPYDATA,NULL,(LPARAM)&data);
-		}	
+		mess.Format("%s run, EIP:%8.8X, ParamPtr:%8.8X \r\nCS:%4.4X, DS:%4.4X, ES:%4.4X, SS:%4.4X, FS:%4.4X, GS:%4.4X\r\n",name,frame.eip,frame.paramPtr,frame.segCs,frame.segDs,frame.segEs,frame.segSs,frame.segFs,frame.segGs);
+		::LogTrace(frame.hookIndex,0x5656,mess);
 	}
 
 	virtual void __stdcall EnableRecursion(unsigned int val)
@@ -273,63 +405,87 @@ public:
 		METHOD(CloseUI)
 	END_INTF()
 public:
-	inline void PutCallData(unsigned int eip,unsigned int thisPtr,unsigned int paramPtr)
-	{
-		DataRef().eip=eip;
-		DataRef().thisPtr=thisPtr;
-		DataRef().paramPtr=paramPtr;
-	}
-	inline void PutOriginalAPI(unsigned int originalAPI)
+	//DLLװʱ趨κι֮ǰã̲֡߳λ
+	static inline void Startup(void)
 	{
-		DataRef().originalAPI=originalAPI;
+		HookFramePool::instance=new HookFramePool();
+		HookFrameSlot::instance=new HookFrameSlot();
 	}
-	inline void PutSegmentRegister(unsigned int segcs,unsigned int segds,unsigned int seges,unsigned int segss,unsigned int segfs,unsigned int seggs)
-	{
-		DataRef().segCs=segcs;
-		DataRef().segDs=segds;
-		DataRef().segEs=seges;
-		DataRef().segSs=segss;
-		DataRef().segFs=segfs;
-		DataRef().segGs=seggs;
-	}
-	inline void PutGeneralRegister(unsigned int regedx,unsigned int regebx,unsigned int regebp,unsigned int regesi,unsigned int regedi,unsigned int regeax,unsigned int regesp,unsigned int regeflags)
+	//DLLжʱãͷŲλFlsFreeĻص黹̲߳֡ͷ֡
+	static inline void Shutdown(void)
 	{
-		DataRef().edx=regedx;
-		DataRef().ebx=regebx;
-		DataRef().ebp=regebp;
-		DataRef().esi=regesi;
-		DataRef().edi=regedi;
-		DataRef().eax=regeax;
-		DataRef().esp=regesp;
-		DataRef().eFlags=regeflags;
+		delete HookFrameSlot::instance;
+		HookFrameSlot::instance=NULL;
+		delete HookFramePool::instance;
+		HookFramePool::instance=NULL;
 	}
-	inline void Push(void)
+	//빳ʱȡһ֡ѹ뵱ǰ̵߳֡ջ֡funcűιӵвٲҡ
+	//ڴ治ʱNULLű
+	static inline HookFrame* Push(void)
 	{
-		Data data;
-		DatasRef().push_back(data);
-	}
-	inline void Pop(void)
-	{
-		if(!DatasRef().empty())
-			DatasRef().pop_back();
+		HookFrameSlot& slot=HookFrameSlot::Instance();
+		HookFrame* frame=HookFramePool::Instance().Acquire();
+		if(!frame)
+			return NULL;
+		if(!frame->func)
+		{
+			frame->func=CreateDispatch();
+			if(!frame->func)
+			{
+				HookFramePool::Instance().Release(frame);
+				return NULL;
+			}
+			frame->func->frame=frame;
+		}
+		frame->owner=::GetCurrentThreadId();
+		frame->prev=slot.Get();
+		frame->directReturn=0;
+		frame->popNBytes=0;
+		frame->hookIndex=TRACE_NOHOOK;
+		slot.Set(frame);
+		return frame;
+	}
+	static inline void Pop(void)
+	{
+		HookFrameSlot& slot=HookFrameSlot::Instance();
+		HookFrame* frame=slot.Get();
+		if(!frame)
+			return;
+		slot.Set(frame->prev);
+		HookFramePool::Instance().Release(frame);
+	}
+	//ǰ߳ڲ֡ڹӵʱΪNULL
+	static inline HookFrame* Current(void)
+	{
+		return HookFrameSlot::Instance().Get();
+	}
+	//󶨵֡δ󶨡֡ѹ黹֡ػ߳ʹãűѶ˹ӵ֮⣩ʱؿ֡
+	inline HookFrame& Frame(void)
+	{
+		if(frame && frame->owner==::GetCurrentThreadId())
+			return *frame;
+		return idle;
 	}
-	inline void Init(void)
-	{
-		DataRef().directReturn=0;
-		DataRef().popNBytes=0;
-	}	
-private:	
-	inline Data& DataRef(void)
+private:
+	inline int HookIndex(void)
 	{
-		return DatasRef().back();
+		return Frame().hookIndex;
 	}
-	inline Datas& DatasRef(void)
-	{
-		int ix=ThreadIndex::Get();
-		return datas[ix];
-	}	
 private:
-	Datas datas[MAXTHREADNUM];
+	friend class HookFramePool;
+	HookFrame* frame;
+	HookFrame idle;
 };
 
+//֡ͷʱӿڶİ󶨣űиöֻ֮֡
+inline void HookFramePool::Destroy(HookFrame* p)
+{
+	if(p->func)
+	{
+		p->func->frame=NULL;
+		p->func->Release();
+	}
+	::_aligned_free(p);
+}
+
 #endif // !defined(AFX_HOOKFUNC_H__99E7C437_71E3_4322_90EF_287B48207F9E__INCLUDED_)
@@ -7,8 +7,10 @@
 #include "HookScript.h"
 #include "HookFunc.h"
 #include "Disasm.h"
+#include "TrampolinePool.h"
 
 #include <vector>
+#include <deque>
 #include <fstream>
 #include "WinForIE.h"
 #include "MyWindowProc.h"
@@ -38,7 +40,8 @@ CString GetHookPath(void)
 }
 //////////////////////////////////////////////////////////////////////	
 	void HookProc(int index);
-	void HookProc_(int index);
+	struct ScriptHookSlot;
+	void HookProc_(ScriptHookSlot* slot);
 	typedef void (*MYHOOKPROC)(void);
 	typedef void (*MYDLLPROC)(IDispatch*);
 	typedef std::vector<void*> MemPtrs;
@@ -58,11 +61,27 @@ CString GetHookPath(void)
 
 	static CString hookScriptFile("HookScript.dll");
 
-	static int curHookItemIndex_=0;
-	static UINT hookScript_[1025];
-	static DWORD originAPI_[1025];
-	static DWORD oldAPI_[1025];
-	static BYTE trampoline_[1025*40];
+#define TRACE_FORWARDINTERVAL	20		//ת־ļ
+	static TraceSegment traceSegment;
+	static HANDLE traceThread=NULL;
+	static HANDLE traceStop=NULL;
+	static HMODULE traceModule=NULL;		//ת̳߳еıģ
+
+	//űӵĲۡеĲǰTRAMPOLINE_CODESIZEֽ壬ڴ룺ѹ뱾ṹĵַHookProc_
+	//˹ӵĸƣṹĵַ趨ٸı䡣ڴ[eax]ȡoriginAPIǵһԱ
+	struct ScriptHookSlot
+	{
+		DWORD originAPI;	//ַԭʱ
+		DWORD oldAPI;		//סĺ
+		UINT hookScript;
+		int index;
+		PBYTE code;
+	};
+#define HOOKENTRY_SIZE		10		//push imm32call rel32
+	typedef std::deque<ScriptHookSlot> ScriptHookSlots;
+	static ScriptHookSlots hookSlots_;
+	static std::deque<int> freeHookSlots_;		//в۵ţͷŵȺ
+	static TrampolinePool trampolinePool_;
 
 	//趨
 	bool CreateHookImpl(int ix,VARIANT func,VARIANT api,VARIANT module);
@@ -77,6 +96,7 @@ CString GetHookPath(void)
 		virtual BSTR __stdcall CompileScript(BSTR scpFile)
 		{
 			canRun=false;
+			ReleaseContexts();
             vmachine.Reset();
 
             vmachine.DefVar("window");
@@ -132,14 +152,23 @@ CString GetHookPath(void)
 			}
 			return ix;
 		}
-		virtual void __stdcall RemoveHook(int index)
+		//ɹʱ0ָͷʧʱסĺԻۣ۱ʹУ
+		virtual int __stdcall RemoveHook(int index)
 		{			
-			if(index>=curHookItemIndex_ || index>=1025 || (hookScript_[index]==0 && oldAPI_[index]==0 && originAPI_[index]==0))
+			if(index<0 || index>=(int)hookSlots_.size() || hookSlots_[index].oldAPI==0)
 			{
-				return;
+				return -1;
+			}
+			ScriptHookSlot& slot=hookSlots_[index];
+			if(!Trampoline::Remove((PBYTE)slot.oldAPI,(PBYTE)slot.originAPI))
+			{
+				char buf[128];
+				::sprintf(buf,"remove hook %d at %8.8X failed, the hook stays installed!",index,slot.oldAPI);
+				Log(buf);
+				return -1;
 			}
-			Trampoline::Remove((PBYTE)oldAPI_[index],(PBYTE)originAPI_[index]);
 			SetNullIndex(index);
+			return 0;
 		}
 		virtual IDispatch* __stdcall get_ExtObject(void) 
 		{
@@ -182,25 +211,55 @@ CString GetHookPath(void)
 			}
 			return true;
 		}
+		//ڹڵִ߳нű߳ʹԼִģ໥֮䲻
 		void CallScript_(int func,IDispatch* pHF)
 		{
 			if(!canRun)
 				return;
+			ScriptcRuntime* pvm=ThreadContext();
 			//ʵװĽű
 			IDispatch* pWin=dlg.GetWindowObj();
-            vmachine.SetVariable(0,CComVariant(pWin));
+            pvm->SetVariable(0,CComVariant(pWin));
 			if(pWin)
 				pWin->Release();
             //HookUIʵװĽű
-            vmachine.SetVariable(1,CComVariant((IDispatch*)this));
+            pvm->SetVariable(1,CComVariant((IDispatch*)this));
 			//ò
             CComVariant externArgs[2];
 			externArgs[0]=func;
 			externArgs[1]=pHF;
 
-            vmachine.ExecScript(externArgs,2);
+            pvm->ExecScript(externArgs,2);
 		}
 	private:
+		//ǰ̵ִ߳ģ״εû±󴴽̵߳ĲλHookUIʱͷ
+		ScriptcRuntime* ThreadContext(void)
+		{
+			ScriptcRuntime** pslot=(ScriptcRuntime**)contextTls.Get();
+			if(pslot && *pslot)
+				return *pslot;
+			CriticalSectionOperator CSO(&contextCriticalSection);
+			if(!pslot)
+			{
+				pslot=new ScriptcRuntime*(NULL);
+				contextTls.Set(pslot);
+				contextSlots.push_back(pslot);
+			}
+			ScriptcRuntime* pvm=vmachine.CreateContext();
+			pvm->OnRuntimeError+=EventFactory::Produce(this,&HookUI::RuntimeError);
+			*pslot=pvm;
+			return pvm;
+		}
+		//ɾȫִģ±ǰ
+		void ReleaseContexts(void)
+		{
+			CriticalSectionOperator CSO(&contextCriticalSection);
+			for(UINT i=0;i<contextSlots.size();i++)
+			{
+				delete *contextSlots[i];
+				*contextSlots[i]=NULL;
+			}
+		}
 		static int Variant2Vars(VARIANT vals,CComVariant* externArgs,int maxnum)
 		{
 			if(vals.vt==VT_EMPTY)
@@ -319,36 +378,32 @@ CString GetHookPath(void)
 			}
 			return 0;
 		}
+		//ժĲһȸ룺ڴѹǲ۵ĵַժʱ߳ҪӲȡoriginAPI
+		//ԿеĲ۳TRAMPOLINE_QUARANTINEʱʹͷŵĲ
 		static inline int GetNullIndex(void)
 		{
-			int ix=0;
-			for(;ix<curHookItemIndex_ && ix<1025;ix++)
-			{
-				if(hookScript_[ix]==0 && oldAPI_[ix]==0 && originAPI_[ix]==0)
-				{
-					break;
-				}
-			}			
-			if(ix>=curHookItemIndex_)
+			if(freeHookSlots_.size()>TRAMPOLINE_QUARANTINE)
 			{
-				if(ix<1025)
-				{
-					ix=curHookItemIndex_;
-					SetNullIndex(ix);
-					curHookItemIndex_++;
-				}
-				else
-				{
-					return -1;
-				}
+				int ix=freeHookSlots_.front();
+				freeHookSlots_.pop_front();
+				ScriptHookSlot& slot=hookSlots_[ix];
+				::memset(&slot,0,sizeof(slot));
+				slot.index=ix;
+				return ix;
 			}
-			return ix;
+			ScriptHookSlot slot;
+			::memset(&slot,0,sizeof(slot));
+			slot.index=hookSlots_.size();
+			hookSlots_.push_back(slot);
+			return slot.index;
 		}
+		//ֻoldAPIʾѿУoriginAPIhookScript۱ʹ
 		static inline void SetNullIndex(int index)
 		{
-			hookScript_[index]=0;
-			oldAPI_[index]=0;
-			originAPI_[index]=0;
+			ScriptHookSlot& slot=hookSlots_[index];
+			trampolinePool_.Free(slot.code);
+			slot.oldAPI=0;
+			freeHookSlots_.push_back(index);
 		}
 	public:
 		bool OnTranslateMsg(HWND,LPMSG pMsg,UINT)
@@ -379,10 +434,16 @@ CString GetHookPath(void)
 			{
 				MyMessageHook<0>::UnHook();
 			}
+			ReleaseContexts();
+			for(UINT i=0;i<contextSlots.size();i++)
+				delete contextSlots[i];
 		}
 	private:
 		bool canRun;
 		ScriptcRuntime vmachine;
+		TlsCap contextTls;
+		std::vector<ScriptcRuntime**> contextSlots;
+		CriticalSection contextCriticalSection;
 		IDispatch* pExt;
 		OSVERSIONINFO ver;
 	};
@@ -433,2066 +494,6 @@ CString GetHookPath(void)
 	}
 
 	
-#define DEFHOOKPROC_(x) \
-	static void __declspec(naked) HookProc_##x()\
-	{\
-		HookProc_(x);\
-	}
-	DEFHOOKPROC_(0)
-	DEFHOOKPROC_(1)
-	DEFHOOKPROC_(2)
-	DEFHOOKPROC_(3)
-	DEFHOOKPROC_(4)
-	DEFHOOKPROC_(5)
-	DEFHOOKPROC_(6)
-	DEFHOOKPROC_(7)
-	DEFHOOKPROC_(8)
-	DEFHOOKPROC_(9)
-	DEFHOOKPROC_(10)
-	DEFHOOKPROC_(11)
-	DEFHOOKPROC_(12)
-	DEFHOOKPROC_(13)
-	DEFHOOKPROC_(14)
-	DEFHOOKPROC_(15)
-	DEFHOOKPROC_(16)
-	DEFHOOKPROC_(17)
-	DEFHOOKPROC_(18)
-	DEFHOOKPROC_(19)
-	DEFHOOKPROC_(20)
-	DEFHOOKPROC_(21)
-	DEFHOOKPROC_(22)
-	DEFHOOKPROC_(23)
-	DEFHOOKPROC_(24)
-	DEFHOOKPROC_(25)
-	DEFHOOKPROC_(26)
-	DEFHOOKPROC_(27)
-	DEFHOOKPROC_(28)
-	DEFHOOKPROC_(29)
-	DEFHOOKPROC_(30)
-	DEFHOOKPROC_(31)
-	DEFHOOKPROC_(32)
-	DEFHOOKPROC_(33)
-	DEFHOOKPROC_(34)
-	DEFHOOKPROC_(35)
-	DEFHOOKPROC_(36)
-	DEFHOOKPROC_(37)
-	DEFHOOKPROC_(38)
-	DEFHOOKPROC_(39)
-	DEFHOOKPROC_(40)
-	DEFHOOKPROC_(41)
-	DEFHOOKPROC_(42)
-	DEFHOOKPROC_(43)
-	DEFHOOKPROC_(44)
-	DEFHOOKPROC_(45)
-	DEFHOOKPROC_(46)
-	DEFHOOKPROC_(47)
-	DEFHOOKPROC_(48)
-	DEFHOOKPROC_(49)
-	DEFHOOKPROC_(50)
-	DEFHOOKPROC_(51)
-	DEFHOOKPROC_(52)
-	DEFHOOKPROC_(53)
-	DEFHOOKPROC_(54)
-	DEFHOOKPROC_(55)
-	DEFHOOKPROC_(56)
-	DEFHOOKPROC_(57)
-	DEFHOOKPROC_(58)
-	DEFHOOKPROC_(59)
-	DEFHOOKPROC_(60)
-	DEFHOOKPROC_(61)
-	DEFHOOKPROC_(62)
-	DEFHOOKPROC_(63)
-	DEFHOOKPROC_(64)
-	DEFHOOKPROC_(65)
-	DEFHOOKPROC_(66)
-	DEFHOOKPROC_(67)
-	DEFHOOKPROC_(68)
-	DEFHOOKPROC_(69)
-	DEFHOOKPROC_(70)
-	DEFHOOKPROC_(71)
-	DEFHOOKPROC_(72)
-	DEFHOOKPROC_(73)
-	DEFHOOKPROC_(74)
-	DEFHOOKPROC_(75)
-	DEFHOOKPROC_(76)
-	DEFHOOKPROC_(77)
-	DEFHOOKPROC_(78)
-	DEFHOOKPROC_(79)
-	DEFHOOKPROC_(80)
-	DEFHOOKPROC_(81)
-	DEFHOOKPROC_(82)
-	DEFHOOKPROC_(83)
-	DEFHOOKPROC_(84)
-	DEFHOOKPROC_(85)
-	DEFHOOKPROC_(86)
-	DEFHOOKPROC_(87)
-	DEFHOOKPROC_(88)
-	DEFHOOKPROC_(89)
-	DEFHOOKPROC_(90)
-	DEFHOOKPROC_(91)
-	DEFHOOKPROC_(92)
-	DEFHOOKPROC_(93)
-	DEFHOOKPROC_(94)
-	DEFHOOKPROC_(95)
-	DEFHOOKPROC_(96)
-	DEFHOOKPROC_(97)
-	DEFHOOKPROC_(98)
-	DEFHOOKPROC_(99)
-	DEFHOOKPROC_(100)
-	DEFHOOKPROC_(101)
-	DEFHOOKPROC_(102)
-	DEFHOOKPROC_(103)
-	DEFHOOKPROC_(104)
-	DEFHOOKPROC_(105)
-	DEFHOOKPROC_(106)
-	DEFHOOKPROC_(107)
-	DEFHOOKPROC_(108)
-	DEFHOOKPROC_(109)
-	DEFHOOKPROC_(110)
-	DEFHOOKPROC_(111)
-	DEFHOOKPROC_(112)
-	DEFHOOKPROC_(113)
-	DEFHOOKPROC_(114)
-	DEFHOOKPROC_(115)
-	DEFHOOKPROC_(116)
-	DEFHOOKPROC_(117)
-	DEFHOOKPROC_(118)
-	DEFHOOKPROC_(119)
-	DEFHOOKPROC_(120)
-	DEFHOOKPROC_(121)
-	DEFHOOKPROC_(122)
-	DEFHOOKPROC_(123)
-	DEFHOOKPROC_(124)
-	DEFHOOKPROC_(125)
-	DEFHOOKPROC_(126)
-	DEFHOOKPROC_(127)
-	DEFHOOKPROC_(128)
-	DEFHOOKPROC_(129)
-	DEFHOOKPROC_(130)
-	DEFHOOKPROC_(131)
-	DEFHOOKPROC_(132)
-	DEFHOOKPROC_(133)
-	DEFHOOKPROC_(134)
-	DEFHOOKPROC_(135)
-	DEFHOOKPROC_(136)
-	DEFHOOKPROC_(137)
-	DEFHOOKPROC_(138)
-	DEFHOOKPROC_(139)
-	DEFHOOKPROC_(140)
-	DEFHOOKPROC_(141)
-	DEFHOOKPROC_(142)
-	DEFHOOKPROC_(143)
-	DEFHOOKPROC_(144)
-	DEFHOOKPROC_(145)
-	DEFHOOKPROC_(146)
-	DEFHOOKPROC_(147)
-	DEFHOOKPROC_(148)
-	DEFHOOKPROC_(149)
-	DEFHOOKPROC_(150)
-	DEFHOOKPROC_(151)
-	DEFHOOKPROC_(152)
-	DEFHOOKPROC_(153)
-	DEFHOOKPROC_(154)
-	DEFHOOKPROC_(155)
-	DEFHOOKPROC_(156)
-	DEFHOOKPROC_(157)
-	DEFHOOKPROC_(158)
-	DEFHOOKPROC_(159)
-	DEFHOOKPROC_(160)
-	DEFHOOKPROC_(161)
-	DEFHOOKPROC_(162)
-	DEFHOOKPROC_(163)
-	DEFHOOKPROC_(164)
-	DEFHOOKPROC_(165)
-	DEFHOOKPROC_(166)
-	DEFHOOKPROC_(167)
-	DEFHOOKPROC_(168)
-	DEFHOOKPROC_(169)
-	DEFHOOKPROC_(170)
-	DEFHOOKPROC_(171)
-	DEFHOOKPROC_(172)
-	DEFHOOKPROC_(173)
-	DEFHOOKPROC_(174)
-	DEFHOOKPROC_(175)
-	DEFHOOKPROC_(176)
-	DEFHOOKPROC_(177)
-	DEFHOOKPROC_(178)
-	DEFHOOKPROC_(179)
-	DEFHOOKPROC_(180)
-	DEFHOOKPROC_(181)
-	DEFHOOKPROC_(182)
-	DEFHOOKPROC_(183)
-	DEFHOOKPROC_(184)
-	DEFHOOKPROC_(185)
-	DEFHOOKPROC_(186)
-	DEFHOOKPROC_(187)
-	DEFHOOKPROC_(188)
-	DEFHOOKPROC_(189)
-	DEFHOOKPROC_(190)
-	DEFHOOKPROC_(191)
-	DEFHOOKPROC_(192)
-	DEFHOOKPROC_(193)
-	DEFHOOKPROC_(194)
-	DEFHOOKPROC_(195)
-	DEFHOOKPROC_(196)
-	DEFHOOKPROC_(197)
-	DEFHOOKPROC_(198)
-	DEFHOOKPROC_(199)
-	DEFHOOKPROC_(200)
-	DEFHOOKPROC_(201)
-	DEFHOOKPROC_(202)
-	DEFHOOKPROC_(203)
-	DEFHOOKPROC_(204)
-	DEFHOOKPROC_(205)
-	DEFHOOKPROC_(206)
-	DEFHOOKPROC_(207)
-	DEFHOOKPROC_(208)
-	DEFHOOKPROC_(209)
-	DEFHOOKPROC_(210)
-	DEFHOOKPROC_(211)
-	DEFHOOKPROC_(212)
-	DEFHOOKPROC_(213)
-	DEFHOOKPROC_(214)
-	DEFHOOKPROC_(215)
-	DEFHOOKPROC_(216)
-	DEFHOOKPROC_(217)
-	DEFHOOKPROC_(218)
-	DEFHOOKPROC_(219)
-	DEFHOOKPROC_(220)
-	DEFHOOKPROC_(221)
-	DEFHOOKPROC_(222)
-	DEFHOOKPROC_(223)
-	DEFHOOKPROC_(224)
-	DEFHOOKPROC_(225)
-	DEFHOOKPROC_(226)
-	DEFHOOKPROC_(227)
-	DEFHOOKPROC_(228)
-	DEFHOOKPROC_(229)
-	DEFHOOKPROC_(230)
-	DEFHOOKPROC_(231)
-	DEFHOOKPROC_(232)
-	DEFHOOKPROC_(233)
-	DEFHOOKPROC_(234)
-	DEFHOOKPROC_(235)
-	DEFHOOKPROC_(236)
-	DEFHOOKPROC_(237)
-	DEFHOOKPROC_(238)
-	DEFHOOKPROC_(239)
-	DEFHOOKPROC_(240)
-	DEFHOOKPROC_(241)
-	DEFHOOKPROC_(242)
-	DEFHOOKPROC_(243)
-	DEFHOOKPROC_(244)
-	DEFHOOKPROC_(245)
-	DEFHOOKPROC_(246)
-	DEFHOOKPROC_(247)
-	DEFHOOKPROC_(248)
-	DEFHOOKPROC_(249)
-	DEFHOOKPROC_(250)
-	DEFHOOKPROC_(251)
-	DEFHOOKPROC_(252)
-	DEFHOOKPROC_(253)
-	DEFHOOKPROC_(254)
-	DEFHOOKPROC_(255)
-	DEFHOOKPROC_(256)
-	DEFHOOKPROC_(257)
-	DEFHOOKPROC_(258)
-	DEFHOOKPROC_(259)
-	DEFHOOKPROC_(260)
-	DEFHOOKPROC_(261)
-	DEFHOOKPROC_(262)
-	DEFHOOKPROC_(263)
-	DEFHOOKPROC_(264)
-	DEFHOOKPROC_(265)
-	DEFHOOKPROC_(266)
-	DEFHOOKPROC_(267)
-	DEFHOOKPROC_(268)
-	DEFHOOKPROC_(269)
-	DEFHOOKPROC_(270)
-	DEFHOOKPROC_(271)
-	DEFHOOKPROC_(272)
-	DEFHOOKPROC_(273)
-	DEFHOOKPROC_(274)
-	DEFHOOKPROC_(275)
-	DEFHOOKPROC_(276)
-	DEFHOOKPROC_(277)
-	DEFHOOKPROC_(278)
-	DEFHOOKPROC_(279)
-	DEFHOOKPROC_(280)
-	DEFHOOKPROC_(281)
-	DEFHOOKPROC_(282)
-	DEFHOOKPROC_(283)
-	DEFHOOKPROC_(284)
-	DEFHOOKPROC_(285)
-	DEFHOOKPROC_(286)
-	DEFHOOKPROC_(287)
-	DEFHOOKPROC_(288)
-	DEFHOOKPROC_(289)
-	DEFHOOKPROC_(290)
-	DEFHOOKPROC_(291)
-	DEFHOOKPROC_(292)
-	DEFHOOKPROC_(293)
-	DEFHOOKPROC_(294)
-	DEFHOOKPROC_(295)
-	DEFHOOKPROC_(296)
-	DEFHOOKPROC_(297)
-	DEFHOOKPROC_(298)
-	DEFHOOKPROC_(299)
-	DEFHOOKPROC_(300)
-	DEFHOOKPROC_(301)
-	DEFHOOKPROC_(302)
-	DEFHOOKPROC_(303)
-	DEFHOOKPROC_(304)
-	DEFHOOKPROC_(305)
-	DEFHOOKPROC_(306)
-	DEFHOOKPROC_(307)
-	DEFHOOKPROC_(308)
-	DEFHOOKPROC_(309)
-	DEFHOOKPROC_(310)
-	DEFHOOKPROC_(311)
-	DEFHOOKPROC_(312)
-	DEFHOOKPROC_(313)
-	DEFHOOKPROC_(314)
-	DEFHOOKPROC_(315)
-	DEFHOOKPROC_(316)
-	DEFHOOKPROC_(317)
-	DEFHOOKPROC_(318)
-	DEFHOOKPROC_(319)
-	DEFHOOKPROC_(320)
-	DEFHOOKPROC_(321)
-	DEFHOOKPROC_(322)
-	DEFHOOKPROC_(323)
-	DEFHOOKPROC_(324)
-	DEFHOOKPROC_(325)
-	DEFHOOKPROC_(326)
-	DEFHOOKPROC_(327)
-	DEFHOOKPROC_(328)
-	DEFHOOKPROC_(329)
-	DEFHOOKPROC_(330)
-	DEFHOOKPROC_(331)
-	DEFHOOKPROC_(332)
-	DEFHOOKPROC_(333)
-	DEFHOOKPROC_(334)
-	DEFHOOKPROC_(335)
-	DEFHOOKPROC_(336)
-	DEFHOOKPROC_(337)
-	DEFHOOKPROC_(338)
-	DEFHOOKPROC_(339)
-	DEFHOOKPROC_(340)
-	DEFHOOKPROC_(341)
-	DEFHOOKPROC_(342)
-	DEFHOOKPROC_(343)
-	DEFHOOKPROC_(344)
-	DEFHOOKPROC_(345)
-	DEFHOOKPROC_(346)
-	DEFHOOKPROC_(347)
-	DEFHOOKPROC_(348)
-	DEFHOOKPROC_(349)
-	DEFHOOKPROC_(350)
-	DEFHOOKPROC_(351)
-	DEFHOOKPROC_(352)
-	DEFHOOKPROC_(353)
-	DEFHOOKPROC_(354)
-	DEFHOOKPROC_(355)
-	DEFHOOKPROC_(356)
-	DEFHOOKPROC_(357)
-	DEFHOOKPROC_(358)
-	DEFHOOKPROC_(359)
-	DEFHOOKPROC_(360)
-	DEFHOOKPROC_(361)
-	DEFHOOKPROC_(362)
-	DEFHOOKPROC_(363)
-	DEFHOOKPROC_(364)
-	DEFHOOKPROC_(365)
-	DEFHOOKPROC_(366)
-	DEFHOOKPROC_(367)
-	DEFHOOKPROC_(368)
-	DEFHOOKPROC_(369)
-	DEFHOOKPROC_(370)
-	DEFHOOKPROC_(371)
-	DEFHOOKPROC_(372)
-	DEFHOOKPROC_(373)
-	DEFHOOKPROC_(374)
-	DEFHOOKPROC_(375)
-	DEFHOOKPROC_(376)
-	DEFHOOKPROC_(377)
-	DEFHOOKPROC_(378)
-	DEFHOOKPROC_(379)
-	DEFHOOKPROC_(380)
-	DEFHOOKPROC_(381)
-	DEFHOOKPROC_(382)
-	DEFHOOKPROC_(383)
-	DEFHOOKPROC_(384)
-	DEFHOOKPROC_(385)
-	DEFHOOKPROC_(386)
-	DEFHOOKPROC_(387)
-	DEFHOOKPROC_(388)
-	DEFHOOKPROC_(389)
-	DEFHOOKPROC_(390)
-	DEFHOOKPROC_(391)
-	DEFHOOKPROC_(392)
-	DEFHOOKPROC_(393)
-	DEFHOOKPROC_(394)
-	DEFHOOKPROC_(395)
-	DEFHOOKPROC_(396)
-	DEFHOOKPROC_(397)
-	DEFHOOKPROC_(398)
-	DEFHOOKPROC_(399)
-	DEFHOOKPROC_(400)
-	DEFHOOKPROC_(401)
-	DEFHOOKPROC_(402)
-	DEFHOOKPROC_(403)
-	DEFHOOKPROC_(404)
-	DEFHOOKPROC_(405)
-	DEFHOOKPROC_(406)
-	DEFHOOKPROC_(407)
-	DEFHOOKPROC_(408)
-	DEFHOOKPROC_(409)
-	DEFHOOKPROC_(410)
-	DEFHOOKPROC_(411)
-	DEFHOOKPROC_(412)
-	DEFHOOKPROC_(413)
-	DEFHOOKPROC_(414)
-	DEFHOOKPROC_(415)
-	DEFHOOKPROC_(416)
-	DEFHOOKPROC_(417)
-	DEFHOOKPROC_(418)
-	DEFHOOKPROC_(419)
-	DEFHOOKPROC_(420)
-	DEFHOOKPROC_(421)
-	DEFHOOKPROC_(422)
-	DEFHOOKPROC_(423)
-	DEFHOOKPROC_(424)
-	DEFHOOKPROC_(425)
-	DEFHOOKPROC_(426)
-	DEFHOOKPROC_(427)
-	DEFHOOKPROC_(428)
-	DEFHOOKPROC_(429)
-	DEFHOOKPROC_(430)
-	DEFHOOKPROC_(431)
-	DEFHOOKPROC_(432)
-	DEFHOOKPROC_(433)
-	DEFHOOKPROC_(434)
-	DEFHOOKPROC_(435)
-	DEFHOOKPROC_(436)
-	DEFHOOKPROC_(437)
-	DEFHOOKPROC_(438)
-	DEFHOOKPROC_(439)
-	DEFHOOKPROC_(440)
-	DEFHOOKPROC_(441)
-	DEFHOOKPROC_(442)
-	DEFHOOKPROC_(443)
-	DEFHOOKPROC_(444)
-	DEFHOOKPROC_(445)
-	DEFHOOKPROC_(446)
-	DEFHOOKPROC_(447)
-	DEFHOOKPROC_(448)
-	DEFHOOKPROC_(449)
-	DEFHOOKPROC_(450)
-	DEFHOOKPROC_(451)
-	DEFHOOKPROC_(452)
-	DEFHOOKPROC_(453)
-	DEFHOOKPROC_(454)
-	DEFHOOKPROC_(455)
-	DEFHOOKPROC_(456)
-	DEFHOOKPROC_(457)
-	DEFHOOKPROC_(458)
-	DEFHOOKPROC_(459)
-	DEFHOOKPROC_(460)
-	DEFHOOKPROC_(461)
-	DEFHOOKPROC_(462)
-	DEFHOOKPROC_(463)
-	DEFHOOKPROC_(464)
-	DEFHOOKPROC_(465)
-	DEFHOOKPROC_(466)
-	DEFHOOKPROC_(467)
-	DEFHOOKPROC_(468)
-	DEFHOOKPROC_(469)
-	DEFHOOKPROC_(470)
-	DEFHOOKPROC_(471)
-	DEFHOOKPROC_(472)
-	DEFHOOKPROC_(473)
-	DEFHOOKPROC_(474)
-	DEFHOOKPROC_(475)
-	DEFHOOKPROC_(476)
-	DEFHOOKPROC_(477)
-	DEFHOOKPROC_(478)
-	DEFHOOKPROC_(479)
-	DEFHOOKPROC_(480)
-	DEFHOOKPROC_(481)
-	DEFHOOKPROC_(482)
-	DEFHOOKPROC_(483)
-	DEFHOOKPROC_(484)
-	DEFHOOKPROC_(485)
-	DEFHOOKPROC_(486)
-	DEFHOOKPROC_(487)
-	DEFHOOKPROC_(488)
-	DEFHOOKPROC_(489)
-	DEFHOOKPROC_(490)
-	DEFHOOKPROC_(491)
-	DEFHOOKPROC_(492)
-	DEFHOOKPROC_(493)
-	DEFHOOKPROC_(494)
-	DEFHOOKPROC_(495)
-	DEFHOOKPROC_(496)
-	DEFHOOKPROC_(497)
-	DEFHOOKPROC_(498)
-	DEFHOOKPROC_(499)
-	DEFHOOKPROC_(500)
-	DEFHOOKPROC_(501)
-	DEFHOOKPROC_(502)
-	DEFHOOKPROC_(503)
-	DEFHOOKPROC_(504)
-	DEFHOOKPROC_(505)
-	DEFHOOKPROC_(506)
-	DEFHOOKPROC_(507)
-	DEFHOOKPROC_(508)
-	DEFHOOKPROC_(509)
-	DEFHOOKPROC_(510)
-	DEFHOOKPROC_(511)
-	DEFHOOKPROC_(512)
-	DEFHOOKPROC_(513)
-	DEFHOOKPROC_(514)
-	DEFHOOKPROC_(515)
-	DEFHOOKPROC_(516)
-	DEFHOOKPROC_(517)
-	DEFHOOKPROC_(518)
-	DEFHOOKPROC_(519)
-	DEFHOOKPROC_(520)
-	DEFHOOKPROC_(521)
-	DEFHOOKPROC_(522)
-	DEFHOOKPROC_(523)
-	DEFHOOKPROC_(524)
-	DEFHOOKPROC_(525)
-	DEFHOOKPROC_(526)
-	DEFHOOKPROC_(527)
-	DEFHOOKPROC_(528)
-	DEFHOOKPROC_(529)
-	DEFHOOKPROC_(530)
-	DEFHOOKPROC_(531)
-	DEFHOOKPROC_(532)
-	DEFHOOKPROC_(533)
-	DEFHOOKPROC_(534)
-	DEFHOOKPROC_(535)
-	DEFHOOKPROC_(536)
-	DEFHOOKPROC_(537)
-	DEFHOOKPROC_(538)
-	DEFHOOKPROC_(539)
-	DEFHOOKPROC_(540)
-	DEFHOOKPROC_(541)
-	DEFHOOKPROC_(542)
-	DEFHOOKPROC_(543)
-	DEFHOOKPROC_(544)
-	DEFHOOKPROC_(545)
-	DEFHOOKPROC_(546)
-	DEFHOOKPROC_(547)
-	DEFHOOKPROC_(548)
-	DEFHOOKPROC_(549)
-	DEFHOOKPROC_(550)
-	DEFHOOKPROC_(551)
-	DEFHOOKPROC_(552)
-	DEFHOOKPROC_(553)
-	DEFHOOKPROC_(554)
-	DEFHOOKPROC_(555)
-	DEFHOOKPROC_(556)
-	DEFHOOKPROC_(557)
-	DEFHOOKPROC_(558)
-	DEFHOOKPROC_(559)
-	DEFHOOKPROC_(560)
-	DEFHOOKPROC_(561)
-	DEFHOOKPROC_(562)
-	DEFHOOKPROC_(563)
-	DEFHOOKPROC_(564)
-	DEFHOOKPROC_(565)
-	DEFHOOKPROC_(566)
-	DEFHOOKPROC_(567)
-	DEFHOOKPROC_(568)
-	DEFHOOKPROC_(569)
-	DEFHOOKPROC_(570)
-	DEFHOOKPROC_(571)
-	DEFHOOKPROC_(572)
-	DEFHOOKPROC_(573)
-	DEFHOOKPROC_(574)
-	DEFHOOKPROC_(575)
-	DEFHOOKPROC_(576)
-	DEFHOOKPROC_(577)
-	DEFHOOKPROC_(578)
-	DEFHOOKPROC_(579)
-	DEFHOOKPROC_(580)
-	DEFHOOKPROC_(581)
-	DEFHOOKPROC_(582)
-	DEFHOOKPROC_(583)
-	DEFHOOKPROC_(584)
-	DEFHOOKPROC_(585)
-	DEFHOOKPROC_(586)
-	DEFHOOKPROC_(587)
-	DEFHOOKPROC_(588)
-	DEFHOOKPROC_(589)
-	DEFHOOKPROC_(590)
-	DEFHOOKPROC_(591)
-	DEFHOOKPROC_(592)
-	DEFHOOKPROC_(593)
-	DEFHOOKPROC_(594)
-	DEFHOOKPROC_(595)
-	DEFHOOKPROC_(596)
-	DEFHOOKPROC_(597)
-	DEFHOOKPROC_(598)
-	DEFHOOKPROC_(599)
-	DEFHOOKPROC_(600)
-	DEFHOOKPROC_(601)
-	DEFHOOKPROC_(602)
-	DEFHOOKPROC_(603)
-	DEFHOOKPROC_(604)
-	DEFHOOKPROC_(605)
-	DEFHOOKPROC_(606)
-	DEFHOOKPROC_(607)
-	DEFHOOKPROC_(608)
-	DEFHOOKPROC_(609)
-	DEFHOOKPROC_(610)
-	DEFHOOKPROC_(611)
-	DEFHOOKPROC_(612)
-	DEFHOOKPROC_(613)
-	DEFHOOKPROC_(614)
-	DEFHOOKPROC_(615)
-	DEFHOOKPROC_(616)
-	DEFHOOKPROC_(617)
-	DEFHOOKPROC_(618)
-	DEFHOOKPROC_(619)
-	DEFHOOKPROC_(620)
-	DEFHOOKPROC_(621)
-	DEFHOOKPROC_(622)
-	DEFHOOKPROC_(623)
-	DEFHOOKPROC_(624)
-	DEFHOOKPROC_(625)
-	DEFHOOKPROC_(626)
-	DEFHOOKPROC_(627)
-	DEFHOOKPROC_(628)
-	DEFHOOKPROC_(629)
-	DEFHOOKPROC_(630)
-	DEFHOOKPROC_(631)
-	DEFHOOKPROC_(632)
-	DEFHOOKPROC_(633)
-	DEFHOOKPROC_(634)
-	DEFHOOKPROC_(635)
-	DEFHOOKPROC_(636)
-	DEFHOOKPROC_(637)
-	DEFHOOKPROC_(638)
-	DEFHOOKPROC_(639)
-	DEFHOOKPROC_(640)
-	DEFHOOKPROC_(641)
-	DEFHOOKPROC_(642)
-	DEFHOOKPROC_(643)
-	DEFHOOKPROC_(644)
-	DEFHOOKPROC_(645)
-	DEFHOOKPROC_(646)
-	DEFHOOKPROC_(647)
-	DEFHOOKPROC_(648)
-	DEFHOOKPROC_(649)
-	DEFHOOKPROC_(650)
-	DEFHOOKPROC_(651)
-	DEFHOOKPROC_(652)
-	DEFHOOKPROC_(653)
-	DEFHOOKPROC_(654)
-	DEFHOOKPROC_(655)
-	DEFHOOKPROC_(656)
-	DEFHOOKPROC_(657)
-	DEFHOOKPROC_(658)
-	DEFHOOKPROC_(659)
-	DEFHOOKPROC_(660)
-	DEFHOOKPROC_(661)
-	DEFHOOKPROC_(662)
-	DEFHOOKPROC_(663)
-	DEFHOOKPROC_(664)
-	DEFHOOKPROC_(665)
-	DEFHOOKPROC_(666)
-	DEFHOOKPROC_(667)
-	DEFHOOKPROC_(668)
-	DEFHOOKPROC_(669)
-	DEFHOOKPROC_(670)
-	DEFHOOKPROC_(671)
-	DEFHOOKPROC_(672)
-	DEFHOOKPROC_(673)
-	DEFHOOKPROC_(674)
-	DEFHOOKPROC_(675)
-	DEFHOOKPROC_(676)
-	DEFHOOKPROC_(677)
-	DEFHOOKPROC_(678)
-	DEFHOOKPROC_(679)
-	DEFHOOKPROC_(680)
-	DEFHOOKPROC_(681)
-	DEFHOOKPROC_(682)
-	DEFHOOKPROC_(683)
-	DEFHOOKPROC_(684)
-	DEFHOOKPROC_(685)
-	DEFHOOKPROC_(686)
-	DEFHOOKPROC_(687)
-	DEFHOOKPROC_(688)
-	DEFHOOKPROC_(689)
-	DEFHOOKPROC_(690)
-	DEFHOOKPROC_(691)
-	DEFHOOKPROC_(692)
-	DEFHOOKPROC_(693)
-	DEFHOOKPROC_(694)
-	DEFHOOKPROC_(695)
-	DEFHOOKPROC_(696)
-	DEFHOOKPROC_(697)
-	DEFHOOKPROC_(698)
-	DEFHOOKPROC_(699)
-	DEFHOOKPROC_(700)
-	DEFHOOKPROC_(701)
-	DEFHOOKPROC_(702)
-	DEFHOOKPROC_(703)
-	DEFHOOKPROC_(704)
-	DEFHOOKPROC_(705)
-	DEFHOOKPROC_(706)
-	DEFHOOKPROC_(707)
-	DEFHOOKPROC_(708)
-	DEFHOOKPROC_(709)
-	DEFHOOKPROC_(710)
-	DEFHOOKPROC_(711)
-	DEFHOOKPROC_(712)
-	DEFHOOKPROC_(713)
-	DEFHOOKPROC_(714)
-	DEFHOOKPROC_(715)
-	DEFHOOKPROC_(716)
-	DEFHOOKPROC_(717)
-	DEFHOOKPROC_(718)
-	DEFHOOKPROC_(719)
-	DEFHOOKPROC_(720)
-	DEFHOOKPROC_(721)
-	DEFHOOKPROC_(722)
-	DEFHOOKPROC_(723)
-	DEFHOOKPROC_(724)
-	DEFHOOKPROC_(725)
-	DEFHOOKPROC_(726)
-	DEFHOOKPROC_(727)
-	DEFHOOKPROC_(728)
-	DEFHOOKPROC_(729)
-	DEFHOOKPROC_(730)
-	DEFHOOKPROC_(731)
-	DEFHOOKPROC_(732)
-	DEFHOOKPROC_(733)
-	DEFHOOKPROC_(734)
-	DEFHOOKPROC_(735)
-	DEFHOOKPROC_(736)
-	DEFHOOKPROC_(737)
-	DEFHOOKPROC_(738)
-	DEFHOOKPROC_(739)
-	DEFHOOKPROC_(740)
-	DEFHOOKPROC_(741)
-	DEFHOOKPROC_(742)
-	DEFHOOKPROC_(743)
-	DEFHOOKPROC_(744)
-	DEFHOOKPROC_(745)
-	DEFHOOKPROC_(746)
-	DEFHOOKPROC_(747)
-	DEFHOOKPROC_(748)
-	DEFHOOKPROC_(749)
-	DEFHOOKPROC_(750)
-	DEFHOOKPROC_(751)
-	DEFHOOKPROC_(752)
-	DEFHOOKPROC_(753)
-	DEFHOOKPROC_(754)
-	DEFHOOKPROC_(755)
-	DEFHOOKPROC_(756)
-	DEFHOOKPROC_(757)
-	DEFHOOKPROC_(758)
-	DEFHOOKPROC_(759)
-	DEFHOOKPROC_(760)
-	DEFHOOKPROC_(761)
-	DEFHOOKPROC_(762)
-	DEFHOOKPROC_(763)
-	DEFHOOKPROC_(764)
-	DEFHOOKPROC_(765)
-	DEFHOOKPROC_(766)
-	DEFHOOKPROC_(767)
-	DEFHOOKPROC_(768)
-	DEFHOOKPROC_(769)
-	DEFHOOKPROC_(770)
-	DEFHOOKPROC_(771)
-	DEFHOOKPROC_(772)
-	DEFHOOKPROC_(773)
-	DEFHOOKPROC_(774)
-	DEFHOOKPROC_(775)
-	DEFHOOKPROC_(776)
-	DEFHOOKPROC_(777)
-	DEFHOOKPROC_(778)
-	DEFHOOKPROC_(779)
-	DEFHOOKPROC_(780)
-	DEFHOOKPROC_(781)
-	DEFHOOKPROC_(782)
-	DEFHOOKPROC_(783)
-	DEFHOOKPROC_(784)
-	DEFHOOKPROC_(785)
-	DEFHOOKPROC_(786)
-	DEFHOOKPROC_(787)
-	DEFHOOKPROC_(788)
-	DEFHOOKPROC_(789)
-	DEFHOOKPROC_(790)
-	DEFHOOKPROC_(791)
-	DEFHOOKPROC_(792)
-	DEFHOOKPROC_(793)
-	DEFHOOKPROC_(794)
-	DEFHOOKPROC_(795)
-	DEFHOOKPROC_(796)
-	DEFHOOKPROC_(797)
-	DEFHOOKPROC_(798)
-	DEFHOOKPROC_(799)
-	DEFHOOKPROC_(800)
-	DEFHOOKPROC_(801)
-	DEFHOOKPROC_(802)
-	DEFHOOKPROC_(803)
-	DEFHOOKPROC_(804)
-	DEFHOOKPROC_(805)
-	DEFHOOKPROC_(806)
-	DEFHOOKPROC_(807)
-	DEFHOOKPROC_(808)
-	DEFHOOKPROC_(809)
-	DEFHOOKPROC_(810)
-	DEFHOOKPROC_(811)
-	DEFHOOKPROC_(812)
-	DEFHOOKPROC_(813)
-	DEFHOOKPROC_(814)
-	DEFHOOKPROC_(815)
-	DEFHOOKPROC_(816)
-	DEFHOOKPROC_(817)
-	DEFHOOKPROC_(818)
-	DEFHOOKPROC_(819)
-	DEFHOOKPROC_(820)
-	DEFHOOKPROC_(821)
-	DEFHOOKPROC_(822)
-	DEFHOOKPROC_(823)
-	DEFHOOKPROC_(824)
-	DEFHOOKPROC_(825)
-	DEFHOOKPROC_(826)
-	DEFHOOKPROC_(827)
-	DEFHOOKPROC_(828)
-	DEFHOOKPROC_(829)
-	DEFHOOKPROC_(830)
-	DEFHOOKPROC_(831)
-	DEFHOOKPROC_(832)
-	DEFHOOKPROC_(833)
-	DEFHOOKPROC_(834)
-	DEFHOOKPROC_(835)
-	DEFHOOKPROC_(836)
-	DEFHOOKPROC_(837)
-	DEFHOOKPROC_(838)
-	DEFHOOKPROC_(839)
-	DEFHOOKPROC_(840)
-	DEFHOOKPROC_(841)
-	DEFHOOKPROC_(842)
-	DEFHOOKPROC_(843)
-	DEFHOOKPROC_(844)
-	DEFHOOKPROC_(845)
-	DEFHOOKPROC_(846)
-	DEFHOOKPROC_(847)
-	DEFHOOKPROC_(848)
-	DEFHOOKPROC_(849)
-	DEFHOOKPROC_(850)
-	DEFHOOKPROC_(851)
-	DEFHOOKPROC_(852)
-	DEFHOOKPROC_(853)
-	DEFHOOKPROC_(854)
-	DEFHOOKPROC_(855)
-	DEFHOOKPROC_(856)
-	DEFHOOKPROC_(857)
-	DEFHOOKPROC_(858)
-	DEFHOOKPROC_(859)
-	DEFHOOKPROC_(860)
-	DEFHOOKPROC_(861)
-	DEFHOOKPROC_(862)
-	DEFHOOKPROC_(863)
-	DEFHOOKPROC_(864)
-	DEFHOOKPROC_(865)
-	DEFHOOKPROC_(866)
-	DEFHOOKPROC_(867)
-	DEFHOOKPROC_(868)
-	DEFHOOKPROC_(869)
-	DEFHOOKPROC_(870)
-	DEFHOOKPROC_(871)
-	DEFHOOKPROC_(872)
-	DEFHOOKPROC_(873)
-	DEFHOOKPROC_(874)
-	DEFHOOKPROC_(875)
-	DEFHOOKPROC_(876)
-	DEFHOOKPROC_(877)
-	DEFHOOKPROC_(878)
-	DEFHOOKPROC_(879)
-	DEFHOOKPROC_(880)
-	DEFHOOKPROC_(881)
-	DEFHOOKPROC_(882)
-	DEFHOOKPROC_(883)
-	DEFHOOKPROC_(884)
-	DEFHOOKPROC_(885)
-	DEFHOOKPROC_(886)
-	DEFHOOKPROC_(887)
-	DEFHOOKPROC_(888)
-	DEFHOOKPROC_(889)
-	DEFHOOKPROC_(890)
-	DEFHOOKPROC_(891)
-	DEFHOOKPROC_(892)
-	DEFHOOKPROC_(893)
-	DEFHOOKPROC_(894)
-	DEFHOOKPROC_(895)
-	DEFHOOKPROC_(896)
-	DEFHOOKPROC_(897)
-	DEFHOOKPROC_(898)
-	DEFHOOKPROC_(899)
-	DEFHOOKPROC_(900)
-	DEFHOOKPROC_(901)
-	DEFHOOKPROC_(902)
-	DEFHOOKPROC_(903)
-	DEFHOOKPROC_(904)
-	DEFHOOKPROC_(905)
-	DEFHOOKPROC_(906)
-	DEFHOOKPROC_(907)
-	DEFHOOKPROC_(908)
-	DEFHOOKPROC_(909)
-	DEFHOOKPROC_(910)
-	DEFHOOKPROC_(911)
-	DEFHOOKPROC_(912)
-	DEFHOOKPROC_(913)
-	DEFHOOKPROC_(914)
-	DEFHOOKPROC_(915)
-	DEFHOOKPROC_(916)
-	DEFHOOKPROC_(917)
-	DEFHOOKPROC_(918)
-	DEFHOOKPROC_(919)
-	DEFHOOKPROC_(920)
-	DEFHOOKPROC_(921)
-	DEFHOOKPROC_(922)
-	DEFHOOKPROC_(923)
-	DEFHOOKPROC_(924)
-	DEFHOOKPROC_(925)
-	DEFHOOKPROC_(926)
-	DEFHOOKPROC_(927)
-	DEFHOOKPROC_(928)
-	DEFHOOKPROC_(929)
-	DEFHOOKPROC_(930)
-	DEFHOOKPROC_(931)
-	DEFHOOKPROC_(932)
-	DEFHOOKPROC_(933)
-	DEFHOOKPROC_(934)
-	DEFHOOKPROC_(935)
-	DEFHOOKPROC_(936)
-	DEFHOOKPROC_(937)
-	DEFHOOKPROC_(938)
-	DEFHOOKPROC_(939)
-	DEFHOOKPROC_(940)
-	DEFHOOKPROC_(941)
-	DEFHOOKPROC_(942)
-	DEFHOOKPROC_(943)
-	DEFHOOKPROC_(944)
-	DEFHOOKPROC_(945)
-	DEFHOOKPROC_(946)
-	DEFHOOKPROC_(947)
-	DEFHOOKPROC_(948)
-	DEFHOOKPROC_(949)
-	DEFHOOKPROC_(950)
-	DEFHOOKPROC_(951)
-	DEFHOOKPROC_(952)
-	DEFHOOKPROC_(953)
-	DEFHOOKPROC_(954)
-	DEFHOOKPROC_(955)
-	DEFHOOKPROC_(956)
-	DEFHOOKPROC_(957)
-	DEFHOOKPROC_(958)
-	DEFHOOKPROC_(959)
-	DEFHOOKPROC_(960)
-	DEFHOOKPROC_(961)
-	DEFHOOKPROC_(962)
-	DEFHOOKPROC_(963)
-	DEFHOOKPROC_(964)
-	DEFHOOKPROC_(965)
-	DEFHOOKPROC_(966)
-	DEFHOOKPROC_(967)
-	DEFHOOKPROC_(968)
-	DEFHOOKPROC_(969)
-	DEFHOOKPROC_(970)
-	DEFHOOKPROC_(971)
-	DEFHOOKPROC_(972)
-	DEFHOOKPROC_(973)
-	DEFHOOKPROC_(974)
-	DEFHOOKPROC_(975)
-	DEFHOOKPROC_(976)
-	DEFHOOKPROC_(977)
-	DEFHOOKPROC_(978)
-	DEFHOOKPROC_(979)
-	DEFHOOKPROC_(980)
-	DEFHOOKPROC_(981)
-	DEFHOOKPROC_(982)
-	DEFHOOKPROC_(983)
-	DEFHOOKPROC_(984)
-	DEFHOOKPROC_(985)
-	DEFHOOKPROC_(986)
-	DEFHOOKPROC_(987)
-	DEFHOOKPROC_(988)
-	DEFHOOKPROC_(989)
-	DEFHOOKPROC_(990)
-	DEFHOOKPROC_(991)
-	DEFHOOKPROC_(992)
-	DEFHOOKPROC_(993)
-	DEFHOOKPROC_(994)
-	DEFHOOKPROC_(995)
-	DEFHOOKPROC_(996)
-	DEFHOOKPROC_(997)
-	DEFHOOKPROC_(998)
-	DEFHOOKPROC_(999)
-	DEFHOOKPROC_(1000)
-	DEFHOOKPROC_(1001)
-	DEFHOOKPROC_(1002)
-	DEFHOOKPROC_(1003)
-	DEFHOOKPROC_(1004)
-	DEFHOOKPROC_(1005)
-	DEFHOOKPROC_(1006)
-	DEFHOOKPROC_(1007)
-	DEFHOOKPROC_(1008)
-	DEFHOOKPROC_(1009)
-	DEFHOOKPROC_(1010)
-	DEFHOOKPROC_(1011)
-	DEFHOOKPROC_(1012)
-	DEFHOOKPROC_(1013)
-	DEFHOOKPROC_(1014)
-	DEFHOOKPROC_(1015)
-	DEFHOOKPROC_(1016)
-	DEFHOOKPROC_(1017)
-	DEFHOOKPROC_(1018)
-	DEFHOOKPROC_(1019)
-	DEFHOOKPROC_(1020)
-	DEFHOOKPROC_(1021)
-	DEFHOOKPROC_(1022)
-	DEFHOOKPROC_(1023)
-	DEFHOOKPROC_(1024)
-#undef DEFHOOKPROC_
-	static MYHOOKPROC hookProc_[1025]=
-	{
-		HookProc_0	,
-		HookProc_1	,
-		HookProc_2	,
-		HookProc_3	,
-		HookProc_4	,
-		HookProc_5	,
-		HookProc_6	,
-		HookProc_7	,
-		HookProc_8	,
-		HookProc_9	,
-		HookProc_10	,
-		HookProc_11	,
-		HookProc_12	,
-		HookProc_13	,
-		HookProc_14	,
-		HookProc_15	,
-		HookProc_16	,
-		HookProc_17	,
-		HookProc_18	,
-		HookProc_19	,
-		HookProc_20	,
-		HookProc_21	,
-		HookProc_22	,
-		HookProc_23	,
-		HookProc_24	,
-		HookProc_25	,
-		HookProc_26	,
-		HookProc_27	,
-		HookProc_28	,
-		HookProc_29	,
-		HookProc_30	,
-		HookProc_31	,
-		HookProc_32	,
-		HookProc_33	,
-		HookProc_34	,
-		HookProc_35	,
-		HookProc_36	,
-		HookProc_37	,
-		HookProc_38	,
-		HookProc_39	,
-		HookProc_40	,
-		HookProc_41	,
-		HookProc_42	,
-		HookProc_43	,
-		HookProc_44	,
-		HookProc_45	,
-		HookProc_46	,
-		HookProc_47	,
-		HookProc_48	,
-		HookProc_49	,
-		HookProc_50	,
-		HookProc_51	,
-		HookProc_52	,
-		HookProc_53	,
-		HookProc_54	,
-		HookProc_55	,
-		HookProc_56	,
-		HookProc_57	,
-		HookProc_58	,
-		HookProc_59	,
-		HookProc_60	,
-		HookProc_61	,
-		HookProc_62	,
-		HookProc_63	,
-		HookProc_64	,
-		HookProc_65	,
-		HookProc_66	,
-		HookProc_67	,
-		HookProc_68	,
-		HookProc_69	,
-		HookProc_70	,
-		HookProc_71	,
-		HookProc_72	,
-		HookProc_73	,
-		HookProc_74	,
-		HookProc_75	,
-		HookProc_76	,
-		HookProc_77	,
-		HookProc_78	,
-		HookProc_79	,
-		HookProc_80	,
-		HookProc_81	,
-		HookProc_82	,
-		HookProc_83	,
-		HookProc_84	,
-		HookProc_85	,
-		HookProc_86	,
-		HookProc_87	,
-		HookProc_88	,
-		HookProc_89	,
-		HookProc_90	,
-		HookProc_91	,
-		HookProc_92	,
-		HookProc_93	,
-		HookProc_94	,
-		HookProc_95	,
-		HookProc_96	,
-		HookProc_97	,
-		HookProc_98	,
-		HookProc_99	,
-		HookProc_100	,
-		HookProc_101	,
-		HookProc_102	,
-		HookProc_103	,
-		HookProc_104	,
-		HookProc_105	,
-		HookProc_106	,
-		HookProc_107	,
-		HookProc_108	,
-		HookProc_109	,
-		HookProc_110	,
-		HookProc_111	,
-		HookProc_112	,
-		HookProc_113	,
-		HookProc_114	,
-		HookProc_115	,
-		HookProc_116	,
-		HookProc_117	,
-		HookProc_118	,
-		HookProc_119	,
-		HookProc_120	,
-		HookProc_121	,
-		HookProc_122	,
-		HookProc_123	,
-		HookProc_124	,
-		HookProc_125	,
-		HookProc_126	,
-		HookProc_127	,
-		HookProc_128	,
-		HookProc_129	,
-		HookProc_130	,
-		HookProc_131	,
-		HookProc_132	,
-		HookProc_133	,
-		HookProc_134	,
-		HookProc_135	,
-		HookProc_136	,
-		HookProc_137	,
-		HookProc_138	,
-		HookProc_139	,
-		HookProc_140	,
-		HookProc_141	,
-		HookProc_142	,
-		HookProc_143	,
-		HookProc_144	,
-		HookProc_145	,
-		HookProc_146	,
-		HookProc_147	,
-		HookProc_148	,
-		HookProc_149	,
-		HookProc_150	,
-		HookProc_151	,
-		HookProc_152	,
-		HookProc_153	,
-		HookProc_154	,
-		HookProc_155	,
-		HookProc_156	,
-		HookProc_157	,
-		HookProc_158	,
-		HookProc_159	,
-		HookProc_160	,
-		HookProc_161	,
-		HookProc_162	,
-		HookProc_163	,
-		HookProc_164	,
-		HookProc_165	,
-		HookProc_166	,
-		HookProc_167	,
-		HookProc_168	,
-		HookProc_169	,
-		HookProc_170	,
-		HookProc_171	,
-		HookProc_172	,
-		HookProc_173	,
-		HookProc_174	,
-		HookProc_175	,
-		HookProc_176	,
-		HookProc_177	,
-		HookProc_178	,
-		HookProc_179	,
-		HookProc_180	,
-		HookProc_181	,
-		HookProc_182	,
-		HookProc_183	,
-		HookProc_184	,
-		HookProc_185	,
-		HookProc_186	,
-		HookProc_187	,
-		HookProc_188	,
-		HookProc_189	,
-		HookProc_190	,
-		HookProc_191	,
-		HookProc_192	,
-		HookProc_193	,
-		HookProc_194	,
-		HookProc_195	,
-		HookProc_196	,
-		HookProc_197	,
-		HookProc_198	,
-		HookProc_199	,
-		HookProc_200	,
-		HookProc_201	,
-		HookProc_202	,
-		HookProc_203	,
-		HookProc_204	,
-		HookProc_205	,
-		HookProc_206	,
-		HookProc_207	,
-		HookProc_208	,
-		HookProc_209	,
-		HookProc_210	,
-		HookProc_211	,
-		HookProc_212	,
-		HookProc_213	,
-		HookProc_214	,
-		HookProc_215	,
-		HookProc_216	,
-		HookProc_217	,
-		HookProc_218	,
-		HookProc_219	,
-		HookProc_220	,
-		HookProc_221	,
-		HookProc_222	,
-		HookProc_223	,
-		HookProc_224	,
-		HookProc_225	,
-		HookProc_226	,
-		HookProc_227	,
-		HookProc_228	,
-		HookProc_229	,
-		HookProc_230	,
-		HookProc_231	,
-		HookProc_232	,
-		HookProc_233	,
-		HookProc_234	,
-		HookProc_235	,
-		HookProc_236	,
-		HookProc_237	,
-		HookProc_238	,
-		HookProc_239	,
-		HookProc_240	,
-		HookProc_241	,
-		HookProc_242	,
-		HookProc_243	,
-		HookProc_244	,
-		HookProc_245	,
-		HookProc_246	,
-		HookProc_247	,
-		HookProc_248	,
-		HookProc_249	,
-		HookProc_250	,
-		HookProc_251	,
-		HookProc_252	,
-		HookProc_253	,
-		HookProc_254	,
-		HookProc_255	,
-		HookProc_256	,
-		HookProc_257	,
-		HookProc_258	,
-		HookProc_259	,
-		HookProc_260	,
-		HookProc_261	,
-		HookProc_262	,
-		HookProc_263	,
-		HookProc_264	,
-		HookProc_265	,
-		HookProc_266	,
-		HookProc_267	,
-		HookProc_268	,
-		HookProc_269	,
-		HookProc_270	,
-		HookProc_271	,
-		HookProc_272	,
-		HookProc_273	,
-		HookProc_274	,
-		HookProc_275	,
-		HookProc_276	,
-		HookProc_277	,
-		HookProc_278	,
-		HookProc_279	,
-		HookProc_280	,
-		HookProc_281	,
-		HookProc_282	,
-		HookProc_283	,
-		HookProc_284	,
-		HookProc_285	,
-		HookProc_286	,
-		HookProc_287	,
-		HookProc_288	,
-		HookProc_289	,
-		HookProc_290	,
-		HookProc_291	,
-		HookProc_292	,
-		HookProc_293	,
-		HookProc_294	,
-		HookProc_295	,
-		HookProc_296	,
-		HookProc_297	,
-		HookProc_298	,
-		HookProc_299	,
-		HookProc_300	,
-		HookProc_301	,
-		HookProc_302	,
-		HookProc_303	,
-		HookProc_304	,
-		HookProc_305	,
-		HookProc_306	,
-		HookProc_307	,
-		HookProc_308	,
-		HookProc_309	,
-		HookProc_310	,
-		HookProc_311	,
-		HookProc_312	,
-		HookProc_313	,
-		HookProc_314	,
-		HookProc_315	,
-		HookProc_316	,
-		HookProc_317	,
-		HookProc_318	,
-		HookProc_319	,
-		HookProc_320	,
-		HookProc_321	,
-		HookProc_322	,
-		HookProc_323	,
-		HookProc_324	,
-		HookProc_325	,
-		HookProc_326	,
-		HookProc_327	,
-		HookProc_328	,
-		HookProc_329	,
-		HookProc_330	,
-		HookProc_331	,
-		HookProc_332	,
-		HookProc_333	,
-		HookProc_334	,
-		HookProc_335	,
-		HookProc_336	,
-		HookProc_337	,
-		HookProc_338	,
-		HookProc_339	,
-		HookProc_340	,
-		HookProc_341	,
-		HookProc_342	,
-		HookProc_343	,
-		HookProc_344	,
-		HookProc_345	,
-		HookProc_346	,
-		HookProc_347	,
-		HookProc_348	,
-		HookProc_349	,
-		HookProc_350	,
-		HookProc_351	,
-		HookProc_352	,
-		HookProc_353	,
-		HookProc_354	,
-		HookProc_355	,
-		HookProc_356	,
-		HookProc_357	,
-		HookProc_358	,
-		HookProc_359	,
-		HookProc_360	,
-		HookProc_361	,
-		HookProc_362	,
-		HookProc_363	,
-		HookProc_364	,
-		HookProc_365	,
-		HookProc_366	,
-		HookProc_367	,
-		HookProc_368	,
-		HookProc_369	,
-		HookProc_370	,
-		HookProc_371	,
-		HookProc_372	,
-		HookProc_373	,
-		HookProc_374	,
-		HookProc_375	,
-		HookProc_376	,
-		HookProc_377	,
-		HookProc_378	,
-		HookProc_379	,
-		HookProc_380	,
-		HookProc_381	,
-		HookProc_382	,
-		HookProc_383	,
-		HookProc_384	,
-		HookProc_385	,
-		HookProc_386	,
-		HookProc_387	,
-		HookProc_388	,
-		HookProc_389	,
-		HookProc_390	,
-		HookProc_391	,
-		HookProc_392	,
-		HookProc_393	,
-		HookProc_394	,
-		HookProc_395	,
-		HookProc_396	,
-		HookProc_397	,
-		HookProc_398	,
-		HookProc_399	,
-		HookProc_400	,
-		HookProc_401	,
-		HookProc_402	,
-		HookProc_403	,
-		HookProc_404	,
-		HookProc_405	,
-		HookProc_406	,
-		HookProc_407	,
-		HookProc_408	,
-		HookProc_409	,
-		HookProc_410	,
-		HookProc_411	,
-		HookProc_412	,
-		HookProc_413	,
-		HookProc_414	,
-		HookProc_415	,
-		HookProc_416	,
-		HookProc_417	,
-		HookProc_418	,
-		HookProc_419	,
-		HookProc_420	,
-		HookProc_421	,
-		HookProc_422	,
-		HookProc_423	,
-		HookProc_424	,
-		HookProc_425	,
-		HookProc_426	,
-		HookProc_427	,
-		HookProc_428	,
-		HookProc_429	,
-		HookProc_430	,
-		HookProc_431	,
-		HookProc_432	,
-		HookProc_433	,
-		HookProc_434	,
-		HookProc_435	,
-		HookProc_436	,
-		HookProc_437	,
-		HookProc_438	,
-		HookProc_439	,
-		HookProc_440	,
-		HookProc_441	,
-		HookProc_442	,
-		HookProc_443	,
-		HookProc_444	,
-		HookProc_445	,
-		HookProc_446	,
-		HookProc_447	,
-		HookProc_448	,
-		HookProc_449	,
-		HookProc_450	,
-		HookProc_451	,
-		HookProc_452	,
-		HookProc_453	,
-		HookProc_454	,
-		HookProc_455	,
-		HookProc_456	,
-		HookProc_457	,
-		HookProc_458	,
-		HookProc_459	,
-		HookProc_460	,
-		HookProc_461	,
-		HookProc_462	,
-		HookProc_463	,
-		HookProc_464	,
-		HookProc_465	,
-		HookProc_466	,
-		HookProc_467	,
-		HookProc_468	,
-		HookProc_469	,
-		HookProc_470	,
-		HookProc_471	,
-		HookProc_472	,
-		HookProc_473	,
-		HookProc_474	,
-		HookProc_475	,
-		HookProc_476	,
-		HookProc_477	,
-		HookProc_478	,
-		HookProc_479	,
-		HookProc_480	,
-		HookProc_481	,
-		HookProc_482	,
-		HookProc_483	,
-		HookProc_484	,
-		HookProc_485	,
-		HookProc_486	,
-		HookProc_487	,
-		HookProc_488	,
-		HookProc_489	,
-		HookProc_490	,
-		HookProc_491	,
-		HookProc_492	,
-		HookProc_493	,
-		HookProc_494	,
-		HookProc_495	,
-		HookProc_496	,
-		HookProc_497	,
-		HookProc_498	,
-		HookProc_499	,
-		HookProc_500	,
-		HookProc_501	,
-		HookProc_502	,
-		HookProc_503	,
-		HookProc_504	,
-		HookProc_505	,
-		HookProc_506	,
-		HookProc_507	,
-		HookProc_508	,
-		HookProc_509	,
-		HookProc_510	,
-		HookProc_511	,
-		HookProc_512	,
-		HookProc_513	,
-		HookProc_514	,
-		HookProc_515	,
-		HookProc_516	,
-		HookProc_517	,
-		HookProc_518	,
-		HookProc_519	,
-		HookProc_520	,
-		HookProc_521	,
-		HookProc_522	,
-		HookProc_523	,
-		HookProc_524	,
-		HookProc_525	,
-		HookProc_526	,
-		HookProc_527	,
-		HookProc_528	,
-		HookProc_529	,
-		HookProc_530	,
-		HookProc_531	,
-		HookProc_532	,
-		HookProc_533	,
-		HookProc_534	,
-		HookProc_535	,
-		HookProc_536	,
-		HookProc_537	,
-		HookProc_538	,
-		HookProc_539	,
-		HookProc_540	,
-		HookProc_541	,
-		HookProc_542	,
-		HookProc_543	,
-		HookProc_544	,
-		HookProc_545	,
-		HookProc_546	,
-		HookProc_547	,
-		HookProc_548	,
-		HookProc_549	,
-		HookProc_550	,
-		HookProc_551	,
-		HookProc_552	,
-		HookProc_553	,
-		HookProc_554	,
-		HookProc_555	,
-		HookProc_556	,
-		HookProc_557	,
-		HookProc_558	,
-		HookProc_559	,
-		HookProc_560	,
-		HookProc_561	,
-		HookProc_562	,
-		HookProc_563	,
-		HookProc_564	,
-		HookProc_565	,
-		HookProc_566	,
-		HookProc_567	,
-		HookProc_568	,
-		HookProc_569	,
-		HookProc_570	,
-		HookProc_571	,
-		HookProc_572	,
-		HookProc_573	,
-		HookProc_574	,
-		HookProc_575	,
-		HookProc_576	,
-		HookProc_577	,
-		HookProc_578	,
-		HookProc_579	,
-		HookProc_580	,
-		HookProc_581	,
-		HookProc_582	,
-		HookProc_583	,
-		HookProc_584	,
-		HookProc_585	,
-		HookProc_586	,
-		HookProc_587	,
-		HookProc_588	,
-		HookProc_589	,
-		HookProc_590	,
-		HookProc_591	,
-		HookProc_592	,
-		HookProc_593	,
-		HookProc_594	,
-		HookProc_595	,
-		HookProc_596	,
-		HookProc_597	,
-		HookProc_598	,
-		HookProc_599	,
-		HookProc_600	,
-		HookProc_601	,
-		HookProc_602	,
-		HookProc_603	,
-		HookProc_604	,
-		HookProc_605	,
-		HookProc_606	,
-		HookProc_607	,
-		HookProc_608	,
-		HookProc_609	,
-		HookProc_610	,
-		HookProc_611	,
-		HookProc_612	,
-		HookProc_613	,
-		HookProc_614	,
-		HookProc_615	,
-		HookProc_616	,
-		HookProc_617	,
-		HookProc_618	,
-		HookProc_619	,
-		HookProc_620	,
-		HookProc_621	,
-		HookProc_622	,
-		HookProc_623	,
-		HookProc_624	,
-		HookProc_625	,
-		HookProc_626	,
-		HookProc_627	,
-		HookProc_628	,
-		HookProc_629	,
-		HookProc_630	,
-		HookProc_631	,
-		HookProc_632	,
-		HookProc_633	,
-		HookProc_634	,
-		HookProc_635	,
-		HookProc_636	,
-		HookProc_637	,
-		HookProc_638	,
-		HookProc_639	,
-		HookProc_640	,
-		HookProc_641	,
-		HookProc_642	,
-		HookProc_643	,
-		HookProc_644	,
-		HookProc_645	,
-		HookProc_646	,
-		HookProc_647	,
-		HookProc_648	,
-		HookProc_649	,
-		HookProc_650	,
-		HookProc_651	,
-		HookProc_652	,
-		HookProc_653	,
-		HookProc_654	,
-		HookProc_655	,
-		HookProc_656	,
-		HookProc_657	,
-		HookProc_658	,
-		HookProc_659	,
-		HookProc_660	,
-		HookProc_661	,
-		HookProc_662	,
-		HookProc_663	,
-		HookProc_664	,
-		HookProc_665	,
-		HookProc_666	,
-		HookProc_667	,
-		HookProc_668	,
-		HookProc_669	,
-		HookProc_670	,
-		HookProc_671	,
-		HookProc_672	,
-		HookProc_673	,
-		HookProc_674	,
-		HookProc_675	,
-		HookProc_676	,
-		HookProc_677	,
-		HookProc_678	,
-		HookProc_679	,
-		HookProc_680	,
-		HookProc_681	,
-		HookProc_682	,
-		HookProc_683	,
-		HookProc_684	,
-		HookProc_685	,
-		HookProc_686	,
-		HookProc_687	,
-		HookProc_688	,
-		HookProc_689	,
-		HookProc_690	,
-		HookProc_691	,
-		HookProc_692	,
-		HookProc_693	,
-		HookProc_694	,
-		HookProc_695	,
-		HookProc_696	,
-		HookProc_697	,
-		HookProc_698	,
-		HookProc_699	,
-		HookProc_700	,
-		HookProc_701	,
-		HookProc_702	,
-		HookProc_703	,
-		HookProc_704	,
-		HookProc_705	,
-		HookProc_706	,
-		HookProc_707	,
-		HookProc_708	,
-		HookProc_709	,
-		HookProc_710	,
-		HookProc_711	,
-		HookProc_712	,
-		HookProc_713	,
-		HookProc_714	,
-		HookProc_715	,
-		HookProc_716	,
-		HookProc_717	,
-		HookProc_718	,
-		HookProc_719	,
-		HookProc_720	,
-		HookProc_721	,
-		HookProc_722	,
-		HookProc_723	,
-		HookProc_724	,
-		HookProc_725	,
-		HookProc_726	,
-		HookProc_727	,
-		HookProc_728	,
-		HookProc_729	,
-		HookProc_730	,
-		HookProc_731	,
-		HookProc_732	,
-		HookProc_733	,
-		HookProc_734	,
-		HookProc_735	,
-		HookProc_736	,
-		HookProc_737	,
-		HookProc_738	,
-		HookProc_739	,
-		HookProc_740	,
-		HookProc_741	,
-		HookProc_742	,
-		HookProc_743	,
-		HookProc_744	,
-		HookProc_745	,
-		HookProc_746	,
-		HookProc_747	,
-		HookProc_748	,
-		HookProc_749	,
-		HookProc_750	,
-		HookProc_751	,
-		HookProc_752	,
-		HookProc_753	,
-		HookProc_754	,
-		HookProc_755	,
-		HookProc_756	,
-		HookProc_757	,
-		HookProc_758	,
-		HookProc_759	,
-		HookProc_760	,
-		HookProc_761	,
-		HookProc_762	,
-		HookProc_763	,
-		HookProc_764	,
-		HookProc_765	,
-		HookProc_766	,
-		HookProc_767	,
-		HookProc_768	,
-		HookProc_769	,
-		HookProc_770	,
-		HookProc_771	,
-		HookProc_772	,
-		HookProc_773	,
-		HookProc_774	,
-		HookProc_775	,
-		HookProc_776	,
-		HookProc_777	,
-		HookProc_778	,
-		HookProc_779	,
-		HookProc_780	,
-		HookProc_781	,
-		HookProc_782	,
-		HookProc_783	,
-		HookProc_784	,
-		HookProc_785	,
-		HookProc_786	,
-		HookProc_787	,
-		HookProc_788	,
-		HookProc_789	,
-		HookProc_790	,
-		HookProc_791	,
-		HookProc_792	,
-		HookProc_793	,
-		HookProc_794	,
-		HookProc_795	,
-		HookProc_796	,
-		HookProc_797	,
-		HookProc_798	,
-		HookProc_799	,
-		HookProc_800	,
-		HookProc_801	,
-		HookProc_802	,
-		HookProc_803	,
-		HookProc_804	,
-		HookProc_805	,
-		HookProc_806	,
-		HookProc_807	,
-		HookProc_808	,
-		HookProc_809	,
-		HookProc_810	,
-		HookProc_811	,
-		HookProc_812	,
-		HookProc_813	,
-		HookProc_814	,
-		HookProc_815	,
-		HookProc_816	,
-		HookProc_817	,
-		HookProc_818	,
-		HookProc_819	,
-		HookProc_820	,
-		HookProc_821	,
-		HookProc_822	,
-		HookProc_823	,
-		HookProc_824	,
-		HookProc_825	,
-		HookProc_826	,
-		HookProc_827	,
-		HookProc_828	,
-		HookProc_829	,
-		HookProc_830	,
-		HookProc_831	,
-		HookProc_832	,
-		HookProc_833	,
-		HookProc_834	,
-		HookProc_835	,
-		HookProc_836	,
-		HookProc_837	,
-		HookProc_838	,
-		HookProc_839	,
-		HookProc_840	,
-		HookProc_841	,
-		HookProc_842	,
-		HookProc_843	,
-		HookProc_844	,
-		HookProc_845	,
-		HookProc_846	,
-		HookProc_847	,
-		HookProc_848	,
-		HookProc_849	,
-		HookProc_850	,
-		HookProc_851	,
-		HookProc_852	,
-		HookProc_853	,
-		HookProc_854	,
-		HookProc_855	,
-		HookProc_856	,
-		HookProc_857	,
-		HookProc_858	,
-		HookProc_859	,
-		HookProc_860	,
-		HookProc_861	,
-		HookProc_862	,
-		HookProc_863	,
-		HookProc_864	,
-		HookProc_865	,
-		HookProc_866	,
-		HookProc_867	,
-		HookProc_868	,
-		HookProc_869	,
-		HookProc_870	,
-		HookProc_871	,
-		HookProc_872	,
-		HookProc_873	,
-		HookProc_874	,
-		HookProc_875	,
-		HookProc_876	,
-		HookProc_877	,
-		HookProc_878	,
-		HookProc_879	,
-		HookProc_880	,
-		HookProc_881	,
-		HookProc_882	,
-		HookProc_883	,
-		HookProc_884	,
-		HookProc_885	,
-		HookProc_886	,
-		HookProc_887	,
-		HookProc_888	,
-		HookProc_889	,
-		HookProc_890	,
-		HookProc_891	,
-		HookProc_892	,
-		HookProc_893	,
-		HookProc_894	,
-		HookProc_895	,
-		HookProc_896	,
-		HookProc_897	,
-		HookProc_898	,
-		HookProc_899	,
-		HookProc_900	,
-		HookProc_901	,
-		HookProc_902	,
-		HookProc_903	,
-		HookProc_904	,
-		HookProc_905	,
-		HookProc_906	,
-		HookProc_907	,
-		HookProc_908	,
-		HookProc_909	,
-		HookProc_910	,
-		HookProc_911	,
-		HookProc_912	,
-		HookProc_913	,
-		HookProc_914	,
-		HookProc_915	,
-		HookProc_916	,
-		HookProc_917	,
-		HookProc_918	,
-		HookProc_919	,
-		HookProc_920	,
-		HookProc_921	,
-		HookProc_922	,
-		HookProc_923	,
-		HookProc_924	,
-		HookProc_925	,
-		HookProc_926	,
-		HookProc_927	,
-		HookProc_928	,
-		HookProc_929	,
-		HookProc_930	,
-		HookProc_931	,
-		HookProc_932	,
-		HookProc_933	,
-		HookProc_934	,
-		HookProc_935	,
-		HookProc_936	,
-		HookProc_937	,
-		HookProc_938	,
-		HookProc_939	,
-		HookProc_940	,
-		HookProc_941	,
-		HookProc_942	,
-		HookProc_943	,
-		HookProc_944	,
-		HookProc_945	,
-		HookProc_946	,
-		HookProc_947	,
-		HookProc_948	,
-		HookProc_949	,
-		HookProc_950	,
-		HookProc_951	,
-		HookProc_952	,
-		HookProc_953	,
-		HookProc_954	,
-		HookProc_955	,
-		HookProc_956	,
-		HookProc_957	,
-		HookProc_958	,
-		HookProc_959	,
-		HookProc_960	,
-		HookProc_961	,
-		HookProc_962	,
-		HookProc_963	,
-		HookProc_964	,
-		HookProc_965	,
-		HookProc_966	,
-		HookProc_967	,
-		HookProc_968	,
-		HookProc_969	,
-		HookProc_970	,
-		HookProc_971	,
-		HookProc_972	,
-		HookProc_973	,
-		HookProc_974	,
-		HookProc_975	,
-		HookProc_976	,
-		HookProc_977	,
-		HookProc_978	,
-		HookProc_979	,
-		HookProc_980	,
-		HookProc_981	,
-		HookProc_982	,
-		HookProc_983	,
-		HookProc_984	,
-		HookProc_985	,
-		HookProc_986	,
-		HookProc_987	,
-		HookProc_988	,
-		HookProc_989	,
-		HookProc_990	,
-		HookProc_991	,
-		HookProc_992	,
-		HookProc_993	,
-		HookProc_994	,
-		HookProc_995	,
-		HookProc_996	,
-		HookProc_997	,
-		HookProc_998	,
-		HookProc_999	,
-		HookProc_1000	,
-		HookProc_1001	,
-		HookProc_1002	,
-		HookProc_1003	,
-		HookProc_1004	,
-		HookProc_1005	,
-		HookProc_1006	,
-		HookProc_1007	,
-		HookProc_1008	,
-		HookProc_1009	,
-		HookProc_1010	,
-		HookProc_1011	,
-		HookProc_1012	,
-		HookProc_1013	,
-		HookProc_1014	,
-		HookProc_1015	,
-		HookProc_1016	,
-		HookProc_1017	,
-		HookProc_1018	,
-		HookProc_1019	,
-		HookProc_1020	,
-		HookProc_1021	,
-		HookProc_1022	,
-		HookProc_1023	,
-		HookProc_1024	
-	};			
-
 #define DEFHOOKPROC(x) \
 	static void __declspec(naked) HookProc##x()\
 	{\
@@ -4553,16 +2554,105 @@ CString GetHookPath(void)
 		HookProc1024	
 	};					
 		
-	void Log(const char* mess)
+	static void SendLog(HWND hWnd,unsigned short channel,const char* mess)
+	{
+		COPYDATASTRUCT data={channel,::strlen(mess)+1,(LPVOID)mess};
+		::SendMessage(hWnd,WM_COPYDATA,NULL,(LPARAM)&data);
+	}
+	//־д빲ڴĸٻأתֱ̻߳Ӵ򿪻Ĳ鿴첽ȡߣ
+	//ʱûнٻʱԭķʽͬ͸ScriptHookڡ
+	void LogTrace(int hook,unsigned short channel,const char* mess)
 	{
-		CString ss(mess);
-		char*s=(LPSTR)(LPCSTR)ss;
+		TraceRing& ring=traceSegment.Ring();
+		if(ring.IsAttached())
+		{
+			ring.Write(hook,channel,mess);
+			return;
+		}
 		HWND hWnd=::FindWindow(NULL,"ScriptHook");
 		if(::IsWindow(hWnd))
+			SendLog(hWnd,channel,mess);
+	}
+	void Log(const char* mess)
+	{
+		LogTrace(TRACE_NOHOOK,0,mess);
+	}
+	//ȡ߸ٻдõ־͸ScriptHookڡÿȡȨͷţ
+	//鿴ԼȡȨһֱʱת̲߳ȡ־
+	static void ForwardTrace(HWND& hWnd)
+	{
+		if(!traceSegment.Claim())
+			return;
+		TraceRing& ring=traceSegment.Ring();
+		TraceRecord rec;
+		while(ring.Read(rec))
+		{
+			if(!::IsWindow(hWnd))
+				hWnd=::FindWindow(NULL,"ScriptHook");
+			if(hWnd)
+				SendLog(hWnd,rec.channel,rec.text);
+		}
+		traceSegment.Release();
+	}
+	//ת̳߳бģһãDLLʱжءյֹ֪ͣͨԼ
+	//תʣ־ͳƣͷ˳жʱװеȴ
+	//岻رգԿڱ߳д־
+	static DWORD WINAPI TraceForwardProc(void*)
+	{
+		HWND hWnd=NULL;
+		while(::WaitForSingleObject(traceStop,TRACE_FORWARDINTERVAL)==WAIT_TIMEOUT)
+			ForwardTrace(hWnd);
+		char buf[128];
+		::sprintf(buf,"trace written:%d,dropped:%d,truncated:%d,abandoned:%d.",traceSegment.Ring().Written(),traceSegment.Ring().Dropped(),
+			traceSegment.Ring().Truncated(),traceSegment.Ring().Abandoned());
+		Log(buf);
+		ForwardTrace(hWnd);
+		::FreeLibraryAndExitThread(traceModule,0);
+		return 0;
+	}
+	static void StartTrace(void)
+	{
+		if(!traceSegment.Open())
+			return;
+		char path[MAX_PATH+1];
+		DWORD len=::GetModuleFileName(_Module.GetModuleInstance(),path,MAX_PATH);
+		path[len]=0;
+		traceModule=::LoadLibrary(path);
+		traceStop=::CreateEvent(NULL,TRUE,FALSE,NULL);
+		if(traceModule && traceStop)
+			traceThread=::CreateThread(NULL,0,TraceForwardProc,NULL,0,NULL);
+		if(!traceThread)
+		{
+			//ûת߳ʱ־ֻڻеȲ鿴ȡ
+			if(traceModule)
+				::FreeLibrary(traceModule);
+			traceModule=NULL;
+		}
+	}
+	//DLLװ֮ãUninit֪ͨת߳β˳ȴ
+	static void StopTrace(void)
+	{
+		if(traceThread)
+		{
+			::SetEvent(traceStop);
+			::CloseHandle(traceThread);
+			traceThread=NULL;
+		}
+	}
+	//DLLжʱãʱװȴκ̡߳ת̳߳ģã
+	//ҪôѾ˳Ҫôǽڽѱϵͳֹʣ־ڻɲ鿴ȡ
+	static void CloseTrace(void)
+	{
+		if(traceThread)
 		{
-			COPYDATASTRUCT data={0x0,::strlen(s)+1,(LPVOID)s};
-			::SendMessage(hWnd,WM_COPYDATA,NULL,(LPARAM)&data);
+			::CloseHandle(traceThread);
+			traceThread=NULL;
 		}
+		if(traceSegment.Ring().IsAttached())
+			traceSegment.Close();
+		if(traceStop)
+			::CloseHandle(traceStop);
+		traceStop=NULL;
 	}
 	//ʹֲ߳̾洢ΪӺCallScriptHookCallBeforeExitScriptĵñ봫ϢǵӺ룬
 	//ҪCallScriptHookCallBeforeExitScriptвͬʱȡ־ֵáǰĳסĺԭֱӻ
@@ -4585,7 +2675,7 @@ CString GetHookPath(void)
 			return rt;
 	}
 	//ýűʵֵĹӣ๳ûʽ趨ʱ
-	static void __stdcall CallScriptHook_(int index,long eip,long thisPtr,long regedx,long regebx,long regebp,long regesi,long regedi,long regeax,long regesp,long regeflags,long paramPtr,long& directReturn,long& popNBytes)
+	static void __stdcall CallScriptHook_(ScriptHookSlot* slot,long eip,long thisPtr,long regedx,long regebx,long regebp,long regesi,long regedi,long regeax,long regesp,long regeflags,long paramPtr,long& directReturn,long& popNBytes)
 	{	
 		int segcs,segds,seges,segss,segfs,seggs;
 		__asm
@@ -4604,18 +2694,25 @@ CString GetHookPath(void)
 			mov ax,ss
 			mov segss,eax
 		}
-		HookFunc* f=hookFunc;
-		f->Push();
-		f->Init();
-		f->PutCallData(eip,thisPtr,paramPtr);
-		f->PutOriginalAPI(originAPI_[index]);
-		f->PutSegmentRegister(segcs,segds,seges,segss,segfs,seggs);
-		f->PutGeneralRegister(regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags);
+		HookFrame* frame=HookFunc::Push();
+		if(!frame)
+		{
+			//ڴ治ȡ֡ʱִнűճԭ
+			directReturn=0;
+			popNBytes=0;
+			return;
+		}
+		HookFunc* f=frame->func;
+		frame->PutCallData(eip,thisPtr,paramPtr);
+		frame->hookIndex=TRACE_SCRIPTHOOK|slot->index;
+		frame->originalAPI=slot->originAPI;
+		frame->PutSegmentRegister(segcs,segds,seges,segss,segfs,seggs);
+		frame->PutGeneralRegister(regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags);
 		try
 		{				
 			if(model)
 			{
-				UINT funcAddr=hookScript_[index];
+				UINT funcAddr=slot->hookScript;
 				model->CallScript_(funcAddr,f);			
 			}			
 		}
@@ -4626,20 +2723,20 @@ CString GetHookPath(void)
 				model->RuntimeError("űô");			
 			}
 		}
-		directReturn=f->get_DirectReturn();
-		popNBytes=f->get_PopNBytes();
+		directReturn=frame->directReturn;
+		popNBytes=frame->popNBytes;
 		//ûBeforeExitӣ뺯ʱѹHookFuncϢջ
 		if(directReturn!=2)
-				f->Pop();
+				HookFunc::Pop();
 	}
 	static void __stdcall CallBeforeExitScript_(void)
 	{
-		HookFunc* f=hookFunc;
+		HookFunc* f=HookFunc::Current()->func;
 		try
 		{
 			if(model)
 			{
-				UINT funcAddr=f->get_BeforeExitScript();
+				UINT funcAddr=f->Frame().beforeExitScript;
 				model->CallScript_(funcAddr,f);			
 			}
 		}
@@ -4652,13 +2749,13 @@ CString GetHookPath(void)
 		}
 		long baseAddr=GetBaseAddr();
 		*(long*)(baseAddr+orginReturnAddr)=f->get_Eip();			
-		f->Pop();
+		HookFunc::Pop();
 	}
 	//: ڹסҪAPI⴦,
 	//		Լջ뷵ֵnakedΣ
 	//: void 
-	//б: int index
-	static void __declspec(naked) HookProc_(int index)
+	//б: ScriptHookSlot* slot еڴѹ
+	static void __declspec(naked) HookProc_(ScriptHookSlot* slot)
 	{		
 		__asm
 		{
@@ -4700,10 +2797,8 @@ CString GetHookPath(void)
 			cmp dword ptr [eax],0	;빳Ӻù
 			jna starthook	
 tooriginal:
-			mov eax,index
-			shl eax,2
-			add eax,offset originAPI_
-			mov eax,[eax]			
+			mov eax,slot
+			mov eax,[eax]			;ȡslot->originAPI			
 			mov esp,ebp				;ָջ
 			pop ebp					;ָ˺ʱEBP
 			add esp,8				;뱾úʱIP
@@ -4719,16 +2814,14 @@ starthook:
 			mov popNBytes,eax
 			
 		}		
-		CallScriptHook_(index,eip,thisPtr,regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags,paramPtr,directReturn,popNBytes);
+		CallScriptHook_(slot,eip,thisPtr,regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags,paramPtr,directReturn,popNBytes);
 		__asm
 		{	
 			mov eax,directReturn
 			test eax,eax
 			jnz dreturn
-			mov eax,index
-			shl eax,2
-			add eax,offset originAPI_
-			mov eax,[eax]			
+			mov eax,slot
+			mov eax,[eax]			;ȡslot->originAPI			
 			mov esp,ebp				;ָջ
 			pop ebp					;ָ˺ʱEBP
 			add esp,8				;뱾úʱIP
@@ -4760,10 +2853,8 @@ dreturn:
 			mov eax,[eax+regEAX]	;÷ֵ32λ
 			ret 0					;
 beforeexit:
-			mov eax,index
-			shl eax,2
-			add eax,offset originAPI_
-			mov eax,[eax]
+			mov eax,slot
+			mov eax,[eax]			;ȡslot->originAPI
 			mov esp,ebp				;ָջ
 			pop ebp					;ָ˺ʱEBP
 			add esp,8				;뱾úʱIP
@@ -4796,12 +2887,13 @@ beforeexit:
 	}
 	static bool CreateHookImpl(int ix,VARIANT func,VARIANT api,VARIANT module)
 	{
-		//ȷºַ
+		//ȷºַűӵڴȡ֮
+		ScriptHookSlot& slot=hookSlots_[ix];
 		SetHookInfoPtr pSetHookInfo=NULL;
 		DWORD newproc=0;
 		if(func.vt==VT_BSTR)
 		{
-			hookScript_[ix]=0;
+			slot.hookScript=0;
 			if(cppModule)
 			{
 				pSetHookInfo=(SetHookInfoPtr)::GetProcAddress(cppModule,"_SetHookInfo@8");
@@ -4811,10 +2903,9 @@ beforeexit:
 		}
 		else if(func.vt==VT_I4 || func.vt==VT_UI4 || func.vt==VT_INT || func.vt==VT_UINT)
 		{
-			hookScript_[ix]=func.ulVal;
-			newproc=(DWORD)hookProc_[ix];
+			slot.hookScript=func.ulVal;
 		}
-		if(!newproc)
+		if(!newproc && !slot.hookScript)
 			return false;
 		//ȡģ		
 		HMODULE hModule=NULL;
@@ -4855,18 +2946,30 @@ beforeexit:
 			else
 				proc=v+(DWORD)hModule;
 		}
-		if(proc)
+		if(!proc)
+			return false;
+		slot.code=trampolinePool_.Alloc((PBYTE)proc);
+		if(!slot.code)
+			return false;
+		if(slot.hookScript)
+		{
+			//push slot; call HookProc_
+			PBYTE entry=slot.code+TRAMPOLINE_CODESIZE;
+			entry[0]=0x68;
+			*(DWORD*)(entry+1)=(DWORD)&slot;
+			entry[5]=0xe8;
+			*(LONG*)(entry+6)=(LONG)((DWORD)HookProc_-(DWORD)(entry+HOOKENTRY_SIZE));
+			newproc=(DWORD)entry;
+		}
+		if(!Trampoline::Create((PBYTE)proc,slot.code,newproc))
+			return false;
+		slot.oldAPI=proc;
+		slot.originAPI=(DWORD)slot.code;
+		if(pSetHookInfo)
 		{
-			Trampoline::Create((PBYTE)proc,trampoline_+ix*40,newproc);
-			oldAPI_[ix]=proc;
-			originAPI_[ix]=(DWORD)(trampoline_+ix*40);
-			if(pSetHookInfo)
-			{
-				(*pSetHookInfo)(newproc,originAPI_[ix]);
-			}
-			return true;
+			(*pSetHookInfo)(newproc,slot.originAPI);
 		}
-		return false;
+		return true;
 	}
 	//C++űĹӲ֣ⲿֹڳʼʱЧһֱЧ
 	static void __stdcall CallScriptHook(int index,long eip,long thisPtr,long regedx,long regebx,long regebp,long regesi,long regedi,long regeax,long regesp,long regeflags,long paramPtr,long& directReturn,long& popNBytes)
@@ -4888,19 +2991,25 @@ beforeexit:
 			mov ax,ss
 			mov segss,eax
 		}
-		HookFunc* f=hookFunc;
-		f->Push();
-		f->Init();
-		f->PutCallData(eip,thisPtr,paramPtr);
-		f->PutOriginalAPI(originAPI[index]);
-		f->PutSegmentRegister(segcs,segds,seges,segss,segfs,seggs);
-		f->PutGeneralRegister(regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags);
+		HookFrame* frame=HookFunc::Push();
+		if(!frame)
+		{
+			//ڴ治ȡ֡ʱִнűճԭ
+			directReturn=0;
+			popNBytes=0;
+			return;
+		}
+		HookFunc* f=frame->func;
+		frame->PutCallData(eip,thisPtr,paramPtr);
+		frame->hookIndex=index;
+		frame->originalAPI=originAPI[index];
+		frame->PutSegmentRegister(segcs,segds,seges,segss,segfs,seggs);
+		frame->PutGeneralRegister(regedx,regebx,regebp,regesi,regedi,regeax,regesp,regeflags);
 		try
 		{				
 			if(hookScript[index]==NULL)//ֱӴ
 			{
 				f->LogStdInfo(hookedAPI[index]);
-				return;
 			}
 			else
 			{
@@ -4918,16 +3027,16 @@ beforeexit:
 		{
 			Log("DLLִ쳣");			
 		}
-		directReturn=f->get_DirectReturn();
-		popNBytes=f->get_PopNBytes();
+		directReturn=frame->directReturn;
+		popNBytes=frame->popNBytes;
 		//ûBeforeExitӣ뺯ʱѹHookFuncϢջ
 		if(directReturn!=2)
-				f->Pop();
+				HookFunc::Pop();
 	}
 	static void __stdcall CallBeforeExitScript(void)
 	{
-		HookFunc* f=hookFunc;
-		UINT funcAddr=f->get_BeforeExitScript();
+		HookFunc* f=HookFunc::Current()->func;
+		UINT funcAddr=f->Frame().beforeExitScript;
 		try
 		{
 			UINT arg=(UINT)f;
@@ -4944,7 +3053,7 @@ beforeexit:
 		}
 		long baseAddr=GetBaseAddr();
 		*(long*)(baseAddr+orginReturnAddr)=f->get_Eip();			
-		f->Pop();
+		HookFunc::Pop();
 	}
 	//: ڹסҪAPI⴦,
 	//		Լջ뷵ֵnakedΣ
@@ -5086,58 +3195,97 @@ beforeexit:
 			ret 0						;
 		}
 	}
-	static void _FinalInit(void)
+	//ȡеiҪҽӵĵַȡʱ0
+	static DWORD _HookTarget(int i)
 	{
-		for(int i=0;i<curHookItemIndex;i++)
+		HMODULE hModule=NULL;
+		if(hookedDLL[i].IsEmpty())
 		{
-			HMODULE hModule=NULL;
-			if(hookedDLL[i].IsEmpty())
+			hModule=::GetModuleHandle(NULL);
+		}
+		else
+		{
+			hModule=::GetModuleHandle(hookedDLL[i]);
+			if(!hModule)
+				hModule=::LoadLibrary(hookedDLL[i]);
+		}
+		if(!hModule)
+			return 0;
+		DWORD oldAPI=0;
+		if(hookedAPI[i][0]>='0' && hookedAPI[i][0]<='9')
+		{
+			if(hookedAPI[i].GetLength()>2 && hookedAPI[i][0]=='0' && hookedAPI[i][1]=='x')
 			{
-				hModule=::GetModuleHandle(NULL);
+				int address;
+				CString hex=hookedAPI[i].Mid(2);
+				hex.MakeUpper();
+				::sscanf(hex,"%X",&address);
+				oldAPI=(DWORD)address+(DWORD)hModule;
 			}
 			else
 			{
-				hModule=::GetModuleHandle(hookedDLL[i]);
-				if(!hModule)
-					hModule=::LoadLibrary(hookedDLL[i]);
+				DWORD v=(DWORD)::atoi(hookedAPI[i]);
+				if((v & 0xffff0000)==0)
+					oldAPI=(DWORD)::GetProcAddress(hModule,(LPCSTR)v);
+				else
+					oldAPI=v+(DWORD)hModule;
 			}
-			if(!hModule)
-				continue;
-			DWORD oldAPI=0;
-			if(hookedAPI[i][0]>='0' && hookedAPI[i][0]<='9')
+		}
+		else
+		{
+			oldAPI=(DWORD)::GetProcAddress(hModule,hookedAPI[i]);
+		}			
+		if(oldAPI==0)
+		{
+			char buf[1024];
+			::sprintf(buf,"޷ģ%s(%8.8X)ȡù%sĵַ!",hookedDLL[i],int(hModule),hookedAPI[i]);
+			::MessageBox(NULL,buf,"ӳʼ",MB_OK);
+		}
+		return oldAPI;
+	}
+	//еĹӷһ趨ÿҳֻıһαԡ
+	//ͬһ˶ʱһҪǰһд֮趨Żӵǰһϣ
+	//ÿһֻδ趨ĵһӣÿύһ
+	static void _FinalInit(void)
+	{
+		static DWORD target[1025];
+		for(int i=0;i<curHookItemIndex;i++)
+			target[i]=_HookTarget(i);
+		for(;;)
+		{
+			HookTransaction tx;
+			std::vector<int> queued;
+			for(int i=0;i<curHookItemIndex;i++)
 			{
-				if(hookedAPI[i].GetLength()>2 && hookedAPI[i][0]=='0' && hookedAPI[i][1]=='x')
+				if(target[i]==0)
+					continue;
+				int j=0;
+				while(j<i && target[j]!=target[i])
+					j++;
+				if(j<i)
+					continue;
+				queued.push_back(i);
+				if(tx.Install((PBYTE)target[i],trampoline+i*40,TRAMPOLINE_CODESIZE,(const void*)hookProc[i]))
 				{
-					int address;
-					CString hex=hookedAPI[i].Mid(2);
-					hex.MakeUpper();
-					::sscanf(hex,"%X",&address);
-					oldAPI=(DWORD)address+(DWORD)hModule;
+					originAPI[i]=(DWORD)(trampoline+i*40);
 				}
 				else
 				{
-					DWORD v=(DWORD)::atoi(hookedAPI[i]);
-					if((v & 0xffff0000)==0)
-						oldAPI=(DWORD)::GetProcAddress(hModule,(LPCSTR)v);
-					else
-						oldAPI=v+(DWORD)hModule;
+					char buf[1024];
+					::sprintf(buf,"޷Ϊģ%sеĹ%s!",hookedDLL[i],hookedAPI[i]);
+					::MessageBox(NULL,buf,"ӳʼ",MB_OK);
 				}
 			}
-			else
+			if(queued.empty())
+				break;
+			if(!tx.Commit())
 			{
-				oldAPI=(DWORD)::GetProcAddress(hModule,hookedAPI[i]);
-			}			
-			if(oldAPI==0)
-			{
-				char buf[1024];
-				::sprintf(buf,"޷ģ%s(%8.8X)ȡù%sĵַ!",hookedDLL[i],int(hModule),hookedAPI[i]);
-				::MessageBox(NULL,buf,"ӳʼ",MB_OK);
+				for(size_t k=0;k<queued.size();k++)
+					originAPI[queued[k]]=0;
+				::MessageBox(NULL,"д빳ʧܣĹӾδЧ!","ӳʼ",MB_OK);
 			}
-			else
-			{
-				Trampoline::Create((PBYTE)oldAPI,trampoline+i*40,(DWORD)hookProc[i]);
-				originAPI[i]=(DWORD)(trampoline+i*40);
-			}			
+			for(size_t k=0;k<queued.size();k++)
+				target[queued[k]]=0;
 		}
 	}	
 	static void HookAPI(CString dll,CString newAPI,CString oldAPI)
@@ -5166,7 +3314,10 @@ beforeexit:
 		bool isHookConfig=false;
 		bool showUI=false;
 		tlsIndex=::TlsAlloc();
+		StartTrace();
+		HookFunc::Startup();
 
+		//ﴴһνӿڶCreateDispatchеľ̬Ϣ趨֮ǰʼ
 		HookFunc* f=HookFunc::CreateDispatch();
 		hookFunc=f;
 		cppModule=::LoadLibrary((LPCSTR)(GetHookPath()+"\\"+hookScriptFile));
@@ -5224,6 +3375,11 @@ beforeexit:
 			ShowUI();
 		}
 	}	
+	//DLLж֮ǰɵUninitãװУֹͣת̲߳ͷеģ
+	void _Uninit(void)
+	{
+		StopTrace();
+	}
 	void _Finalize(void)
 	{
 		CloseUI();
@@ -5241,6 +3397,8 @@ beforeexit:
 			Log(buf);
 			it++;
 		}
+		HookFunc::Shutdown();
+		CloseTrace();
 		::TlsFree(tlsIndex);
 	}
 	void _ThreadInit(void)
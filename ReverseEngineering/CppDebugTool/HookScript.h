@@ -10,6 +10,7 @@
 #endif // _MSC_VER > 1000
 
 extern void _Init(void);
+extern void _Uninit(void);
 extern void _Finalize(void);
 extern void _ThreadInit(void);
 extern void _ThreadFinalize(void);
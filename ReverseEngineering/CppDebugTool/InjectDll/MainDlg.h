@@ -11,6 +11,7 @@
 #include "injdll.h"
 #include <Psapi.h>
 #include "WinForIE.h"
+#include "../TraceRing.h"
 
 #include <process.h>
 #include <vector>
@@ -21,6 +22,9 @@
 using namespace std;
 
 #define MYWM_NOTIFYICON WINFORIE_LAST_MSG+1
+#define TRACE_TIMERID		0x5452		//ȡ־Ķʱ
+#define TRACE_VIEWINTERVAL	50			//ȡ־ļ
+#define TRACE_VIEWBATCH		256			//ÿȡ־һ
 
 typedef int (*InstallPtr)(void);
 typedef int (*UninstallPtr)(void);
@@ -794,6 +798,18 @@ private:
 		BOOL ret=TRUE;
 		BOOL r=TRUE;
 		DWORD dw=0,dwID=0;		
+		// DLLUninitʱhook.dllĿеDLLװ֮ͷԼеģã
+		// FreeLibraryʹжءʧܲʾûDLLճж
+		DWORD pUninit=RemoteGetProcAddress(hProcess,dwHandle,CString("Uninit"),FALSE);
+		if(pUninit)
+		{
+			HANDLE hUninit=::CreateRemoteThread( hProcess, NULL, 0, (LPTHREAD_START_ROUTINE)pUninit, NULL, 0, &dwID );
+			if(hUninit)
+			{
+				::WaitForSingleObject( hUninit, INFINITE );
+				::CloseHandle( hUninit );
+			}
+		}
 		// ʹĿ̵FreeLibraryжDLL
 		DWORD pFunc = (DWORD)FreeLibrary;
 		if(isDebug)
@@ -2156,6 +2172,7 @@ public:
 		}
 		MESSAGE_HANDLER(WM_CLOSE,OnClose);
 		MESSAGE_HANDLER(MYWM_NOTIFYICON,On_MYWM_NOTIFYICON)
+		MESSAGE_HANDLER(WM_TIMER,OnTraceTimer)
 		return false;
 	}
 	void DoModeless(const char* cmd)
@@ -2192,6 +2209,9 @@ public:
 		dlg.InitTitle("InjectDll");
 		IEAppPointer::SetPtr(modelPtr);
 		dlg.DoModeless(NULL,-1,-1,-1,-1);		
+		//ֱӴ򿪹DLLĸٻ壬ڽ߳жʱȡ־DLLתֹ֮߳ͣת
+		if(traceSegment.Open())
+			dlg.SetTimer(TRACE_TIMERID,TRACE_VIEWINTERVAL);
 	}
 private:
 	LRESULT OnClose(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM lParam, BOOL& bHandled)
@@ -2200,9 +2220,46 @@ private:
 		{
 			MyTaskBarDeleteIcon(dlg.m_hWnd,0);
 		}
+		if(traceSegment.Ring().IsAttached())
+		{
+			dlg.KillTimer(TRACE_TIMERID);
+			traceSegment.Close();
+		}
 		bHandled=FALSE;
 		return 0;
 	}
+	LRESULT OnTraceTimer(UINT /*uMsg*/, WPARAM wParam, LPARAM /*lParam*/, BOOL& bHandled)
+	{
+		if(wParam!=TRACE_TIMERID)
+		{
+			bHandled=FALSE;
+			return 0;
+		}
+		DrainTrace();
+		return 0;
+	}
+	//Ȩڽ߳ȡúһֱУһ鿴ʱ˳ٽӹ
+	void DrainTrace(void)
+	{
+		if(!traceSegment.Claim())
+			return;
+		IDispatch* temp=dlg.GetWindowObj();
+		if(!temp)return;
+		CComPtr<IDispatch> p;
+		p.Attach(temp);
+		TraceRing& ring=traceSegment.Ring();
+		TraceRecord rec;
+		for(int i=0;i<TRACE_VIEWBATCH && ring.Read(rec);i++)
+			DispatchDriver::NRInvoke(p,L"CopyDataMsg",0,(int)rec.channel,(int)rec.length+1,CComBSTR(rec.text));
+		TraceLong dropped=ring.Dropped();
+		if(dropped!=traceDropped)
+		{
+			CString mess;
+			mess.Format("trace dropped:%d.",dropped);
+			DispatchDriver::NRInvoke(p,L"CopyDataMsg",0,0,mess.GetLength()+1,CComBSTR(mess));
+			traceDropped=dropped;
+		}
+	}
 private:
 	BOOL MyTaskBarAddIcon(HWND hwnd, UINT uID, HICON hicon, LPSTR lpszTip) 
 	{ 
@@ -2271,7 +2328,7 @@ private:
 		return 0; 
 	}
 public:
-	CMainDlg():hookInstalled(false),hookModule(NULL),hShellIcon(NULL)
+	CMainDlg():hookInstalled(false),hookModule(NULL),hShellIcon(NULL),traceDropped(0)
 	{}
 	~CMainDlg()
 	{}
@@ -2279,4 +2336,6 @@ private:
 	HICON hShellIcon;
 	HMODULE hookModule;
 	bool hookInstalled;
+	TraceSegment traceSegment;
+	TraceLong traceDropped;
 };
\ No newline at end of file
@@ -0,0 +1,508 @@
+#pragma once
+//־Ĺڴ滷λ壺ߣס̣߳ڲͬУһߣ鿴
+//¼ǶĶƽṹÿ۴һţñȽϽԤдλãд󷢲ţ
+//߰жϲǷдãƽһȦߡʱ¼ס̡߳
+//Ԥûз̱߳ǿֹ̱Ĳ۳TRACE_STALETIMEջز
+//ջ뷢ñȽϽ޸ţٵķʧܣ¼Ϊ
+//ȨûʾWindowsϵͳǷڹڴеĽ׳쳣˳Ա߽ӹܡ
+//ļֻϵͳԭӲ빲ڴӿڣWindowsļӳ䣬ϵͳPOSIXڴ档
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#endif
+#include <string.h>
+#include <stdio.h>
+
+#define TRACE_SEGMENTNAME	"ScriptHookTrace"
+#define TRACE_CAPACITY		4096		//۵ĸ2
+#define TRACE_TEXTSIZE		484			//ÿ¼Ϣޣβ0¼ܳ512ֽ
+#define TRACE_NOHOOK		-1			//ڹӺм¼־
+#define TRACE_MAGIC			0x33525354	//'TSR3'
+#define TRACE_CONSUMERSUFFIX	"Consumer"	//ȨΪڴּ׺
+#define TRACE_STALETIME		10000000	//ԤδĲ۵ȴôã100Ϊλ1룩ջ
+
+#ifdef _WIN32
+typedef LONG TraceLong;
+typedef __int64 TraceInt64;
+#else
+typedef int TraceLong;
+typedef long long TraceInt64;
+#endif
+
+//ԭӲȡ壬дͷ
+class TraceAtomic
+{
+public:
+#ifdef _WIN32
+	static inline TraceLong Load(volatile TraceLong* p)
+	{
+		return *p;
+	}
+	static inline void Store(volatile TraceLong* p,TraceLong v)
+	{
+		::InterlockedExchange(p,v);
+	}
+	static inline bool Cas(volatile TraceLong* p,TraceLong v,TraceLong cmp)
+	{
+		return ::InterlockedCompareExchange(p,v,cmp)==cmp;
+	}
+	static inline void Add(volatile TraceLong* p,TraceLong v)
+	{
+		::InterlockedExchangeAdd(p,v);
+	}
+	static inline void Yield(void)
+	{
+		::Sleep(0);
+	}
+	//1601100FILETIMEͬ
+	static inline TraceInt64 Now(void)
+	{
+		FILETIME ft;
+		::GetSystemTimeAsFileTime(&ft);
+		return ((TraceInt64)ft.dwHighDateTime<<32)|ft.dwLowDateTime;
+	}
+	static inline unsigned int ThreadId(void)
+	{
+		return ::GetCurrentThreadId();
+	}
+	static inline unsigned int ProcessId(void)
+	{
+		return ::GetCurrentProcessId();
+	}
+#else
+	static inline TraceLong Load(volatile TraceLong* p)
+	{
+		return __atomic_load_n(p,__ATOMIC_ACQUIRE);
+	}
+	static inline void Store(volatile TraceLong* p,TraceLong v)
+	{
+		__atomic_store_n(p,v,__ATOMIC_RELEASE);
+	}
+	static inline bool Cas(volatile TraceLong* p,TraceLong v,TraceLong cmp)
+	{
+		return __atomic_compare_exchange_n(p,&cmp,v,false,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE);
+	}
+	static inline void Add(volatile TraceLong* p,TraceLong v)
+	{
+		__atomic_fetch_add(p,v,__ATOMIC_RELAXED);
+	}
+	static inline void Yield(void)
+	{
+		::sched_yield();
+	}
+	static inline TraceInt64 Now(void)
+	{
+		struct timespec ts;
+		::clock_gettime(CLOCK_REALTIME,&ts);
+		return ((TraceInt64)ts.tv_sec+11644473600LL)*10000000+ts.tv_nsec/100;
+	}
+	static inline unsigned int ThreadId(void)
+	{
+		return (unsigned int)(size_t)::pthread_self();
+	}
+	static inline unsigned int ProcessId(void)
+	{
+		return (unsigned int)::getpid();
+	}
+#endif
+};
+
+struct TraceRecord
+{
+	volatile TraceLong seq;		//дλü1ʱ¼ɶдλʱۿд
+	unsigned int pid;
+	unsigned int tid;
+	int hook;					//ţTRACE_NOHOOKʾڹӺ
+	TraceInt64 time;			//TraceAtomic::Nowʱ
+	unsigned short channel;		//ת鿴ʱWM_COPYDATAdwData
+	unsigned short length;		//Ϣȣβ0
+	char text[TRACE_TEXTSIZE];
+};
+
+//ڴ濪ͷĿƿ飬ʹõλ÷ڲͬĻ
+struct TraceRingHeader
+{
+	volatile TraceLong state;		//0δʼ1ʼУ2
+	TraceLong magic;
+	TraceLong capacity;
+	TraceLong recordSize;
+	char pad0[64-4*sizeof(TraceLong)];
+	volatile TraceLong head;		//һԤдλ
+	char pad1[64-sizeof(TraceLong)];
+	volatile TraceLong tail;		//һλãֻɳȨһ޸
+	char pad2[64-sizeof(TraceLong)];
+	volatile TraceLong written;		//дļ¼
+	volatile TraceLong dropped;		//ʱļ¼
+	volatile TraceLong truncated;	//Ϣضϵļ¼
+	volatile TraceLong abandoned;	//ԤδջصĲ
+	char pad3[64-4*sizeof(TraceLong)];
+#ifndef _WIN32
+	pthread_mutex_t consumer;		//Ȩ̼乲Ľ׳
+#endif
+};
+
+//ڴһλͼڴķ
+class TraceRing
+{
+	TraceRingHeader* header;
+	TraceRecord* records;
+	TraceLong mask;
+	TraceLong stalePos;			//ߵȴĶλãstaleSinceΪʼȴʱ䣬0ʾûڵ
+	TraceInt64 staleSince;
+	TraceInt64 staleTime;
+public:
+	TraceRing(void)
+	{
+		header=NULL;
+		records=NULL;
+		mask=0;
+		stalePos=0;
+		staleSince=0;
+		staleTime=TRACE_STALETIME;
+	}
+	static inline size_t Size(TraceLong capacity)
+	{
+		return sizeof(TraceRingHeader)+capacity*sizeof(TraceRecord);
+	}
+	//ȫ0ѳʼڴϽͼɵһһʼȴʼ
+	inline bool Attach(void* p,TraceLong capacity)
+	{
+		header=(TraceRingHeader*)p;
+		records=(TraceRecord*)(header+1);
+		if(TraceAtomic::Cas(&header->state,1,0))
+		{
+			header->magic=TRACE_MAGIC;
+			header->capacity=capacity;
+			header->recordSize=sizeof(TraceRecord);
+			header->head=0;
+			header->tail=0;
+			header->written=0;
+			header->dropped=0;
+			header->truncated=0;
+			header->abandoned=0;
+			for(TraceLong i=0;i<capacity;i++)
+				records[i].seq=i;
+#ifndef _WIN32
+			pthread_mutexattr_t attr;
+			::pthread_mutexattr_init(&attr);
+			::pthread_mutexattr_setpshared(&attr,PTHREAD_PROCESS_SHARED);
+			::pthread_mutexattr_setrobust(&attr,PTHREAD_MUTEX_ROBUST);
+			::pthread_mutex_init(&header->consumer,&attr);
+			::pthread_mutexattr_destroy(&attr);
+#endif
+			TraceAtomic::Store(&header->state,2);
+		}
+		else
+		{
+			while(TraceAtomic::Load(&header->state)!=2)
+				TraceAtomic::Yield();
+		}
+		if(header->magic!=TRACE_MAGIC || header->recordSize!=sizeof(TraceRecord) || header->capacity!=capacity)
+		{
+			Detach();
+			return false;
+		}
+		mask=capacity-1;
+		return true;
+	}
+	inline void Detach(void)
+	{
+		header=NULL;
+		records=NULL;
+		mask=0;
+	}
+	inline bool IsAttached(void) const
+	{
+		return header!=NULL;
+	}
+	//дһ¼Ԥѱջʱfalse
+	inline bool Write(int hook,unsigned short channel,const char* text)
+	{
+		TraceLong pos;
+		TraceRecord* r=Reserve(pos);
+		if(!r)
+			return false;
+		size_t len=::strlen(text);
+		if(len>=TRACE_TEXTSIZE)
+		{
+			len=TRACE_TEXTSIZE-1;
+			TraceAtomic::Add(&header->truncated,1);
+		}
+		r->pid=TraceAtomic::ProcessId();
+		r->tid=TraceAtomic::ThreadId();
+		r->hook=hook;
+		r->time=TraceAtomic::Now();
+		r->channel=channel;
+		r->length=(unsigned short)len;
+		::memcpy(r->text,text,len);
+		r->text[len]=0;
+		return Publish(r,pos);
+	}
+	//ԤһдλãҪдĲۣʱNULL
+	inline TraceRecord* Reserve(TraceLong& pos)
+	{
+		if(!header)
+			return NULL;
+		pos=TraceAtomic::Load(&header->head);
+		TraceRecord* r;
+		for(;;)
+		{
+			r=&records[pos&mask];
+			TraceLong seq=TraceAtomic::Load(&r->seq);
+			TraceLong diff=(TraceLong)((unsigned int)seq-(unsigned int)pos);
+			if(diff==0)
+			{
+				if(TraceAtomic::Cas(&header->head,Next(pos,1),pos))
+					break;
+			}
+			else if(diff<0)
+			{
+				TraceAtomic::Add(&header->dropped,1);
+				return NULL;
+			}
+			pos=TraceAtomic::Load(&header->head);
+		}
+		return r;
+	}
+	//ReserveԤĲۡѱߵջʱfalse¼Ϊ
+	inline bool Publish(TraceRecord* r,TraceLong pos)
+	{
+		if(!TraceAtomic::Cas(&r->seq,Next(pos,1),pos))
+		{
+			TraceAtomic::Add(&header->dropped,1);
+			return false;
+		}
+		TraceAtomic::Add(&header->written,1);
+		return true;
+	}
+#ifndef _WIN32
+	inline pthread_mutex_t* Consumer(void)
+	{
+		return header?&header->consumer:NULL;
+	}
+#endif
+	//ȨTraceSegment::Claimʱһ¼ûдõļ¼ʱfalse
+	//Ԥλõδдʱļ¼ҲҪдܶȴstaleTimeĲ۱ջ
+	inline bool Read(TraceRecord& out)
+	{
+		if(!header)
+			return false;
+		for(;;)
+		{
+			TraceLong pos=header->tail;
+			TraceRecord* r=&records[pos&mask];
+			TraceLong seq=TraceAtomic::Load(&r->seq);
+			if(seq==Next(pos,1))
+			{
+				::memcpy(&out,r,sizeof(TraceRecord));
+				TraceAtomic::Store(&r->seq,Next(pos,mask+1));
+				TraceAtomic::Store(&header->tail,Next(pos,1));
+				staleSince=0;
+				return true;
+			}
+			//seqposдλԽposʱ۱Ԥδ
+			if(seq!=pos || TraceAtomic::Load(&header->head)==pos)
+				return false;
+			TraceInt64 now=TraceAtomic::Now();
+			if(staleSince==0 || stalePos!=pos)
+			{
+				stalePos=pos;
+				staleSince=now;
+				return false;
+			}
+			if(now-staleSince<staleTime)
+				return false;
+			//ջʧ˵߸պ÷ˣ¶
+			if(TraceAtomic::Cas(&r->seq,Next(pos,mask+1),pos))
+			{
+				TraceAtomic::Add(&header->abandoned,1);
+				TraceAtomic::Store(&header->tail,Next(pos,1));
+				staleSince=0;
+			}
+		}
+	}
+	//ԤδĲ۱ջǰĵȴʱ䣬100Ϊλ
+	inline void SetStaleTime(TraceInt64 t)
+	{
+		staleTime=t;
+	}
+	inline TraceLong Written(void) const
+	{
+		return header?TraceAtomic::Load(&header->written):0;
+	}
+	inline TraceLong Dropped(void) const
+	{
+		return header?TraceAtomic::Load(&header->dropped):0;
+	}
+	inline TraceLong Truncated(void) const
+	{
+		return header?TraceAtomic::Load(&header->truncated):0;
+	}
+	inline TraceLong Abandoned(void) const
+	{
+		return header?TraceAtomic::Load(&header->abandoned):0;
+	}
+private:
+	//λŰ32λ޷
+	static inline TraceLong Next(TraceLong pos,TraceLong n)
+	{
+		return (TraceLong)((unsigned int)pos+(unsigned int)n);
+	}
+};
+
+//ڴеĻλ壬鿴ͬһִ򿪣ȴһʼ
+class TraceSegment
+{
+	TraceRing ring;
+	void* view;
+	size_t size;
+	bool claimed;
+#ifdef _WIN32
+	HANDLE mapping;
+	HANDLE consumer;
+#else
+	int fd;
+#endif
+public:
+	TraceSegment(void)
+	{
+		view=NULL;
+		size=0;
+		claimed=false;
+#ifdef _WIN32
+		mapping=NULL;
+		consumer=NULL;
+#else
+		fd=-1;
+#endif
+	}
+	~TraceSegment()
+	{
+		Close();
+	}
+	inline bool Open(const char* name=TRACE_SEGMENTNAME,TraceLong capacity=TRACE_CAPACITY)
+	{
+		Close();
+		size=TraceRing::Size(capacity);
+#ifdef _WIN32
+		mapping=::CreateFileMapping(INVALID_HANDLE_VALUE,NULL,PAGE_READWRITE,0,(DWORD)size,name);
+		if(!mapping)
+			return false;
+		view=::MapViewOfFile(mapping,FILE_MAP_ALL_ACCESS,0,0,size);
+		char lockName[256];
+		::_snprintf(lockName,sizeof(lockName)-1,"%s%s",name,TRACE_CONSUMERSUFFIX);
+		lockName[sizeof(lockName)-1]=0;
+		consumer=::CreateMutex(NULL,FALSE,lockName);
+		if(!consumer)
+		{
+			Close();
+			return false;
+		}
+#else
+		char path[256];
+		path[0]='/';
+		::strncpy(path+1,name,sizeof(path)-2);
+		path[sizeof(path)-1]=0;
+		fd=::shm_open(path,O_RDWR|O_CREAT,0600);
+		if(fd<0)
+			return false;
+		struct stat st;
+		if(::fstat(fd,&st)!=0 || ((size_t)st.st_size<size && ::ftruncate(fd,size)!=0))
+		{
+			Close();
+			return false;
+		}
+		view=::mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+		if(view==MAP_FAILED)
+			view=NULL;
+#endif
+		if(!view || !ring.Attach(view,capacity))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+	inline void Close(void)
+	{
+		Release();
+		ring.Detach();
+#ifdef _WIN32
+		if(view)
+			::UnmapViewOfFile(view);
+		if(mapping)
+			::CloseHandle(mapping);
+		if(consumer)
+			::CloseHandle(consumer);
+		mapping=NULL;
+		consumer=NULL;
+#else
+		if(view)
+			::munmap(view,size);
+		if(fd>=0)
+			::close(fd);
+		fd=-1;
+#endif
+		view=NULL;
+	}
+	//ȴȡȨͬһʱֻһܶ˳ʱûͷŵģ
+	//ϵͳΪһȡáClaimReleaseͬһ߳еá
+	inline bool Claim(void)
+	{
+		if(claimed)
+			return true;
+		if(!ring.IsAttached())
+			return false;
+#ifdef _WIN32
+		DWORD r=::WaitForSingleObject(consumer,0);
+		claimed=(r==WAIT_OBJECT_0 || r==WAIT_ABANDONED);
+#else
+		int r=::pthread_mutex_trylock(ring.Consumer());
+		if(r==EOWNERDEAD)
+		{
+			::pthread_mutex_consistent(ring.Consumer());
+			r=0;
+		}
+		claimed=(r==0);
+#endif
+		return claimed;
+	}
+	inline void Release(void)
+	{
+		if(!claimed)
+			return;
+		claimed=false;
+#ifdef _WIN32
+		::ReleaseMutex(consumer);
+#else
+		::pthread_mutex_unlock(ring.Consumer());
+#endif
+	}
+	inline bool IsClaimed(void) const
+	{
+		return claimed;
+	}
+	//ɾڴֻ֣POSIXѴ򿪵һӰ
+	static inline void Unlink(const char* name=TRACE_SEGMENTNAME)
+	{
+#ifndef _WIN32
+		char path[256];
+		path[0]='/';
+		::strncpy(path+1,name,sizeof(path)-2);
+		path[sizeof(path)-1]=0;
+		::shm_unlink(path);
+#endif
+	}
+	inline TraceRing& Ring(void)
+	{
+		return ring;
+	}
+};
@@ -0,0 +1,204 @@
+#pragma once
+//أ豣ִегɶĲۣӴŸƳȥָڴ롣
+//x86-64jmp rel32ֻתƵ2GB֮ڣڱסĺʱҲֻȡŵеĲۡ
+//ÿTRAMPOLINE_REGIONSIZE룬һ۴ͷв۴ͷŶҪҡ
+//һͷšժʱ̸߳ȡִַУͷŵĲ۱ԭȷ
+//پTRAMPOLINE_QUARANTINEͷźŻص಻̰߳ȫģֻ趨ӵ߳ʹá
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include <stddef.h>
+
+#define TRAMPOLINE_SLOTSIZE		64				//ÿ۵ֽ
+#define TRAMPOLINE_REGIONSIZE	0x10000			//ÿֽWindowsķͬ
+#define TRAMPOLINE_REACH		0x7ff00000		//Ŀ֮룬2GBСָ
+#define TRAMPOLINE_QUARANTINE	256				//ͷŵĲڸͣͷŴ
+
+class TrampolinePool
+{
+	struct Region
+	{
+		Region* next;
+		unsigned char* freeList;	//в۵һв۵ĵַڲ۵Ŀͷ
+		int used;
+	};
+public:
+	TrampolinePool(void):regions(NULL),last(NULL),regionNum(0),quarantineNext(0)
+	{
+		for(int i=0;i<TRAMPOLINE_QUARANTINE;i++)
+			quarantine[i]=NULL;
+	}
+	//һTRAMPOLINE_SLOTSIZEֽڵĲۣhintΪNULLʱhint֮ľrel32Χ֮ڣʧʱNULL
+	unsigned char* Alloc(const void* hint)
+	{
+		Region* r=last;
+		if(!r || !r->freeList || !Reach(r,hint))
+		{
+			for(r=regions;r;r=r->next)
+			{
+				if(r->freeList && Reach(r,hint))
+					break;
+			}
+			if(!r)
+			{
+				r=NewRegion(hint);
+				if(!r)
+					return NULL;
+			}
+			last=r;
+		}
+		unsigned char* slot=r->freeList;
+		r->freeList=*(unsigned char**)slot;
+		r->used++;
+		return slot;
+	}
+	//۵ݲĶͷŵĲ۷Żؿ
+	void Free(unsigned char* slot)
+	{
+		if(!slot)
+			return;
+		unsigned char* oldest=quarantine[quarantineNext];
+		quarantine[quarantineNext]=slot;
+		quarantineNext=(quarantineNext+1)%TRAMPOLINE_QUARANTINE;
+		if(oldest)
+			Release(oldest);
+	}
+	inline int GetRegionNum(void) const
+	{
+		return regionNum;
+	}
+private:
+	void Release(unsigned char* slot)
+	{
+		Region* r=(Region*)AlignDown((size_t)slot);
+		*(unsigned char**)slot=r->freeList;
+		r->freeList=slot;
+		r->used--;
+	}
+	static inline bool Reach(const Region* r,const void* hint)
+	{
+		if(!hint || sizeof(void*)==4)
+			return true;
+		size_t base=(size_t)r;
+		size_t target=(size_t)hint;
+		if(base<=target)
+			return target-base<=TRAMPOLINE_REACH;
+		return base+TRAMPOLINE_REGIONSIZE-target<=TRAMPOLINE_REACH;
+	}
+	Region* NewRegion(const void* hint)
+	{
+		unsigned char* base=Reserve(hint);
+		if(!base)
+			return NULL;
+		for(int i=0;i<TRAMPOLINE_REGIONSIZE;i++)
+			base[i]=0xcc;
+		Region* r=(Region*)base;
+		r->freeList=NULL;
+		r->used=0;
+		//۰ַӵ͵߷䣬һͷ
+		for(int off=TRAMPOLINE_REGIONSIZE-TRAMPOLINE_SLOTSIZE;off>=TRAMPOLINE_SLOTSIZE;off-=TRAMPOLINE_SLOTSIZE)
+		{
+			*(unsigned char**)(base+off)=r->freeList;
+			r->freeList=base+off;
+		}
+		r->next=regions;
+		regions=r;
+		regionNum++;
+		return r;
+	}
+	static inline size_t AlignDown(size_t v)
+	{
+		return v&~(size_t)(TRAMPOLINE_REGIONSIZE-1);
+	}
+	//hintཻҿеĵַ32λ̻hintΪNULLʱϵͳѡַ
+	static unsigned char* Reserve(const void* hint)
+	{
+		if(!hint || sizeof(void*)==4)
+			return ReserveAt(0);
+		size_t target=AlignDown((size_t)hint);
+		size_t low=(target>TRAMPOLINE_REACH)?target-TRAMPOLINE_REACH+TRAMPOLINE_REGIONSIZE:TRAMPOLINE_REGIONSIZE;
+		size_t high=target+TRAMPOLINE_REACH-TRAMPOLINE_REGIONSIZE;
+		size_t down=target;
+		size_t up=target+TRAMPOLINE_REGIONSIZE;
+		while(down>=low || up<=high)
+		{
+			if(down>=low)
+			{
+				unsigned char* p=ReserveAt(down);
+				if(p)
+					return p;
+				down=Skip(down,false);
+			}
+			if(up<=high)
+			{
+				unsigned char* p=ReserveAt(up);
+				if(p)
+					return p;
+				up=Skip(up,true);
+			}
+		}
+		return NULL;
+	}
+#ifdef _WIN32
+	static unsigned char* ReserveAt(size_t addr)
+	{
+		return (unsigned char*)::VirtualAlloc((LPVOID)addr,TRAMPOLINE_REGIONSIZE,MEM_RESERVE|MEM_COMMIT,PAGE_EXECUTE_READWRITE);
+	}
+	//Խaddrڵռ
+	static size_t Skip(size_t addr,bool upward)
+	{
+		MEMORY_BASIC_INFORMATION mbi;
+		if(::VirtualQuery((LPCVOID)addr,&mbi,sizeof(mbi))==0)
+			return upward?addr+TRAMPOLINE_REGIONSIZE:addr-TRAMPOLINE_REGIONSIZE;
+		if(upward)
+			return AlignDown((size_t)mbi.BaseAddress+mbi.RegionSize+TRAMPOLINE_REGIONSIZE-1);
+		if(mbi.State==MEM_FREE)
+			return addr-TRAMPOLINE_REGIONSIZE;
+		return AlignDown((size_t)mbi.AllocationBase)-TRAMPOLINE_REGIONSIZE;
+	}
+#else
+	static unsigned char* ReserveAt(size_t addr)
+	{
+		int flags=MAP_PRIVATE|MAP_ANONYMOUS;
+#ifdef MAP_FIXED_NOREPLACE
+		if(addr)
+			flags|=MAP_FIXED_NOREPLACE;
+#endif
+		if(addr)
+		{
+			void* p=::mmap((void*)addr,TRAMPOLINE_REGIONSIZE,PROT_READ|PROT_WRITE|PROT_EXEC,flags,-1,0);
+			if(p==MAP_FAILED)
+				return NULL;
+			if((size_t)p!=addr)
+			{
+				::munmap(p,TRAMPOLINE_REGIONSIZE);
+				return NULL;
+			}
+			return (unsigned char*)p;
+		}
+		//ӳһĴСٽȥ˵õ
+		size_t size=TRAMPOLINE_REGIONSIZE*2;
+		unsigned char* p=(unsigned char*)::mmap(NULL,size,PROT_READ|PROT_WRITE|PROT_EXEC,flags,-1,0);
+		if(p==(unsigned char*)MAP_FAILED)
+			return NULL;
+		unsigned char* base=(unsigned char*)AlignDown((size_t)p+TRAMPOLINE_REGIONSIZE-1);
+		if(base>p)
+			::munmap(p,base-p);
+		if(base+TRAMPOLINE_REGIONSIZE<p+size)
+			::munmap(base+TRAMPOLINE_REGIONSIZE,p+size-(base+TRAMPOLINE_REGIONSIZE));
+		return base;
+	}
+	static size_t Skip(size_t addr,bool upward)
+	{
+		return upward?addr+TRAMPOLINE_REGIONSIZE:addr-TRAMPOLINE_REGIONSIZE;
+	}
+#endif
+private:
+	Region* regions;
+	Region* last;				//ϴη趨Ĺͨͬһģ
+	int regionNum;
+	unsigned char* quarantine[TRAMPOLINE_QUARANTINE];	//ͷŵĲۣѭʹ
+	int quarantineNext;
+};
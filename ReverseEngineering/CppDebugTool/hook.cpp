@@ -92,4 +92,10 @@ STDAPI DllUnregisterServer(void)
 extern "C" __declspec(dllexport) void Init(void)
 {	
 	::_Init();
+}
+
+//жDLL֮ǰãInjectDllжDLLʱĿԶ̵ת־̳߳бģã˳DLLܱж
+extern "C" __declspec(dllexport) void Uninit(void)
+{	
+	::_Uninit();
 }
\ No newline at end of file
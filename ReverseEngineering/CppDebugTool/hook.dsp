@@ -298,6 +298,14 @@ SOURCE=.\Resource.h
 
 SOURCE=.\StdAfx.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\TraceRing.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\TrampolinePool.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
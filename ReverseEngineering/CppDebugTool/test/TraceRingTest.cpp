@@ -0,0 +1,271 @@
+//TraceRingѹ׼LinuxPOSIXڴ̼顣
+//	g++ -O2 -pthread -o TraceRingTest TraceRingTest.cpp -lrt
+//̵Ķ߳ͬʱд룬һ߶ÿߵļ¼˳򡢳
+//黺ʱĶضϼȨĽ쳣˳ȨܱӹܣԼԤδĲ۱ջ
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <map>
+#include "../TraceRing.h"
+
+#define PRODUCER_PROCESSES	4
+#define PRODUCER_THREADS	4
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+static double Now(void)
+{
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+struct ProducerArg
+{
+	const char* name;
+	TraceLong capacity;
+	int id;
+	int count;
+	bool retry;			//ʱԣ
+};
+
+//ÿ̵߳򿪹ڴ棬벻ͬеĹһֻͨҵ
+static void* Producer(void* param)
+{
+	ProducerArg* a=(ProducerArg*)param;
+	TraceSegment seg;
+	if(!seg.Open(a->name,a->capacity))
+		return (void*)1;
+	char buf[32];
+	for(int i=0;i<a->count;i++)
+	{
+		::sprintf(buf,"%d",i);
+		while(!seg.Ring().Write(a->id,0,buf) && a->retry)
+			TraceAtomic::Yield();
+	}
+	return NULL;
+}
+
+//PRODUCER_PROCESSEṢÿPRODUCER_THREADS߳д
+static void StartProducers(const char* name,TraceLong capacity,int count,bool retry)
+{
+	for(int p=0;p<PRODUCER_PROCESSES;p++)
+	{
+		if(::fork()!=0)
+			continue;
+		pthread_t th[PRODUCER_THREADS];
+		ProducerArg args[PRODUCER_THREADS];
+		int bad=0;
+		for(int t=0;t<PRODUCER_THREADS;t++)
+		{
+			ProducerArg a={name,capacity,p*PRODUCER_THREADS+t,count,retry};
+			args[t]=a;
+			::pthread_create(&th[t],NULL,Producer,&args[t]);
+		}
+		for(int t=0;t<PRODUCER_THREADS;t++)
+		{
+			void* r;
+			::pthread_join(th[t],&r);
+			if(r)
+				bad++;
+		}
+		::_exit(bad);
+	}
+}
+
+static bool WaitProducers(void)
+{
+	bool ok=true;
+	int status;
+	while(::wait(&status)>0)
+		ok=ok && WIFEXITED(status) && WEXITSTATUS(status)==0;
+	return ok;
+}
+
+//ȫ¼ÿߵļ¼0,1,2...ҳȷ
+static void TestOrder(int count)
+{
+	const char* name="TraceRingTestOrder";
+	const int producers=PRODUCER_PROCESSES*PRODUCER_THREADS;
+	TraceSegment::Unlink(name);
+	TraceSegment seg;
+	Check(seg.Open(name,1024),"ڴ");
+	Check(seg.Claim(),"ȡȨ");
+	StartProducers(name,1024,count,true);
+	std::map<int,int> next;
+	long got=0,bad=0;
+	TraceRecord rec;
+	double start=Now();
+	while(got<(long)producers*count)
+	{
+		if(!seg.Ring().Read(rec))
+		{
+			TraceAtomic::Yield();
+			continue;
+		}
+		got++;
+		int expect=next[rec.hook];
+		if(::atoi(rec.text)!=expect || ::strlen(rec.text)!=rec.length || rec.pid==0)
+			bad++;
+		next[rec.hook]=expect+1;
+	}
+	double seconds=Now()-start;
+	Check(WaitProducers(),"");
+	printf("%d߹д%ld%.2f/룬%d\n",producers,got,got/seconds/1e6,seg.Ring().Dropped());
+	Check(bad==0,"ÿߵļ¼˳볤ȷ");
+	Check(seg.Ring().Written()==(TraceLong)got,"дһ");
+	seg.Close();
+	TraceSegment::Unlink(name);
+}
+
+static void TestCounters(void)
+{
+	const char* name="TraceRingTestCounters";
+	TraceSegment::Unlink(name);
+	TraceSegment seg;
+	seg.Open(name,16);
+	int written=0;
+	for(int i=0;i<20;i++)
+		written+=seg.Ring().Write(TRACE_NOHOOK,0,"x");
+	Check(written==16 && seg.Ring().Dropped()==4,"ʱ");
+	char big[TRACE_TEXTSIZE*2];
+	::memset(big,'a',sizeof(big)-1);
+	big[sizeof(big)-1]=0;
+	TraceRecord rec;
+	seg.Claim();
+	seg.Ring().Read(rec);
+	seg.Ring().Write(1,0,big);
+	for(int i=0;i<16;i++)
+		seg.Ring().Read(rec);
+	Check(seg.Ring().Truncated()==1 && rec.length==TRACE_TEXTSIZE-1 && rec.text[TRACE_TEXTSIZE-1]==0,"Ϣضϲ");
+	seg.Close();
+	TraceSegment::Unlink(name);
+}
+
+//Ԥһ۲ģдһ뱻ֹߣǰļ¼ںջ
+//ٵķʧܲΪջصĲ۴˺ճʹ
+static void TestStale(void)
+{
+	const char* name="TraceRingTestStale";
+	TraceSegment::Unlink(name);
+	TraceSegment seg;
+	seg.Open(name,16);
+	seg.Claim();
+	TraceRing& ring=seg.Ring();
+	ring.SetStaleTime(1000000);
+	TraceLong pos=0;
+	TraceRecord* stale=ring.Reserve(pos);
+	ring.Write(1,0,"0");
+	ring.Write(1,0,"1");
+	TraceRecord rec;
+	Check(stale && !ring.Read(rec),"ǰȴδĲ");
+	::usleep(150000);
+	bool ok=ring.Read(rec) && ::strcmp(rec.text,"0")==0 && ring.Read(rec) && ::strcmp(rec.text,"1")==0 && !ring.Read(rec);
+	Check(ok && ring.Abandoned()==1,"ڵĲ۱ջأļ¼ճ");
+	TraceLong dropped=ring.Dropped();
+	Check(!ring.Publish(stale,pos) && ring.Dropped()==dropped+1,"ջصĲ۳ٵķʧ");
+	int got=0;
+	for(int i=0;i<40;i++)
+	{
+		ring.Write(1,0,"x");
+		got+=ring.Read(rec);
+	}
+	Check(got==40 && !ring.Read(rec),"ջغ󻺳ճд");
+	seg.Close();
+	TraceSegment::Unlink(name);
+}
+
+//ӽ̳ȡȨholdΪʱȡúͷֱ˳ֵΪǷȡ
+static bool ClaimInChild(const char* name,bool hold)
+{
+	pid_t pid=::fork();
+	if(pid==0)
+	{
+		TraceSegment seg;
+		bool ok=seg.Open(name,64) && seg.Claim();
+		if(ok && hold)
+			::_exit(0);
+		seg.Close();
+		::_exit(ok?0:1);
+	}
+	int status;
+	::waitpid(pid,&status,0);
+	return WIFEXITED(status) && WEXITSTATUS(status)==0;
+}
+
+static void TestClaim(void)
+{
+	const char* name="TraceRingTestClaim";
+	TraceSegment::Unlink(name);
+	TraceSegment seg;
+	seg.Open(name,64);
+	Check(seg.Claim(),"ȡȨ");
+	Check(!ClaimInChild(name,false),"ȨʱĽȡ");
+	seg.Release();
+	Check(ClaimInChild(name,true),"ͷźĽȡȨ");
+	Check(seg.Claim(),"δͷž˳Ȩӹ");
+	seg.Ring().Write(1,0,"after");
+	TraceRecord rec;
+	Check(seg.Ring().Read(rec) && ::strcmp(rec.text,"after")==0,"ӹܺճ");
+	seg.Close();
+	TraceSegment::Unlink(name);
+}
+
+//߻ʱֱӶ빳едͬ߾дٶ붪
+static void Bench(int count)
+{
+	const char* name="TraceRingBench";
+	const int producers=PRODUCER_PROCESSES*PRODUCER_THREADS;
+	TraceSegment::Unlink(name);
+	TraceSegment seg;
+	seg.Open(name,TRACE_CAPACITY);
+	seg.Claim();
+	double start=Now();
+	StartProducers(name,TRACE_CAPACITY,count,false);
+	long got=0;
+	TraceRecord rec;
+	bool running=true;
+	while(running)
+	{
+		if(seg.Ring().Read(rec))
+		{
+			got++;
+			continue;
+		}
+		running=::waitpid(-1,NULL,WNOHANG)>=0;
+	}
+	while(seg.Ring().Read(rec))
+		got++;
+	double seconds=Now()-start;
+	long total=(long)producers*count;
+	printf("%d߸д%dʱ%.3f룬%.2f/룬%ld%d%.1f%%\n",
+		producers,count,seconds,total/seconds/1e6,got,seg.Ring().Dropped(),100.0*seg.Ring().Dropped()/total);
+	Check(got+seg.Ring().Dropped()==total,"붪֮͵д");
+	seg.Close();
+	TraceSegment::Unlink(name);
+}
+
+int main(int argc,char* argv[])
+{
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench((argc>2)?::atoi(argv[2]):1000000);
+		return failures?1:0;
+	}
+	TestCounters();
+	TestClaim();
+	TestStale();
+	TestOrder((argc>1)?::atoi(argv[1]):200000);
+	return failures?1:0;
+}
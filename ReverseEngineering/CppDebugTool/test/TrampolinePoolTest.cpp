@@ -0,0 +1,237 @@
+//TrampolinePoolĲһӵĻ׼LinuxmmapĴҳAPI
+//	g++ -O2 -pthread -o TrampolinePoolTest TrampolinePoolTest.cpp
+//˶ͷŵĲڸбԭTRAMPOLINE_QUARANTINEͷź·䣬
+//߳̾ɸժĹӵʱȻȷٲһӳ趨ժĺʱ
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <vector>
+#include "../../../MyInclude/HookTransaction.h"
+#include "../TrampolinePool.h"
+
+#define SLOT_CODESIZE	40			//TRAMPOLINE_CODESIZEͬǽűӵڴ
+#define FUNC_STRIDE		16
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+typedef int (*IntFunc)(void);
+
+//mov eax,value; ret
+static void PutReturn(unsigned char* p,int value)
+{
+	p[0]=0xb8;
+	::memcpy(p+1,&value,4);
+	p[5]=0xc3;
+}
+
+static unsigned char* MapFunctions(int n)
+{
+	unsigned char* code=(unsigned char*)::mmap(NULL,n*FUNC_STRIDE,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	if(code==(unsigned char*)MAP_FAILED)
+		return NULL;
+	::memset(code,0x90,n*FUNC_STRIDE);
+	for(int i=0;i<n;i++)
+		PutReturn(code+i*FUNC_STRIDE,i);
+	::mprotect(code,n*FUNC_STRIDE,PROT_READ|PROT_EXEC);
+	return code;
+}
+
+static void TestQuarantine(void)
+{
+	TrampolinePool pool;
+	unsigned char* first=pool.Alloc(NULL);
+	::memset(first,0x5a,TRAMPOLINE_SLOTSIZE);
+	pool.Free(first);
+	bool intact=true;
+	for(int i=0;i<TRAMPOLINE_SLOTSIZE;i++)
+		intact=intact && first[i]==0x5a;
+	Check(intact,"ͷŵĲ۱ԭ");
+	//ͷTRAMPOLINE_QUARANTINE-1ۣfirstڸ
+	bool reused=false;
+	for(int i=0;i<TRAMPOLINE_QUARANTINE-1;i++)
+	{
+		unsigned char* p=pool.Alloc(NULL);
+		reused=reused || p==first;
+		pool.Free(p);
+	}
+	Check(!reused,"еĲ۲·");
+	//һͷŰfirst
+	pool.Free(pool.Alloc(NULL));
+	unsigned char* again=pool.Alloc(NULL);
+	Check(again==first,"TRAMPOLINE_QUARANTINEͷź·");
+}
+
+//߳ȡַٵã߳ͬʱժӡ²趨ͷžɲۡ
+//ִԭɾöӦi
+struct ChurnState
+{
+	unsigned char* code;
+	unsigned char* volatile* trampolines;
+	int num;
+	volatile int stop;
+	long calls;
+	long bad;
+};
+
+static void* ChurnCaller(void* param)
+{
+	ChurnState* s=(ChurnState*)param;
+	unsigned seed=(unsigned)(size_t)&seed;
+	long calls=0,bad=0;
+	while(!s->stop)
+	{
+		int i=rand_r(&seed)%s->num;
+		unsigned char* t=s->trampolines[i];
+		//ȡõַһٵã൱֮߳ǰлȥ
+		for(volatile int delay=rand_r(&seed)%256;delay>0;delay--)
+			;
+		if(((IntFunc)t)()!=i)
+			bad++;
+		calls++;
+	}
+	__sync_fetch_and_add(&s->calls,calls);
+	__sync_fetch_and_add(&s->bad,bad);
+	return NULL;
+}
+
+static void TestChurn(int rounds)
+{
+	const int n=1000;
+	const int threads=4;
+	TrampolinePool pool;
+	ChurnState s;
+	s.code=MapFunctions(n);
+	std::vector<unsigned char*> trampolines(n);
+	s.trampolines=&trampolines[0];
+	s.num=n;
+	s.stop=0;
+	s.calls=0;
+	s.bad=0;
+	unsigned char* detour=MapFunctions(1);
+	HookTransaction tx;
+	for(int i=0;i<n;i++)
+	{
+		trampolines[i]=pool.Alloc(s.code+i*FUNC_STRIDE);
+		tx.Install(s.code+i*FUNC_STRIDE,trampolines[i],SLOT_CODESIZE,detour);
+	}
+	Check(tx.Commit(),"趨");
+	pthread_t th[threads];
+	for(int t=0;t<threads;t++)
+		::pthread_create(&th[t],NULL,ChurnCaller,&s);
+	int failed=0;
+	for(int r=0;r<rounds;r++)
+	{
+		for(int i=0;i<n;i++)
+		{
+			unsigned char* target=s.code+i*FUNC_STRIDE;
+			HookTransaction ux;
+			if(!ux.Uninstall(target,trampolines[i],SLOT_CODESIZE) || !ux.Commit())
+				failed++;
+			//ȡ²ͷžɲۣɲصͻᱻһȡ
+			unsigned char* slot=pool.Alloc(target);
+			HookTransaction ix;
+			if(!slot || !ix.Install(target,slot,SLOT_CODESIZE,detour) || !ix.Commit())
+				failed++;
+			unsigned char* old=trampolines[i];
+			trampolines[i]=slot;
+			pool.Free(old);
+		}
+	}
+	s.stop=1;
+	for(int t=0;t<threads;t++)
+		::pthread_join(th[t],NULL);
+	printf("%d趨%dӣ%d߳̾%ldΣ%ld\n",rounds,n,threads,s.calls,s.bad);
+	Check(failed==0 && s.bad==0,"ժʹõȷ");
+}
+
+static double Seconds(clock_t start)
+{
+	return (double)(::clock()-start)/CLOCKS_PER_SEC;
+}
+
+//һӣۡ趨ժͷţύÿӵύһ飬ժֽڱ븴ԭ
+static void Bench(int n,int rounds)
+{
+	TrampolinePool pool;
+	unsigned char* code=MapFunctions(n);
+	std::vector<unsigned char> original(code,code+n*FUNC_STRIDE);
+	std::vector<unsigned char*> slots(n);
+	double batchIn=0,batchOut=0,singleIn=0,singleOut=0;
+	int failed=0;
+	for(int r=0;r<rounds;r++)
+	{
+		clock_t start=::clock();
+		HookTransaction tx;
+		for(int i=0;i<n;i++)
+		{
+			slots[i]=pool.Alloc(code+i*FUNC_STRIDE);
+			if(!slots[i] || !tx.Install(code+i*FUNC_STRIDE,slots[i],SLOT_CODESIZE,code))
+				failed++;
+		}
+		if(!tx.Commit())
+			failed++;
+		batchIn+=Seconds(start);
+		start=::clock();
+		HookTransaction ux;
+		for(int i=0;i<n;i++)
+		{
+			if(!ux.Uninstall(code+i*FUNC_STRIDE,slots[i],SLOT_CODESIZE))
+				failed++;
+		}
+		if(!ux.Commit())
+			failed++;
+		for(int i=0;i<n;i++)
+			pool.Free(slots[i]);
+		batchOut+=Seconds(start);
+		if(::memcmp(code,&original[0],original.size())!=0)
+			failed++;
+
+		start=::clock();
+		for(int i=0;i<n;i++)
+		{
+			slots[i]=pool.Alloc(code+i*FUNC_STRIDE);
+			HookTransaction one;
+			if(!slots[i] || !one.Install(code+i*FUNC_STRIDE,slots[i],SLOT_CODESIZE,code) || !one.Commit())
+				failed++;
+		}
+		singleIn+=Seconds(start);
+		start=::clock();
+		for(int i=0;i<n;i++)
+		{
+			HookTransaction one;
+			if(!one.Uninstall(code+i*FUNC_STRIDE,slots[i],SLOT_CODESIZE) || !one.Commit())
+				failed++;
+			pool.Free(slots[i]);
+		}
+		singleOut+=Seconds(start);
+		if(::memcmp(code,&original[0],original.size())!=0)
+			failed++;
+	}
+	double scale=1e6/rounds/n;
+	printf("%dӣ%d֣%d\n",n,rounds,pool.GetRegionNum());
+	printf("ύ: 趨%.2f΢/ӣժ%.2f΢/\n",batchIn*scale,batchOut*scale);
+	printf("ύ: 趨%.2f΢/ӣժ%.2f΢/\n",singleIn*scale,singleOut*scale);
+	Check(failed==0,"һ趨ժֽڸԭ");
+}
+
+int main(int argc,char* argv[])
+{
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench(10000,(argc>2)?::atoi(argv[2]):5);
+		return failures?1:0;
+	}
+	TestQuarantine();
+	TestChurn((argc>1)?::atoi(argv[1]):20);
+	return failures?1:0;
+}
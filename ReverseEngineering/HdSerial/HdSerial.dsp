@@ -85,10 +85,6 @@ LIB32=link.exe -lib
 # PROP Default_Filter "cpp;c;cxx;rc;def;r;odl;idl;hpj;bat"
 # Begin Source File
 
-SOURCE=.\Disasm.cpp
-# End Source File
-# Begin Source File
-
 SOURCE=.\HwSerial.cpp
 # End Source File
 # Begin Source File
@@ -0,0 +1,239 @@
+#pragma once
+//Ԥִѭл߱ģǵָExecDecodedtest/ScriptJitTest.cppΪյִѭ
+//StepȥŻִеĴյĴͬһݡ
+//ļHostṩͨ·ֵĶд
+//	double DoubleConstant(int index);
+//	void CalcBinary(int op,Value& op1,const Value& op2);	ٷ֧ʱĶԪ㣬дop1
+//	void CalcUnary(int op,Value& op1);
+//	void StepOther(Value& val,int delta);	ԼĲ븡ʱĴ
+//	void GetLValue(Value* locals,Value* args,int argnum,const Value& vop,Value& r);
+//	void SetLValue(Value* locals,Value* args,int argnum,const Value& vop,const Value& newVal);
+#include <stddef.h>
+#include "ScriptOpcode.h"
+#include "TaggedValue.h"
+
+#ifdef _MSC_VER
+#define DECODED_INLINE	__forceinline
+#else
+#define DECODED_INLINE	inline __attribute__((always_inline))
+#endif
+
+template<typename Value,typename Host>
+	struct DecodedExecT
+{
+	typedef TaggedArithT<Value> Arith;
+	//ָ㣬TaggedArithĴһ
+	static inline int FusedIntOp(int op,int a,int c)
+	{
+		switch(op)
+		{
+		case OP_ADD:
+			return a+c;
+		case OP_SUB:
+			return a-c;
+		case OP_EQ:
+			return (a==c)?1:0;
+		case OP_NE:
+			return (a!=c)?1:0;
+		case OP_LT:
+			return (a<c)?1:0;
+		case OP_GT:
+			return (a>c)?1:0;
+		case OP_LE:
+			return (a<=c)?1:0;
+		}
+		return (a>=c)?1:0;
+	}
+	//ϸֵӦĶԪ
+	static inline int AssignToBinary(int op)
+	{
+		switch(op)
+		{
+		case OP_ADD_ASSIGN:return OP_ADD;
+		case OP_SUB_ASSIGN:return OP_SUB;
+		case OP_MUL_ASSIGN:return OP_MUL;
+		case OP_DIV_ASSIGN:return OP_DIV;
+		case OP_MOD_ASSIGN:return OP_MOD;
+		case OP_AND_ASSIGN:return OP_AND;
+		case OP_OR_ASSIGN:return OP_OR;
+		case OP_XOR_ASSIGN:return OP_XOR;
+		case OP_LS_ASSIGN:return OP_LS;
+		case OP_RS_ASSIGN:return OP_RS;
+		}
+		return op;
+	}
+	//ִָdpcָһָִʱtrueOP_RETURNﲻָfalseɵߵִѭ
+	static DECODED_INLINE bool Step(Host& host,const DecodedIns* pins,const DecodedIns& d,int& pc,Value*& sp,Value* locals,Value* args,int argnum,Value& result)
+	{
+		switch(d.op)
+		{
+		case DOP_PUSH_LOCAL:
+			*sp++=locals[d.index];
+			break;
+		case DOP_PUSH_INT:
+		case DOP_PUSH_LVALUE:
+			(sp++)->SetInt(d.index);
+			break;
+		case DOP_PUSH_DOUBLE:
+			(sp++)->SetDouble(host.DoubleConstant(d.index));
+			break;
+		case DOP_PUSH_ARG:
+			if(d.index>=argnum)
+				(sp++)->SetInt(0);
+			else
+				*sp++=args[d.index];
+			break;
+		case DOP_LOCAL_INT_OP:
+		case DOP_LOCAL_LOCAL_OP:
+			{
+				const Value& v=locals[d.index];
+				const DecodedIns& n=pins[pc];
+				const Value* pv=(d.op==DOP_LOCAL_LOCAL_OP)?&locals[n.index]:NULL;
+				if(v.tag!=TAG_INT || (pv && pv->tag!=TAG_INT))
+				{
+					*sp++=v;
+					break;
+				}
+				(sp++)->SetInt(FusedIntOp(pins[pc+1].op,v.i,pv?pv->i:n.index));
+				pc+=2;
+			}
+			break;
+		case OP_POP:
+			result.MoveFrom(*--sp);
+			break;
+		case OP_JMP:
+			pc=d.index;
+			break;
+		case OP_JZ:
+			{
+				--sp;
+				bool zero=!sp->Low32();
+				sp->Clear();
+				if(zero)
+					pc=d.index;
+			}
+			break;
+		case OP_JNZ:
+			{
+				--sp;
+				bool zero=!sp->Low32();
+				sp->Clear();
+				if(!zero)
+					pc=d.index;
+			}
+			break;
+		case DOP_JZ_KEEP:
+			if(!sp[-1].Low32())
+				pc=d.index;
+			break;
+		case DOP_JNZ_KEEP:
+			if(sp[-1].Low32())
+				pc=d.index;
+			break;
+		case OP_ADD:
+			if(!Arith::Add(sp[-2],sp[-1]))
+				host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_SUB:
+			if(!Arith::Sub(sp[-2],sp[-1]))
+				host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_MUL:
+			if(!Arith::Mul(sp[-2],sp[-1]))
+				host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_EQ:
+		case OP_NE:
+			if(!Arith::Equal(sp[-2],sp[-1],d.op==OP_NE))
+				host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			if(!Arith::Compare(d.op-OP_LT,sp[-2],sp[-1]))
+				host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_DIV:
+		case OP_MOD:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_ANDAND:
+		case OP_OROR:
+		case OP_LS:
+		case OP_RS:
+			host.CalcBinary(d.op,sp[-2],sp[-1]);
+			(--sp)->Clear();
+			break;
+		case OP_NEG:
+		case OP_NOT:
+		case OP_USUB:
+			host.CalcUnary(d.op,sp[-1]);
+			break;
+		case OP_INC:
+		case OP_DEC:
+			{
+				int delta=(d.op==OP_INC)?1:-1;
+				Value& lv=sp[-1];
+				//ֲ򸡵ʱԭ޸
+				if(lv.tag==TAG_INT && (lv.i & 0x0f0000)==0)
+				{
+					Value& var=locals[lv.i & 0x00ffff];
+					if(Arith::Step(var,delta))
+					{
+						lv=var;
+						break;
+					}
+				}
+				Value val;
+				host.GetLValue(locals,args,argnum,lv,val);
+				if(!Arith::Step(val,delta))
+					host.StepOther(val,delta);
+				host.SetLValue(locals,args,argnum,lv,val);
+				lv.MoveFrom(val);
+			}
+			break;
+		case OP_ASSIGN:
+			{
+				host.SetLValue(locals,args,argnum,sp[-2],sp[-1]);
+				--sp;
+				sp[-1].MoveFrom(*sp);
+			}
+			break;
+		case OP_ADD_ASSIGN:
+		case OP_SUB_ASSIGN:
+		case OP_MUL_ASSIGN:
+		case OP_DIV_ASSIGN:
+		case OP_MOD_ASSIGN:
+		case OP_AND_ASSIGN:
+		case OP_OR_ASSIGN:
+		case OP_XOR_ASSIGN:
+		case OP_LS_ASSIGN:
+		case OP_RS_ASSIGN:
+			{
+				Value val;
+				host.GetLValue(locals,args,argnum,sp[-2],val);
+				host.CalcBinary(AssignToBinary(d.op),val,sp[-1]);
+				host.SetLValue(locals,args,argnum,sp[-2],val);
+				(--sp)->Clear();
+				sp[-1].MoveFrom(val);
+			}
+			break;
+		case OP_COMMA:
+			{
+				--sp;
+				sp[-1].MoveFrom(*sp);
+			}
+			break;
+		default:
+			return false;
+		}
+		return true;
+	}
+};
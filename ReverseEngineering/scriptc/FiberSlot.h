@@ -0,0 +1,63 @@
+#pragma once
+//ÿ߳һָĲλϵͳṩFlsAllocWindows Server 2003Ժʱ˳ֲ̾洢
+//߳˳ʱɻصյвָ룻˻ΪTLS߳˳ʱû֪ͨ
+//ⲿջ빳DLLĹ֡ջñࡣʵκ߳ʹ֮ǰ
+class FiberSlot
+{
+public:
+	typedef VOID (WINAPI* FlsCallbackPtr)(PVOID);
+private:
+	typedef DWORD (WINAPI* FlsAllocPtr)(FlsCallbackPtr);
+	typedef PVOID (WINAPI* FlsGetValuePtr)(DWORD);
+	typedef BOOL (WINAPI* FlsSetValuePtr)(DWORD,PVOID);
+	typedef BOOL (WINAPI* FlsFreePtr)(DWORD);
+public:
+	//threadExit߳˳ʱԲзǿյֵãҲʱԸֵ̲߳
+	FiberSlot(FlsCallbackPtr threadExit)
+	{
+		flsGet=NULL;
+		flsSet=NULL;
+		flsFree=NULL;
+		index=TLS_OUT_OF_INDEXES;
+		HMODULE hKernel=::GetModuleHandle("kernel32.dll");
+		FlsAllocPtr flsAlloc=(FlsAllocPtr)::GetProcAddress(hKernel,"FlsAlloc");
+		if(flsAlloc)
+		{
+			flsGet=(FlsGetValuePtr)::GetProcAddress(hKernel,"FlsGetValue");
+			flsSet=(FlsSetValuePtr)::GetProcAddress(hKernel,"FlsSetValue");
+			flsFree=(FlsFreePtr)::GetProcAddress(hKernel,"FlsFree");
+			if(flsGet && flsSet && flsFree)
+				index=(*flsAlloc)(threadExit);
+		}
+		if(index==TLS_OUT_OF_INDEXES)
+		{
+			flsGet=NULL;
+			index=::TlsAlloc();
+		}
+	}
+	~FiberSlot()
+	{
+		if(flsGet)
+			(*flsFree)(index);
+		else
+			::TlsFree(index);
+	}
+	inline void* Get(void)
+	{
+		if(flsGet)
+			return (*flsGet)(index);
+		return ::TlsGetValue(index);
+	}
+	inline void Set(void* p)
+	{
+		if(flsGet)
+			(*flsSet)(index,p);
+		else
+			::TlsSetValue(index,p);
+	}
+private:
+	DWORD index;
+	FlsGetValuePtr flsGet;
+	FlsSetValuePtr flsSet;
+	FlsFreePtr flsFree;
+};
@@ -18,14 +18,25 @@ protected:
 	CString str;
 	CComBSTR bstr;
 	CComVariant variant;	
+	DWORD hash;
+	bool hashed;
+	bool constant;	//װʱפַδ޸Ĺ
 public:
+	StringBase(void)
+	{
+		hash=0;
+		hashed=false;
+		constant=false;
+	}
 	inline void Init(const char* s)
 	{
 		str=s;
+		Touch();
 	}
 	inline void Init(const BSTR s)
 	{
 		str=s;
+		Touch();
 	}
 	inline void Init(const VARIANT& s)
 	{
@@ -37,6 +48,49 @@ public:
 			v.ChangeType(VT_BSTR);
 			str=v.bstrVal;
 		}
+		Touch();
+	}
+	//ݸıɢֵUNICODEVARIANT
+	inline void Touch(void)
+	{
+		hashed=false;
+		constant=false;
+		bstr.Empty();
+		variant.Clear();
+	}
+	inline void MarkConstant(void)
+	{
+		constant=true;
+	}
+	//ԳĵַΪԱļݱ޸ĺ󻺴治Ч
+	inline bool IsConstant(void)
+	{
+		return constant;
+	}
+	//ݵFNVɢֵ󻺴
+	inline DWORD Hash(void)
+	{
+		if(!hashed)
+		{
+			DWORD h=2166136261;
+			const unsigned char* p=(const unsigned char*)(LPCSTR)str;
+			int len=str.GetLength();
+			for(int i=0;i<len;i++)
+				h=(h^p[i])*16777619;
+			hash=h;
+			hashed=true;
+		}
+		return hash;
+	}
+	//ȽǷͬͬһͬɢֵҲͬʱزͬűȽݡ
+	//פַװʱɢֵ֮ıȽͨҪȽݡ
+	static inline bool Equals(StringBase* a,StringBase* b)
+	{
+		if(a==b)
+			return true;
+		if(a->hashed && b->hashed && a->hash!=b->hash)
+			return false;
+		return a->str==b->str;
 	}
 	inline CString& Ref(void)
 	{
@@ -110,6 +164,18 @@ public:
 //̬ӳϵҪڶͷʱΪҪIDispatchReleaseʵʩHook,COM
 //󷽷ʵʩHookȽϼ򵥣滻麯ĶӦɡ
 //Ķ̬ӳȫ־̬ݣڶ̹ݵDLLпܲ쳣
+//ӳΪȫʱִĹãдӵİװͷʱDynamicDispatchLock½С
+//룺ȡDISPIDʱAddRef/ReleaseԭReleaseͷʱٴνDispatchRelease
+template<int N>
+	struct DynamicDispatchLockT
+{
+	static CriticalSection criticalSection;
+};
+//ģľ̬ԱԶͷļУȫֹʱʼڶ߳״ʹʱ
+template<int N>
+	CriticalSection DynamicDispatchLockT<N>::criticalSection;
+typedef DynamicDispatchLockT<0> DynamicDispatchLock;
+
 class DynamicDispatch
 {
 	typedef unsigned long (__stdcall*DispatchReleasePtr)(IDispatch*);
@@ -121,59 +187,61 @@ public:
 	{
 		//IObjectIDispatchʵУDISPIDʵصģǶÿʵӳ䣬ͨCOM
 		//DISPIDʵضʵأЩCOMԣʵַʽе˷ѿռ䡣
-		Obj_Disps& objdisps=ObjDispsRef();
-		Obj_Disps::iterator it=objdisps.find(obj);
-		//ûиöʱö
-		if(it==objdisps.end())
 		{
-			//HOOK,ΪVTBLǶģHOOKVTBLַʶöʵָ
-			DWORD pOBJ=(DWORD)obj;
-			DWORD pVTBL=*(DWORD*)pOBJ;
-			Vtbl_OldPtr& vop=VtblOldPtrRef();
-			Vtbl_OldPtr::iterator vit=vop.find(pVTBL);
-			if(vit==vop.end())
+			CriticalSectionOperator CSO(&DynamicDispatchLock::criticalSection);
+			Obj_Disps& objdisps=ObjDispsRef();
+			Obj_Disps::iterator it=objdisps.find(obj);
+			//ûиöʱö
+			if(it==objdisps.end())
 			{
-				MemoryProtect mp((LPVOID)pVTBL);
-				DWORD pFUNC=((DWORD*)pVTBL)[2];//ReleaseIDispatch麯ĵ
-				((DWORD*)pVTBL)[2]=(DWORD)DispatchRelease;
-				DispatchReleasePtr ptr=(DispatchReleasePtr)pFUNC;
-				VtblOldPtrRef()[pVTBL]=ptr;
+				//HOOK,ΪVTBLǶģHOOKVTBLַʶöʵָ
+				DWORD pOBJ=(DWORD)obj;
+				DWORD pVTBL=*(DWORD*)pOBJ;
+				Vtbl_OldPtr& vop=VtblOldPtrRef();
+				Vtbl_OldPtr::iterator vit=vop.find(pVTBL);
+				if(vit==vop.end())
+				{
+					MemoryProtect mp((LPVOID)pVTBL);
+					DWORD pFUNC=((DWORD*)pVTBL)[2];//ReleaseIDispatch麯ĵ
+					((DWORD*)pVTBL)[2]=(DWORD)DispatchRelease;
+					DispatchReleasePtr ptr=(DispatchReleasePtr)pFUNC;
+					VtblOldPtrRef()[pVTBL]=ptr;
+				}
+				//
+				Member_Dispid md;
+				objdisps[obj]=md;
+				it=objdisps.find(obj);
 			}
-			//
-			Member_Dispid md;
-			objdisps[obj]=md;
-			it=objdisps.find(obj);
+			//ӳʱȡDISPID
+			Member_Dispid& dispids=it->second;
+			Member_Dispid::iterator mit=dispids.find(member);
+			if(mit!=dispids.end())
+				return mit->second;
 		}
-		//ӳʱȡDISPIDñ׼IDispatchӿڷȡDISPIDӳ
-		Member_Dispid& dispids=it->second;
-		Member_Dispid::iterator mit=dispids.find(member);
-		if(mit!=dispids.end())
+		//ñ׼IDispatchӿڷȡDISPIDӳ䡣ѯУⲿCOMĲѯܽ
+		//߳objã󲻻ͷţֻͬһԱ߳м¼Ѿ
+		//תͣûнжϣͨӿڲѯȷһתǰȫġ
+		/*
+		CComPtr<IDispatch> dispEx;
+		member->QueryInterface(IID_IString,(void**)&dispEx);
+		*/
+		IString* pmember=static_cast<IString*>(member);
+		CComBSTR& bstr=pmember->UnicodeRef();
+		CComDispatchDriver disp(obj);
+		DISPID dispid=0xffffffff;
+		HRESULT hr=disp.GetIDOfName(bstr,&dispid);
+		if(SUCCEEDED(hr))
 		{
-			return mit->second;
-		}
-		else
-		{
-			//תͣûнжϣͨӿڲѯȷһתǰȫġ
-			/*
-			CComPtr<IDispatch> dispEx;
-			member->QueryInterface(IID_IString,(void**)&dispEx);
-			*/
-			IString* pmember=static_cast<IString*>(member);
-			CComBSTR& bstr=pmember->UnicodeRef();
-			CComDispatchDriver disp(obj);
-			DISPID dispid=0xffffffff;
-			HRESULT hr=disp.GetIDOfName(bstr,&dispid);
-			if(SUCCEEDED(hr))
-			{
-				dispids[member]=dispid;
-			}
-			return dispid;
+			CriticalSectionOperator CSO(&DynamicDispatchLock::criticalSection);
+			ObjDispsRef()[obj][member]=dispid;
 		}
+		return dispid;
 	}
 	//Զ̬ӵĳԱͬһͬһԱڲͬʱDISPIDܷ仯
 	//һڱ仯ǰǰ¼DISPID
 	static void Erase(IDispatch* obj,IDispatch* member)
 	{
+		CriticalSectionOperator CSO(&DynamicDispatchLock::criticalSection);
 		Obj_Disps& objdisps=ObjDispsRef();
 		Obj_Disps::iterator it=objdisps.find(obj);
 		if(it!=objdisps.end())
@@ -183,13 +251,17 @@ public:
 	}
 	static void ClearAll(void)
 	{
+		CriticalSectionOperator CSO(&DynamicDispatchLock::criticalSection);
 		ObjDispsRef().clear();
 	}
 private:
+	//ԭReleaseӳͬһμɣͷźӳǰ
+	//߳ͬһַ½ĶȡɶDISPID
 	static unsigned long __stdcall DispatchRelease(IDispatch* obj)
 	{
 		DWORD pOBJ=(DWORD)obj;
 		DWORD pVTBL=*(DWORD*)pOBJ;
+		CriticalSectionOperator CSO(&DynamicDispatchLock::criticalSection);
 		Vtbl_OldPtr& oldptr=VtblOldPtrRef();
 		Vtbl_OldPtr::iterator it=oldptr.find(pVTBL);
 		if(it!=oldptr.end())
@@ -313,6 +385,12 @@ protected:
 		::itoa(d,buf,10);
 		return CStringW(buf);
 	}
+public:
+	//Ƿ̬ӹԱ̬Աڱڽķ
+	inline bool HasDynamicMembers(void)
+	{
+		return !dispIDMap.empty();
+	}
 public:
     /* IUnknown methods */
     STDMETHOD(QueryInterface)(REFIID riid, void** ppv)
@@ -331,12 +409,14 @@ public:
     STDMETHOD_(unsigned long, AddRef)(void)
 	{
 		//ATLTRACE("retcount: %d\n",m_refs+1);
-		return ++m_refs;
+		//üԭӲвѯʱ̻߳ͬʱͬһ
+		return ::InterlockedIncrement((LONG*)&m_refs);
 	}
     STDMETHOD_(unsigned long, Release)(void)
 	{
 		//ATLTRACE("retcount: %d\n",m_refs-1);
-		if(--m_refs == 0)
+		unsigned long refs=::InterlockedDecrement((LONG*)&m_refs);
+		if(refs == 0)
 		{
 			if(typeInfo != NULL)
 			{
@@ -345,7 +425,7 @@ public:
 			delete this;
 			return 0;
 		}
-		return m_refs;
+		return refs;
 	}
 
     /* IDispatch methods */
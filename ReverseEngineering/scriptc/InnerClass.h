@@ -11,6 +11,7 @@
 #include <queue>
 
 #include "GenerateObject.h"
+#include "StringSearch.h"
 
 namespace Scriptc
 {
@@ -31,6 +32,8 @@ namespace Scriptc
 				IString* pr=IString::GetIString(right);
 				if(pl && pr)
 				{
+					if(pl==pr)
+						return false;
 					return pl->Ref() < pr->Ref();
 				}
 				else
@@ -67,6 +70,8 @@ namespace Scriptc
 				IString* pr=IString::GetIString(right);
 				if(pl && pr)
 				{
+					if(pl==pr)
+						return false;
 					return pl->Ref() > pr->Ref();
 				}
 				else
@@ -103,7 +108,7 @@ namespace Scriptc
 				IString* pr=IString::GetIString(right);
 				if(pl && pr)
 				{
-					return pl->Ref() == pr->Ref();
+					return StringBase::Equals(pl,pr);
 				}
 				else
 				{
@@ -139,6 +144,8 @@ namespace Scriptc
 				IString* pr=IString::GetIString(right);
 				if(pl && pr)
 				{
+					if(pl==pr)
+						return true;
 					return pl->Ref() <= pr->Ref();
 				}
 				else
@@ -175,6 +182,8 @@ namespace Scriptc
 				IString* pr=IString::GetIString(right);
 				if(pl && pr)
 				{
+					if(pl==pr)
+						return true;
 					return pl->Ref() >= pr->Ref();
 				}
 				else
@@ -220,11 +229,238 @@ namespace Scriptc
 		}
 	};
 
+	//CComVariantɢȱȽϣɢʹã
+	//ֵΪĸɢͬȣڲַBSTRɢȽϣ
+	//ַɢֵڶУָȽϡ
+	template<typename VariantT>
+		class VarHashT
+	{
+	public:
+		static inline DWORD Mix(DWORD h)
+		{
+			h^=h>>16;
+			h*=0x85ebca6b;
+			h^=h>>13;
+			h*=0xc2b2ae35;
+			h^=h>>16;
+			return h;
+		}
+		//StringBase::HashͬFNVɢ
+		static inline DWORD StringHash(const CString& s)
+		{
+			DWORD h=2166136261;
+			const unsigned char* p=(const unsigned char*)(LPCSTR)s;
+			int len=s.GetLength();
+			for(int i=0;i<len;i++)
+				h=(h^p[i])*16777619;
+			return h;
+		}
+		static inline bool IsNumber(const VariantT& v)
+		{
+			return v.vt==VT_I4 || v.vt==VT_INT || v.vt==VT_R8;
+		}
+		static inline double ToDouble(const VariantT& v)
+		{
+			if(v.vt==VT_R8)
+				return v.dblVal;
+			return (double)v.lVal;
+		}
+		static inline DWORD Hash(const VariantT& v)
+		{
+			if(v.vt==VT_I4 || v.vt==VT_INT)
+			{
+				return Mix((DWORD)v.lVal);
+			}
+			else if(v.vt==VT_R8)
+			{
+				double d=v.dblVal;
+				if(d>=-2147483648.0 && d<=2147483647.0 && d==(double)(int)d)
+					return Mix((DWORD)(int)d);
+				const DWORD* p=(const DWORD*)&d;
+				return Mix(p[0]^Mix(p[1]));
+			}
+			else if(v.vt==VT_BSTR)
+			{
+				return StringHash(CString(v.bstrVal));
+			}
+			else if(v.vt==VT_DISPATCH)
+			{
+				IString* pstr=IString::GetIString(v);
+				if(pstr)
+					return pstr->Hash();
+				return Mix((DWORD)(DWORD_PTR)v.pdispVal);
+			}
+			return Mix(v.ulVal);
+		}
+		static inline bool Equal(const VariantT& left,const VariantT& right)
+		{
+			if(IsNumber(left) && IsNumber(right))
+			{
+				if(left.vt==VT_R8 || right.vt==VT_R8)
+					return ToDouble(left)==ToDouble(right);
+				return left.lVal==right.lVal;
+			}
+			IString* pl=IString::GetIString(left);
+			IString* pr=IString::GetIString(right);
+			if(pl && pr)
+				return StringBase::Equals(pl,pr);
+			else if(pl && right.vt==VT_BSTR)
+				return pl->Ref()==CString(right.bstrVal);
+			else if(pr && left.vt==VT_BSTR)
+				return pr->Ref()==CString(left.bstrVal);
+			else if(left.vt==VT_BSTR && right.vt==VT_BSTR)
+				return CString(left.bstrVal)==CString(right.bstrVal);
+			else if(left.vt!=right.vt)
+				return false;
+			else if(left.vt==VT_DISPATCH)
+				return left.pdispVal==right.pdispVal;
+			return left.ulVal==right.ulVal;
+		}
+	};
+	typedef VarHashT<CComVariant> VarHash;
+
+	//Ŷַ̽⣩ɢбԪذ˳Ųɢֵɰλֱӷʣ
+	//ֻԪ±꣬ɾʱ۰ƷһԪƵɾԪصλԱ
+	class VarHashTable
+	{
+	public:
+		struct Entry
+		{
+			DWORD hash;
+			CComVariant key;
+			CComVariant value;
+		};
+		typedef std::vector<Entry> Entries;
+	public:
+		inline int size(void) const
+		{
+			return entries.size();
+		}
+		inline bool empty(void) const
+		{
+			return entries.empty();
+		}
+		inline void clear(void)
+		{
+			entries.clear();
+			slots.clear();
+		}
+		inline Entry& At(UINT pos)
+		{
+			return entries[pos];
+		}
+		//Ԫصλãʱ-1
+		inline int Find(const CComVariant& key) const
+		{
+			if(entries.empty())
+				return -1;
+			int slot=Probe(key,VarHash::Hash(key));
+			if(slot<0)
+				return -1;
+			return slots[slot];
+		}
+		//ԪصλãinsertedʾǷ¼Ԫ
+		inline int Insert(const CComVariant& key,bool& inserted)
+		{
+			DWORD hash=VarHash::Hash(key);
+			if((entries.size()+1)*4>slots.size()*3)
+				Rehash(slots.empty()?16:slots.size()*2);
+			UINT mask=slots.size()-1;
+			UINT i=hash&mask;
+			for(;slots[i]>=0;i=(i+1)&mask)
+			{
+				Entry& e=entries[slots[i]];
+				if(e.hash==hash && VarHash::Equal(e.key,key))
+				{
+					inserted=false;
+					return slots[i];
+				}
+			}
+			slots[i]=entries.size();
+			entries.push_back(Entry());
+			Entry& e=entries.back();
+			e.hash=hash;
+			e.key=key;
+			inserted=true;
+			return slots[i];
+		}
+		inline bool Erase(const CComVariant& key)
+		{
+			if(entries.empty())
+				return false;
+			int slot=Probe(key,VarHash::Hash(key));
+			if(slot<0)
+				return false;
+			int index=slots[slot];
+			RemoveSlot(slot);
+			int last=entries.size()-1;
+			if(index!=last)
+			{
+				slots[SlotOf(last)]=index;
+				entries[index]=entries[last];
+			}
+			entries.pop_back();
+			return true;
+		}
+	private:
+		inline int Probe(const CComVariant& key,DWORD hash) const
+		{
+			UINT mask=slots.size()-1;
+			for(UINT i=hash&mask;slots[i]>=0;i=(i+1)&mask)
+			{
+				const Entry& e=entries[slots[i]];
+				if(e.hash==hash && VarHash::Equal(e.key,key))
+					return i;
+			}
+			return -1;
+		}
+		inline UINT SlotOf(int index) const
+		{
+			UINT mask=slots.size()-1;
+			UINT i=entries[index].hash&mask;
+			while(slots[i]!=index)
+				i=(i+1)&mask;
+			return i;
+		}
+		//̽ԪǰղۣʹҲҪɾ
+		inline void RemoveSlot(UINT i)
+		{
+			UINT mask=slots.size()-1;
+			UINT j=i;
+			for(;;)
+			{
+				j=(j+1)&mask;
+				if(slots[j]<0)
+					break;
+				UINT k=entries[slots[j]].hash&mask;
+				if((i<=j)?(i<k && k<=j):(i<k || k<=j))
+					continue;
+				slots[i]=slots[j];
+				i=j;
+			}
+			slots[i]=-1;
+		}
+		inline void Rehash(UINT num)
+		{
+			slots.assign(num,-1);
+			UINT mask=num-1;
+			for(UINT n=0;n<entries.size();n++)
+			{
+				UINT i=entries[n].hash&mask;
+				while(slots[i]>=0)
+					i=(i+1)&mask;
+				slots[i]=n;
+			}
+		}
+	private:
+		Entries entries;
+		std::vector<int> slots;
+	};
+
 	typedef std::vector<CComVariant> VarVector;
 	typedef std::deque<CComVariant> VarDeque;
 	typedef std::list<CComVariant> VarList;
 	typedef std::set<CComVariant,VarLess> VarSet;
-	typedef std::map<CString,VarVector> ClassObjects;
 	typedef std::priority_queue<CComVariant,std::vector<CComVariant>,VarLess> MaxVarPriorityQueue;
 	typedef std::priority_queue<CComVariant,std::vector<CComVariant>,VarGreater> MinVarPriorityQueue;
 
@@ -495,6 +731,225 @@ namespace Scriptc
 			return p;
 		}
 
+	//OQLϰһԽɢشȱȽϣشΧȽϡ
+	//ֻΪڲֵַ͵ĶΪѡַ֮ıȽ
+	//ֵָУû壬ǻѡֻСѡWHEREӾԶԺѡֵ
+	class ClassIndex
+	{
+		enum KeyType
+		{
+			KEY_INT=0,
+			KEY_STRING
+		};
+		struct Key
+		{
+			int type;
+			int i;
+			DWORD hash;
+			CString s;
+		};
+		typedef std::vector<Key> Keys;
+		typedef stdext::hash_map<DWORD,std::vector<int> > Buckets;
+		class KeyOrder
+		{
+			const Keys* pKeys;
+		public:
+			KeyOrder(const Keys* p):pKeys(p)
+			{}
+			inline bool operator()(int a,int b) const
+			{
+				return Less((*pKeys)[a],(*pKeys)[b]);
+			}
+		};
+	public:
+		CString name;		//
+		CComVariant attr;	//ڲַȡʱʹ
+		bool ordered;
+		UINT version;		//ʱversion
+		UINT epoch;			//ʱűдԵļ
+	public:
+		ClassIndex(void)
+		{
+			ordered=false;
+			version=0;
+			epoch=0;
+			sorted=0;
+		}
+		//ѱĶ󰴶Ĵ
+		inline UINT Count(void) const
+		{
+			return keys.size();
+		}
+		inline void Reset(UINT ver,UINT ep)
+		{
+			keys.clear();
+			buckets.clear();
+			others.clear();
+			order.clear();
+			sorted=0;
+			version=ver;
+			epoch=ep;
+		}
+		//еһvalueΪֵ
+		inline void Add(const CComVariant& value)
+		{
+			int n=keys.size();
+			keys.push_back(Key());
+			if(!MakeKey(value,keys.back()))
+			{
+				others.push_back(n);
+				return;
+			}
+			buckets[keys.back().hash].push_back(n);
+			if(ordered)
+				order.push_back(n);
+		}
+		//ȡvalueȵĺѡ±꣬ĴСvalueڲַʱfalse
+		inline bool LookupEqual(const CComVariant& value,std::vector<int>& result)
+		{
+			Key key;
+			if(!MakeKey(value,key))
+				return false;
+			Buckets::iterator it=buckets.find(key.hash);
+			if(it!=buckets.end())
+			{
+				std::vector<int>& cands=it->second;
+				for(UINT k=0;k<cands.size();k++)
+				{
+					if(SameKey(keys[cands[k]],key))
+						result.push_back(cands[k]);
+				}
+			}
+			MergeOthers(result);
+			return true;
+		}
+		//ȡСڣlessΪtruevalueĺѡ±꣬inclusiveʱȵĶûʱfalse
+		inline bool LookupRange(const CComVariant& value,bool less,bool inclusive,std::vector<int>& result)
+		{
+			Key key;
+			if(!ordered || !MakeKey(value,key))
+				return false;
+			Sort();
+			//ͬ͵ļorderҳ͵䣬ڶֲұ߽
+			int first=Bound(key.type,NULL,false);
+			int last=Bound(key.type,NULL,true);
+			int bound=Bound(key.type,&key,less==inclusive);
+			if(less)
+				result.insert(result.end(),order.begin()+first,order.begin()+bound);
+			else
+				result.insert(result.end(),order.begin()+bound,order.begin()+last);
+			std::sort(result.begin(),result.end());
+			MergeOthers(result);
+			return true;
+		}
+	private:
+		static inline bool MakeKey(const CComVariant& value,Key& key)
+		{
+			if(value.vt==VT_I4 || value.vt==VT_INT)
+			{
+				key.type=KEY_INT;
+				key.i=value.lVal;
+				key.hash=VarHash::Mix((DWORD)value.lVal);
+				return true;
+			}
+			IString* pstr=IString::GetIString(value);
+			if(!pstr)
+				return false;
+			key.type=KEY_STRING;
+			key.i=0;
+			key.hash=pstr->Hash();
+			key.s=pstr->Ref();
+			return true;
+		}
+		static inline bool SameKey(const Key& a,const Key& b)
+		{
+			if(a.type!=b.type || a.hash!=b.hash)
+				return false;
+			if(a.type==KEY_INT)
+				return a.i==b.i;
+			return a.s==b.s;
+		}
+		//ȰֵַٰͣݱȽϣOP_LTȶڲַıȽһ
+		static inline bool Less(const Key& a,const Key& b)
+		{
+			if(a.type!=b.type)
+				return a.type<b.type;
+			if(a.type==KEY_INT)
+				return a.i<b.i;
+			return a.s<b.s;
+		}
+		//׷ӺδĲ򲿷ֹ鲢
+		inline void Sort(void)
+		{
+			if(sorted==order.size())
+				return;
+			KeyOrder ko(&keys);
+			std::sort(order.begin()+sorted,order.end(),ko);
+			std::inplace_merge(order.begin(),order.begin()+sorted,order.end(),ko);
+			sorted=order.size();
+		}
+		//orderжֲңpkeyΪNULLʱΪtype߽磬ҵһСڣupperʱΪڣ*pkeyλ
+		inline int Bound(int type,const Key* pkey,bool upper) const
+		{
+			int lo=0;
+			int hi=order.size();
+			while(lo<hi)
+			{
+				int mid=(lo+hi)/2;
+				const Key& k=keys[order[mid]];
+				bool before;
+				if(k.type!=type)
+					before=(k.type<type);
+				else if(!pkey)
+					before=upper;
+				else
+					before=upper?!Less(*pkey,k):Less(k,*pkey);
+				if(before)
+					lo=mid+1;
+				else
+					hi=mid;
+			}
+			return lo;
+		}
+		inline void MergeOthers(std::vector<int>& result)
+		{
+			if(others.empty())
+				return;
+			UINT mid=result.size();
+			result.insert(result.end(),others.begin(),others.end());
+			std::inplace_merge(result.begin(),result.begin()+mid,result.end());
+		}
+	private:
+		Keys keys;					//ƽУܽĶҲռһ
+		Buckets buckets;
+		std::vector<int> others;	//ֵڲַĶ±
+		std::vector<int> order;		//и±꣬ǰsortedź
+		UINT sorted;
+	};
+
+	//OQLͬ󱣴УϽ
+	//versionڶ롢ɾдʱֻĩβ׷Ӷʱ䣬ʱ¶󣬷ؽ
+	struct ClassTable
+	{
+		VarVector objects;
+		UINT version;
+		std::vector<ClassIndex> indexes;
+		ClassTable(void)
+		{
+			version=0;
+		}
+		inline ClassIndex* FindIndex(const CString& name)
+		{
+			for(UINT i=0;i<indexes.size();i++)
+			{
+				if(indexes[i].name==name)
+					return &indexes[i];
+			}
+			return NULL;
+		}
+	};
+	typedef std::map<CString,ClassTable> ClassObjects;
+
 	template<bool userCreate>
 		class VectorObjData
 	{
@@ -506,6 +961,9 @@ namespace Scriptc
 		inline void VarVectorPtr(VarVector* p)
 		{
 		}
+		inline void Modified(void)
+		{
+		}
 	private:
 		VarVector varVector;
 	};
@@ -515,6 +973,11 @@ namespace Scriptc
 		class VectorObjData<false>
 	{
 	public:
+		VectorObjData(void)
+		{
+			pVarVector=NULL;
+			pTable=NULL;
+		}
 		inline VarVector*& VarVectorPtr(void)
 		{
 			return pVarVector;
@@ -523,8 +986,20 @@ namespace Scriptc
 		{
 			pVarVector=p;
 		}
+		inline void Table(ClassTable* p)
+		{
+			pTable=p;
+			pVarVector=&p->objects;
+		}
+		//ĩβ׷Ӷ޸ģʹ´βѯʱؽ
+		inline void Modified(void)
+		{
+			if(pTable)
+				pTable->version++;
+		}
 	private:
 		VarVector* pVarVector;
+		ClassTable* pTable;
 	};
 
 	template<typename T,bool userCreate=true>
@@ -541,6 +1016,7 @@ namespace Scriptc
 			VarVector::iterator it=vData.VarVectorPtr()->begin();
 			std::advance(it,pos);
 			vData.VarVectorPtr()->insert(it,CComVariant(v));
+			vData.Modified();
 		}
 		virtual void __stdcall erase(VARIANT key)
 		{
@@ -550,10 +1026,12 @@ namespace Scriptc
 			VarVector::iterator it=vData.VarVectorPtr()->begin();
 			std::advance(it,pos);
 			vData.VarVectorPtr()->erase(it);
+			vData.Modified();
 		}
 		virtual void __stdcall put_length(int size)
 		{
 			vData.VarVectorPtr()->resize(size,CComVariant(0));
+			vData.Modified();
 		}
 		virtual int __stdcall get_length(void)
 		{
@@ -566,6 +1044,7 @@ namespace Scriptc
 		virtual void __stdcall pop(void)
 		{
 			vData.VarVectorPtr()->pop_back();
+			vData.Modified();
 		}
 		virtual VARIANT __stdcall get_front(void)
 		{
@@ -603,6 +1082,7 @@ namespace Scriptc
 		virtual void __stdcall clear(void)
 		{
 			vData.VarVectorPtr()->clear();
+			vData.Modified();
 		}
 		virtual BOOL __stdcall get_empty(void)
 		{
@@ -664,6 +1144,10 @@ namespace Scriptc
 		{
 			vData.VarVectorPtr(p);
 		}
+		inline void Init(ClassTable* p)
+		{
+			vData.Table(p);
+		}
 		inline VARIANT get(UINT pos)
 		{		
 			if(pos<0 || pos>=vData.VarVectorPtr()->size())
@@ -679,6 +1163,7 @@ namespace Scriptc
 			if(pos<0 || pos>=vData.VarVectorPtr()->size())
 				return;
 			(*vData.VarVectorPtr())[pos]=CComVariant(v);
+			vData.Modified();
 		}
 	private:
 		VectorObjData<userCreate> vData;
@@ -842,6 +1327,7 @@ namespace Scriptc
 		VarDeque varDeque;
 	};
 
+	//бԷֿ鱣棬λöдǳʱ䣬˵Ĳɾԭһǳʱ
 	template<typename T>
 		class ListObj : public ObjectBaseT<T>
 	{
@@ -851,48 +1337,48 @@ namespace Scriptc
 		virtual void __stdcall insert(VARIANT key,VARIANT v)
 		{
 			UINT pos=key.intVal;
-			if(pos<0 || pos>varList.size())
+			if(pos<0 || pos>varDeque.size())
 				return;
-			VarList::iterator it=varList.begin();
+			VarDeque::iterator it=varDeque.begin();
 			std::advance(it,pos);
-			varList.insert(it,CComVariant(v));
+			varDeque.insert(it,CComVariant(v));
 		}
 		virtual void __stdcall erase(VARIANT key)
 		{
 			UINT pos=key.intVal;
-			if(pos<0 || pos>=varList.size())
+			if(pos<0 || pos>=varDeque.size())
 				return;
-			VarList::iterator it=varList.begin();
+			VarDeque::iterator it=varDeque.begin();
 			std::advance(it,pos);
-			varList.erase(it);
+			varDeque.erase(it);
 		}
 		virtual void __stdcall put_length(int size)
 		{
-			varList.resize(size,CComVariant(0));
+			varDeque.resize(size,CComVariant(0));
 		}
 		virtual int __stdcall get_length(void)
 		{
-			return varList.size();
+			return varDeque.size();
 		}
 		virtual void __stdcall unshift(VARIANT v)
 		{
-			varList.push_front(CComVariant(v));
+			varDeque.push_front(CComVariant(v));
 		}
 		virtual void __stdcall shift(void)
 		{
-			varList.pop_front();
+			varDeque.pop_front();
 		}
 		virtual void __stdcall push(VARIANT v)
 		{
-			varList.push_back(CComVariant(v));
+			varDeque.push_back(CComVariant(v));
 		}
 		virtual void __stdcall pop(void)
 		{
-			varList.pop_back();
+			varDeque.pop_back();
 		}
 		virtual VARIANT __stdcall get_front(void)
 		{
-			CComVariant v=varList.front();
+			CComVariant v=varDeque.front();
 			VARIANT var;
 			::VariantInit(&var);
 			v.Detach(&var);
@@ -900,7 +1386,7 @@ namespace Scriptc
 		}
 		virtual VARIANT __stdcall get_back(void)
 		{
-			CComVariant v=varList.back();
+			CComVariant v=varDeque.back();
 			VARIANT var;
 			::VariantInit(&var);
 			v.Detach(&var);
@@ -908,27 +1394,24 @@ namespace Scriptc
 		}
 		virtual int __stdcall find(VARIANT v)
 		{
-			VarList::iterator it=std::find(varList.begin(),varList.end(),CComVariant(v));
-			if(it==varList.end())
+			VarDeque::iterator it=std::find(varDeque.begin(),varDeque.end(),CComVariant(v));
+			if(it==varDeque.end())
 				return -1;
-			return (int)std::distance(varList.begin(),it);
+			return (int)std::distance(varDeque.begin(),it);
 		}
 		virtual IDispatch* __stdcall splice(unsigned int where,IDispatch* pOther,unsigned int start,unsigned int count)
 		{
 			ListObj<T>* pO=(ListObj<T>*)pOther;
-			try
+			if(where<=varDeque.size() && start<=pO->varDeque.size() && count<=pO->varDeque.size()-start)
 			{
-				VarList::iterator iwhere,istart,iend;
-				iwhere=varList.begin();
-				std::advance(iwhere,where);
-				istart=pO->varList.begin();
-				std::advance(istart,start);
-				iend=pO->varList.begin();
-				std::advance(iend,start+count);
-				varList.splice(iwhere,pO->varList,istart,iend);
+				VarDeque::iterator istart=pO->varDeque.begin()+start;
+				VarDeque moved(istart,istart+count);
+				pO->varDeque.erase(istart,istart+count);
+				//ͬһбƶʱλߵ֮Ҫǰ
+				if(pO==this && where>start)
+					where=(where>=start+count)?where-count:start;
+				varDeque.insert(varDeque.begin()+where,moved.begin(),moved.end());
 			}
-			catch(...)
-			{}
 			this->AddRef();
 			return this;
 		}
@@ -938,19 +1421,19 @@ namespace Scriptc
 		}
 		virtual void __stdcall remove(VARIANT v)
 		{
-			varList.remove(CComVariant(v));
+			varDeque.erase(std::remove(varDeque.begin(),varDeque.end(),CComVariant(v)),varDeque.end());
 		}
 		virtual void __stdcall clear(void)
 		{
-			varList.clear();
+			varDeque.clear();
 		}
 		virtual BOOL __stdcall get_empty(void)
 		{
-			return (BOOL)varList.empty();
+			return (BOOL)varDeque.empty();
 		}
 		virtual void __stdcall resize(int size,VARIANT v)
 		{
-			varList.resize(size,CComVariant(v));
+			varDeque.resize(size,CComVariant(v));
 		}
 		virtual IDispatch* __stdcall clone(void)
 		{
@@ -1004,11 +1487,9 @@ namespace Scriptc
 	public:
 		inline VARIANT get(UINT pos)
 		{		
-			if(pos<0 || pos>=varList.size())
+			if(pos<0 || pos>=varDeque.size())
 				return CComVariant(0);
-			VarList::iterator it=varList.begin();
-			std::advance(it,pos);
-			CComVariant v=*it;
+			CComVariant v=varDeque[pos];
 			VARIANT var;
 			::VariantInit(&var);
 			v.Detach(&var);
@@ -1016,14 +1497,12 @@ namespace Scriptc
 		}
 		inline void set(UINT pos,VARIANT v)
 		{
-			if(pos<0 || pos>=varList.size())
+			if(pos<0 || pos>=varDeque.size())
 				return;
-			VarList::iterator it=varList.begin();
-			std::advance(it,pos);
-			*it=CComVariant(v);
+			varDeque[pos]=CComVariant(v);
 		}
 	private:
-		VarList varList;
+		VarDeque varDeque;
 	};
 
 	template<typename T>
@@ -1043,15 +1522,18 @@ namespace Scriptc
 	public:
 		virtual void __stdcall insert(VARIANT v)
 		{
-			varSet.insert(CComVariant(v));
+			if(varSet.insert(CComVariant(v)).second)
+				order.clear();
 		}
 		virtual void __stdcall erase(VARIANT v)
 		{
-			varSet.erase(CComVariant(v));
+			if(varSet.erase(CComVariant(v))>0)
+				order.clear();
 		}
 		virtual void __stdcall clear(void)
 		{
 			varSet.clear();
+			order.clear();
 		}
 		virtual int __stdcall get_length(void)
 		{
@@ -1125,9 +1607,15 @@ namespace Scriptc
 		{		
 			if(pos<0 || pos>=varSet.size())
 				return CComVariant(0);
-			VarSet::iterator it=varSet.begin();
-			std::advance(it,pos);
-			CComVariant v=*it;
+			if(order.size()!=varSet.size())
+			{
+				order.clear();
+				order.reserve(varSet.size());
+				VarSet::iterator it=varSet.begin();
+				for(;it!=varSet.end();it++)
+					order.push_back(&*it);
+			}
+			CComVariant v=*order[pos];
 			VARIANT var;
 			::VariantInit(&var);
 			v.Detach(&var);
@@ -1136,6 +1624,231 @@ namespace Scriptc
 	private:
 		VM* vmachine;
 		VarSet varSet;
+		//еԪָ룬޸ĺϣλöȡʱؽʹ˳ʱ
+		std::vector<const CComVariant*> order;
+	};
+
+	//ɢмϣԪذ˳򱣴棬λöȡǳʱ䣬ɾʱһԪƵɾԪصλ
+	template<typename T>
+		class HashSetObj : public IDispatch
+	{
+	public:
+		typedef T VM;		
+	public:
+		inline void SetVM(VM* p)
+		{
+			vmachine=p;
+		}
+		inline VM* GetVM(void)
+		{
+			return vmachine;
+		}
+	public:
+		virtual void __stdcall insert(VARIANT v)
+		{
+			bool inserted;
+			varHash.Insert(CComVariant(v),inserted);
+		}
+		virtual void __stdcall erase(VARIANT v)
+		{
+			varHash.Erase(CComVariant(v));
+		}
+		virtual void __stdcall clear(void)
+		{
+			varHash.clear();
+		}
+		virtual int __stdcall get_length(void)
+		{
+			return varHash.size();
+		}
+		virtual BOOL __stdcall get_empty(void)
+		{
+			return (BOOL)varHash.empty();
+		}
+		virtual BOOL __stdcall exist(VARIANT v)
+		{
+			if(varHash.Find(CComVariant(v))>=0)
+				return TRUE;
+			return FALSE;
+		}
+		virtual IDispatch* __stdcall clone(void)
+		{
+			return CloneImpl(this);
+		}
+		virtual IDispatch* __stdcall concatSibling(IDispatch* other)
+		{
+			ConcatSiblingImpl(this,other);
+			this->AddRef();
+			return this;
+		}
+		virtual IDispatch* __stdcall concatVariant(VARIANT vals)
+		{
+			ConcatVariantImpl(this,vals);
+			this->AddRef();
+			return this;
+		}
+		virtual BSTR __stdcall toString(VARIANT s)
+		{
+			return ToStringImpl(this,s);
+		}
+		virtual VARIANT __stdcall toSafeArray(void)
+		{
+			return ToSafeArrayImpl(this);
+		}
+		virtual IDispatch* __stdcall toObject(void)
+		{
+			return ToObjectImpl(this);
+		}
+	public:
+		BEGIN_INTF(HashSetObj)
+			METHOD(insert)
+			METHOD(erase)
+			METHOD(clear)
+			PROPERTYGET(length,true)
+			PROPERTYGET(empty,true)
+			METHOD(exist)
+			METHOD(clone)
+			METHOD(concatSibling)
+			METHOD(concatVariant)
+			METHOD(toString)
+			METHOD(toSafeArray)
+			METHOD(toObject)
+		END_INTF()
+	public:
+		static inline HashSetObj* CreateDispatchEx(void)
+		{
+			return CreateDispatch();
+		}
+	public:
+		inline void push(VARIANT v)
+		{
+			insert(v);
+		}
+		inline VARIANT get(UINT pos)
+		{		
+			if(pos<0 || pos>=(UINT)varHash.size())
+				return CComVariant(0);
+			CComVariant v=varHash.At(pos).key;
+			VARIANT var;
+			::VariantInit(&var);
+			v.Detach(&var);
+			return var;
+		}
+	private:
+		VM* vmachine;
+		VarHashTable varHash;
+	};
+
+	//ɢӳ䣬ֵ԰˳򱣴棬keyAtvalueAtλñ
+	template<typename T>
+		class HashMapObj : public IDispatch
+	{
+	public:
+		typedef T VM;		
+	public:
+		inline void SetVM(VM* p)
+		{
+			vmachine=p;
+		}
+		inline VM* GetVM(void)
+		{
+			return vmachine;
+		}
+	public:
+		//ֵԣѴʱ滻ֵ
+		virtual void __stdcall insert(VARIANT key,VARIANT v)
+		{
+			bool inserted;
+			int pos=varHash.Insert(CComVariant(key),inserted);
+			varHash.At(pos).value=v;
+		}
+		virtual void __stdcall erase(VARIANT key)
+		{
+			varHash.Erase(CComVariant(key));
+		}
+		virtual void __stdcall clear(void)
+		{
+			varHash.clear();
+		}
+		virtual int __stdcall get_length(void)
+		{
+			return varHash.size();
+		}
+		virtual BOOL __stdcall get_empty(void)
+		{
+			return (BOOL)varHash.empty();
+		}
+		virtual BOOL __stdcall exist(VARIANT key)
+		{
+			if(varHash.Find(CComVariant(key))>=0)
+				return TRUE;
+			return FALSE;
+		}
+		//ȡӦֵʱ0
+		virtual VARIANT __stdcall lookup(VARIANT key)
+		{
+			int pos=varHash.Find(CComVariant(key));
+			if(pos<0)
+				return CComVariant(0);
+			CComVariant v=varHash.At(pos).value;
+			VARIANT var;
+			::VariantInit(&var);
+			v.Detach(&var);
+			return var;
+		}
+		virtual VARIANT __stdcall keyAt(int pos)
+		{
+			return get(pos);
+		}
+		virtual VARIANT __stdcall valueAt(int pos)
+		{
+			if(pos<0 || pos>=varHash.size())
+				return CComVariant(0);
+			CComVariant v=varHash.At(pos).value;
+			VARIANT var;
+			::VariantInit(&var);
+			v.Detach(&var);
+			return var;
+		}
+		virtual IDispatch* __stdcall clone(void)
+		{
+			HashMapObj<T>* p=HashMapObj<T>::CreateDispatchEx();
+			p->SetVM(GetVM());
+			p->varHash=varHash;
+			return p;
+		}
+	public:
+		BEGIN_INTF(HashMapObj)
+			METHOD(insert)
+			METHOD(erase)
+			METHOD(clear)
+			PROPERTYGET(length,true)
+			PROPERTYGET(empty,true)
+			METHOD(exist)
+			METHOD(lookup)
+			METHOD(keyAt)
+			METHOD(valueAt)
+			METHOD(clone)
+		END_INTF()
+	public:
+		static inline HashMapObj* CreateDispatchEx(void)
+		{
+			return CreateDispatch();
+		}
+	public:
+		inline VARIANT get(UINT pos)
+		{		
+			if(pos<0 || pos>=(UINT)varHash.size())
+				return CComVariant(0);
+			CComVariant v=varHash.At(pos).key;
+			VARIANT var;
+			::VariantInit(&var);
+			v.Detach(&var);
+			return var;
+		}
+	private:
+		VM* vmachine;
+		VarHashTable varHash;
 	};
 
 	template<typename T>
@@ -1267,6 +1980,7 @@ namespace Scriptc
 				return;
 			TCHAR c=v.bVal;
 			str.Insert(pos,c);
+			Touch();
 		}
 		virtual void __stdcall erase(VARIANT key)
 		{
@@ -1274,6 +1988,7 @@ namespace Scriptc
 			if(pos<0 || pos>=str.GetLength())
 				return;
 			str.Delete(pos);
+			Touch();
 		}
 		virtual void __stdcall put_length(int size)
 		{}
@@ -1295,7 +2010,8 @@ namespace Scriptc
 				}
 				else
 				{
-					ds=pstr->Ref();
+					//ֱַϲң
+					return StringSearch::Find(str,pstr->Ref(),start);
 				}
 			}
 			else if(d.vt==VT_BSTR)
@@ -1308,7 +2024,7 @@ namespace Scriptc
 				vd.ChangeType(VT_BSTR);
 				ds=CString(vd.bstrVal);
 			}
-			return str.Find(ds,start);
+			return StringSearch::Find(str,ds,start);
 		}	
 		virtual BSTR __stdcall substr(int start,int len)
 		{
@@ -1443,6 +2159,7 @@ namespace Scriptc
 				return;
 			TCHAR c=v.bVal;
 			str.SetAt(pos,c);
+			Touch();
 		}
 	private:	
 	template<typename C> inline 
@@ -1475,7 +2192,7 @@ namespace Scriptc
 				vvs.ChangeType(VT_BSTR);
 				sp=CString(vvs.bstrVal);
 			}
-			int i=str.Find(sp),li=0;
+			int i=StringSearch::Find(str,sp),li=0;
 			while(i>=0)
 			{			
 				StringObj<T>* ptr=StringObj<T>::CreateDispatchEx();		
@@ -1491,7 +2208,7 @@ namespace Scriptc
 				co->push(CComVariant(ptr));
 				ptr->Release();
 				li=i+sp.GetLength();
-				i=str.Find(sp,li);
+				i=StringSearch::Find(str,sp,li);
 			}
 			StringObj<T>* ptr0=StringObj<T>::CreateDispatchEx();		
 			ptr0->Init(str.Mid(li));
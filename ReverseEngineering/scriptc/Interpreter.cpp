@@ -21,6 +21,22 @@
 		return 0;
 	}
 
+	ApiStackPool* ApiStackPool::instance=NULL;
+	FiberSlot* ApiStack::slot=NULL;
+
+	//ⲿջջ̲߳λģʼʱжʱͷţʱûнű߳
+	static struct ApiStackStartup
+	{
+		ApiStackStartup(void)
+		{
+			ApiStack::Startup();
+		}
+		~ApiStackStartup()
+		{
+			ApiStack::Shutdown();
+		}
+	} apiStackStartup;
+
 	void OqlRuntime::ClearCompileInfo(void)
 	{
 #ifdef INCLUDE_COMPILE
@@ -80,14 +96,17 @@
 	}
 	CString ScriptcRuntime::Compile(const char* buf,const char* filePath)
 	{
+		if(pOwner)
+			return "ִĲܱű!";
 		CriticalSectionOperator CSO(&compileCriticalSection);
 
 		Parser p(buf,filePath,this);
 		p.parse();
 		if(p.haserror())
 			return p.error();
-		else
-			return "";
+		Optimize();
+		DecodeAll();
+		return "";
 	}
 	int ScriptcRuntime::DecideOperator(const CString& data,int opnum)
 	{
@@ -484,7 +503,7 @@
 		while(!switchIndexes.empty())
 			switchIndexes.pop();
 
-		for(int i=0;i<MAXQUERY;i++)
+		for(int i=0;i<MAXQUERY && !pOwner;i++)
 		{
 			if(oqls[i])
 				oqls[i]->ClearCompileInfo();
@@ -912,6 +931,7 @@
 		{
 			switchInfos[switchIndexes.top().index].def=d-switchIndexes.top().source;
 		}
+		BuildSwitchTable(switchInfos[switchIndexes.top().index]);
 		switchIndexes.pop();
 
 		PopBreak(d);
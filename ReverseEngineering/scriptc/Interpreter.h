@@ -1,6 +1,16 @@
 #pragma once
 #include "InnerClass.h"
 #include "lzari.h"
+#include "ScriptImage.h"
+#include "ScriptProfiler.h"
+#include "ScriptOpcode.h"
+#include "TaggedValue.h"
+#include "ScriptJit.h"
+#include "DecodedExec.h"
+#include "FiberSlot.h"
+#include <process.h>
+#include <malloc.h>
+#include <new>
 
 #define INCLUDE_COMPILE
 
@@ -14,71 +24,29 @@ extern int __cdecl nullprintf(const char *, ...);
 
 #define USER_FUNCTION_NUM		100
 
-#define INITIAL_APISTACK_COUNT	100
-#define APISTACK_CHECK_TIME		10000
 
 #define MAXCODEBUFFERSIZE		64*1024
 #define MAXOQLBUFFERSIZE		8*1024
 #define APISTACKSIZE			64*1024
 #define APINESTEDLEVEL			8
+#define APISTACK_POOLSIZE		16		//ⲿջౣĿջ
 #define MAXQUERY				64
 #define OUTERFUNC_MAXARGNUM		32
 #define TRAMPOLINE_SIZE			4*1024
 #define MAX_CONST_STRING_SIZE	10*1024
 #define MAX_IDENTIFIER_SIZE		1024
-
-#define OP_PUSH			1
-#define OP_POP			2
-#define OP_JMP			3
-#define OP_JZ			4
-#define OP_JNZ			5
-#define OP_TABLE_JMP	6
-#define OP_CALL			7
-#define OP_RETURN		8
-#define OP_OBJCALL		9
-#define OP_OBJGETATTR	10
-#define OP_OBJSETATTR	11
-#define OP_ADD			12
-#define OP_SUB			13
-#define OP_MUL			14
-#define OP_DIV			15
-#define OP_MOD			16
-#define OP_AND			17
-#define OP_OR			18
-#define OP_NEG			19
-#define OP_XOR			20
-#define OP_ANDAND		21
-#define OP_OROR			22
-#define OP_NOT			23
-#define OP_EQ			24
-#define OP_NE			25
-#define OP_LS			26
-#define OP_RS			27
-#define OP_LT			28
-#define OP_GT			29
-#define OP_LE			30
-#define OP_GE			31
-#define OP_INC			32
-#define OP_DEC			33
-#define OP_USUB			34
-#define OP_ASSIGN		35
-#define OP_ADD_ASSIGN	36
-#define OP_SUB_ASSIGN	37
-#define OP_MUL_ASSIGN	38
-#define OP_DIV_ASSIGN	39
-#define OP_MOD_ASSIGN	40
-#define OP_AND_ASSIGN	41
-#define OP_OR_ASSIGN	42
-#define OP_XOR_ASSIGN	43
-#define OP_LS_ASSIGN	44
-#define OP_RS_ASSIGN	45
-#define OP_COMMA		46
-#define OP_EXECQUERY	47
-#define OP_PTRINFO		48
-#define OP_PTRCALC		49
-#define OP_ADDR			50
-#define OP_CAST			51
-#define OP_ARG			52
+#define VALUESTACKSIZE			64*1024
+#define ARGSTACKSIZE			4*1024
+#define QUERYCHUNKSIZE			1024
+#define MAXQUERYWORKERS			32
+#define INLINECACHE_WAYS		4
+#define SWITCH_DENSE_FACTOR		3		//ֵ򲻳֧ʱֱ
+#define SWITCH_DENSE_MAXRANGE	4096
+#define SWITCH_HASH_MINCASES	64		//ֵ֧ҷֲϡʱɢ
+#define OPTIMIZE_MAXROUND		16		//Ż
+#define NEEDLESET_MAXCACHE		256		//LIKEINĳϵ໺ʱȫ
+#define NEEDLESET_MINLIKE		64		//LIKEĳӴʱöമԶʱҸ
+#define NEEDLESET_MININ			4		//INĳַʱɢֵ
 
 #define FUNC_MIN_PREDEFINE  101
 #define FUNC_OUTPUT			101
@@ -101,12 +69,12 @@ extern int __cdecl nullprintf(const char *, ...);
 #define FUNC_IN				118
 #define FUNC_INVARIANT		119
 #define FUNC_DISTANCE		120
-#define FUNC_MAX_PREDEFINE	120
+#define FUNC_OQLINDEX		121
+#define FUNC_MAX_PREDEFINE	121
 
 
 typedef std::vector<CComVariant> Variables;
-//typedef std::vector<CComVariant> Objects;
-typedef std::list<CComVariant> Objects;//洢OQLѯĽЩ
+typedef std::vector<CComVariant> Objects;//OQLѯĽʱֻ±򣬲ƶԪ
 typedef std::vector<int> Instructions;
 
 typedef std::vector<CString> SelectList;
@@ -155,6 +123,163 @@ struct Buffer
 	}
 };
 
+//ֵڽеʵֲԣΪIDispatchVARIANTװΪCComVariant
+struct VariantValuePolicy
+{
+	typedef IDispatch Object;
+	typedef CComVariant Boxed;
+	static inline Boxed* CloneBox(const Boxed* v)
+	{
+		return new CComVariant(*v);
+	}
+	static inline void FreeBox(Boxed* v)
+	{
+		delete v;
+	}
+	static inline int BoxLow32(const Boxed* v)
+	{
+		return v->lVal;
+	}
+};
+typedef TaggedValueT<VariantValuePolicy> TaggedValue;
+typedef TaggedArithT<TaggedValue> TaggedArith;
+
+//ʱڲĴֵʵ
+typedef JitFrameT<TaggedValue> JitFrame;
+typedef DecodedJitT<TaggedValue> DecodedJit;
+typedef DecodedJit::Entry JitEntry;
+
+//ڽֱַӷڣ麯ʶ
+struct BuiltinType
+{
+	void* vtbl;
+	DISPID lengthId;
+	bool (*Plain)(IDispatch* p);				//ûж̬ԱͻDISPIDԸöЧ
+	int (*Length)(IDispatch* p);
+	VARIANT (*Get)(IDispatch* p,int pos);
+	void (*Set)(IDispatch* p,int pos,const VARIANT& v);
+};
+typedef std::vector<BuiltinType> BuiltinTypes;
+//麯Ա±ʱΪNULLDISPIDĶӦtypeΪNULLʾڽ
+struct InlineCacheEntry
+{
+	void* vtbl;
+	IDispatch* member;
+	const BuiltinType* type;
+	DISPID dispid;
+};
+//һԶд򷽷ָ棬¼INLINECACHE_WAYSֻͣ滻
+struct InlineCache
+{
+	InlineCacheEntry entries[INLINECACHE_WAYS];
+	int count;
+	int next;
+	InlineCache(void)
+	{
+		count=0;
+		next=0;
+	}
+	inline InlineCacheEntry* Find(void* vtbl,IDispatch* member)
+	{
+		for(int i=0;i<count;i++)
+		{
+			if(entries[i].vtbl==vtbl && entries[i].member==member)
+				return &entries[i];
+		}
+		return NULL;
+	}
+	inline InlineCacheEntry* Add(void* vtbl,IDispatch* member,const BuiltinType* type,DISPID dispid)
+	{
+		InlineCacheEntry* pe;
+		if(count<INLINECACHE_WAYS)
+			pe=&entries[count++];
+		else
+		{
+			pe=&entries[next];
+			next=(next+1)%INLINECACHE_WAYS;
+		}
+		pe->vtbl=vtbl;
+		pe->member=member;
+		pe->type=type;
+		pe->dispid=dispid;
+		return pe;
+	}
+};
+typedef std::vector<InlineCache> InlineCaches;
+//LIKEINһһַԸĵַΪ棬Զɢбֻһ
+struct NeedleSet
+{
+	std::vector<CString> needles;
+	MultiSearch matcher;
+	bool matchable;		//Զѽ״̬ʱΪfalseɵ
+	std::vector<std::pair<DWORD,int> > hashes;	//ɢֵɢֵneedles±
+};
+typedef std::map<std::vector<IDispatch*>,NeedleSet> NeedleSets;
+
+struct DecodedCode
+{
+	DecodedInstructions ins;
+	InlineCaches caches;	//Զд뷽ָ棬ָindex
+	int maxStack;	//ֵջȣС0ʾ޷Ԥ룬ֻԭѭִ
+	int calls;		//ΪűõĴ
+	JitEntry jit;	//ʱĴ룬NULLʾûб
+	DecodedCode(void)
+	{
+		maxStack=-1;
+		calls=0;
+		jit=NULL;
+	}
+};
+typedef std::vector<DecodedCode> DecodedCodes;
+
+//JOINӾִмƻӱʽFROMԴӱʽȱȽʱϣִ
+struct JoinPlan
+{
+	int source[2];				//ӱʽõFROMԴС0ʾûпõļƻ
+	Instructions keys[2];		//ӱʽOP_POPβ
+	DecodedCode decodedKeys[2];
+	JoinPlan(void)
+	{
+		source[0]=-1;
+		source[1]=-1;
+	}
+};
+
+//FROMԴƻWHEREӾ&&һǸԴ볣ӱʽıȽʱ
+//ȰȡѡٶԺѡWHEREӾ
+struct IndexPlan
+{
+	int op;					//ʱıȽС0ʾûпõļƻ
+	CString attr;			//
+	Instructions key;		//ӱʽOP_POPβ
+	DecodedCode decodedKey;
+	IndexPlan(void)
+	{
+		op=-1;
+	}
+};
+typedef std::vector<IndexPlan> IndexPlans;
+
+//ѯִмƻ״ִʱɲOqlRuntimeУOqlRuntime::ClearAllԤʱ
+struct QueryPlan
+{
+	bool compiled;
+	std::vector<CString> fromClass;	//FROMԴ"all"תΪմ
+	std::vector<int> selectFrom;	//SELECTӦFROMԴ±꣬ҲʱΪ-1
+	std::vector<char> pureExp;		//ʽǷûиãú뷽޸ıԣǶײѯ
+	std::vector<char> constExp;		//ʽһβѯǷΪûиãҲFROM󡢲ȡڴ
+	std::vector<char> pureFrom;		//FROMԴWHEREӾǷûиãûWHEREӾʱΪ1
+	bool linkResult;				//JOINӾ䣬ȡӺĶ
+	int sortOrder;					//ORDER BYʽûORDER BYʱΪ-1
+	int sortExp;
+	QueryPlan(void)
+	{
+		compiled=false;
+		linkResult=false;
+		sortOrder=-1;
+		sortExp=-1;
+	}
+};
 
 class OqlRuntime
 {
@@ -166,6 +291,10 @@ private:
 	Instructions instructions;
 #endif
 	Expressions expressions;
+	DecodedCodes decodedExpressions;
+	JoinPlan joinPlan;
+	IndexPlans indexPlans;		//FROMԴƻ
+	QueryPlan plan;
 public:
 	int join;
 	int sort;
@@ -183,6 +312,10 @@ private:
 		ClearCompileInfo();
 
 		expressions.clear();
+		decodedExpressions.clear();
+		joinPlan=JoinPlan();
+		indexPlans.clear();
+		plan=QueryPlan();
 		selectList.clear();
 		fromList.clear();
 		fromExpList.clear();
@@ -319,6 +452,77 @@ private:
 		delete[] pstr;
 		delete[] pdata;
 	}
+	//.scbӳеOQL¼joinsortʽڴе±SELECTFROMֵַƫƣFROMʽ
+	inline void SaveOqlImage(ScriptImageWriter& w)
+	{
+		w.Put(join);
+		w.Put(sort);
+		w.Put((UINT)expressions.size());
+		for(UINT i=0;i<expressions.size();i++)
+		{
+			Instructions& ins=expressions[i];
+			w.Put(w.AddCode(ins.empty()?NULL:&ins[0],ins.size()));
+			w.Put((UINT)ins.size());
+		}
+		w.Put((UINT)selectList.size());
+		for(UINT i=0;i<selectList.size();i++)
+			w.Put(w.AddString(selectList[i]));
+		w.Put((UINT)fromList.size());
+		for(UINT i=0;i<fromList.size();i++)
+			w.Put(w.AddString(fromList[i]));
+		w.Put((UINT)fromExpList.size());
+		for(UINT i=0;i<fromExpList.size();i++)
+			w.Put(fromExpList[i]);
+	}
+	inline bool LoadOqlImage(ScriptImageCursor& c,const ScriptImageReader& r)
+	{
+		ClearAll();
+
+		const int* code;
+		UINT codeNum;
+		if(!r.Array(SCB_SEC_CODE,code,codeNum))
+			return false;
+		UINT len;
+		if(!c.Read(join) || !c.Read(sort) || !c.Read(len))
+			return false;
+		for(UINT i=0;i<len;i++)
+		{
+			UINT offset,num;
+			if(!c.Read(offset) || !c.Read(num) || offset>codeNum || num>codeNum-offset)
+				return false;
+			expressions.push_back(Instructions(code+offset,code+offset+num));
+		}
+		if(!c.Read(len))
+			return false;
+		for(UINT i=0;i<len;i++)
+		{
+			UINT offset;
+			const char* s;
+			if(!c.Read(offset) || !(s=r.String(offset)))
+				return false;
+			selectList.push_back(s);
+		}
+		if(!c.Read(len))
+			return false;
+		for(UINT i=0;i<len;i++)
+		{
+			UINT offset;
+			const char* s;
+			if(!c.Read(offset) || !(s=r.String(offset)))
+				return false;
+			fromList.push_back(s);
+		}
+		if(!c.Read(len))
+			return false;
+		for(UINT i=0;i<len;i++)
+		{
+			int v;
+			if(!c.Read(v))
+				return false;
+			fromExpList.push_back(v);
+		}
+		return true;
+	}
 	inline CString ListOql(void)
 	{
 		CString temp="select ",prestr="";
@@ -389,163 +593,428 @@ public:
 	CComVariant* externArgs;
 	int argnum;
 	Variables* pVariables;
+	TaggedValue* pLocals;//Ԥ·µľֲΪNULLʱʹpVariablesexternArgs
+	TaggedValue* pArgs;
 public:	
 	inline void SetObject(const CComVariant& object)
 	{
 		if(pOql->fromExpList[fromIndex]>=0)
 		{
-			Objects::iterator it=pObjects->begin();
-			std::advance(it,fromIndex);
-			*it=object;
+			(*pObjects)[fromIndex]=object;
 		}
 	}
 	inline CComVariant CalcExpression(void)
 	{
 		if(pOql->fromExpList[fromIndex]<0)
 			return CComVariant(1);
-		return pScriptc->CalcExpression(oqlIndex,pOql->fromExpList[fromIndex],*pVariables,externArgs,argnum,pObjects);
+		return Eval(pOql->fromExpList[fromIndex]);
+	}
+	inline CComVariant Eval(int exp)
+	{
+		if(pLocals)
+			return pScriptc->CalcExpression(oqlIndex,exp,pLocals,pArgs,argnum,pObjects);
+		return pScriptc->CalcExpression(oqlIndex,exp,*pVariables,externArgs,argnum,pObjects);
 	}
 };
 
-class ApiStack
+//ⲿʹõһջstackΪջף͵ַtopΪǰջ͵ַ
+struct ApiStackBlock
+{
+	SLIST_ENTRY entry;		//ڿʱʹãΪһԱMEMORY_ALLOCATION_ALIGNMENT
+	char* stack;
+	char* top;
+};
+
+//ⲿջĽڹأеջУౣAPISTACK_POOLSIZE飬ֱͷš
+//ΨһʵApiStack::Startupģʼʱúڵľ̬ΪVC2005ĳʼ̰߳ȫ
+class ApiStackPool
 {
-	struct Info
+public:
+	struct Stats
 	{
-		char* apistack;
-		char* papistack;
-		int count;
-		Info(void)
-		{
-			apistack=NULL;
-			papistack=NULL;
-			count=INITIAL_APISTACK_COUNT;
-		}
-		~Info()
-		{
-			Release();
-		}
-		Info(const Info& info)
-		{
-			apistack=info.apistack;
-			papistack=info.papistack;
-		}
-		inline char* Top(void)
-		{
-			return papistack;
-		}
-		inline void PushFrame(void)
-		{
-			papistack-=APISTACKSIZE/APINESTEDLEVEL;
-		}
-		inline void PopFrame(void)
+		LONG created;		//ۼ·ջ
+		LONG acquired;		//ۼȡô
+		LONG reused;		//ȡʱӿõĴ
+		LONG inUse;			//ǰ߳ռõջ
+		LONG highWater;		//ͬʱռõջ
+		LONG pooled;		//еջ
+		LONG discarded;		//黹ʱͷŵջ
+	};
+public:
+	ApiStackPool(void)
+	{
+		::InitializeSListHead(&freeList);
+		::ZeroMemory((void*)&stats,sizeof(stats));
+	}
+	~ApiStackPool()
+	{
+		ApiStackBlock* p;
+		while((p=(ApiStackBlock*)::InterlockedPopEntrySList(&freeList))!=NULL)
+			Delete(p);
+	}
+	static inline ApiStackPool& Instance(void)
+	{
+		return *instance;
+	}
+	//ڴ治ʱNULL
+	inline ApiStackBlock* Acquire(void)
+	{
+		::InterlockedIncrement(&stats.acquired);
+		ApiStackBlock* p=(ApiStackBlock*)::InterlockedPopEntrySList(&freeList);
+		if(p)
 		{
-			papistack+=APISTACKSIZE/APINESTEDLEVEL;
+			::InterlockedDecrement(&stats.pooled);
+			::InterlockedIncrement(&stats.reused);
 		}
-		inline void Release(void)
+		else
 		{
-			if(apistack)
+			p=(ApiStackBlock*)::_aligned_malloc(sizeof(ApiStackBlock),MEMORY_ALLOCATION_ALIGNMENT);
+			if(!p)
+				return NULL;
+			p->stack=new(std::nothrow) char[APISTACKSIZE];
+			if(!p->stack)
 			{
-				delete[] apistack;				
-				apistack=NULL;
-				papistack=NULL;
+				::_aligned_free(p);
+				return NULL;
 			}
+			::InterlockedIncrement(&stats.created);
 		}
-		inline void Reset(void)
+		p->top=p->stack+APISTACKSIZE;
+		LONG n=::InterlockedIncrement(&stats.inUse);
+		LONG high=stats.highWater;
+		while(n>high)
 		{
-			if(!apistack)
-				apistack=new char[APISTACKSIZE];			
-			count=INITIAL_APISTACK_COUNT;
-			papistack=apistack+APISTACKSIZE;
+			LONG old=::InterlockedCompareExchange(&stats.highWater,n,high);
+			if(old==high)
+				break;
+			high=old;
 		}
-	};
-	typedef std::vector<Info> Infos;
-	typedef std::map<UINT_PTR,Infos*> TimerID_Infos; 
+		return p;
+	}
+	inline void Release(ApiStackBlock* p)
+	{
+		::InterlockedDecrement(&stats.inUse);
+		if(::InterlockedIncrement(&stats.pooled)>APISTACK_POOLSIZE)
+		{
+			::InterlockedDecrement(&stats.pooled);
+			::InterlockedIncrement(&stats.discarded);
+			Delete(p);
+			return;
+		}
+		::InterlockedPushEntrySList(&freeList,&p->entry);
+	}
+	inline Stats GetStats(void)
+	{
+		Stats s;
+		::memcpy(&s,(const void*)&stats,sizeof(s));
+		return s;
+	}
+	//ȡиÿջıȷAPISTACK_POOLSIZEǷ
+	inline double ReuseRatio(void)
+	{
+		LONG acquired=stats.acquired;
+		if(acquired<=0)
+			return 0;
+		return (double)stats.reused/acquired;
+	}
+private:
+	friend class ApiStack;
+	static ApiStackPool* instance;
+	static inline void Delete(ApiStackBlock* p)
+	{
+		delete[] p->stack;
+		::_aligned_free(p);
+	}
+private:
+	SLIST_HEADER freeList;
+	volatile Stats stats;
+};
+
+//ⲿջÿ߳һ飬̵߳һεⲿʱApiStackPoolȡã߳˳ʱ黹
+//ͬһ߳иʱִĵⲿðǶ״ʹͬһջĸ֡
+//̵߳ǰʹõջFiberSlotУϵͳṩFlsAllocʱ߳˳ʱԶ黹Ҫ߳˳ǰRelease
+class ApiStack
+{
 public:
+	//ģʼʱκ̵߳ⲿ֮ǰãInterpreter.cppջ̲߳λ
+	static inline void Startup(void)
+	{
+		ApiStackPool::instance=new ApiStackPool();
+		slot=new FiberSlot(ThreadExit);
+	}
+	//ͷŲλFlsFreeĻص黹̲߳ջͷջ
+	static inline void Shutdown(void)
+	{
+		delete slot;
+		slot=NULL;
+		delete ApiStackPool::instance;
+		ApiStackPool::instance=NULL;
+	}
+	//ǰ̵߳ջȡջڴ治㣩ʱNULL
 	inline char* Top(void)
 	{
-		return InfoRef().Top();
+		ApiStackBlock* p=Block();
+		return p?p->top:NULL;
 	}
 	inline void PushFrame(void)
 	{
-		InfoRef().PushFrame();
+		Block()->top-=APISTACKSIZE/APINESTEDLEVEL;
 	}
 	inline void PopFrame(void)
 	{
-		InfoRef().PopFrame();
+		Block()->top+=APISTACKSIZE/APINESTEDLEVEL;
 	}
+	//ѵǰ̵߳ջ黹ջأǰ߳неⲿʱ黹
 	inline void Release(void)
 	{
-		InfoRef().Release();
+		ApiStackBlock* p=(ApiStackBlock*)slot->Get();
+		if(!p || p->top!=p->stack+APISTACKSIZE)
+			return;
+		slot->Set(NULL);
+		ApiStackPool::Instance().Release(p);
+	}
+	static inline ApiStackPool::Stats GetStats(void)
+	{
+		return ApiStackPool::Instance().GetStats();
+	}
+	static inline double ReuseRatio(void)
+	{
+		return ApiStackPool::Instance().ReuseRatio();
+	}
+private:
+	static VOID WINAPI ThreadExit(PVOID p)
+	{
+		if(p)
+			ApiStackPool::Instance().Release((ApiStackBlock*)p);
+	}
+	static inline ApiStackBlock* Block(void)
+	{
+		ApiStackBlock* p=(ApiStackBlock*)slot->Get();
+		if(!p)
+		{
+			p=ApiStackPool::Instance().Acquire();
+			slot->Set(p);
+		}
+		return p;
+	}
+private:
+	static FiberSlot* slot;			//̵߳ǰʹõջ
+};
+
+//Ԥִ·ʹõֵջС̶ڽʱһη䡣
+//ԼջϵĲλǿֵջʱMoveFromֵƳ⸴ü
+struct ValueStack
+{
+	TaggedValue* base;
+	TaggedValue* top;
+	TaggedValue* limit;
+	ValueStack(void)
+	{
+		base=new TaggedValue[VALUESTACKSIZE];
+		top=base;
+		limit=base+VALUESTACKSIZE;
+	}
+	~ValueStack()
+	{
+		delete[] base;
+	}
+	inline bool Reserve(int num)
+	{
+		return top+num<=limit;
 	}
 	inline void Clear(void)
 	{
-		infos.clear();
+		while(top>base)
+			(--top)->Clear();
+	}
+};
+
+//ⲿ󷽷ʱVARIANTջǶ״ͷţռ䲻ʱɵ߸öѷ䡣
+struct ArgStack
+{
+	CComVariant* base;
+	CComVariant* top;
+	CComVariant* limit;
+	ArgStack(void)
+	{
+		base=new CComVariant[ARGSTACKSIZE];
+		top=base;
+		limit=base+ARGSTACKSIZE;
+	}
+	~ArgStack()
+	{
+		delete[] base;
+	}
+	inline CComVariant* Alloc(int num)
+	{
+		if(top+num>limit)
+			return NULL;
+		CComVariant* p=top;
+		top+=num;
+		return p;
+	}
+	inline bool Own(CComVariant* p)
+	{
+		return p>=base && p<=limit;
 	}
+	//ͷpϵȫ
+	inline void Free(CComVariant* p)
+	{
+		while(top>p)
+			(--top)->Clear();
+	}
+};
+
+//й˲ѯʱʹõĹ̳߳ء߳ύһ߳һԭӼȡ
+//ȫɺ󷵻ءλ0Ϊ̣߳λӦһ̣߳ÿλһֵջ
+//߳ҲʹýֵջеԶȡ˶ͬ·
+class QueryWorkers
+{
+	struct Worker
+	{
+		QueryWorkers* pOwner;
+		int slot;
+		HANDLE handle;
+		ValueStack stack;
+	};
+	typedef std::vector<Worker*> Workers;
+public:
+	typedef void (*TaskProc)(void* context,int task,int slot);
 public:
-	ApiStack(void)
+	QueryWorkers(void)
 	{
-		timerID=::SetTimer(NULL,NULL,APISTACK_CHECK_TIME,TimerProc);
-		TimerID_Infos& tis=TimerID_InfosRef();
-		tis[timerID]=&infos;
+		quit=0;
+		proc=NULL;
+		context=NULL;
+		taskNum=0;
+		nextTask=0;
+		activeNum=0;
+		workSemaphore=NULL;
+		doneEvent=NULL;
+		callerStack=NULL;
 	}
-	~ApiStack()
+	~QueryWorkers()
 	{
-		::KillTimer(NULL,timerID);
-		TimerID_Infos& tis=TimerID_InfosRef();
-		tis.erase(timerID);
-		infos.clear();
+		Stop();
 	}
-	//˴ʹ˾̬ȫֱڶ̹ڴ滷п쳣
-	static TimerID_Infos& TimerID_InfosRef(void)
+	inline int Size(void)
 	{
-		static TimerID_Infos timerID_Infos;
-		return timerID_Infos;
+		return workers.size();
 	}
-	//ÿһʱԵǰ̵ApiStackļ10ʱͷŸջռ䡣
-	static VOID CALLBACK TimerProc(HWND hwnd,UINT uMsg,UINT_PTR idEvent,DWORD dwTime)
-	{		
-		TimerID_Infos& tis=TimerID_InfosRef();
-		TimerID_Infos::iterator it=tis.find(idEvent);
-		if(it!=tis.end())
+	inline ValueStack& Stack(int slot)
+	{
+		if(slot==0)
+			return *callerStack;
+		return workers[slot-1]->stack;
+	}
+	//nuṃ߳numΪ0ʱֹͣȫ߳
+	inline void Start(int num)
+	{
+		if(num>MAXQUERYWORKERS)
+			num=MAXQUERYWORKERS;
+		if(num==Size())
+			return;
+		Stop();
+		if(num<=0)
+			return;
+		quit=0;
+		callerStack=new ValueStack;
+		workSemaphore=::CreateSemaphore(NULL,0,num,NULL);
+		doneEvent=::CreateEvent(NULL,FALSE,FALSE,NULL);
+		for(int i=0;i<num;i++)
 		{
-			Infos* pinfos=it->second;
-			Infos::iterator iit=pinfos->begin();
-			while(iit!=pinfos->end())
+			Worker* pw=new Worker;
+			pw->pOwner=this;
+			pw->slot=i+1;
+			pw->handle=(HANDLE)::_beginthreadex(NULL,0,WorkerProc,pw,0,NULL);
+			if(!pw->handle)
 			{
-				iit->count--;
-				if(iit->count<=0)
-				{
-					iit->Release();
-				}
-				iit++;
+				delete pw;
+				break;
+			}
+			workers.push_back(pw);
+		}
+	}
+	inline void Stop(void)
+	{
+		if(workers.size()>0)
+		{
+			quit=1;
+			::ReleaseSemaphore(workSemaphore,workers.size(),NULL);
+			for(UINT i=0;i<workers.size();i++)
+			{
+				::WaitForSingleObject(workers[i]->handle,INFINITE);
+				::CloseHandle(workers[i]->handle);
+				delete workers[i];
 			}
+			workers.clear();
+		}
+		if(callerStack)
+		{
+			delete callerStack;
+			callerStack=NULL;
+		}
+		if(workSemaphore)
+		{
+			::CloseHandle(workSemaphore);
+			workSemaphore=NULL;
+		}
+		if(doneEvent)
+		{
+			::CloseHandle(doneEvent);
+			doneEvent=NULL;
 		}
 	}
+	//ִбΪ0num-1񣬷ʱȫ
+	inline void Run(TaskProc _proc,void* _context,int num)
+	{
+		proc=_proc;
+		context=_context;
+		taskNum=num;
+		nextTask=0;
+		activeNum=workers.size();
+		::ReleaseSemaphore(workSemaphore,workers.size(),NULL);
+		RunTasks(0);
+		::WaitForSingleObject(doneEvent,INFINITE);
+	}
 private:
-	inline Info& InfoRef(void)
+	inline void RunTasks(int slot)
 	{
-		UINT ix=ThreadIndex::Get();
-		if(infos.size()<=ix)
+		while(true)
 		{
-			Info info;
-			infos.push_back(info);
-			Info& i=infos.back();
-			i.Reset();
-			return i;
+			int task=::InterlockedIncrement(&nextTask)-1;
+			if(task>=taskNum)
+				break;
+			(*proc)(context,task,slot);
 		}
-		else
+	}
+	//һ߳ͬһпܱѶΣѴɼǵ߳
+	static unsigned __stdcall WorkerProc(void* p)
+	{
+		Worker* pw=(Worker*)p;
+		QueryWorkers* pOwner=pw->pOwner;
+		while(true)
 		{
-			Info& i=infos[ix];
-			if(i.Top()==NULL)
-				i.Reset();
-			else
-				i.count++;
-			return i;
+			::WaitForSingleObject(pOwner->workSemaphore,INFINITE);
+			if(pOwner->quit)
+				break;
+			pOwner->RunTasks(pw->slot);
+			if(::InterlockedDecrement(&pOwner->activeNum)==0)
+				::SetEvent(pOwner->doneEvent);
 		}
+		return 0;
 	}
 private:
-	Infos infos;
-	UINT_PTR timerID;
+	Workers workers;
+	ValueStack* callerStack;	//й߳ʱŷ
+	volatile LONG quit;
+	TaskProc proc;
+	void* context;
+	int taskNum;
+	volatile LONG nextTask;
+	volatile LONG activeNum;
+	HANDLE workSemaphore;
+	HANDLE doneEvent;
 };
 
 class ScriptcRuntime
@@ -567,6 +1036,9 @@ public:
 
 	typedef FilterObjectsCallbackArgT<ScriptcRuntime,OqlRuntime> FilterObjectsCallbackArg;
 	friend class FilterObjectsCallbackArg;
+	//ԤִѭղԹõָʵֵ֣ͨдͨ·
+	typedef DecodedExecT<TaggedValue,ScriptcRuntime> DecodedExec;
+	friend struct DecodedExecT<TaggedValue,ScriptcRuntime>;
 	typedef IEvent3<const CString&,Objects&,FilterObjectsCallbackArg&> FilterObjectsEvent;
 	typedef SimpleEventTrigerT<FilterObjectsEvent> FilterObjectsEventTriger;
 	
@@ -582,11 +1054,38 @@ public:
 		int loopEnd;
 	}LoopInfo;
 	typedef std::map<int,int> Cases;
-	typedef struct
+	//OP_TABLE_JMP֧ıʾʽʱֵ֧ķֲѡȡӳ񱣴
+	enum SwitchKind
+	{
+		SWITCH_MAP=0,		//ֱcasesв
+		SWITCH_DENSE,		//ֵСֵ֮Ϊ±ֱ
+		SWITCH_SORTED,		//ϵ޷ֲ֧
+		SWITCH_HASH			//˷ɢеɢб
+	};
+	struct SwitchInfo
 	{
 		Cases cases;
 		int def;
-	}SwitchInfo;
+		int kind;					//SwitchKindС0ʾδѡȡ
+		int low;					//ֱӦСֵ
+		UINT seed;					//ɢλĳ
+		int shift;					//ɢλλ
+		UINT bucketSeed;			//ɢͰĳ
+		int bucketShift;
+		std::vector<int> disp;		//ɢиͰλƣλõ
+		std::vector<int> keys;		//ɢбֵ
+		std::vector<int> targets;	//תƫƣֱɢбĿΪȱʡ֧
+		SwitchInfo(void)
+		{
+			def=0;
+			kind=-1;
+			low=0;
+			seed=0;
+			shift=0;
+			bucketSeed=0;
+			bucketShift=0;
+		}
+	};
 	typedef struct
 	{
 		int index;
@@ -605,6 +1104,7 @@ public:
 	typedef std::vector<double> DoubleConstants;
 	typedef std::vector<CString> StrConstants;
 	typedef std::vector<CComVariant> IStrConstants;
+	typedef std::map<CString,UINT> InternTable;
 	typedef std::stack<CComVariant> RuntimeStack;
 	typedef std::vector<CString> NameTable;
 	typedef std::map<CString,CComVariant> SymbolConstants;
@@ -651,37 +1151,104 @@ public:
 	typedef std::vector<JoinObjs> JOINLISTS;
 	typedef std::vector<Objects> OBJLISTS;
 	typedef std::map<CComVariant,CComVariant,Scriptc::VarLess> Orders;
+	typedef std::vector< std::vector<CComVariant*> > TupleTables;
+	typedef std::vector<Objects::iterator> TupleSlots;
+	typedef std::pair<int,int> JoinPair;
+	typedef std::vector<JoinPair> JoinPairs;
+	typedef stdext::hash_map<DWORD,std::vector<int> > JoinHash;
 
-	template<bool less>
-		class CompareT
+	//ƽеֵȽ±꣬ûֵĶֵͬʱԭд
+	class KeyIndexCompare
+	{
+		const Variables* pKeys;
+		const std::vector<char>* pHasKey;
+		bool less;
+	public:
+		KeyIndexCompare(const Variables* _pKeys,const std::vector<char>* _pHasKey,bool _less)
 		{
-			Orders* pOrders;
-		public:
-			CompareT(Orders* _pOrders)
-			{
-				pOrders=_pOrders;
-			}
-		public:
-			inline bool operator() (const CComVariant& a,const CComVariant& b)
+			pKeys=_pKeys;
+			pHasKey=_pHasKey;
+			less=_less;
+		}
+	public:
+		inline bool operator() (int a,int b) const
+		{
+			bool ha=((*pHasKey)[a]!=0);
+			bool hb=((*pHasKey)[b]!=0);
+			if(ha!=hb)
+				return ha;
+			if(ha)
 			{
-				Orders::iterator ait=pOrders->find(a);
-				Orders::iterator bit=pOrders->find(b);
-				if(ait==pOrders->end())
-				{
-					return false;//˳Ҫ
-				}
-				if(bit==pOrders->end())
-				{
-					return true;//˳
-				}
-				if(ait->second == bit->second)
-					return true;//˳
-				else if(Scriptc::VarCompare::LT(ait->second,bit->second))
-					return less;
-				else
-					return !less;
+				const CComVariant& ka=(*pKeys)[less?a:b];
+				const CComVariant& kb=(*pKeys)[less?b:a];
+				if(Scriptc::VarCompare::LT(ka,kb))
+					return true;
+				if(Scriptc::VarCompare::LT(kb,ka))
+					return false;
 			}
-		};
+			return a<b;
+		}
+	};
+	//ԭmax/minõıȽϣaûֵʱΪ٣bûֵʱΪ棬ֵʱΪ
+	static inline bool OrderLessEqual(const Variables& keys,const std::vector<char>& hasKey,int a,int b)
+	{
+		if(!hasKey[a])
+			return false;
+		if(!hasKey[b])
+			return true;
+		if(keys[a]==keys[b])
+			return true;
+		return Scriptc::VarCompare::LT(keys[a],keys[b]);
+	}
+	//װصõĽűִʱֻһʱĶִĹ
+	//ȫֱOQLǽеĿдִ֣ĺֱglobalCriticalSectionoqlCriticalSection·
+	struct Program
+	{
+		OuterFuncInfos outerFuncInfos;
+		SwitchInfos switchInfos;
+		IntConstants intConstants;
+		DoubleConstants doubleConstants;
+		StrConstants strConstants;
+		IStrConstants istrConstants;
+		InternTable internTable;
+		Functions functions;
+		FuncVarNum funcVarNum;
+		Variables globalVariables;
+		OqlRuntime* oqls[MAXQUERY];
+		Librarys librarys;
+		Scriptc::ClassObjects classObjects;
+		std::map<CString,int> indexedAttrs;
+		UINT attrEpoch;
+		volatile LONG contextNum;	//óִĸ
+		bool shared;				//ִģ˺ȫֱOQLҪͬ
+		CriticalSection globalCriticalSection;
+		CriticalSection oqlCriticalSection;
+		Program(void)
+		{
+			for(int i=0;i<MAXQUERY;i++)
+				oqls[i]=NULL;
+			attrEpoch=0;
+			contextNum=0;
+			shared=false;
+		}
+	};
+	//򱻹żʱִʱûͬ
+	class SharedLock
+	{
+		CriticalSection* pCS;
+	public:
+		SharedLock(const Program* p,CriticalSection& cs)
+		{
+			pCS=p->shared?&cs:NULL;
+			if(pCS)
+				pCS->Enter();
+		}
+		~SharedLock()
+		{
+			if(pCS)
+				pCS->Leave();
+		}
+	};
 private:
 #ifdef INCLUDE_COMPILE
 	CString nsPrefix;
@@ -708,26 +1275,47 @@ private:
 	int oqlIndex;
 	Instructions* pInstructions;
 #endif
-	OuterFuncInfos outerFuncInfos;
-	SwitchInfos switchInfos;
+	//programУʹĴ벻Ƕʱִ
+	Program* program;
+	ScriptcRuntime* pOwner;		//ִʱʱΪNULL
 
-	IntConstants intConstants;
-	DoubleConstants doubleConstants;
-	StrConstants strConstants;
-	IStrConstants istrConstants;
-	Functions functions;
-	FuncVarNum funcVarNum;
+	OuterFuncInfos& outerFuncInfos;
+	SwitchInfos& switchInfos;
 
-	Variables globalVariables;
+	IntConstants& intConstants;
+	DoubleConstants& doubleConstants;
+	StrConstants& strConstants;
+	IStrConstants& istrConstants;
+	InternTable& internTable;
+	Functions& functions;
+	FuncVarNum& funcVarNum;
 
-	OqlRuntime* oqls[MAXQUERY];
+	Variables& globalVariables;
 
-	Librarys librarys;
+	OqlRuntime* (&oqls)[MAXQUERY];
+
+	Librarys& librarys;
+	//ΪÿִĸԵִ״̬
 	CString output;
 	RuntimeStack runtimeStack;
 	ApiStack apiStack;
+
+	DecodedCodes decodedFunctions;
+	ValueStack valueStack;
+	ArgStack argStack;
+	bool fastExec;
+	bool optimizeCode;
+	int optimizeBefore;			//һαŻǰȫָ
+	int optimizeAfter;
+	ScriptProfiler* profiler;	//ûпʱΪNULL
+	JitMemory jitMemory;		//ʱڵĿִڴ棬Ԥһ
+	NeedleSets needleSets;
+	int jitThreshold;			//öٴκʱ룬0Ϊ
+	QueryWorkers queryWorkers;
 	
-	Scriptc::ClassObjects classObjects;
+	Scriptc::ClassObjects& classObjects;
+	std::map<CString,int>& indexedAttrs;	//
+	UINT& attrEpoch;						//űд뽨ԵĴ仯ʱؽ
 
 	char* trampoline;
 	char* ptrampoline;
@@ -743,6 +1331,8 @@ private:
 	CriticalSection unloadLibraryCriticalSection;
 
 	CriticalSection trampolineCriticalSection;
+	//йʱ̷߳¼ͬ
+	CriticalSection queryCriticalSection;
 public:
 	inline bool LoadScriptc(const char*& p,UINT& leftsize)
 	{
@@ -837,6 +1427,7 @@ public:
 				return false;
 			strConstants.push_back(Buffer::ReadString(porigin+stroff+offset));
 		}
+		InternConstants();
 		//
 		Buffer::Read(p,len,leftsize);
 		for(int i=0;i<len;i++)
@@ -866,58 +1457,7 @@ public:
 			int ix=0;//16λ=123ַ16λΪӦ
 			if(!Buffer::Read(p,ix,leftsize))
 				return false;
-			int type=(ix & 0xFFFF0000)>>16;
-			int index=ix & 0x0000FFFF;
-			if(type==1)
-			{
-				if(index>=0 && index<intConstants.size())
-					globalVariables.push_back(CComVariant(intConstants[index]));
-				else
-					globalVariables.push_back(CComVariant(0));
-			}
-			else if(type==2)
-			{
-				if(index>=0 && index<doubleConstants.size())
-					globalVariables.push_back(CComVariant(doubleConstants[index]));
-				else
-					globalVariables.push_back(CComVariant(0));
-			}
-			else if(type==3)
-			{
-				if(index>=0 && index<strConstants.size())
-				{
-					if(istrConstants.size()<=0)
-					{
-						for(UINT ci=0;ci<strConstants.size();ci++)
-							istrConstants.push_back(CComVariant(0));
-					}
-					CComVariant& str=istrConstants[index];
-					if(str.vt!=VT_DISPATCH || !str.lVal)
-					{
-#ifdef ENCODE_STRING
-						CString& d=strConstants[index];
-						int len=d.GetLength();
-						char* buf=constStringBuffer;
-						ScriptFile::MemCpy(buf,d,len+1);
-						ScriptFile::UnRotateKey((UCHAR*)buf);
-						
-						str=BuildIString(buf);
-						globalVariables.push_back(str);
-#else
-						str=BuildIString((LPCSTR)strConstants[index]);
-						globalVariables.push_back(str);
-#endif						
-					}
-					else
-					{
-						globalVariables.push_back(str);
-					}
-				}
-				else
-					globalVariables.push_back(CComVariant(0));
-			}
-			else
-				globalVariables.push_back(CComVariant(0));
+			globalVariables.push_back(GlobalInitValue(ix));
 		}		
 		//жȷ
 		if(p-porigin!=stroff)
@@ -947,35 +1487,116 @@ public:
 		}
 		if(leftsize<0)
 			return false;
+		DecodeAll();
 		return true;
 	}
-#ifdef INCLUDE_COMPILE
-	inline void SaveScriptc(char*& p)
+	//ȫֱֵ16λ=123ַ16λΪӦ
+	inline CComVariant GlobalInitValue(int ix)
 	{
-		//ΪȫֱĳֵڳнڣΪȫֱֵı䣬˳־ûӦýڱɺ֮ǰá
-		for(int gi=0;gi<globalVariables.size();gi++)
+		int type=(ix & 0xFFFF0000)>>16;
+		int index=ix & 0x0000FFFF;
+		if(type==1)
 		{
-			const CComVariant& val=globalVariables[gi];
-			if(val.vt==VT_DISPATCH)
-			{
-				if(IsIString(val))
-					DecideConst(ReadIString(val));
-				else
-					DecideConst(0);
-			}
-			else if(val.vt==VT_BSTR)
-			{
-				DecideConst(CString(val.bstrVal));
-			}
-			else if(val.vt==VT_R8)
-			{
-				DecideConst(val.dblVal);
-			}
-			else
+			if(index>=0 && index<intConstants.size())
+				return CComVariant(intConstants[index]);
+		}
+		else if(type==2)
+		{
+			if(index>=0 && index<doubleConstants.size())
+				return CComVariant(doubleConstants[index]);
+		}
+		else if(type==3)
+		{
+			if(index>=0 && index<strConstants.size())
+				return StrConstant(index);
+		}
+		return CComVariant(0);
+	}
+	//װ.scbӳĶָ鸴ƣⲿ֧OQL¼ȡ
+	inline bool LoadSections(const char* p,const ScriptImageHeader& header)
+	{
+		ClearAll();
+
+		ScriptImageReader r;
+		if(!r.Open(p,header))
+			return false;
+		//ⲿϢ
+		ScriptImageCursor c=r.Cursor(SCB_SEC_OUTERFUNC);
+		UINT len=r.Count(SCB_SEC_OUTERFUNC);
+		for(UINT i=0;i<len;i++)
+		{
+			OuterFuncInfo info;
+			UINT lib,origin;
+			if(!c.Read(lib) || !c.Read(origin) || !c.Read(info.retsize) || !c.Read(info.argnum))
+				return false;
+			if(info.argnum<0 || info.argnum>OUTERFUNC_MAXARGNUM)
+				return false;
+			for(int j=0;j<info.argnum;j++)
 			{
-				DecideConst(val.lVal);
+				if(!c.Read(info.argsize[j]))
+					return false;
 			}
+			if(!c.Read(info.address))
+				return false;
+			const char* s1=r.String(lib);
+			const char* s2=r.String(origin);
+			if(!s1 || !s2)
+				return false;
+			info.lib=s1;
+			info.origin=s2;
+			outerFuncInfos.push_back(info);
+		}
+		//֧뺯
+		if(!ScriptImageTables::Load(r,switchInfos,intConstants,doubleConstants,strConstants,functions,funcVarNum))
+			return false;
+		InternConstants();
+		//ȫֱ
+		const int* globals;
+		if(!r.Array(SCB_SEC_GLOBAL,globals,len))
+			return false;
+		for(UINT i=0;i<len;i++)
+			globalVariables.push_back(GlobalInitValue(globals[i]));
+		//OQL
+		c=r.Cursor(SCB_SEC_OQL);
+		len=r.Count(SCB_SEC_OQL);
+		for(UINT i=0;i<len;i++)
+		{
+			int index;
+			if(!c.Read(index) || index<0 || index>=MAXQUERY)
+				return false;
+			if(!oqls[index])
+				oqls[index]=new OqlRuntime();
+			if(!oqls[index]->LoadOqlImage(c,r))
+				return false;
+		}
+		DecodeAll();
+		return true;
+	}
+#ifdef INCLUDE_COMPILE
+	//ȫֱֵڳеڣGlobalInitValue
+	inline int GlobalInitIndex(const CComVariant& val)
+	{
+		if(val.vt==VT_DISPATCH)
+		{
+			if(IsIString(val))
+				return 0x00030000+DecideConst(ReadIString(val));
+			return 0x00010000+DecideConst(0);
+		}
+		else if(val.vt==VT_BSTR)
+		{
+			return 0x00030000+DecideConst(CString(val.bstrVal));
+		}
+		else if(val.vt==VT_R8)
+		{
+			return 0x00020000+DecideConst(val.dblVal);
 		}
+		return 0x00010000+DecideConst(val.lVal);
+	}
+	inline void SaveScriptc(char*& p)
+	{
+		//ΪȫֱĳֵڳнڣΪȫֱֵı䣬˳־ûӦýڱɺ֮ǰá
+		for(int gi=0;gi<globalVariables.size();gi++)
+			GlobalInitIndex(globalVariables[gi]);
 		//ʼ־û
 		char* porigin=p;
 		char tag[4]={'S','C','0','5'};
@@ -1074,37 +1695,7 @@ public:
 		Buffer::Write(len,data,dsize);
 		for(int i=0;i<len;i++)
 		{
-			const CComVariant& val=globalVariables[i];
-			int ix=0;//16λ=123ַ16λΪӦ
-			if(val.vt==VT_DISPATCH)
-			{
-				if(IsIString(val))
-				{
-					ix=0x00030000;
-					ix+=DecideConst(ReadIString(val));
-				}
-				else
-				{
-					ix=0x00010000;
-					ix+=DecideConst(0);
-				}
-			}
-			else if(val.vt==VT_BSTR)
-			{
-				ix=0x00030000;
-				ix+=DecideConst(CString(val.bstrVal));
-			}
-			else if(val.vt==VT_R8)
-			{
-				ix=0x00020000;
-				ix+=DecideConst(val.dblVal);
-			}
-			else
-			{
-				ix=0x00010000;
-				ix+=DecideConst(val.lVal);
-			}
-			Buffer::Write(ix,data,dsize);
+			Buffer::Write(GlobalInitIndex(globalVariables[i]),data,dsize);
 		}
 		//дʵַƫ
 		Buffer::ReWrite(dsize+ssize,pdata+8);
@@ -1130,6 +1721,56 @@ public:
 		size=p-porigin;
 		Buffer::ReWrite(size,porigin+4);
 	}
+	//.scbӳʽ־ûSaveScriptcһӦڱɺ֮ǰãpackΪSCB_PACK_*
+	inline void SaveImage(std::vector<char>& image,int pack=SCB_PACK_NONE)
+	{
+		CriticalSectionOperator CSO(&saveMemCriticalSection);
+
+		std::vector<int> globals;
+		for(UINT i=0;i<globalVariables.size();i++)
+			globals.push_back(GlobalInitIndex(globalVariables[i]));
+		ScriptImageWriter w;
+		//ⲿϢ
+		w.BeginSection(SCB_SEC_OUTERFUNC);
+		for(UINT i=0;i<outerFuncInfos.size();i++)
+		{
+			OuterFuncInfo& info=outerFuncInfos[i];
+			w.Put(w.AddString(info.lib));
+			w.Put(w.AddString(info.origin));
+			w.Put(info.retsize);
+			w.Put(info.argnum);
+			w.PutBlock(info.argsize,info.argnum*sizeof(int));
+			w.Put(info.address);
+		}
+		w.EndSection(outerFuncInfos.size());
+		//֧뺯
+		ScriptImageTables::Save(w,switchInfos,intConstants,doubleConstants,strConstants,functions,funcVarNum);
+		//ȫֱ
+		w.BeginSection(SCB_SEC_GLOBAL);
+		w.PutBlock(globals.empty()?NULL:&globals[0],globals.size()*sizeof(int));
+		w.EndSection(globals.size());
+		//OQL
+		UINT num=0;
+		w.BeginSection(SCB_SEC_OQL);
+		for(int i=0;i<MAXQUERY;i++)
+		{
+			if(!oqls[i] || oqls[i]->selectList.size()==0)
+				continue;
+			w.Put(i);
+			oqls[i]->SaveOqlImage(w);
+			num++;
+		}
+		w.EndSection(num);
+		w.Finish(image,pack);
+	}
+	inline bool SaveImageFile(const char* path,int pack=SCB_PACK_NONE)
+	{
+		std::vector<char> image;
+		SaveImage(image,pack);
+		if(ScriptFile::WriteLocal(path,&image[0],image.size())<0)
+			return false;
+		return true;
+	}
 #endif
 private:
 #ifdef INCLUDE_COMPILE
@@ -1290,6 +1931,65 @@ private:
 		else
 			return (__int64)r.dblVal;
 	}
+	//һεãʱڹʱĿ꣬ʱ뿪
+	struct ProfileScope
+	{
+		ScriptProfiler* p;
+		ProfileScope(ScriptcRuntime* pThis,int key)
+		{
+			p=pThis->profiler;
+			if(p)
+				pThis->ProfileEnter(key);
+		}
+		~ProfileScope()
+		{
+			if(p)
+				p->Leave();
+		}
+	};
+	inline void ProfileEnter(int key)
+	{
+		if(!profiler->HasName(key))
+			profiler->SetName(key,ProfileName(key));
+		profiler->Enter(key);
+	}
+	//Ŀ֣űȡУⲿȡ뺯
+	inline CString ProfileName(int key)
+	{
+		int type=key&0xff000000;
+		int index=key&0x00ffffff;
+		CString name;
+		if(type==PROFILE_FUNCTION)
+		{
+#ifdef INCLUDE_COMPILE
+			if(index<(int)funcNames.size())
+				return funcNames[index];
+#endif
+			name.Format("function#%d",index);
+		}
+		else if(type==PROFILE_QUERY)
+		{
+			name.Format("oql#%d",index);
+		}
+		else if(index<(int)outerFuncInfos.size())
+		{
+			OuterFuncInfo& info=outerFuncInfos[index];
+#ifdef ENCODE_STRING
+			char lib[MAX_IDENTIFIER_SIZE];
+			char origin[MAX_IDENTIFIER_SIZE];
+			ScriptFile::MemCpy(lib,info.lib,info.lib.GetLength()+1);
+			ScriptFile::MemCpy(origin,info.origin,info.origin.GetLength()+1);
+			ScriptFile::UnRotateKey((UCHAR*)lib);
+			ScriptFile::UnRotateKey((UCHAR*)origin);
+			name.Format("%s!%s",lib,origin);
+#else
+			name.Format("%s!%s",(LPCSTR)info.lib,(LPCSTR)info.origin);
+#endif
+		}
+		else
+			name.Format("api#%d",index);
+		return name;
+	}
 	inline CComVariant CallFunction(const CComVariant& vname,CComVariant* args,int num)
 	{
 		if(vname.vt==VT_EMPTY || vname.lVal==0)
@@ -1456,18 +2156,12 @@ private:
 					if(!IsIString(args[0]))
 						return CComVariant(0);
 					CString& key=ReadIString(args[0]);
-					Scriptc::ClassObjects::iterator it=classObjects.find(key);
-					if(it==classObjects.end())
-					{
-						Scriptc::VarVector varVector;
-						classObjects[key]=varVector;
-						it=classObjects.find(key);
-					}
-					Scriptc::VarVector& vv=it->second;
+					SharedLock lock(program,program->oqlCriticalSection);
+					Scriptc::ClassTable& table=classObjects[key];
 
 					Scriptc::VectorObj<ScriptcRuntime,false>* pObj=Scriptc::VectorObj<ScriptcRuntime,false>::CreateDispatchEx();
 					pObj->SetVM(this);
-					pObj->Init(&vv);
+					pObj->Init(&table);
 					for(int i=1;i<num;i++)
 					{
 						pObj->push(args[i]);
@@ -1505,6 +2199,31 @@ private:
 						pObj->Release();
 						return ret;	
 					}
+					else if(progid==L"ScriptC.HashSet")
+					{
+						Scriptc::HashSetObj<ScriptcRuntime>* pObj=Scriptc::HashSetObj<ScriptcRuntime>::CreateDispatchEx();
+						pObj->SetVM(this);
+						for(int i=1;i<num;i++)
+						{
+							pObj->push(args[i]);
+						}
+						CComVariant ret(pObj);
+						pObj->Release();
+						return ret;
+					}
+					else if(progid==L"ScriptC.HashMap")
+					{
+						//Ϊֵ
+						Scriptc::HashMapObj<ScriptcRuntime>* pObj=Scriptc::HashMapObj<ScriptcRuntime>::CreateDispatchEx();
+						pObj->SetVM(this);
+						for(int i=1;i+1<num;i+=2)
+						{
+							pObj->insert(args[i],args[i+1]);
+						}
+						CComVariant ret(pObj);
+						pObj->Release();
+						return ret;
+					}
 					else if(num!=1)
 						return CComVariant(0);
 					else
@@ -1584,60 +2303,9 @@ private:
 					return ret;
 				}
 			case FUNC_LIKE:
-				{
-					if(num<=0)
-						return CComVariant(0);
-					if(!IsIString(args[0]))
-						return CComVariant(FALSE);
-					CString& temp=ReadIString(args[0]);
-					bool like=true;
-					for(int i=1;i<num;i++)
-					{
-						if(!IsIString(args[i]) || temp.Find(ReadIString(args[i]))<0)
-						{
-							like=false;
-							break;
-						}
-					}
-					if(like)
-						return CComVariant(TRUE);
-					else
-						return CComVariant(FALSE);
-				}
+				return CComVariant(Like(args,num,true));
 			case FUNC_IN:
-				{
-					if(num<=0)
-						return CComVariant(0);
-					bool in=false;
-					bool isStr=false;
-					if(IsIString(args[0]))
-						isStr=true;
-					for(int i=1;i<num;i++)
-					{
-						if(isStr)
-						{
-							if(IsIString(args[i]))
-							{
-								CString& t1=ReadIString(args[0]);
-								CString& t2=ReadIString(args[i]);
-								if(t1==t2)
-								{
-									in=true;
-									break;
-								}
-							}
-						}
-						else if(args[0]==args[i])
-						{
-							in=true;
-							break;
-						}
-					}
-					if(in)
-						return CComVariant(TRUE);
-					else
-						return CComVariant(FALSE);
-				}
+				return CComVariant(In(args,num,true));
 			case FUNC_INVARIANT:
 				{
 					if(num!=2)
@@ -1669,6 +2337,16 @@ private:
 					int r=(int)::sqrt((double)((x1-x2)*(x1-x2)+(y1-y2)*(y1-y2)));
 					return CComVariant(r);
 				}
+			case FUNC_OQLINDEX:
+				{
+					//oqlindex(,[,ʽ])ʽΪ0ȱʡɢΪ1С0ɾ
+					if(num<2 || !IsIString(args[0]) || !IsIString(args[1]))
+						return CComVariant(0);
+					int kind=0;
+					if(num>2)
+						kind=args[2].lVal;
+					return CComVariant(DeclareIndex(ReadIString(args[0]),args[1],kind)?1:0);
+				}
 			}
 		}
 		else if(fname<0)//ⲿ,ⲿAPIֻصűصűֵⲿAPIĻ
@@ -1676,6 +2354,7 @@ private:
 						//ʱҲᵹصջ
 		{
 			fname=-1-fname;
+			ProfileScope scope(this,PROFILE_API+fname);
 			OuterFuncInfo& info=outerFuncInfos[fname];
 			int addr=info.address;
 			if(!addr)
@@ -1683,6 +2362,8 @@ private:
 			int _EAX,_EDX,oldsp;
 			int sn=APISTACKSIZE/sizeof(int);
 			int* pstack=(int*)apiStack.Top();
+			if(!pstack)
+				return CComVariant(0);
 			apiStack.PushFrame();
 			pstack-=2;
 			int* stacktop=pstack;
@@ -1758,72 +2439,340 @@ private:
 #endif
 		return CComVariant(0);
 	}
-	inline CComVariant CallObject(const CComVariant& obj,const CComVariant& fname,CComVariant* args,int num)
+	//ڽֱַӷڣSΪʵʵCDispatchExForScriptT<C,piid,1>
+	template<typename S>
+		struct BuiltinThunk
 	{
-		HRESULT hr=S_OK;
-		if(obj.vt==VT_DISPATCH)
+		static bool Plain(IDispatch* p)
 		{
-			CComDispatchDriver disp(obj.pdispVal);
-			IObject* pobj=GetIObject(obj);
-			CComVariant ret;
-			CComVariant* vargs=new CComVariant[num];
-			for(int i=0;i<num;i++)
-			{
-				if(!pobj && IsIString(args[num-i-1]))
-					vargs[i]=ReadIStringVariant(args[num-i-1]);
-				else
-					vargs[i]=args[num-i-1];
-			}
-			if(IsIString(fname))
+			return !static_cast<S*>(p)->HasDynamicMembers();
+		}
+		static int Length(IDispatch* p)
+		{
+			return static_cast<S*>(p)->get_length();
+		}
+		static VARIANT Get(IDispatch* p,int pos)
+		{
+			return static_cast<S*>(p)->get(pos);
+		}
+		static void Set(IDispatch* p,int pos,const VARIANT& v)
+		{
+			static_cast<S*>(p)->set(pos,v);
+		}
+	};
+	//һȡ麯lengthԵDISPID
+	template<typename C,const IID* piid>
+		static inline void RegisterBuiltin(BuiltinTypes& types)
+	{
+		typedef CDispatchExForScriptT<C,piid,1> S;
+		C* p=C::CreateDispatchEx();
+		if(!p)
+			return;
+		IDispatch* disp=p;
+		BuiltinType type;
+		type.vtbl=*(void**)disp;
+		type.lengthId=DISPID_UNKNOWN;
+		OLECHAR* name=L"length";
+		disp->GetIDsOfNames(IID_NULL,&name,1,LOCALE_SYSTEM_DEFAULT,&type.lengthId);
+		type.Plain=BuiltinThunk<S>::Plain;
+		type.Length=BuiltinThunk<S>::Length;
+		type.Get=BuiltinThunk<S>::Get;
+		type.Set=BuiltinThunk<S>::Set;
+		types.push_back(type);
+		disp->Release();
+	}
+	static inline BuiltinTypes& BuiltinTypesRef(void)
+	{
+		static BuiltinTypes types;
+		return types;
+	}
+	static inline void InitBuiltinTypes(void)
+	{
+		BuiltinTypes& types=BuiltinTypesRef();
+		if(types.size()>0)
+			return;
+		RegisterBuiltin<Scriptc::VectorObj<ScriptcRuntime>,&IID_NULL>(types);
+		RegisterBuiltin<Scriptc::VectorObj<ScriptcRuntime,false>,&IID_NULL>(types);
+		RegisterBuiltin<Scriptc::DequeObj<ScriptcRuntime>,&IID_NULL>(types);
+		RegisterBuiltin<Scriptc::ListObj<ScriptcRuntime>,&IID_NULL>(types);
+		RegisterBuiltin<Scriptc::StringObj<ScriptcRuntime>,&IID_IString>(types);
+	}
+	static inline const BuiltinType* FindBuiltin(void* vtbl)
+	{
+		BuiltinTypes& types=BuiltinTypesRef();
+		for(UINT i=0;i<types.size();i++)
+		{
+			if(types[i].vtbl==vtbl)
+				return &types[i];
+		}
+		return NULL;
+	}
+	//һֻڽͣԱַ±ԪΧڣ
+	//ַʱж̬Ա򷵻NULLɵͨ·
+	inline InlineCacheEntry* CacheLookup(InlineCache& ic,IDispatch* obj,const CComVariant& member)
+	{
+		if(!obj)
+			return NULL;
+		IDispatch* key=NULL;
+		if(member.vt==VT_DISPATCH)
+			key=member.pdispVal;
+		else if(member.vt!=VT_I4 || member.lVal<0 || member.lVal>=MEMBERID_FIRST)
+			return NULL;
+		void* vtbl=*(void**)obj;
+		InlineCacheEntry* pe=ic.Find(vtbl,key);
+		if(pe)
+		{
+			if(!pe->type)
+				return NULL;
+			if(key && !IStringPtr(member)->IsConstant())
+				return NULL;
+		}
+		else
+		{
+			const BuiltinType* type=FindBuiltin(vtbl);
+			DISPID did=DISPID_UNKNOWN;
+			if(type && key)
 			{
-				DISPID did=DynamicDispatch::GetDispID(obj.pdispVal,fname.pdispVal);
-				hr=disp.InvokeN(did,vargs,num,&ret);
-				//CComBSTR& bstr=ReadIStringUnicode(fname);
-				//hr=disp.InvokeN(bstr,vargs,num,&ret);
+				if(!IsIString(member) || !IStringPtr(member)->IsConstant())
+					return NULL;
+				if(!type->Plain(obj))
+					return NULL;
+				BSTR name=ReadIStringUnicode(member);
+				if(FAILED(obj->GetIDsOfNames(IID_NULL,&name,1,LOCALE_SYSTEM_DEFAULT,&did)))
+					return NULL;
 			}
-			else
-				hr=disp.InvokeN((DISPID)fname.lVal,vargs,num,&ret);
-			delete[] vargs;
-			if(SUCCEEDED(hr))
+			pe=ic.Add(vtbl,key,type,did);
+			if(!type)
+				return NULL;
+		}
+		if(key && !pe->type->Plain(obj))
+			return NULL;
+		return pe;
+	}
+	//LIKEINڶĲַʱػĳϣ״ʱ򷵻NULL
+	//еĵַפĳһʱ鳣Ƿѱ޸ġ
+	//like(s,sub...)sȫӴʱΪ档useCacheΪfalseʱҲӴϻ棬ѯĹ̵߳
+	inline BOOL Like(CComVariant* args,int num,bool useCache)
+	{
+		if(num<=0)
+			return FALSE;
+		if(!IsIString(args[0]))
+			return FALSE;
+		CString& temp=ReadIString(args[0]);
+		//ӴǳʱûԶtempֻɨһ
+		if(useCache && num-1>=NEEDLESET_MINLIKE)
+		{
+			NeedleSet* ns=FindNeedleSet(args,num);
+			if(ns && ns->matchable)
 			{
-				if(ret.vt==VT_BSTR)
-					return VariantToScript(ret);
+				if(ns->matcher.ContainsAll(temp,temp.GetLength()))
+					return TRUE;
 				else
-					return ret;
+					return FALSE;
 			}
 		}
-		if(SUCCEEDED(hr))
+		bool like=true;
+		for(int i=1;i<num;i++)
 		{
-			CallObjectEvent* pEvent=OnCallObject.get();
-			if(pEvent)
+			//ͬһַפͬһز
+			if(args[i].vt==VT_DISPATCH && args[i].pdispVal==args[0].pdispVal)
+				continue;
+			if(!IsIString(args[i]) || StringSearch::Find(temp,ReadIString(args[i]))<0)
 			{
-				CComVariant ret;
-				if(!(*pEvent)(obj,fname,args,num,&ret))
-					hr=DISP_E_MEMBERNOTFOUND;
-				else
-					return ret;
+				like=false;
+				break;
 			}
 		}
-#ifdef INCLUDE_COMPILE
-		CComVariant tempvar;
-		if(IsIString(fname))
-			tempvar=ReadIStringVariant(fname);
+		if(like)
+			return TRUE;
 		else
-			tempvar.ChangeType(VT_BSTR);
-		CString temp;
-		temp.Format("call unknown method : %s!",CString(tempvar.bstrVal));
-		RuntimeError(temp);
-#endif
-		return CComVariant(0);
+			return FALSE;
 	}
-	inline CComVariant GetAttr(const CComVariant& obj,const CComVariant& attr)
+	//in(v,c...)vĳѡֵʱΪ棬useCacheĺͬLike
+	inline BOOL In(CComVariant* args,int num,bool useCache)
 	{
-		HRESULT hr=S_OK;
-		if(obj.vt==VT_DISPATCH)
+		if(num<=0)
+			return FALSE;
+		bool in=false;
+		bool isStr=false;
+		if(IsIString(args[0]))
+			isStr=true;
+		//ѡַʱһɢֵڻв
+		if(useCache && isStr && num-1>=NEEDLESET_MININ)
+		{
+			NeedleSet* ns=FindNeedleSet(args,num);
+			if(ns)
+			{
+				StringBase* ps=IStringPtr(args[0]);
+				DWORD h=ps->Hash();
+				std::vector<std::pair<DWORD,int> >::iterator it=std::lower_bound(ns->hashes.begin(),ns->hashes.end(),std::make_pair(h,0));
+				for(;it!=ns->hashes.end() && it->first==h;it++)
+				{
+					if(ps->Ref()==ns->needles[it->second])
+						return TRUE;
+				}
+				return FALSE;
+			}
+		}
+		for(int i=1;i<num;i++)
+		{
+			if(isStr)
+			{
+				if(IsIString(args[i]) && StringBase::Equals(IStringPtr(args[0]),IStringPtr(args[i])))
+				{
+					in=true;
+					break;
+				}
+			}
+			else if(args[0]==args[i])
+			{
+				in=true;
+				break;
+			}
+		}
+		if(in)
+			return TRUE;
+		else
+			return FALSE;
+	}
+	//ѯĹ߳еڲParallelSafeֻûиõlikeinʹʱӴϻ
+	inline CComVariant CallPure(int fname,CComVariant* args,int num)
+	{
+		switch(fname)
+		{
+		case FUNC_LIKE:
+			return CComVariant(Like(args,num,false));
+		case FUNC_IN:
+			return CComVariant(In(args,num,false));
+		}
+		return CComVariant(0);
+	}
+	inline NeedleSet* FindNeedleSet(CComVariant* args,int num)
+	{
+		std::vector<IDispatch*> key(num-1);
+		for(int i=1;i<num;i++)
+		{
+			if(args[i].vt!=VT_DISPATCH || !args[i].pdispVal)
+				return NULL;
+			key[i-1]=args[i].pdispVal;
+		}
+		NeedleSets::iterator it=needleSets.find(key);
+		if(it!=needleSets.end())
+		{
+			for(int i=1;i<num;i++)
+			{
+				if(!IStringPtr(args[i])->IsConstant())
+					return NULL;
+			}
+			return &it->second;
+		}
+		for(int i=1;i<num;i++)
 		{
+			if(!IsIString(args[i]) || !IStringPtr(args[i])->IsConstant())
+				return NULL;
+		}
+		if(needleSets.size()>=NEEDLESET_MAXCACHE)
+			needleSets.clear();
+		NeedleSet& ns=needleSets[key];
+		for(int i=1;i<num;i++)
+		{
+			ns.needles.push_back(ReadIString(args[i]));
+			ns.hashes.push_back(std::make_pair(IStringPtr(args[i])->Hash(),i-1));
+		}
+		std::sort(ns.hashes.begin(),ns.hashes.end());
+		ns.matchable=ns.matcher.Build(ns.needles);
+		return &ns;
+	}
+	inline CComVariant CallObject(const CComVariant& obj,const CComVariant& fname,CComVariant* args,int num,InlineCache* pic=NULL)
+	{
+		HRESULT hr=S_OK;
+		if(obj.vt==VT_DISPATCH)
+		{
+			InlineCacheEntry* pe=NULL;
+			if(pic && fname.vt==VT_DISPATCH)
+				pe=CacheLookup(*pic,obj.pdispVal,fname);
 			CComDispatchDriver disp(obj.pdispVal);
+			IObject* pobj=pe?NULL:GetIObject(obj);
 			CComVariant ret;
-			if(IsIString(attr))
+			CComVariant* vargs=AllocArgs(num);
+			for(int i=0;i<num;i++)
+			{
+				if(!pe && !pobj && IsIString(args[num-i-1]))
+					vargs[i]=ReadIStringVariant(args[num-i-1]);
+				else
+					vargs[i]=args[num-i-1];
+			}
+			if(pe)
+				hr=disp.InvokeN(pe->dispid,vargs,num,&ret);
+			else if(IsIString(fname))
+			{
+				DISPID did=DynamicDispatch::GetDispID(obj.pdispVal,fname.pdispVal);
+				hr=disp.InvokeN(did,vargs,num,&ret);
+				//CComBSTR& bstr=ReadIStringUnicode(fname);
+				//hr=disp.InvokeN(bstr,vargs,num,&ret);
+			}
+			else
+				hr=disp.InvokeN((DISPID)fname.lVal,vargs,num,&ret);
+			FreeArgs(vargs);
+			if(SUCCEEDED(hr))
+			{
+				if(ret.vt==VT_BSTR)
+					return VariantToScript(ret);
+				else
+					return ret;
+			}
+		}
+		if(SUCCEEDED(hr))
+		{
+			CallObjectEvent* pEvent=OnCallObject.get();
+			if(pEvent)
+			{
+				CComVariant ret;
+				if(!(*pEvent)(obj,fname,args,num,&ret))
+					hr=DISP_E_MEMBERNOTFOUND;
+				else
+					return ret;
+			}
+		}
+#ifdef INCLUDE_COMPILE
+		CComVariant tempvar;
+		if(IsIString(fname))
+			tempvar=ReadIStringVariant(fname);
+		else
+			tempvar.ChangeType(VT_BSTR);
+		CString temp;
+		temp.Format("call unknown method : %s!",CString(tempvar.bstrVal));
+		RuntimeError(temp);
+#endif
+		return CComVariant(0);
+	}
+	inline CComVariant GetAttr(const CComVariant& obj,const CComVariant& attr,InlineCache* pic=NULL)
+	{
+		HRESULT hr=S_OK;
+		if(obj.vt==VT_DISPATCH)
+		{
+			InlineCacheEntry* pe=NULL;
+			if(pic)
+				pe=CacheLookup(*pic,obj.pdispVal,attr);
+			if(pe && attr.vt==VT_I4)
+			{
+				//Ԫֱַʵȡ
+				VARIANT v=pe->type->Get(obj.pdispVal,attr.lVal);
+				CComVariant ret;
+				ret.Attach(&v);
+				if(ret.vt==VT_BSTR)
+					return VariantToScript(ret);
+				return ret;
+			}
+			if(pe && pe->dispid==pe->type->lengthId)
+				return CComVariant(pe->type->Length(obj.pdispVal));
+			CComDispatchDriver disp(obj.pdispVal);
+			CComVariant ret;
+			if(pe)
+			{
+				hr=disp.GetProperty(pe->dispid,&ret);
+			}
+			else if(IsIString(attr))
 			{
 				DISPID did=DynamicDispatch::GetDispID(obj.pdispVal,attr.pdispVal);
 				hr=disp.GetProperty(did,&ret);
@@ -1857,11 +2806,27 @@ private:
 		}
 		return CComVariant(0);
 	}
-	inline void SetAttr(const CComVariant& obj,const CComVariant& attr,CComVariant& val)
+	inline void SetAttr(const CComVariant& obj,const CComVariant& attr,CComVariant& val,InlineCache* pic=NULL)
 	{
 		HRESULT hr=S_OK;
+		if(!indexedAttrs.empty() && IsIString(attr))
+		{
+			SharedLock lock(program,program->oqlCriticalSection);
+			if(indexedAttrs.find(ReadIString(attr))!=indexedAttrs.end())
+				attrEpoch++;
+		}
 		if(obj.vt==VT_DISPATCH)
 		{
+			//ֻ水±дԪأдΪӳԱ
+			if(pic && attr.vt==VT_I4)
+			{
+				InlineCacheEntry* pe=CacheLookup(*pic,obj.pdispVal,attr);
+				if(pe)
+				{
+					pe->type->Set(obj.pdispVal,attr.lVal,val);
+					return;
+				}
+			}
 			CComDispatchDriver disp(obj.pdispVal);			
 			IObject* pobj=GetIObject(obj);
 			if(IsIString(attr))
@@ -1920,8 +2885,15 @@ private:
 		Scriptc::ClassObjects::iterator it=classObjects.find(className);
 		if(it!=classObjects.end())
 		{
-			Scriptc::VarVector::iterator vit=it->second.begin();
-			for(;vit!=it->second.end();vit++)
+			Scriptc::VarVector& candidates=it->second.objects;
+			if(FilterConstant(candidates,objList,arg))
+				return;
+			if(FilterIndexed(it->second,objList,arg))
+				return;
+			if(FilterParallel(candidates,objList,arg))
+				return;
+			Scriptc::VarVector::iterator vit=candidates.begin();
+			for(;vit!=candidates.end();vit++)
 			{			
 				arg.SetObject(*vit);
 				CComVariant r=arg.CalcExpression();
@@ -1939,6 +2911,250 @@ private:
 			(*pEvent)(className,objList,arg);
 		}
 	}
+	//WHEREӾһβѯΪʱֵֻһΣȫѡһ
+	inline bool FilterConstant(const Scriptc::VarVector& candidates,Objects& objList,FilterObjectsCallbackArg& arg)
+	{
+		int exp=arg.pOql->fromExpList[arg.fromIndex];
+		if(exp<0 || !arg.pOql->plan.constExp[exp] || candidates.size()==0 || OnDebug.get())
+			return false;
+		//봮йһ£˺FROMһѡ
+		arg.SetObject(candidates.back());
+		CComVariant r=arg.CalcExpression();
+		if(r.vt==VT_EMPTY || !r.lVal)
+			return true;
+		objList.insert(objList.end(),candidates.begin(),candidates.end());
+		return true;
+	}
+	//FROMԴƻȡѡֻԺѡWHEREӾ䣬Ĵͬ
+	//ûƻûжӦWHEREӾиûȽֵشʱfalse
+	inline bool FilterIndexed(Scriptc::ClassTable& table,Objects& objList,FilterObjectsCallbackArg& arg)
+	{
+		OqlRuntime* oql=arg.pOql;
+		int from=arg.fromIndex;
+		if(table.indexes.empty() || from>=(int)oql->indexPlans.size() || OnDebug.get())
+			return false;
+		IndexPlan& ip=oql->indexPlans[from];
+		if(ip.op<0 || !oql->plan.pureFrom[from])
+			return false;
+		Scriptc::ClassIndex* index=table.FindIndex(ip.attr);
+		if(!index)
+			return false;
+		UpdateIndex(table,*index);
+		CComVariant key=CalcSubExpression(ip.key,ip.decodedKey,arg);
+		std::vector<int> cands;
+		bool done;
+		switch(ip.op)
+		{
+		case OP_EQ:
+			done=index->LookupEqual(key,cands);
+			break;
+		case OP_LT:
+		case OP_LE:
+			done=index->LookupRange(key,true,ip.op==OP_LE,cands);
+			break;
+		default:
+			done=index->LookupRange(key,false,ip.op==OP_GE,cands);
+			break;
+		}
+		if(!done)
+			return false;
+		Scriptc::VarVector& objects=table.objects;
+		for(UINT i=0;i<cands.size();i++)
+		{
+			arg.SetObject(objects[cands[i]]);
+			CComVariant r=arg.CalcExpression();
+			if(r.vt==VT_EMPTY || !r.lVal)
+				continue;
+			objList.push_back(objects[cands[i]]);
+		}
+		//봮йһ£˺FROMһ
+		if(objects.size()>0)
+			arg.SetObject(objects.back());
+		return true;
+	}
+	//ֻĩβ׷˶ʱ¶޸Ļűдʱؽ
+	inline void UpdateIndex(Scriptc::ClassTable& table,Scriptc::ClassIndex& index)
+	{
+		if(index.version!=table.version || index.epoch!=attrEpoch || index.Count()>table.objects.size())
+			index.Reset(table.version,attrEpoch);
+		for(UINT i=index.Count();i<table.objects.size();i++)
+			index.Add(GetAttr(table.objects[i],index.attr));
+	}
+	//Ͻɾڲѯʱ
+	inline bool DeclareIndex(const CString& className,const CComVariant& attr,int kind)
+	{
+		CString name=ReadIString(attr);
+		SharedLock lock(program,program->oqlCriticalSection);
+		Scriptc::ClassTable& table=classObjects[className];
+		for(UINT i=0;i<table.indexes.size();i++)
+		{
+			if(table.indexes[i].name!=name)
+				continue;
+			if(kind<0)
+			{
+				table.indexes.erase(table.indexes.begin()+i);
+				if(--indexedAttrs[name]<=0)
+					indexedAttrs.erase(name);
+				return true;
+			}
+			//ıʽʱؽ
+			if(table.indexes[i].ordered!=(kind>0))
+			{
+				table.indexes[i].ordered=(kind>0);
+				table.indexes[i].Reset(table.version,attrEpoch);
+			}
+			return true;
+		}
+		if(kind<0)
+			return false;
+		Scriptc::ClassIndex index;
+		index.name=name;
+		index.attr=BuildIString(name);
+		index.ordered=(kind>0);
+		index.Reset(table.version,attrEpoch);
+		table.indexes.push_back(index);
+		indexedAttrs[name]++;
+		return true;
+	}
+	struct FilterTask
+	{
+		ScriptcRuntime* pThis;
+		FilterObjectsCallbackArg* pArg;
+		DecodedCode* pCode;
+		const Scriptc::VarVector* pCandidates;
+		std::vector<Objects> results;		//Ĺ˽Ĵϲ
+		std::vector<Objects> slotObjects;	//̵߳FROM
+	};
+	//ڹ̳߳зֿһFROMԭϲ봮й˵Ľͬ
+	//δСٻWHEREӾ䲻ParallelSafeʱfalseɵߴйˡ
+	inline bool FilterParallel(const Scriptc::VarVector& candidates,Objects& objList,FilterObjectsCallbackArg& arg)
+	{
+		int num=candidates.size();
+		if(queryWorkers.Size()<=0 || num<2*QUERYCHUNKSIZE || !arg.pLocals || OnDebug.get())
+			return false;
+		int exp=arg.pOql->fromExpList[arg.fromIndex];
+		if(exp<0)
+			return false;
+		DecodedCode& code=arg.pOql->decodedExpressions[exp];
+		if(!ParallelSafe(code) || !queryWorkers.Stack(0).Reserve(code.maxStack))
+			return false;
+		int chunks=(num+QUERYCHUNKSIZE-1)/QUERYCHUNKSIZE;
+		FilterTask task;
+		task.pThis=this;
+		task.pArg=&arg;
+		task.pCode=&code;
+		task.pCandidates=&candidates;
+		task.results.resize(chunks);
+		task.slotObjects.resize(queryWorkers.Size()+1,*arg.pObjects);
+		queryWorkers.Run(FilterChunk,&task,chunks);
+		for(int i=0;i<chunks;i++)
+			objList.insert(objList.end(),task.results[i].begin(),task.results[i].end());
+		//봮йһ£˺FROMһѡ
+		arg.SetObject(candidates.back());
+		return true;
+	}
+	static void FilterChunk(void* context,int chunk,int slot)
+	{
+		FilterTask* pTask=(FilterTask*)context;
+		ScriptcRuntime* pThis=pTask->pThis;
+		FilterObjectsCallbackArg& arg=*pTask->pArg;
+		ValueStack& stack=pThis->queryWorkers.Stack(slot);
+		Objects& objects=pTask->slotObjects[slot];
+		Objects& result=pTask->results[chunk];
+		const Scriptc::VarVector& candidates=*pTask->pCandidates;
+		int begin=chunk*QUERYCHUNKSIZE;
+		int end=begin+QUERYCHUNKSIZE;
+		if(end>(int)candidates.size())
+			end=candidates.size();
+		for(int i=begin;i<end;i++)
+		{
+			objects[arg.fromIndex]=candidates[i];
+			TaggedValue r;
+			pThis->ExecDecoded(stack,*pTask->pCode,arg.pLocals,arg.pArgs,arg.argnum,&objects,r);
+			if(r.tag==TAG_EMPTY || !r.Low32())
+				continue;
+			result.push_back(candidates[i]);
+		}
+	}
+	//OP_CALLõĺԵôǰջȣҵѹ뺯ֵָ
+	//мתʱ޷ȷ0ֵʱҲ0
+	static inline int CalledFunction(const DecodedCode& code,int pc)
+	{
+		int need=code.ins[pc].operand+1;
+		int pops,pushes;
+		for(int i=pc-1;i>=0;i--)
+		{
+			const DecodedIns& d=code.ins[i];
+			switch(d.op)
+			{
+			case OP_JMP:
+			case OP_JZ:
+			case OP_JNZ:
+			case DOP_JZ_KEEP:
+			case DOP_JNZ_KEEP:
+			case OP_TABLE_JMP:
+			case OP_RETURN:
+				return 0;
+			}
+			StackEffect(d,pops,pushes);
+			need-=pushes;
+			if(need<=0)
+			{
+				if(need==0 && pushes==1 && d.op==DOP_PUSH_INT)
+					return d.index;
+				return 0;
+			}
+			need+=pops;
+		}
+		return 0;
+	}
+	//ڹִ߳еıʽԤ룬likeinⲻú÷޸ıԣǶײѯ
+	static inline bool ParallelSafe(const DecodedCode& code)
+	{
+		if(code.maxStack<0)
+			return false;
+		for(UINT i=0;i<code.ins.size();i++)
+		{
+			int op=code.ins[i].op;
+			switch(op)
+			{
+			case OP_CALL:
+				{
+					int f=CalledFunction(code,i);
+					if(f!=FUNC_LIKE && f!=FUNC_IN)
+						return false;
+				}
+				break;
+			case OP_OBJCALL:
+			case OP_OBJSETATTR:
+			case OP_INC:
+			case OP_DEC:
+			case OP_EXECQUERY:
+			case OP_ADDR:
+				return false;
+			}
+			if(op>=OP_ASSIGN && op<=OP_RS_ASSIGN)
+				return false;
+		}
+		return true;
+	}
+	//߳жȡԣ̬DISPIDӳԴ¼̰߳ȫģͬ·ʣֵĶȡн
+	inline CComVariant GetAttrShared(const CComVariant& obj,const CComVariant& attr)
+	{
+		if(obj.vt==VT_DISPATCH && IsIString(attr))
+		{
+			DISPID did=DynamicDispatch::GetDispID(obj.pdispVal,attr.pdispVal);
+			CComDispatchDriver disp(obj.pdispVal);
+			CComVariant ret;
+			if(FAILED(disp.GetProperty(did,&ret)))
+				return CComVariant(0);
+			if(ret.vt==VT_BSTR)
+				return VariantToScript(ret);
+			return ret;
+		}
+		CriticalSectionOperator CSO(&queryCriticalSection);
+		return GetAttr(obj,attr);
+	}
 	inline void RuntimeError(const char* msg)
 	{
 		RuntimeErrorEvent* pEvent=OnRuntimeError.get();
@@ -1972,37 +3188,20 @@ private:
 	{
 		ClearCompileInfo();
 
-		outerFuncInfos.clear();
-		switchInfos.clear();
-
-		intConstants.clear();
-		doubleConstants.clear();
-		strConstants.clear();
-		istrConstants.clear();
-
-		functions.clear();
-		funcVarNum.clear();
-
-		globalVariables.clear();
-
-		UnloadLibrary();
+		//ִֻԼִ״̬ʱ
+		if(!pOwner)
+			ClearProgram();
 		callbackFuncs.clear();
 		output="";
 		ptrampoline=trampoline;
 		while(!runtimeStack.empty())
 			runtimeStack.pop();
-		apiStack.Clear();
-
-		classObjects.clear();
+		decodedFunctions.clear();
+		jitMemory.Clear();
+		needleSets.clear();
+		valueStack.Clear();
+		argStack.Free(argStack.base);
 
-		for(int i=0;i<MAXQUERY;i++)
-		{
-			if(oqls[i])
-			{
-				delete oqls[i];
-				oqls[i]=NULL;
-			}
-		}
 		RuntimeErrorEvent* pREE=OnRuntimeError.get();
 		if(pREE)
 		{
@@ -2052,6 +3251,37 @@ private:
 			delete pPTME;
 		}
 	}
+	inline void ClearProgram(void)
+	{
+		outerFuncInfos.clear();
+		switchInfos.clear();
+
+		intConstants.clear();
+		doubleConstants.clear();
+		strConstants.clear();
+		istrConstants.clear();
+		internTable.clear();
+
+		functions.clear();
+		funcVarNum.clear();
+
+		globalVariables.clear();
+
+		UnloadLibrary();
+
+		classObjects.clear();
+		indexedAttrs.clear();
+
+		for(int i=0;i<MAXQUERY;i++)
+		{
+			if(oqls[i])
+			{
+				delete oqls[i];
+				oqls[i]=NULL;
+			}
+		}
+		program->shared=(program->contextNum>0);
+	}
 	void ClearCompileInfo(void);
 	inline void Initialize(void)
 	{
@@ -2061,6 +3291,9 @@ private:
 		curFuncIndex=-1;
 		oqlIndex=-1;
 		nsPrefix="";
+		//ִĲ룬ڲmainѵǼڹĳ
+		if(pOwner)
+			return;
 		InitSymbolConstants();
 
 		DecideInnerFunc("output",true);
@@ -2083,37 +3316,154 @@ private:
 		DecideInnerFunc("in",true);
 		DecideInnerFunc("invariant",true);	
 		DecideInnerFunc("distance",true);
+		DecideInnerFunc("oqlindex",true);
 
 		DecideFunction("main",0,true);
 #endif
-		for(int i=0;i<MAXQUERY;i++)
-		{
-			oqls[i]=NULL;
-		}
 	}
 public:
-	ScriptcRuntime()
+	//ownerΪNULLʱʱownerִģCreateContext
+	explicit ScriptcRuntime(ScriptcRuntime* owner=NULL)
+		:program(owner?owner->program:new Program)
+		,pOwner(owner)
+		,outerFuncInfos(program->outerFuncInfos)
+		,switchInfos(program->switchInfos)
+		,intConstants(program->intConstants)
+		,doubleConstants(program->doubleConstants)
+		,strConstants(program->strConstants)
+		,istrConstants(program->istrConstants)
+		,internTable(program->internTable)
+		,functions(program->functions)
+		,funcVarNum(program->funcVarNum)
+		,globalVariables(program->globalVariables)
+		,oqls(program->oqls)
+		,librarys(program->librarys)
+		,classObjects(program->classObjects)
+		,indexedAttrs(program->indexedAttrs)
+		,attrEpoch(program->attrEpoch)
 	{
 		trampoline=new char[TRAMPOLINE_SIZE];
 		constStringBuffer=new char[MAX_CONST_STRING_SIZE];
+		fastExec=true;
+		optimizeCode=true;
+		optimizeBefore=0;
+		optimizeAfter=0;
+		profiler=NULL;
+		jitThreshold=0;
+		InitBuiltinTypes();
 		Initialize();
+		if(owner)
+		{
+			::InterlockedIncrement(&program->contextNum);
+			program->shared=true;
+			fastExec=owner->fastExec;
+			jitThreshold=owner->jitThreshold;
+			//ָʱͬһݽĸԴӿտʼ
+			decodedFunctions.resize(owner->decodedFunctions.size());
+			for(UINT i=0;i<decodedFunctions.size();i++)
+			{
+				const DecodedCode& code=owner->decodedFunctions[i];
+				decodedFunctions[i].ins=code.ins;
+				decodedFunctions[i].maxStack=code.maxStack;
+				decodedFunctions[i].caches.resize(code.caches.size());
+			}
+		}
 	}
 	virtual ~ScriptcRuntime()
 	{
 		ClearAll();
+		delete profiler;
 		delete[] constStringBuffer;
 		delete[] trampoline;
+		if(pOwner)
+			::InterlockedDecrement(&program->contextNum);
+		else
+			delete program;
 	}
-	inline void Reset(void)
+	//ʱִģɵdelete
+	//ִԼֵջջAPIջ棬ڸԵִ߳нűʱ
+	//ȫֱÿζдOQLѯڳ½Уȶдԭӵģ
+	//ӦڱװزLoadLibrary֮󴴽ȫִڱʱResetװػ֮ǰɾ
+	//ִĲܱװؽűĽűصʱԽִģӦɾʹ
+	inline ScriptcRuntime* CreateContext(void)
+	{
+		if(pOwner)
+			return pOwner->CreateContext();
+		//֮ǰפȫִַĶʱдĳ
+		InternConstants();
+		return new ScriptcRuntime(this);
+	}
+	inline bool IsContext(void)
+	{
+		return pOwner!=NULL;
+	}
+	inline void Reset(void)
 	{
 		ClearAll();
 		Initialize();
 	}
+	//ǷʹԤִ·رպȫԭѭִУڶԱִзʽĽܣ
+	inline void SetFastExec(bool fast)
+	{
+		fastExec=fast;
+	}
+	//űԤ·ϱcallsκʱΪ룬0ΪرգĬϣֻx86x86-64Ч
+	//ֲֻֻ볣ĺʱ˻Ԥ·ִ
+	inline void SetJitThreshold(int calls)
+	{
+		jitThreshold=calls;
+	}
+	//ʱǷŻָĬϿرպԭָͬ
+	inline void SetOptimize(bool opt)
+	{
+		optimizeCode=opt;
+	}
+	//һαŻǰȫָ
+	inline void GetOptimizeStats(int& before,int& after)
+	{
+		before=optimizeBefore;
+		after=optimizeAfter;
+	}
+	//й˲ѯĹ߳0ΪйˣĬϣϴWHEREӾֿڹֵ߳
+	//ֻԤ·ϲú뷽޸ıWHEREӾЧҪȡĶԿڶ߳ͬʱȡ
+	inline void SetQueryWorkers(int num)
+	{
+		queryWorkers.Start(num);
+	}
+	//ررʱռݡͳƸִдڣ
+	//ԼűOQLѯⲿĵֻͳƽ߳еִС
+	inline void EnableProfiler(bool enable)
+	{
+		if(enable && !profiler)
+			profiler=new ScriptProfiler;
+		else if(!enable && profiler)
+		{
+			delete profiler;
+			profiler=NULL;
+		}
+	}
+	inline ScriptProfiler* GetProfiler(void)
+	{
+		return profiler;
+	}
+	//۵ջдļͼʹ
+	inline bool SaveProfile(const char* path)
+	{
+		if(!profiler)
+			return false;
+		CString stacks=profiler->CollapsedStacks();
+		int len=stacks.GetLength();
+		long r=ScriptFile::WriteLocal(path,stacks.GetBuffer(len),len);
+		stacks.ReleaseBuffer(len);
+		return r>=0;
+	}
 	inline void SetVariable(UINT index,const CComVariant& val)
 	{
 		if(index<0 || index>=globalVariables.size())
 			return;
-		globalVariables[index]=VariantToScript(val);
+		CComVariant v=VariantToScript(val);
+		SharedLock lock(program,program->globalCriticalSection);
+		globalVariables[index]=v;
 	}
 	//ؽűеıʱڲַBSTRVARIANTתڲַṩCOMtoStringתΪBSTR
 	//⣬ʹ߿Բýṩڲַȡַ(ҪǿǵBSTRڴ)
@@ -2122,7 +3472,8 @@ public:
 		if(index<0 || index>=globalVariables.size())
 			return CComVariant(0);
 
-		CComVariant& val=globalVariables[index];
+		SharedLock lock(program,program->globalCriticalSection);
+		CComVariant val=globalVariables[index];
 		return val;
 	}
 public:
@@ -2194,17 +3545,24 @@ public:
 
 	CString Compile(const char* filePath);
 	CString Compile(const char* buf,const char* filePath);
-	inline bool SaveFile(const char* path,const char* key=NULL)
+	inline bool SaveFile(const char* path,const char* key=NULL,int pack=SCB_PACK_LZARI)
 	{
 		char* buf=new char[MAXCODEBUFFERSIZE];
-		int size=SaveMemory(buf,key);
+		int size=SaveMemory(buf,key,pack);
+		if(size<0)
+		{
+			delete[] buf;
+			return false;
+		}
 		int r=ScriptFile::WriteLocal(path,buf,size);
 		delete[] buf;
 		if(r<0)
 			return false;
 		return true;
 	}
-	inline int SaveMemory(char* dbuf,const char* key=NULL)
+	//dbufMAXCODEBUFFERSIZEֽڣѹֱдdbufʱ-1
+	//packΪSCB_PACK_LZARISCB_PACK_LZFASTLZFastLZFAST_TAGͷLoadMemoryݴ
+	inline int SaveMemory(char* dbuf,const char* key=NULL,int pack=SCB_PACK_LZARI)
 	{
 		CriticalSectionOperator CSO(&saveMemCriticalSection);
 
@@ -2213,19 +3571,25 @@ public:
 		SaveScriptc(p);
 		int size=p-buf;
 		
-		LZARI lzari;
-		p=buf;
-		buf=(char*)lzari.Compress((const BYTE*)buf,size,size);
-		delete[] p;
+		if(pack==SCB_PACK_LZFAST)
+		{
+			LZFast lzfast;
+			size=lzfast.Pack((const BYTE*)buf,size,(BYTE*)dbuf,MAXCODEBUFFERSIZE);
+		}
+		else
+		{
+			LZARI lzari;
+			size=lzari.CompressTo((const BYTE*)buf,size,(BYTE*)dbuf,MAXCODEBUFFERSIZE);
+		}
+		delete[] buf;
+		if(size<0)
+			return -1;
 
 		if(key)
 		{
 			UINT num=ScriptFile::CalcuRotateNum(key);
-			ScriptFile::Encode((unsigned char*)buf,(const unsigned char*)key,size,num);
+			ScriptFile::Encode((unsigned char*)dbuf,(const unsigned char*)key,size,num);
 		}
-
-		ScriptFile::MemCpy(dbuf,buf,size);
-		delete[] buf;
 		return size;
 	}
 	inline CString ListFunctions(void)
@@ -2354,6 +3718,11 @@ public:
 		CStringA& s=strPtr->Ref();
 		return s;
 	}
+	//ڲַָ룬ǷΪڲַIsIStringʹ
+	static inline StringBase* IStringPtr(const CComVariant& v)
+	{
+		return static_cast<Scriptc::StringObj<ScriptcRuntime>*>(v.pdispVal);
+	}
 	//ֱӶȡڲַUNICODEãǷΪڲַIsIStringʹ
 	static inline CComBSTR& ReadIStringUnicode(const CComVariant& v)
 	{
@@ -2426,10 +3795,62 @@ public:
 		delete[] buf;
 		return true;
 	}
+	//ӳ.scbļֱӴӳͼװأʽļԭʽװ
+	inline bool LoadImageFile(const char* path)
+	{
+		HANDLE hFile=::CreateFile(path,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+		if(hFile==INVALID_HANDLE_VALUE)
+			return LoadFile(path);
+		DWORD size=::GetFileSize(hFile,NULL);
+		HANDLE hMap=NULL;
+		const char* view=NULL;
+		if(size!=INVALID_FILE_SIZE && size>0)
+			hMap=::CreateFileMapping(hFile,NULL,PAGE_READONLY,0,0,NULL);
+		if(hMap)
+			view=(const char*)::MapViewOfFile(hMap,FILE_MAP_READ,0,0,0);
+		bool image=view && ScriptImage::IsImage(view,size);
+		bool r=false;
+		if(image)
+			r=LoadImageMemory(view,size);
+		if(view)
+			::UnmapViewOfFile(view);
+		if(hMap)
+			::CloseHandle(hMap);
+		::CloseHandle(hFile);
+		if(!image)
+			return LoadFile(path);
+		return r;
+	}
+	//װ.scbӳδѹĶֱsbuf϶ȡֻѹӳҪȽѹ
+	inline bool LoadImageMemory(const char* sbuf,int size)
+	{
+		if(pOwner)
+			return false;
+		CriticalSectionOperator CSO(&loadMemCriticalSection);
+		if(!ScriptImage::IsImage(sbuf,size))
+			return false;
+		ScriptImageHeader header;
+		::memcpy(&header,sbuf,sizeof(header));
+		const char* p=sbuf+sizeof(header);
+		if(header.packedSize>size-sizeof(header))
+			return false;
+		if(!(header.flags&SCB_COMPRESSED))
+		{
+			if(header.size!=header.packedSize)
+				return false;
+			return LoadSections(p,header);
+		}
+		char* buf=new char[header.size?header.size:1];
+		bool r=ScriptImage::Unpack(p,header,buf) && LoadSections(buf,header);
+		delete[] buf;
+		return r;
+	}
 	inline bool LoadMemory(const char* sbuf,int size,const char* key=NULL)
 	{
+		if(!key && ScriptImage::IsImage(sbuf,size))
+			return LoadImageMemory(sbuf,size);
 		CriticalSectionOperator CSO(&loadMemCriticalSection);
-		if(size<0)
+		if(size<0 || pOwner)
 			return false;
 
 		char* buf=new char[size];
@@ -2441,14 +3862,37 @@ public:
 			ScriptFile::Decode((unsigned char*)buf,(const unsigned char*)key,size,num);
 		}
 		
-		LZARI lzari;
+		//LZARIԭȿͷűLZFAST_TAGͬԾݴѹ
 		const char* p=buf;
-		buf=(char*)lzari.Decompress((const BYTE*)buf,size,size);
+		int usize;
+		if(LZFast::IsPacked((const BYTE*)p,size))
+		{
+			usize=LZFast::PackedSize((const BYTE*)p,size);
+			buf=(usize>=0)?new char[usize?usize:1]:NULL;
+			if(buf && LZFast::Unpack((const BYTE*)p,size,(BYTE*)buf,usize)!=usize)
+			{
+				delete[] buf;
+				buf=NULL;
+			}
+		}
+		else
+		{
+			LZARI lzari;
+			usize=LZARI::DecompressedSize((const BYTE*)p,size);
+			buf=(usize>=0)?new char[usize?usize:1]:NULL;
+			if(buf && lzari.DecompressTo((const BYTE*)p,size,(BYTE*)buf,usize)!=usize)
+			{
+				delete[] buf;
+				buf=NULL;
+			}
+		}
 		delete[] p;
+		if(!buf)
+			return false;
 
 		p=buf;
-		UINT usize=(UINT)size;
-		if(!LoadScriptc(p,usize))
+		UINT leftsize=(UINT)usize;
+		if(!LoadScriptc(p,leftsize))
 		{
 			delete[] buf;
 			return false;
@@ -2460,6 +3904,8 @@ public:
 	{
 		char libNameBuffer[MAX_IDENTIFIER_SIZE];
 		char funcNameBuffer[MAX_IDENTIFIER_SIZE];
+		if(pOwner)
+			return;
 		CriticalSectionOperator CSO(&loadLibraryCriticalSection);
 
 		OuterFuncInfos::iterator it=outerFuncInfos.begin();
@@ -2506,6 +3952,8 @@ public:
 	}
 	inline void UnloadLibrary(void)
 	{
+		if(pOwner)
+			return;
 		CriticalSectionOperator CSO(&unloadLibraryCriticalSection);
 
 		Librarys::iterator it=librarys.begin();
@@ -2515,10 +3963,20 @@ public:
 		}
 		librarys.clear();
 	}
+	//߳˳ʱⲿջԶ黹ûFlsAllocϵͳ߳˳ǰ
 	inline void ReleaseThreadApiStack(void)
 	{
 		apiStack.Release();
 	}
+	//ⲿջصͳƣȷAPISTACK_POOLSIZE
+	static inline ApiStackPool::Stats GetApiStackStats(void)
+	{
+		return ApiStack::GetStats();
+	}
+	static inline double GetApiStackReuseRatio(void)
+	{
+		return ApiStack::ReuseRatio();
+	}
 	inline CComVariant ExecScript(CComVariant* externArgs=NULL,int argnum=0)
 	{
 		return ExecFunction(0,externArgs,argnum);
@@ -2536,10 +3994,31 @@ public:
 #endif
 			return CComVariant(0);
 		}
+		ProfileScope scope(this,PROFILE_FUNCTION+index);
+		DecodedCode* pcode=DecodedFunction(index);
+		if(CanExecDecoded(pcode,argnum+FrameSize(index)))
+		{
+			//Ԥ·תΪֵֵջϣغдأԭѭֱ޸ĲΪһ
+			TaggedValue* args=valueStack.top;
+			valueStack.top+=argnum;
+			for(int ii=0;ii<argnum;ii++)
+				ToValue(externArgs[ii],args[ii]);
+			TaggedValue self;
+			ToValue(obj,self);
+			TaggedValue res;
+			CallDecoded(*pcode,index,args,argnum,self,res);
+			for(int ii=0;ii<argnum;ii++)
+			{
+				ToVariant(args[ii],externArgs[ii]);
+				args[ii].Clear();
+			}
+			valueStack.top=args;
+			CComVariant r;
+			MoveToVariant(res,r);
+			return r;
+		}
 
-		Variables localVariables;
-		for(int ii=0;ii<funcVarNum[index];ii++)
-			localVariables.push_back(CComVariant(0));
+		Variables localVariables(funcVarNum[index],CComVariant(0));
 		//ʼԤֲ
 		localVariables[0]=obj;//this
 		localVariables[1]=CComVariant(argnum);//argnum
@@ -2551,6 +4030,28 @@ public:
 	}
 private:
 	inline int ExecQuery(int index,int objnum,Variables& localVariables,CComVariant* externArgs,int argnum,CComVariant* result)
+	{
+		FilterObjectsCallbackArg arg;
+		arg.pVariables=&localVariables;
+		arg.pLocals=NULL;
+		arg.pArgs=NULL;
+		arg.externArgs=externArgs;
+		arg.argnum=argnum;
+		return ExecQuery(index,objnum,arg,result);
+	}
+	//Ԥ·ִвѯֲΪֵ
+	inline int ExecQuery(int index,int objnum,TaggedValue* locals,TaggedValue* args,int argnum,CComVariant* result)
+	{
+		FilterObjectsCallbackArg arg;
+		arg.pVariables=NULL;
+		arg.pLocals=locals;
+		arg.pArgs=args;
+		arg.externArgs=NULL;
+		arg.argnum=argnum;
+		return ExecQuery(index,objnum,arg,result);
+	}
+	//argɵþֲֶڴд
+	inline int ExecQuery(int index,int objnum,FilterObjectsCallbackArg& arg,CComVariant* result)
 	{
 		if(index<0 || index>=MAXQUERY || !oqls[index])
 		{
@@ -2561,68 +4062,87 @@ private:
 #endif
 			return 0;
 		}
+		ProfileScope scope(this,PROFILE_QUERY+index);
+		//ѯƻʽڳйִĵĲѯִ
+		SharedLock lock(program,program->oqlCriticalSection);
 
-		Objects expargs;
-		int size=oqls[index]->fromList.size();
+		OqlRuntime* oql=oqls[index];
+		QueryPlan& plan=oql->plan;
+		if(!plan.compiled)
+			CompileQuery(*oql);
+		int size=oql->fromList.size();
+		Objects expargs(size,CComVariant(0));
 
 		//õFROMб
 		//FROMбиWHEREӾ
-		FilterObjectsCallbackArg arg;
 		arg.pScriptc=this;
-		arg.pOql=oqls[index];
+		arg.pOql=oql;
 		arg.oqlIndex=index;
-		arg.pVariables=&localVariables;
-
-		arg.externArgs=externArgs;
-		arg.argnum=argnum;
 		arg.pObjects=&expargs;
 
-		OBJLISTS objlists;
+		OBJLISTS objlists(size);
+		bool nullLink=false;
+		bool debug=(OnDebug.get()!=NULL);
 		for(int i=0;i<size;i++)
 		{
+			//FROMԴΪʱΪգԴWHEREӾûиʱٹ
+			if(nullLink && plan.pureFrom[i] && !debug)
+				continue;
 			arg.fromIndex=i;
-			expargs.push_back(NULL);
-			Objects objlist;
-			objlists.push_back(objlist);
-			if(oqls[index]->fromList[i]=="all")
-			{				
-				FilterObjects("",objlists[i],arg);
-			}
-			else
-			{
-				FilterObjects(oqls[index]->fromList[i],objlists[i],arg);
-			}
+			FilterObjects(plan.fromClass[i],objlists[i],arg);
+			if(objlists[i].size()==0)
+				nullLink=true;
 		}
 		OBJLISTS* pObjList=&objlists;
 		Orders orders;
-		//JOINӾִӹ
-		bool nullLink=false;
-		for(int i=0;i<size;i++)
-		{
-			if((*pObjList)[i].size()==0)
-				nullLink=true;
-		}
 		OBJLISTS objlists2;
-		JOINLISTS joinlists;
-		if(nullLink || oqls[index]->join>=0 || oqls[index]->sort!=-1)
+		//JOINӾִӹ
+		if(!nullLink && (plan.linkResult || plan.sortOrder>=0))
 		{
-			if(nullLink || oqls[index]->join>=0)
+			JOINLISTS joinlists;
+			if(plan.linkResult)
 			{
-				for(int i=0;i<size;i++)
+				objlists2.resize(size);
+				joinlists.resize(size);
+			}
+			//תΪʵ飬ڵѿзstd::advance
+			TupleTables tables(size);
+			TupleSlots slots(size);
+			Objects::iterator eit=expargs.begin();
+			for(int i=0;i<size;i++,eit++)
+			{
+				slots[i]=eit;
+				Objects& objs=(*pObjList)[i];
+				for(Objects::iterator oit=objs.begin();oit!=objs.end();oit++)
+					tables[i].push_back(&(*oit));
+			}
+			//һβѯΪʱֵֻһΣΪʱûԪ
+			bool checkJoin=plan.linkResult;
+			bool joinAll=true;
+			if(checkJoin && plan.constExp[oql->join] && !debug)
+			{
+				CComVariant r=arg.Eval(oql->join);
+				checkJoin=false;
+				joinAll=!(r.vt==VT_EMPTY || !r.lVal);
+			}
+			JoinPairs pairs;
+			if(checkJoin && HashJoin(oql->joinPlan,arg,tables,slots,pairs))
+			{
+				int sub[2];
+				for(UINT k=0;k<pairs.size();k++)
 				{
-					Objects objlist;
-					objlists2.push_back(objlist);
-					JoinObjs joinobjs;
-					joinlists.push_back(joinobjs);
+					sub[0]=pairs[k].first;
+					sub[1]=pairs[k].second;
+					JoinTuple(index,arg,sub,tables,slots,false,objlists2,joinlists,orders);
 				}
 			}
-			if(!nullLink)
+			else if(joinAll)
 			{
 				int* dim=new int[size];
 				int* sub=new int[size];
 				for(int i=0;i<size;i++)
 				{
-					dim[i]=(*pObjList)[i].size();
+					dim[i]=tables[i].size();
 					sub[i]=0;
 				}
 				sub[size-1]=-1;
@@ -2644,140 +4164,2273 @@ private:
 					}
 					if(i<0)
 						break;
-					//ӹ˵Ľ
-					for(int ii=0;ii<size;ii++)
-					{
-						Objects::iterator dit=expargs.begin();
-						std::advance(dit,ii);
-						Objects::iterator sit=(*pObjList)[ii].begin();
-						std::advance(sit,sub[ii]);
-						*dit=*sit;
-					}
-					//Ӳӽobjlists2
-					if(oqls[index]->join>=0)
-					{
-						CComVariant r=CalcExpression(index,oqls[index]->join,localVariables,externArgs,argnum,&expargs);
-						if(r.vt==VT_EMPTY || !r.lVal)
-							continue;
-						for(int ii=0;ii<size;ii++)
-						{
-							Objects::iterator dit=expargs.begin();
-							std::advance(dit,ii);
-							JoinObjs& objs=joinlists[ii];
-							JoinObjs::iterator it=objs.find(*dit);
-							if(it==objs.end())
-							{
-								objs.insert(*dit);
-								objlists2[ii].push_back(*dit);
-							}
-						}
-					}
-					//ΪORDER BYӾֵ
-					if(oqls[index]->sort!=-1)
-					{
-						int exp=oqls[index]->sort & 0x00FFFFFF;
-						CComVariant r=CalcExpression(index,exp,localVariables,externArgs,argnum,&expargs);
-						if(r.vt==VT_EMPTY)
-							r.lVal=0;
-						for(int ii=0;ii<size;ii++)
-						{
-							Objects::iterator dit=expargs.begin();
-							std::advance(dit,ii);
-							orders[*dit]=r;
-						}
-					}
+					JoinTuple(index,arg,sub,tables,slots,checkJoin,objlists2,joinlists,orders);
 				}
 				delete[] dim;
 				delete[] sub;
-				joinlists.clear();
 			}
-			if(nullLink || oqls[index]->join>=0)
+			if(plan.linkResult)
 				pObjList=&objlists2;
 		}
-		//ȡ
-		Objects objects;
-		size=oqls[index]->selectList.size();
-		for(int i=0;i<size;i++)
+		//ȡFROMԴΪʱΪ
+		Objects objects;
+		size=plan.selectFrom.size();
+		for(int i=0;i<size && !nullLink;i++)
+		{
+			int d=plan.selectFrom[i];
+			if(d<0)
+				continue;
+			Objects& objs=(*pObjList)[d];
+			objects.insert(objects.end(),objs.begin(),objs.end());
+		}
+		int len=objects.size();
+		//ʵORDER BYӾĹܣֵһȡƽеУֻ±
+		//ȡСֵʱֻһɨ裬ֻȡǰobjnumʱֻ
+		if(plan.sortOrder>=0 && len>0)
+		{
+			int order=plan.sortOrder;
+			Variables keys(len);
+			std::vector<char> hasKey(len,0);
+			for(int i=0;i<len;i++)
+			{
+				Orders::iterator oit=orders.find(objects[i]);
+				if(oit!=orders.end())
+				{
+					keys[i]=oit->second;
+					hasKey[i]=1;
+				}
+			}
+			switch(order)
+			{
+			case 0:
+			case 1:
+				{
+					std::vector<int> idx(len);
+					for(int i=0;i<len;i++)
+						idx[i]=i;
+					int need=len;
+					if(objnum>=1 && objnum<len)
+						need=objnum;
+					KeyIndexCompare cmp(&keys,&hasKey,order==0);
+					if(need<len)
+						std::partial_sort(idx.begin(),idx.begin()+need,idx.end(),cmp);
+					else
+						std::sort(idx.begin(),idx.end(),cmp);
+					Objects sorted;
+					sorted.reserve(need);
+					for(int i=0;i<need;i++)
+						sorted.push_back(objects[idx[i]]);
+					objects.swap(sorted);
+					len=need;
+				}
+				break;
+			case 2:
+			case 3:
+				{
+					//ԭȵstd::max_element/min_elementαȽϵĽһ£ֵʱȡĶ
+					//ȡֵʱûֵĶͣڸöϣȡСֵʱûֵĶҵ׸󽻻
+					int found=0;
+					for(int i=1;i<len;i++)
+					{
+						if(order==2 && OrderLessEqual(keys,hasKey,found,i))
+							found=i;
+						else if(order==3 && OrderLessEqual(keys,hasKey,i,found))
+							found=i;
+					}
+					if(found>0)
+						std::swap(objects[0],objects[found]);
+				}
+				break;
+			}
+		}
+		if(objnum==1)
+		{
+			if(len<=0)
+				return 0;		
+			*result=objects.front();
+			return 1;
+		}
+		else
+		{
+			//objnum<=0ʱȡѯȫ󣬷ȡǰnum
+			if(objnum>1 && objnum<len)
+				len=objnum;
+			SAFEARRAY* psa=::SafeArrayCreateVector(VT_VARIANT,0,len);
+			for(LONG ii=0;ii<len;ii++)
+			{			
+				::SafeArrayPutElement(psa,&ii,&objects[ii]);
+			}			
+			VARIANT var;
+			::VariantInit(&var);
+			var.vt=VT_ARRAY|VT_VARIANT;
+			var.parray=psa;
+			*result=var;
+			::SafeArrayDestroy(psa);
+			return len;
+		}
+	}
+	//ѿеһԪ飺checkJoinΪtrueʱԪ鰴ԭӽֵ
+	inline void JoinTuple(int index,FilterObjectsCallbackArg& arg,const int* sub,TupleTables& tables,TupleSlots& slots,bool checkJoin,OBJLISTS& objlists2,JOINLISTS& joinlists,Orders& orders)
+	{
+		OqlRuntime* oql=oqls[index];
+		int size=slots.size();
+		for(int ii=0;ii<size;ii++)
+			*slots[ii]=*tables[ii][sub[ii]];
+		//Ӳӽobjlists2
+		if(oql->join>=0)
+		{
+			if(checkJoin)
+			{
+				CComVariant r=arg.Eval(oql->join);
+				if(r.vt==VT_EMPTY || !r.lVal)
+					return;
+			}
+			for(int ii=0;ii<size;ii++)
+			{
+				CComVariant& obj=*slots[ii];
+				JoinObjs& objs=joinlists[ii];
+				if(objs.find(obj)==objs.end())
+				{
+					objs.insert(obj);
+					objlists2[ii].push_back(obj);
+				}
+			}
+		}
+		//ΪORDER BYӾֵ
+		if(oql->sort!=-1)
+		{
+			int exp=oql->sort & 0x00FFFFFF;
+			CComVariant r=arg.Eval(exp);
+			if(r.vt==VT_EMPTY)
+				r.lVal=0;
+			for(int ii=0;ii<size;ii++)
+				orders[*slots[ii]]=r;
+		}
+	}
+	//ӼƻִйϣӣڽСһఴֵϣһ̽⣬±ԣ
+	//ԭѿıһ¡ֵгָʱfalseɵ߸Ƕѭ
+	inline bool HashJoin(JoinPlan& plan,FilterObjectsCallbackArg& arg,TupleTables& tables,TupleSlots& slots,JoinPairs& pairs)
+	{
+		if(plan.source[0]<0 || tables.size()!=2 || OnDebug.get())
+			return false;
+		int build=(tables[0].size()<=tables[1].size())?0:1;
+		int probe=1-build;
+		int buildKey=(plan.source[0]==build)?0:1;
+		Variables keys(tables[build].size());
+		JoinHash hash;
+		for(UINT i=0;i<tables[build].size();i++)
+		{
+			*slots[build]=*tables[build][i];
+			keys[i]=CalcJoinKey(plan,buildKey,arg);
+			if(keys[i].vt==VT_R8)
+				return false;
+			hash[JoinKeyHash(keys[i])].push_back(i);
+		}
+		for(UINT j=0;j<tables[probe].size();j++)
+		{
+			*slots[probe]=*tables[probe][j];
+			CComVariant key=CalcJoinKey(plan,1-buildKey,arg);
+			if(key.vt==VT_R8)
+				return false;
+			JoinHash::iterator it=hash.find(JoinKeyHash(key));
+			if(it==hash.end())
+				continue;
+			std::vector<int>& cands=it->second;
+			for(UINT k=0;k<cands.size();k++)
+			{
+				CComVariant eq=CalcBinary(OP_EQ,keys[cands[k]],key);
+				if(!eq.lVal)
+					continue;
+				if(build==0)
+					pairs.push_back(JoinPair(cands[k],j));
+				else
+					pairs.push_back(JoinPair(j,cands[k]));
+			}
+		}
+		//Դ0ΪʱԴ1ĴָΪԴ0Ĵ
+		if(build==0)
+			std::sort(pairs.begin(),pairs.end());
+		return true;
+	}
+	//ӼڲַɢУͰlValɢУOP_EQıȽϷʽһ
+	static inline DWORD JoinKeyHash(const CComVariant& key)
+	{
+		if(IsIString(key))
+			return IStringPtr(key)->Hash();
+		return (DWORD)key.lVal;
+	}
+	inline CComVariant CalcJoinKey(JoinPlan& plan,int k,FilterObjectsCallbackArg& arg)
+	{
+		return CalcSubExpression(plan.keys[k],plan.decodedKeys[k],arg);
+	}
+	//ִмƻӲѯʽвӱʽinscodeͬһָԭʽԤʽ
+	inline CComVariant CalcSubExpression(Instructions& ins,DecodedCode& code,FilterObjectsCallbackArg& arg)
+	{
+		if(!arg.pLocals)
+			return Exec(ins,*arg.pVariables,arg.externArgs,arg.argnum,arg.pObjects);
+		if(!valueStack.Reserve(code.maxStack))
+		{
+#ifdef INCLUDE_COMPILE
+			RuntimeError("value stack overflow in query expression!");
+#endif
+			return CComVariant(0);
+		}
+		TaggedValue res;
+		ExecDecoded(code,arg.pLocals,arg.pArgs,arg.argnum,arg.pObjects,res);
+		CComVariant r;
+		MoveToVariant(res,r);
+		return r;
+	}
+	inline CComVariant CalcExpression(int oqlix,int index,Variables& localVariables,CComVariant* externArgs,int argnum,const Objects* pobjects)
+	{
+		Instructions& ins=oqls[oqlix]->GetExpression(index);		
+		return Exec(ins,localVariables,externArgs,argnum,pobjects);
+	}
+	//Ԥ·еĲѯʽֵѯȫʽԤʱȷϿԤ
+	inline CComVariant CalcExpression(int oqlix,int index,TaggedValue* locals,TaggedValue* args,int argnum,const Objects* pobjects)
+	{
+		DecodedCode& code=oqls[oqlix]->decodedExpressions[index];
+		if(!valueStack.Reserve(code.maxStack))
+		{
+#ifdef INCLUDE_COMPILE
+			RuntimeError("value stack overflow in query expression!");
+#endif
+			return CComVariant(0);
+		}
+		TaggedValue res;
+		ExecDecoded(code,locals,args,argnum,pobjects,res);
+		CComVariant r;
+		MoveToVariant(res,r);
+		return r;
+	}
+	inline DecodedCode* DecodedFunction(UINT index)
+	{
+		if(index<decodedFunctions.size())
+			return &decodedFunctions[index];
+		return NULL;
+	}
+	//Ԥɹδҽӵ¼ֵջռ㹻extra֡λʱԤ·ԭѭִ
+	inline bool CanExecDecoded(DecodedCode* pcode,int extra=0)
+	{
+		return fastExec && pcode && pcode->maxStack>=0 && !OnDebug.get() && valueStack.Reserve(pcode->maxStack+extra);
+	}
+	//ʱһֻx86x86-64ϱ룬ʧʱԤ·ִ
+	inline void JitCompile(DecodedCode& code)
+	{
+#ifdef JIT_SUPPORTED
+		DecodedJit compiler;
+		code.jit=compiler.Compile(code.ins,doubleConstants,jitMemory);
+#endif
+	}
+	//֡оֲĸٰthisargnum
+	inline int FrameSize(UINT index)
+	{
+		int varnum=funcVarNum[index];
+		if(varnum<2)
+			varnum=2;
+		return varnum;
+	}
+	//Ԥ·ִнűֲֵջջ֮Ϸ䣬ԭķʽʼΪ0
+	//ʱղ黹CanExecDecodedȷϿռ㹻
+	inline void CallDecoded(DecodedCode& code,UINT index,TaggedValue* args,int argnum,const TaggedValue& obj,TaggedValue& result)
+	{
+		int varnum=FrameSize(index);
+		TaggedValue* locals=valueStack.top;
+		valueStack.top+=varnum;
+		for(int i=2;i<varnum;i++)
+			locals[i].SetInt(0);
+		locals[0]=obj;//this
+		locals[1].SetInt(argnum);//argnum
+		if(jitThreshold>0 && ++code.calls==jitThreshold)
+			JitCompile(code);
+		ExecDecoded(code,locals,args,argnum,NULL,result);
+		for(int i=0;i<varnum;i++)
+			locals[i].Clear();
+		valueStack.top=locals;
+	}
+	//Ԥ·еýűargsΪֵջϵĲ
+	//Ԥʱڱ߽紦תΪVARIANTԭѭִС
+	inline void CallScript(UINT index,TaggedValue* args,int argnum,TaggedValue& result)
+	{
+		DecodedCode* pcode=DecodedFunction(index);
+		if(index<functions.size() && CanExecDecoded(pcode,FrameSize(index)))
+		{
+			ProfileScope scope(this,PROFILE_FUNCTION+index);
+			TaggedValue obj;
+			obj.SetInt(0);
+			CallDecoded(*pcode,index,args,argnum,obj,result);
+			return;
+		}
+		CComVariant* vargs=AllocArgs(argnum);
+		for(int i=0;i<argnum;i++)
+			MoveToVariant(args[i],vargs[i]);
+		CComVariant r=ExecFunction(index,vargs,argnum);
+		FreeArgs(vargs);
+		MoveToValue(r,result);
+	}
+	//Ϊⲿ󷽷÷VARIANT飬ʹòջ
+	inline CComVariant* AllocArgs(int num)
+	{
+		CComVariant* args=argStack.Alloc(num);
+		if(!args)
+			args=new CComVariant[num];
+		return args;
+	}
+	inline void FreeArgs(CComVariant* args)
+	{
+		if(argStack.Own(args))
+			argStack.Free(args);
+		else
+			delete[] args;
+	}
+private:
+#ifdef INCLUDE_COMPILE
+	//ɺŻָOQLʽԭѯƻָʶеԶȡȽ
+	inline void Optimize(void)
+	{
+		optimizeBefore=0;
+		optimizeAfter=0;
+		for(UINT i=0;i<functions.size();i++)
+		{
+			optimizeBefore+=functions[i].size();
+			if(optimizeCode)
+				OptimizeFunction(functions[i]);
+			optimizeAfter+=functions[i].size();
+		}
+	}
+	struct OptIns
+	{
+		int op;
+		int operand;
+		int target;		//תָľĿָ꣬Ϊ-1
+		bool keep;
+	};
+	typedef std::vector<OptIns> OptCode;
+	//г۵תӡɾʹõѹջջ벻ɴָֱûб仯
+	//ŻڼתĿ֧ƫƶǾλãɺ±룻޷תĺԭ
+	inline void OptimizeFunction(Instructions& ins)
+	{
+		OptCode code;
+		if(!LoadOptCode(ins,code))
+			return;
+		for(int round=0;round<OPTIMIZE_MAXROUND;round++)
+		{
+			bool changed=FoldConstants(code);
+			if(ThreadJumps(code))
+				changed=true;
+			if(RemoveDeadPushes(code))
+				changed=true;
+			if(RemoveUnreachable(code))
+				changed=true;
+			if(!changed)
+				break;
+		}
+		StoreOptCode(code,ins);
+	}
+	inline bool LoadOptCode(const Instructions& ins,OptCode& code)
+	{
+		int num=ins.size();
+		std::set<int> tables;
+		code.resize(num);
+		for(int pc=0;pc<num;pc++)
+		{
+			OptIns& o=code[pc];
+			o.op=(ins[pc]&0xff000000)>>24;
+			o.operand=(ins[pc]&0x00ffffff);
+			o.target=-1;
+			o.keep=true;
+			switch(o.op)
+			{
+			case OP_JMP:
+			case OP_JZ:
+			case OP_JNZ:
+				{
+					int type=(o.operand&(o.op==OP_JMP?0xff0000:0x0f0000))>>16;
+					int offset=(o.operand&0xffff);
+					o.target=pc+1;
+					if(type==0)
+						o.target=pc+offset+1;
+					else if(type==1)
+						o.target=pc-offset+1;
+					if(o.target<0 || o.target>num)
+						return false;
+				}
+				break;
+			case OP_TABLE_JMP:
+				{
+					//ÿֻ֧һָ
+					if(o.operand>=(int)switchInfos.size() || !tables.insert(o.operand).second)
+						return false;
+					SwitchInfo& info=switchInfos[o.operand];
+					Cases::iterator cit=info.cases.begin();
+					for(;cit!=info.cases.end();cit++)
+					{
+						if(pc+1+cit->second<0 || pc+1+cit->second>num)
+							return false;
+					}
+					if(pc+1+info.def<0 || pc+1+info.def>num)
+						return false;
+				}
+				break;
+			}
+		}
+		for(int pc=0;pc<num;pc++)
+		{
+			if(code[pc].op!=OP_TABLE_JMP)
+				continue;
+			SwitchInfo& info=switchInfos[code[pc].operand];
+			Cases::iterator cit=info.cases.begin();
+			for(;cit!=info.cases.end();cit++)
+				cit->second+=pc+1;
+			info.def+=pc+1;
+		}
+		return true;
+	}
+	inline void StoreOptCode(const OptCode& code,Instructions& ins)
+	{
+		int num=code.size();
+		ins.resize(num);
+		for(int pc=0;pc<num;pc++)
+		{
+			const OptIns& o=code[pc];
+			int operand=o.operand;
+			if(o.target>=0)
+			{
+				int offset=o.target-pc-1;
+				int type=0;
+				if(offset<0)
+				{
+					type=1;
+					offset=-offset;
+				}
+				operand=(o.op==OP_JMP)?0:(o.operand&0xf00000);
+				operand|=(type<<16)|offset;
+			}
+			else if(o.op==OP_TABLE_JMP)
+			{
+				SwitchInfo& info=switchInfos[o.operand];
+				Cases::iterator cit=info.cases.begin();
+				for(;cit!=info.cases.end();cit++)
+					cit->second-=pc+1;
+				info.def-=pc+1;
+			}
+			ins[pc]=(o.op<<24)|operand;
+		}
+	}
+	//ɾȥkeepΪfalseָתɾָĸΪתһָ
+	inline void CompactOptCode(OptCode& code)
+	{
+		int num=code.size();
+		std::vector<int> pos(num+1);
+		int n=0;
+		for(int pc=0;pc<num;pc++)
+		{
+			pos[pc]=n;
+			if(code[pc].keep)
+				n++;
+		}
+		pos[num]=n;
+		OptCode out;
+		out.reserve(n);
+		for(int pc=0;pc<num;pc++)
+		{
+			OptIns o=code[pc];
+			if(o.op==OP_TABLE_JMP)
+			{
+				SwitchInfo& info=switchInfos[o.operand];
+				if(!o.keep)
+				{
+					info.cases.clear();
+					info.def=0;
+					continue;
+				}
+				Cases::iterator cit=info.cases.begin();
+				for(;cit!=info.cases.end();cit++)
+					cit->second=pos[cit->second];
+				info.def=pos[info.def];
+			}
+			if(!o.keep)
+				continue;
+			if(o.target>=0)
+				o.target=pos[o.target];
+			out.push_back(o);
+		}
+		code.swap(out);
+	}
+	inline void OptSuccessors(const OptCode& code,int pc,std::vector<int>& succ)
+	{
+		const OptIns& o=code[pc];
+		succ.clear();
+		switch(o.op)
+		{
+		case OP_RETURN:
+			break;
+		case OP_JMP:
+			succ.push_back(o.target);
+			break;
+		case OP_JZ:
+		case OP_JNZ:
+			succ.push_back(pc+1);
+			succ.push_back(o.target);
+			break;
+		case OP_TABLE_JMP:
+			{
+				SwitchInfo& info=switchInfos[o.operand];
+				Cases::iterator cit=info.cases.begin();
+				for(;cit!=info.cases.end();cit++)
+					succ.push_back(cit->second);
+				succ.push_back(info.def);
+			}
+			break;
+		default:
+			succ.push_back(pc+1);
+			break;
+		}
+	}
+	//ΪתĿָЩָ֮ǰǰָϲ
+	inline void OptTargets(const OptCode& code,std::vector<bool>& targets)
+	{
+		int num=code.size();
+		targets.assign(num+1,false);
+		for(int pc=0;pc<num;pc++)
+		{
+			const OptIns& o=code[pc];
+			if(o.target>=0)
+				targets[o.target]=true;
+			else if(o.op==OP_TABLE_JMP)
+			{
+				SwitchInfo& info=switchInfos[o.operand];
+				Cases::iterator cit=info.cases.begin();
+				for(;cit!=info.cases.end();cit++)
+					targets[cit->second]=true;
+				targets[info.def]=true;
+			}
+		}
+	}
+	//ѹ򸡵ָ
+	inline bool OptConst(const OptIns& o,TaggedValue& v)
+	{
+		if(o.op!=OP_PUSH || (o.operand&0xf00000)!=0)
+			return false;
+		int type=(o.operand&0x0f0000)>>16;
+		int index=(o.operand&0xffff);
+		if(type==1 && index<(int)intConstants.size())
+		{
+			v.SetInt(intConstants[index]);
+			return true;
+		}
+		if(type==2 && index<(int)doubleConstants.size())
+		{
+			v.SetDouble(doubleConstants[index]);
+			return true;
+		}
+		return false;
+	}
+	//ִʱĹͬೣĶԪ㣬ִʱܲͬΪ0λ32λȣĲ۵
+	static inline bool FoldBinary(int op,TaggedValue& a,const TaggedValue& c)
+	{
+		if(a.tag!=c.tag)
+			return false;
+		if(a.tag==TAG_DOUBLE)
+		{
+			switch(op)
+			{
+			case OP_DIV:
+			case OP_ADD:
+			case OP_SUB:
+			case OP_MUL:
+			case OP_EQ:
+			case OP_NE:
+			case OP_LT:
+			case OP_GT:
+			case OP_LE:
+			case OP_GE:
+				if(op==OP_DIV && c.d==0)
+					return false;
+				CalcBinary(op,a,c);
+				return true;
+			}
+			return false;
+		}
+		switch(op)
+		{
+		case OP_DIV:
+			if(c.i==0 || (c.i==-1 && a.u==0x80000000))
+				return false;
+			break;
+		case OP_MOD:
+			if(c.i==0)
+				return false;
+			break;
+		case OP_LS:
+		case OP_RS:
+			if(c.u>=32)
+				return false;
+			break;
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			break;
+		default:
+			return false;
+		}
+		CalcBinary(op,a,c);
+		return true;
+	}
+	static inline bool FoldUnary(int op,TaggedValue& a)
+	{
+		if(op==OP_USUB || (a.tag==TAG_INT && (op==OP_NEG || op==OP_NOT)))
+		{
+			CalcUnary(op,a);
+			return true;
+		}
+		return false;
+	}
+	//ڱе±꣬ڱʱΪ-1
+	template<typename Pool,typename T>
+		static inline int OptFindConst(const Pool& pool,const T& v)
+	{
+		typename Pool::const_iterator it=std::find(pool.begin(),pool.end(),v);
+		return (it==pool.end())?-1:(int)(it-pool.begin());
+	}
+	//ѳд볣дѹջָ16λʱֻñеĳ۵ڱ³
+	inline bool OptSetConst(OptIns& o,const TaggedValue& v)
+	{
+		int index,type;
+		if(v.tag==TAG_INT)
+		{
+			if(intConstants.size()>0xffff)
+				index=OptFindConst(intConstants,v.i);
+			else
+				index=DecideConst(v.i);
+			type=1;
+		}
+		else
+		{
+			if(doubleConstants.size()>0xffff)
+				index=OptFindConst(doubleConstants,v.d);
+			else
+				index=DecideConst(v.d);
+			type=2;
+		}
+		if(index<0 || index>0xffff)
+			return false;
+		o.operand=(type<<16)|index;
+		return true;
+	}
+	//һԪĶԪڱʱ
+	inline bool FoldConstants(OptCode& code)
+	{
+		int num=code.size();
+		std::vector<bool> targets;
+		OptTargets(code,targets);
+		bool changed=false;
+		TaggedValue a,c;
+		for(int pc=0;pc+1<num;pc++)
+		{
+			if(!OptConst(code[pc],a) || targets[pc+1])
+				continue;
+			if(FoldUnary(code[pc+1].op,a))
+			{
+				if(OptSetConst(code[pc],a))
+				{
+					code[pc+1].keep=false;
+					changed=true;
+					pc++;
+				}
+				continue;
+			}
+			if(pc+2>=num || targets[pc+2] || !OptConst(code[pc+1],c))
+				continue;
+			if(FoldBinary(code[pc+2].op,a,c) && OptSetConst(code[pc],a))
+			{
+				code[pc+1].keep=false;
+				code[pc+2].keep=false;
+				changed=true;
+				pc+=2;
+			}
+		}
+		if(changed)
+			CompactOptCode(code);
+		return changed;
+	}
+	//תתĸΪֱתĿ꣬ɾȥתһָת
+	inline bool ThreadJumps(OptCode& code)
+	{
+		int num=code.size();
+		bool changed=false;
+		for(int pc=0;pc<num;pc++)
+		{
+			OptIns& o=code[pc];
+			if(o.target<0)
+				continue;
+			int t=o.target;
+			for(int hops=0;hops<num && t<num && code[t].op==OP_JMP && code[t].target!=t;hops++)
+				t=code[t].target;
+			if(t!=o.target && t-pc-1<=0xffff && pc+1-t<=0xffff)
+			{
+				o.target=t;
+				changed=true;
+			}
+		}
+		for(int pc=0;pc<num;pc++)
+		{
+			if(code[pc].op==OP_JMP && code[pc].target==pc+1)
+			{
+				code[pc].keep=false;
+				changed=true;
+			}
+		}
+		if(changed)
+			CompactOptCode(code);
+		return changed;
+	}
+	//ÿָڴֵǷ񻹻ᱻʹãûOP_RETURNʱ󵯳ֵΪֵ
+	//ֻڵﺯĩβ֮ǰپOP_POPOP_RETURNʱŻõ
+	inline void ResultLiveness(const OptCode& code,std::vector<bool>& live)
+	{
+		int num=code.size();
+		live.assign(num+1,false);
+		live[num]=true;
+		std::vector<int> succ;
+		bool changed=true;
+		while(changed)
+		{
+			changed=false;
+			for(int pc=num-1;pc>=0;pc--)
+			{
+				if(live[pc] || code[pc].op==OP_POP || code[pc].op==OP_RETURN)
+					continue;
+				OptSuccessors(code,pc,succ);
+				for(UINT i=0;i<succ.size();i++)
+				{
+					if(live[succ[i]])
+					{
+						live[pc]=true;
+						changed=true;
+						break;
+					}
+				}
+			}
+		}
+	}
+	//ѹջҵֵΪֵָԣֻг䣩
+	inline bool RemoveDeadPushes(OptCode& code)
+	{
+		int num=code.size();
+		std::vector<bool> targets;
+		OptTargets(code,targets);
+		std::vector<bool> live;
+		ResultLiveness(code,live);
+		bool changed=false;
+		for(int pc=0;pc+1<num;pc++)
+		{
+			const OptIns& o=code[pc];
+			if(o.op!=OP_PUSH || ((o.operand&0x0f0000)>>16)>6)
+				continue;
+			if(code[pc+1].op!=OP_POP || targets[pc+1] || live[pc+2])
+				continue;
+			code[pc].keep=false;
+			code[pc+1].keep=false;
+			changed=true;
+			pc++;
+		}
+		if(changed)
+			CompactOptCode(code);
+		return changed;
+	}
+	inline bool RemoveUnreachable(OptCode& code)
+	{
+		int num=code.size();
+		if(num==0)
+			return false;
+		std::vector<bool> reach(num+1,false);
+		std::vector<int> work;
+		std::vector<int> succ;
+		work.push_back(0);
+		while(!work.empty())
+		{
+			int pc=work.back();
+			work.pop_back();
+			if(pc>=num || reach[pc])
+				continue;
+			reach[pc]=true;
+			OptSuccessors(code,pc,succ);
+			work.insert(work.end(),succ.begin(),succ.end());
+		}
+		bool changed=false;
+		for(int pc=0;pc<num;pc++)
+		{
+			if(!reach[pc])
+			{
+				code[pc].keep=false;
+				changed=true;
+			}
+		}
+		if(changed)
+			CompactOptCode(code);
+		return changed;
+	}
+#endif
+	//װػɺȫűOQLʽԤ롣
+	//ȽOQLʽִеĲѯֻҪһʽԤ룬úԭѭִС
+	inline void DecodeAll(void)
+	{
+		InternConstants();
+		for(int i=0;i<MAXQUERY;i++)
+		{
+			if(!oqls[i])
+				continue;
+			OqlRuntime::Expressions& exps=oqls[i]->expressions;
+			DecodedCodes& dexps=oqls[i]->decodedExpressions;
+			dexps.clear();
+			dexps.resize(exps.size());
+			for(UINT j=0;j<exps.size();j++)
+				DecodeInstructions(exps[j],dexps[j]);
+			PlanJoin(*oqls[i]);
+			PlanIndex(*oqls[i]);
+			oqls[i]->plan=QueryPlan();
+		}
+		decodedFunctions.clear();
+		jitMemory.Clear();
+		needleSets.clear();
+		decodedFunctions.resize(functions.size());
+		for(UINT i=0;i<functions.size();i++)
+		{
+			DecodeInstructions(functions[i],decodedFunctions[i]);
+			if(decodedFunctions[i].maxStack>=0)
+				FuseInstructions(decodedFunctions[i]);
+		}
+		for(UINT i=0;i<switchInfos.size();i++)
+			BuildSwitchTable(switchInfos[i]);
+	}
+	//ѺгָкϲΪһָϲָֻдһԭ
+	//ʱָѹֲִвִкתĿʱϲ
+	inline void FuseInstructions(DecodedCode& code)
+	{
+		int num=code.ins.size();
+		std::vector<bool> targets(num+1,false);
+		for(int pc=0;pc<num;pc++)
+		{
+			const DecodedIns& d=code.ins[pc];
+			switch(d.op)
+			{
+			case OP_JMP:
+			case OP_JZ:
+			case OP_JNZ:
+			case DOP_JZ_KEEP:
+			case DOP_JNZ_KEEP:
+				targets[d.index]=true;
+				break;
+			case OP_TABLE_JMP:
+				{
+					SwitchInfo& info=switchInfos[d.operand];
+					Cases::iterator cit=info.cases.begin();
+					for(;cit!=info.cases.end();cit++)
+						targets[pc+1+cit->second]=true;
+					targets[pc+1+info.def]=true;
+				}
+				break;
+			}
+		}
+		for(int pc=0;pc+2<num;pc++)
+		{
+			DecodedIns& d=code.ins[pc];
+			if(d.op!=DOP_PUSH_LOCAL || targets[pc+1] || targets[pc+2] || !IsFusedOp(code.ins[pc+2].op))
+				continue;
+			if(code.ins[pc+1].op==DOP_PUSH_INT)
+				d.op=DOP_LOCAL_INT_OP;
+			else if(code.ins[pc+1].op==DOP_PUSH_LOCAL)
+				d.op=DOP_LOCAL_LOCAL_OP;
+		}
+	}
+	static inline bool IsFusedOp(int op)
+	{
+		switch(op)
+		{
+		case OP_ADD:
+		case OP_SUB:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			return true;
+		}
+		return false;
+	}
+	//ֵ֧ķֲѡȡ֧ıʾʽֵʱֱ֧ϡʱɢУ
+	static inline int ChooseSwitchKind(const SwitchInfo& info)
+	{
+		int n=info.cases.size();
+		if(n==0)
+			return SWITCH_MAP;
+		__int64 range=(__int64)info.cases.rbegin()->first-info.cases.begin()->first+1;
+		if(range<=SWITCH_DENSE_MAXRANGE && range<=(__int64)n*SWITCH_DENSE_FACTOR)
+			return SWITCH_DENSE;
+		if(n>=SWITCH_HASH_MINCASES)
+			return SWITCH_HASH;
+		return SWITCH_SORTED;
+	}
+	//ѡȡķʽɷ֧޷÷ʽʱΪ
+	static inline void BuildSwitchTable(SwitchInfo& info)
+	{
+		if(info.kind<0)
+			info.kind=ChooseSwitchKind(info);
+		info.keys.clear();
+		info.targets.clear();
+		info.disp.clear();
+		if(info.cases.empty())
+		{
+			info.kind=SWITCH_MAP;
+			return;
+		}
+		if(info.kind==SWITCH_DENSE && !BuildSwitchDense(info))
+			info.kind=SWITCH_SORTED;
+		if(info.kind==SWITCH_HASH && !BuildSwitchHash(info))
+			info.kind=SWITCH_SORTED;
+		if(info.kind==SWITCH_SORTED)
+		{
+			Cases::const_iterator it=info.cases.begin();
+			for(;it!=info.cases.end();it++)
+			{
+				info.keys.push_back(it->first);
+				info.targets.push_back(it->second);
+			}
+		}
+		else if(info.kind!=SWITCH_DENSE && info.kind!=SWITCH_HASH)
+			info.kind=SWITCH_MAP;
+	}
+	static inline bool BuildSwitchDense(SwitchInfo& info)
+	{
+		__int64 range=(__int64)info.cases.rbegin()->first-info.cases.begin()->first+1;
+		if(range>SWITCH_DENSE_MAXRANGE)
+			return false;
+		info.low=info.cases.begin()->first;
+		info.targets.assign((UINT)range,info.def);
+		Cases::const_iterator it=info.cases.begin();
+		for(;it!=info.cases.end();it++)
+			info.targets[it->first-info.low]=it->second;
+		return true;
+	}
+	//ֻһɢУʱһγ˷ȡ֧ʱĳڣðͰλƵɢ
+	static inline bool BuildSwitchHash(SwitchInfo& info)
+	{
+		info.disp.clear();
+		return BuildSwitchHashDirect(info) || BuildSwitchHashDisplaced(info);
+	}
+	//ȡСڷ֧2ݣԳֱûгͻҲʱѱӱ
+	static inline bool BuildSwitchHashDirect(SwitchInfo& info)
+	{
+		int n=info.cases.size();
+		int bits=1;
+		while((1<<bits)<2*n)
+			bits++;
+		for(int grow=0;grow<3 && bits<=16;grow++,bits++)
+		{
+			UINT size=1<<bits;
+			UINT seed=2654435769u;
+			for(int tries=0;tries<64;tries++)
+			{
+				info.keys.assign(size,0);
+				info.targets.assign(size,info.def);
+				std::vector<bool> used(size,false);
+				bool ok=true;
+				Cases::const_iterator it=info.cases.begin();
+				for(;it!=info.cases.end();it++)
+				{
+					UINT slot=((UINT)it->first*seed)>>(32-bits);
+					if(used[slot])
+					{
+						ok=false;
+						break;
+					}
+					used[slot]=true;
+					info.keys[slot]=it->first;
+					info.targets[slot]=it->second;
+				}
+				if(ok)
+				{
+					info.seed=seed;
+					info.shift=32-bits;
+					return true;
+				}
+				seed=(seed*1664525+1013904223)|1;
+			}
+		}
+		info.keys.clear();
+		info.targets.clear();
+		return false;
+	}
+	//ͰλƵɢУֵȰһֵԼn/2ͰУٰһλÿͰȡһλλ
+	//ӴͰʼΪͰҵʹͰڸֵڿղеλơȡСڷ֧2ݣ
+	//ͰֵλͬҲλƵʱԣʧʱѱӱ
+	static inline bool BuildSwitchHashDisplaced(SwitchInfo& info)
+	{
+		int n=info.cases.size();
+		int bits=1;
+		while((1<<bits)<2*n)
+			bits++;
+		int bucketBits=1;
+		while((1<<bucketBits)<(n+1)/2)
+			bucketBits++;
+		UINT seed=2654435769u;
+		for(int grow=0;grow<3 && bits<=16;grow++,bits++)
+		{
+			UINT size=1<<bits;
+			UINT buckets=1<<bucketBits;
+			for(int tries=0;tries<16;tries++)
+			{
+				UINT bucketSeed=seed*2246822519u|1;
+				int bucketShift=32-bucketBits;
+				std::vector<std::vector<int> > members(buckets);
+				Cases::const_iterator it=info.cases.begin();
+				for(;it!=info.cases.end();it++)
+				{
+					UINT b=((UINT)it->first*bucketSeed)>>bucketShift;
+					members[b].push_back(it->first);
+				}
+				std::vector<std::pair<int,UINT> > order;
+				for(UINT b=0;b<buckets;b++)
+				{
+					if(!members[b].empty())
+						order.push_back(std::make_pair(-(int)members[b].size(),b));
+				}
+				std::sort(order.begin(),order.end());
+				info.keys.assign(size,0);
+				info.targets.assign(size,info.def);
+				info.disp.assign(buckets,0);
+				std::vector<bool> used(size,false);
+				std::vector<UINT> slots;
+				bool ok=true;
+				for(UINT k=0;k<order.size() && ok;k++)
+				{
+					std::vector<int>& keys=members[order[k].second];
+					UINT d=0;
+					for(;d<size;d++)
+					{
+						slots.clear();
+						UINT j=0;
+						for(;j<keys.size();j++)
+						{
+							UINT slot=(((UINT)keys[j]*seed)>>(32-bits))^d;
+							if(used[slot] || std::find(slots.begin(),slots.end(),slot)!=slots.end())
+								break;
+							slots.push_back(slot);
+						}
+						if(j==keys.size())
+							break;
+					}
+					if(d==size)
+					{
+						ok=false;
+						break;
+					}
+					info.disp[order[k].second]=d;
+					for(UINT j=0;j<keys.size();j++)
+					{
+						used[slots[j]]=true;
+						info.keys[slots[j]]=keys[j];
+						info.targets[slots[j]]=info.cases.find(keys[j])->second;
+					}
+				}
+				if(ok)
+				{
+					info.seed=seed;
+					info.shift=32-bits;
+					info.bucketSeed=bucketSeed;
+					info.bucketShift=bucketShift;
+					return true;
+				}
+				seed=(seed*1664525+1013904223)|1;
+			}
+		}
+		info.keys.clear();
+		info.targets.clear();
+		info.disp.clear();
+		return false;
+	}
+	//ֵ֧vӦתƫƣûжӦ֧ʱΪȱʡ֧
+	static inline int SwitchTarget(const SwitchInfo& info,int v)
+	{
+		switch(info.kind)
+		{
+		case SWITCH_DENSE:
+			{
+				UINT i=(UINT)v-(UINT)info.low;
+				if(i<info.targets.size())
+					return info.targets[i];
+				return info.def;
+			}
+		case SWITCH_SORTED:
+			{
+				//ÿ۰붼ִУȽϽֻѡȡָ룬Ԥת
+				const int* keys=&info.keys[0];
+				const int* p=keys;
+				int n=info.keys.size();
+				while(n>1)
+				{
+					int half=n>>1;
+					p=(p[half]<=v)?p+half:p;
+					n-=half;
+				}
+				return (*p==v)?info.targets[p-keys]:info.def;
+			}
+		case SWITCH_HASH:
+			{
+				UINT slot=((UINT)v*info.seed)>>info.shift;
+				if(!info.disp.empty())
+					slot^=info.disp[((UINT)v*info.bucketSeed)>>info.bucketShift];
+				return (info.keys[slot]==v)?info.targets[slot]:info.def;
+			}
+		}
+		Cases::const_iterator cit=info.cases.find(v);
+		if(cit!=info.cases.end())
+			return cit->second;
+		return info.def;
+	}
+	//ɲѯִмƻFROMԴSELECTӦFROMԴȡʽ
+	//ʽǷиáǷһβѯΪ˺ÿִвѯʱֱʹ
+	inline void CompileQuery(OqlRuntime& oql)
+	{
+		QueryPlan& plan=oql.plan;
+		plan=QueryPlan();
+		int size=oql.fromList.size();
+		for(int i=0;i<size;i++)
+		{
+			if(oql.fromList[i]=="all")
+				plan.fromClass.push_back(CString(""));
+			else
+				plan.fromClass.push_back(oql.fromList[i]);
+		}
+		for(UINT i=0;i<oql.selectList.size();i++)
+		{
+			FromList::iterator it=std::find(oql.fromList.begin(),oql.fromList.end(),oql.selectList[i]);
+			if(it==oql.fromList.end())
+				plan.selectFrom.push_back(-1);
+			else
+				plan.selectFrom.push_back(std::distance(oql.fromList.begin(),it));
+		}
+		int num=oql.expressions.size();
+		plan.pureExp.resize(num,0);
+		plan.constExp.resize(num,0);
+		for(int i=0;i<num;i++)
+			AnalyzeExpression(oql.expressions[i],plan.pureExp[i],plan.constExp[i]);
+		for(int i=0;i<size;i++)
+		{
+			int exp=(i<(int)oql.fromExpList.size())?oql.fromExpList[i]:-1;
+			plan.pureFrom.push_back((exp<0 || (exp<num && plan.pureExp[exp]))?1:0);
+		}
+		plan.linkResult=(oql.join>=0 && oql.join<num);
+		if(oql.sort!=-1)
+		{
+			plan.sortOrder=(oql.sort & 0xFF000000)>>24;
+			plan.sortExp=oql.sort & 0x00FFFFFF;
+		}
+		plan.compiled=true;
+	}
+	static inline void AnalyzeExpression(const Instructions& ins,char& pure,char& constant)
+	{
+		pure=1;
+		constant=1;
+		for(UINT i=0;i<ins.size();i++)
+		{
+			int op=(ins[i]&0xff000000)>>24;
+			switch(op)
+			{
+			case OP_PUSH:
+				if(((ins[i]&0x0f0000)>>16)==6)
+					constant=0;
+				break;
+			case OP_OBJGETATTR:
+			case OP_PTRCALC:
+				constant=0;
+				break;
+			case OP_CALL:
+			case OP_OBJCALL:
+			case OP_OBJSETATTR:
+			case OP_INC:
+			case OP_DEC:
+			case OP_EXECQUERY:
+			case OP_ADDR:
+				pure=0;
+				break;
+			}
+			if(op>=OP_ASSIGN && op<=OP_RS_ASSIGN)
+				pure=0;
+		}
+		if(!pure)
+			constant=0;
+	}
+	//ΪѯJOINӾɹϣӼƻӱʽFROMԴӱʽȱȽϣ
+	//ӱʽвתáֵָǰֻFROMԴĲѯ
+	inline void PlanJoin(OqlRuntime& oql)
+	{
+		JoinPlan& plan=oql.joinPlan;
+		plan=JoinPlan();
+		if(oql.join<0 || oql.join>=oql.expressions.size() || oql.fromList.size()!=2)
+			return;
+		Instructions& exp=oql.expressions[oql.join];
+		DecodedCode& code=oql.decodedExpressions[oql.join];
+		int num=code.ins.size();
+		if(code.maxStack<0 || num<4 || code.ins[num-1].op!=OP_POP || code.ins[num-2].op!=OP_EQ)
+			return;
+		//ԺǰҳҲ㣬ָ
+		int split=-1;
+		int need=1;
+		int pops,pushes;
+		for(int pc=num-3;pc>=0;pc--)
+		{
+			const DecodedIns& d=code.ins[pc];
+			if(!PlanSafe(d.op))
+				return;
+			StackEffect(d,pops,pushes);
+			need+=pops-pushes;
+			if(need==0 && split<0)
+				split=pc;
+		}
+		if(split<=0)
+			return;
+		int depth=0;
+		for(int pc=0;pc<split;pc++)
+		{
+			StackEffect(code.ins[pc],pops,pushes);
+			depth+=pushes-pops;
+		}
+		if(depth!=1)
+			return;
+		//ֻһFROMԴ
+		int source[2]={-1,-1};
+		for(int pc=0;pc<num-2;pc++)
+		{
+			const DecodedIns& d=code.ins[pc];
+			if(d.op!=DOP_PUSH_OBJECT)
+				continue;
+			int k=(pc<split)?0:1;
+			if(source[k]>=0 && source[k]!=d.index)
+				return;
+			source[k]=d.index;
+		}
+		if(source[0]<0 || source[1]<0 || source[0]==source[1] || source[0]>=2 || source[1]>=2)
+			return;
+		plan.keys[0].assign(exp.begin(),exp.begin()+split);
+		plan.keys[0].push_back(OP_POP<<24);
+		plan.keys[1].assign(exp.begin()+split,exp.end()-2);
+		plan.keys[1].push_back(OP_POP<<24);
+		DecodeInstructions(plan.keys[0],plan.decodedKeys[0]);
+		DecodeInstructions(plan.keys[1],plan.decodedKeys[1]);
+		if(plan.decodedKeys[0].maxStack<0 || plan.decodedKeys[1].maxStack<0)
+		{
+			plan=JoinPlan();
+			return;
+		}
+		plan.source[0]=source[0];
+		plan.source[1]=source[1];
+	}
+	//ΪFROMԴƻǷпõִвѯʱȷ
+	inline void PlanIndex(OqlRuntime& oql)
+	{
+		oql.indexPlans.clear();
+		int size=oql.fromList.size();
+		oql.indexPlans.resize(size);
+		for(int i=0;i<size && i<(int)oql.fromExpList.size();i++)
+		{
+			int exp=oql.fromExpList[i];
+			if(exp<0 || exp>=(int)oql.decodedExpressions.size())
+				continue;
+			DecodedCode& code=oql.decodedExpressions[exp];
+			int num=code.ins.size();
+			if(code.maxStack<0 || num<5 || code.ins[num-1].op!=OP_POP)
+				continue;
+			PlanIndexTerm(oql.expressions[exp],code,i,0,num-1,oql.indexPlans[i]);
+		}
+	}
+	//ָ[begin,end)ҿشıȽϣ䱾볣ӱʽıȽϣ
+	//a&&babеݹҡa&&bʽΪaָĩβDOP_JZ_KEEPbOP_ANDAND
+	inline bool PlanIndexTerm(const Instructions& exp,const DecodedCode& code,int from,int begin,int end,IndexPlan& plan)
+	{
+		int op=code.ins[end-1].op;
+		if(op==OP_ANDAND)
+		{
+			for(int pc=begin;pc<end-1;pc++)
+			{
+				const DecodedIns& d=code.ins[pc];
+				if(d.op!=DOP_JZ_KEEP || d.index!=end)
+					continue;
+				return PlanIndexTerm(exp,code,from,begin,pc,plan) || PlanIndexTerm(exp,code,from,pc+1,end-1,plan);
+			}
+			return false;
+		}
+		if(op!=OP_EQ && op!=OP_LT && op!=OP_GT && op!=OP_LE && op!=OP_GE)
+			return false;
+		//ԺǰҳҲ㣬ָ
+		int split=-1;
+		int need=1;
+		int pops,pushes;
+		for(int pc=end-2;pc>=begin;pc--)
+		{
+			const DecodedIns& d=code.ins[pc];
+			if(!PlanSafe(d.op))
+				return false;
+			StackEffect(d,pops,pushes);
+			need+=pops-pushes;
+			if(need==0 && split<0)
+				split=pc;
+		}
+		if(split<=begin)
+			return false;
+		int depth=0;
+		for(int pc=begin;pc<split;pc++)
+		{
+			StackEffect(code.ins[pc],pops,pushes);
+			depth+=pushes-pops;
+		}
+		if(depth!=1)
+			return false;
+		//һFROMԶȡһǳӱʽҲʱȽϷ
+		int attrBegin,keyBegin,keyEnd;
+		if(IsAttrRead(code,from,begin,split))
+		{
+			keyBegin=split;
+			keyEnd=end-1;
+		}
+		else if(IsAttrRead(code,from,split,end-1))
+		{
+			keyBegin=begin;
+			keyEnd=split;
+			if(op==OP_LT)
+				op=OP_GT;
+			else if(op==OP_GT)
+				op=OP_LT;
+			else if(op==OP_LE)
+				op=OP_GE;
+			else if(op==OP_GE)
+				op=OP_LE;
+		}
+		else
+			return false;
+		attrBegin=(keyBegin==begin)?split:begin;
+		for(int pc=keyBegin;pc<keyEnd;pc++)
+		{
+			int kop=code.ins[pc].op;
+			if(kop==DOP_PUSH_OBJECT || kop==OP_OBJGETATTR || kop==OP_OBJCALL || kop==OP_PTRCALC)
+				return false;
+		}
+		plan.key.assign(exp.begin()+keyBegin,exp.begin()+keyEnd);
+		plan.key.push_back(OP_POP<<24);
+		DecodeInstructions(plan.key,plan.decodedKey);
+		if(plan.decodedKey.maxStack<0)
+		{
+			plan=IndexPlan();
+			return false;
+		}
+		CComVariant attr=StrConstant(code.ins[attrBegin+1].index);
+		plan.attr=ReadIString(attr);
+		plan.op=op;
+		return true;
+	}
+	//ָǡΪȡFROMԴfromĶһ
+	static inline bool IsAttrRead(const DecodedCode& code,int from,int begin,int end)
+	{
+		if(end-begin!=3)
+			return false;
+		return code.ins[begin].op==DOP_PUSH_OBJECT && code.ins[begin].index==from
+			&& code.ins[begin+1].op==DOP_PUSH_STR && code.ins[begin+2].op==OP_OBJGETATTR;
+	}
+	//ԳӼӱʽеָ
+	static inline bool PlanSafe(int op)
+	{
+		switch(op)
+		{
+		case OP_POP:
+		case OP_JMP:
+		case OP_JZ:
+		case OP_JNZ:
+		case DOP_JZ_KEEP:
+		case DOP_JNZ_KEEP:
+		case OP_TABLE_JMP:
+		case OP_RETURN:
+		case OP_CALL:
+		case OP_OBJSETATTR:
+		case OP_INC:
+		case OP_DEC:
+		case OP_EXECQUERY:
+		case OP_ADDR:
+			return false;
+		}
+		if(op>=OP_ASSIGN && op<=OP_RS_ASSIGN)
+			return false;
+		return true;
+	}
+	inline bool QueryDecoded(int index)
+	{
+		if(index<0 || index>=MAXQUERY || !oqls[index])
+			return false;
+		DecodedCodes& dexps=oqls[index]->decodedExpressions;
+		if(dexps.size()!=oqls[index]->expressions.size())
+			return false;
+		for(UINT i=0;i<dexps.size();i++)
+		{
+			if(dexps[i].maxStack<0)
+				return false;
+		}
+		return true;
+	}
+	//һָֵջȡ޷ĲջȲһʱmaxStackΪ-1
+	//öָԭѭִСԤ·ľֲǴֵȡַָҲԤ롣
+	inline void DecodeInstructions(const Instructions& ins,DecodedCode& code)
+	{
+		int num=ins.size();
+		code.maxStack=-1;
+		code.ins.resize(num);
+		code.caches.clear();
+		for(int pc=0;pc<num;pc++)
+		{
+			DWORD c=ins[pc];
+			DecodedIns& d=code.ins[pc];
+			d.op=(c&0xff000000)>>24;
+			d.operand=(c&0x00ffffff);
+			d.index=d.operand;
+			switch(d.op)
+			{
+			case OP_PUSH:
+				{
+					int lv=(d.operand&0xf00000)>>16;
+					int type=(d.operand&0x0f0000)>>16;
+					int index=(d.operand&0xffff);
+					d.index=index;
+					switch(type)
+					{
+					case 0:
+						d.op=DOP_PUSH_LOCAL;
+						break;
+					case 1:
+						if(index>=intConstants.size())
+							return;
+						d.op=DOP_PUSH_INT;
+						d.index=intConstants[index];
+						break;
+					case 2:
+						if(index>=doubleConstants.size())
+							return;
+						d.op=DOP_PUSH_DOUBLE;
+						break;
+					case 3:
+						if(index>=strConstants.size())
+							return;
+						d.op=DOP_PUSH_STR;
+						break;
+					case 4:
+						d.op=DOP_PUSH_ARG;
+						break;
+					case 5:
+						if(index>=globalVariables.size())
+							return;
+						d.op=DOP_PUSH_GLOBAL;
+						break;
+					case 6:
+						d.op=DOP_PUSH_OBJECT;
+						break;
+					default:
+						d.op=DOP_NOP;
+						break;
+					}
+					if(lv>0 && (type==0 || type==4 || type==5))
+					{
+						d.op=DOP_PUSH_LVALUE;
+						d.index=d.operand&0x0fffff;
+					}
+				}
+				break;
+			case OP_JMP:
+				{
+					int type=(d.operand&0xff0000)>>16;
+					int offset=(d.operand&0xffff);
+					d.index=pc+1;
+					if(type==0)
+						d.index=pc+offset+1;
+					else if(type==1)
+						d.index=pc-offset+1;
+				}
+				break;
+			case OP_JZ:
+			case OP_JNZ:
+				{
+					int flag=(d.operand&0xf00000)>>16;
+					int type=(d.operand&0x0f0000)>>16;
+					int offset=(d.operand&0xffff);
+					d.index=pc+1;
+					if(type==0)
+						d.index=pc+offset+1;
+					else if(type==1)
+						d.index=pc-offset+1;
+					if(flag!=0)
+						d.op=(d.op==OP_JZ)?DOP_JZ_KEEP:DOP_JNZ_KEEP;
+				}
+				break;
+			case OP_TABLE_JMP:
+				{
+					if(d.operand>=switchInfos.size())
+						return;
+				}
+				break;
+			case OP_OBJCALL:
+			case OP_OBJGETATTR:
+			case OP_OBJSETATTR:
+				//ÿԶд뷽ָһ棬ȡoperand
+				d.index=code.caches.size();
+				code.caches.push_back(InlineCache());
+				break;
+			case OP_ADDR:
+				{
+					int type=(d.operand & 0x0f0000)>>16;
+					if(type!=5 || (d.operand & 0x00ffff)>=globalVariables.size())
+						return;
+				}
+				break;
+			case OP_EXECQUERY:
+				{
+					if(!QueryDecoded(d.operand))
+						return;
+				}
+				break;
+			}
+			if((d.op==OP_JMP || d.op==OP_JZ || d.op==OP_JNZ || d.op==DOP_JZ_KEEP || d.op==DOP_JNZ_KEEP) && (d.index<0 || d.index>num))
+				return;
+		}
+		//ÿָڴջ
+		std::vector<int> depth(num+1,-1);
+		std::vector<int> work;
+		std::vector<int> succ;
+		int maxDepth=0;
+		depth[0]=0;
+		work.push_back(0);
+		while(!work.empty())
+		{
+			int pc=work.back();
+			work.pop_back();
+			if(pc>=num)
+				continue;
+			const DecodedIns& d=code.ins[pc];
+			int pops=0,pushes=0;
+			StackEffect(d,pops,pushes);
+			int dp=depth[pc];
+			if(dp<pops)
+				return;
+			int after=dp-pops+pushes;
+			if(after>maxDepth)
+				maxDepth=after;
+			succ.clear();
+			switch(d.op)
+			{
+			case OP_RETURN:
+				break;
+			case OP_JMP:
+				succ.push_back(d.index);
+				break;
+			case OP_JZ:
+			case OP_JNZ:
+			case DOP_JZ_KEEP:
+			case DOP_JNZ_KEEP:
+				succ.push_back(pc+1);
+				succ.push_back(d.index);
+				break;
+			case OP_TABLE_JMP:
+				{
+					SwitchInfo& info=switchInfos[d.operand];
+					Cases::iterator cit=info.cases.begin();
+					for(;cit!=info.cases.end();cit++)
+						succ.push_back(pc+1+cit->second);
+					succ.push_back(pc+1+info.def);
+				}
+				break;
+			default:
+				succ.push_back(pc+1);
+				break;
+			}
+			for(UINT i=0;i<succ.size();i++)
+			{
+				int next=succ[i];
+				if(next<0 || next>num)
+					return;
+				if(depth[next]<0)
+				{
+					depth[next]=after;
+					work.push_back(next);
+				}
+				else if(depth[next]!=after)
+					return;
+			}
+		}
+		code.maxStack=maxDepth;
+	}
+	static inline void StackEffect(const DecodedIns& d,int& pops,int& pushes)
+	{
+		pops=0;
+		pushes=0;
+		switch(d.op)
+		{
+		case DOP_PUSH_LOCAL:
+		case DOP_LOCAL_INT_OP:
+		case DOP_LOCAL_LOCAL_OP:
+		case DOP_PUSH_INT:
+		case DOP_PUSH_DOUBLE:
+		case DOP_PUSH_STR:
+		case DOP_PUSH_ARG:
+		case DOP_PUSH_GLOBAL:
+		case DOP_PUSH_OBJECT:
+		case DOP_PUSH_LVALUE:
+		case OP_ADDR:
+			pushes=1;
+			break;
+		case OP_POP:
+		case OP_JZ:
+		case OP_JNZ:
+		case OP_TABLE_JMP:
+		case OP_RETURN:
+			pops=1;
+			break;
+		case DOP_JZ_KEEP:
+		case DOP_JNZ_KEEP:
+		case OP_NEG:
+		case OP_NOT:
+		case OP_USUB:
+		case OP_INC:
+		case OP_DEC:
+		case OP_EXECQUERY:
+		case OP_ARG:
+			pops=1;
+			pushes=1;
+			break;
+		case OP_CALL:
+			pops=d.operand+1;
+			pushes=1;
+			break;
+		case OP_OBJCALL:
+			pops=d.operand+2;
+			pushes=1;
+			break;
+		case OP_OBJSETATTR:
+			pops=3;
+			pushes=1;
+			break;
+		case OP_OBJGETATTR:
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_ANDAND:
+		case OP_OROR:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LS:
+		case OP_RS:
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+		case OP_ASSIGN:
+		case OP_ADD_ASSIGN:
+		case OP_SUB_ASSIGN:
+		case OP_MUL_ASSIGN:
+		case OP_DIV_ASSIGN:
+		case OP_MOD_ASSIGN:
+		case OP_AND_ASSIGN:
+		case OP_OR_ASSIGN:
+		case OP_XOR_ASSIGN:
+		case OP_LS_ASSIGN:
+		case OP_RS_ASSIGN:
+		case OP_COMMA:
+		case OP_PTRINFO:
+		case OP_PTRCALC:
+		case OP_CAST:
+			pops=2;
+			pushes=1;
+			break;
+		}
+	}
+	//ַڲַװɼִʱȫ죻
+	//˺ĳﲹפ½
+	inline CComVariant& StrConstant(int index)
+	{
+		if(index>=(int)istrConstants.size())
+		{
+			SharedLock lock(program,program->globalCriticalSection);
+			InternConstants();
+		}
+		return istrConstants[index];
+	}
+	//δַפͬĳͬһڲַɢֵԤ
+	//ִʱٽ빹죬ݱȽϵĳֱ֮Ӱָɢֵж
+	inline void InternConstants(void)
+	{
+		for(UINT i=istrConstants.size();i<strConstants.size();i++)
+		{
+			CString s=DecodeStrConstant(i);
+			InternTable::iterator it=internTable.find(s);
+			if(it!=internTable.end())
+			{
+				istrConstants.push_back(istrConstants[it->second]);
+				continue;
+			}
+			CComVariant str=BuildIString((LPCSTR)s);
+			Scriptc::StringObj<ScriptcRuntime>* p=static_cast<Scriptc::StringObj<ScriptcRuntime>*>(str.pdispVal);
+			p->Hash();
+			p->MarkConstant();
+			internTable[s]=i;
+			istrConstants.push_back(str);
+		}
+	}
+	inline CString DecodeStrConstant(int index)
+	{
+#ifdef ENCODE_STRING
+		CString& d=strConstants[index];
+		int len=d.GetLength();
+		char* buf=constStringBuffer;
+		ScriptFile::MemCpy(buf,d,len+1);
+		ScriptFile::UnRotateKey((UCHAR*)buf);
+		return CString(buf);
+#else
+		return strConstants[index];
+#endif
+	}
+	//VARIANTתΪֵBSTRתΪڲַ
+	static inline void ToValue(const VARIANT& v,TaggedValue& r)
+	{
+		switch(v.vt)
+		{
+		case VT_EMPTY:
+			r.Clear();
+			break;
+		case VT_I4:
+			r.SetInt(v.lVal);
+			break;
+		case VT_R8:
+			r.SetDouble(v.dblVal);
+			break;
+		case VT_DISPATCH:
+			if(v.pdispVal)
+				v.pdispVal->AddRef();
+			r.AttachObject(v.pdispVal);
+			break;
+		case VT_BSTR:
+			{
+				CComVariant str=VariantToScript(v);
+				ToValue(str,r);
+			}
+			break;
+		default:
+			r.AttachBox(new CComVariant(v));
+			break;
+		}
+	}
+	//VARIANTֵֵװֵãvݿܱ
+	static inline void MoveToValue(CComVariant& v,TaggedValue& r)
+	{
+		switch(v.vt)
+		{
+		case VT_DISPATCH:
+			r.AttachObject(v.pdispVal);
+			v.vt=VT_EMPTY;
+			break;
+		case VT_EMPTY:
+		case VT_I4:
+		case VT_R8:
+		case VT_BSTR:
+			ToValue(v,r);
+			break;
+		default:
+			{
+				CComVariant* box=new CComVariant;
+				box->Attach(&v);
+				r.AttachBox(box);
+			}
+			break;
+		}
+	}
+	static inline void ToVariant(const TaggedValue& v,CComVariant& r)
+	{
+		switch(v.tag)
+		{
+		case TAG_INT:
+			r=(long)v.i;
+			break;
+		case TAG_DOUBLE:
+			r=v.d;
+			break;
+		case TAG_OBJECT:
+			r=v.o;
+			break;
+		case TAG_BOXED:
+			r=*v.b;
+			break;
+		default:
+			r.Clear();
+			break;
+		}
+	}
+	//ѴֵVARIANTvΪֵ
+	static inline void MoveToVariant(TaggedValue& v,CComVariant& r)
+	{
+		if(v.tag==TAG_OBJECT)
+		{
+			r.Clear();
+			r.vt=VT_DISPATCH;
+			r.pdispVal=v.DetachObject();
+		}
+		else if(v.tag==TAG_BOXED)
+		{
+			CComVariant* box=v.DetachBox();
+			r.Attach(box);
+			delete box;
+		}
+		else
+		{
+			ToVariant(v,r);
+			v.Clear();
+		}
+	}
+	//Ԫͨʵ֣ԭѭи֧һ£Ԥ·ڿٷ֧ʱ
+	static inline CComVariant CalcBinary(int op,CComVariant op1,CComVariant op2)
+	{
+		switch(op)
+		{
+		case OP_ADD:
+			{
+				if(IsIString(op1))
+				{
+					CString& t1=ReadIString(op1);
+					CString t2=ScriptToString(op2);
+					return BuildIString(t1+t2);
+				}
+				else if(IsIString(op2))
+				{
+					CString t1=ScriptToString(op1);
+					CString& t2=ReadIString(op2);
+					return BuildIString(t1+t2);
+				}
+				else if(op1.vt==VT_R8 || op2.vt==VT_R8)
+				{
+					op1.ChangeType(VT_R8);
+					op2.ChangeType(VT_R8);
+					return CComVariant(op1.dblVal+op2.dblVal);
+				}
+				return CComVariant(op1.lVal+op2.lVal);
+			}
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+			{
+				if(op1.vt==VT_R8 || op2.vt==VT_R8)
+				{
+					op1.ChangeType(VT_R8);
+					op2.ChangeType(VT_R8);
+					if(op==OP_SUB)
+						op1.dblVal-=op2.dblVal;
+					else if(op==OP_MUL)
+						op1.dblVal*=op2.dblVal;
+					else
+						op1.dblVal/=op2.dblVal;
+				}
+				else
+				{
+					if(op==OP_SUB)
+						op1.lVal-=op2.lVal;
+					else if(op==OP_MUL)
+						op1.lVal*=op2.lVal;
+					else
+						op1.lVal/=op2.lVal;
+				}
+				return op1;
+			}
+		case OP_MOD:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+			{
+				if(op1.vt==VT_R8 || op2.vt==VT_R8)
+				{
+					op1.ChangeType(VT_R8);
+					op2.ChangeType(VT_R8);
+					unsigned __int64 v1=(unsigned __int64)op1.dblVal;
+					unsigned __int64 v2=(unsigned __int64)op2.dblVal;
+					if(op==OP_MOD)
+						op1.dblVal=(DOUBLE)(v1%v2);
+					else if(op==OP_AND)
+						op1.dblVal=(DOUBLE)(v1&v2);
+					else if(op==OP_OR)
+						op1.dblVal=(DOUBLE)(v1|v2);
+					else
+						op1.dblVal=(DOUBLE)(v1^v2);
+				}
+				else
+				{
+					if(op==OP_MOD)
+						op1.ulVal%=op2.ulVal;
+					else if(op==OP_AND)
+						op1.ulVal&=op2.ulVal;
+					else if(op==OP_OR)
+						op1.ulVal|=op2.ulVal;
+					else
+						op1.ulVal^=op2.ulVal;
+				}
+				return op1;
+			}
+		case OP_LS:
+			{
+				if(op1.vt==VT_R8)
+					op1.dblVal=(DOUBLE)(((unsigned __int64)op1.dblVal)<<op2.ulVal);
+				else
+					op1.ulVal<<=op2.ulVal;
+				return op1;
+			}
+		case OP_RS:
+			{
+				if(op1.vt==VT_R8)
+					op1.dblVal=(DOUBLE)(((__int64)op1.dblVal)>>op2.ulVal);
+				else
+					op1.ulVal>>=op2.ulVal;
+				return op1;
+			}
+		case OP_ANDAND:
+			return CComVariant((op1.boolVal && op2.boolVal)?TRUE:FALSE);
+		case OP_OROR:
+			return CComVariant((op1.boolVal || op2.boolVal)?TRUE:FALSE);
+		case OP_EQ:
+		case OP_NE:
+			{
+				bool eq;
+				if(IsIString(op1) && IsIString(op2))
+					eq=(ReadIString(op1)==ReadIString(op2));
+				else if(op1.vt==VT_R8 && op2.vt==VT_R8)
+					eq=(op1.dblVal==op2.dblVal);
+				else
+					eq=(op1.lVal==op2.lVal);
+				if(op==OP_NE)
+					eq=!eq;
+				return CComVariant(eq?TRUE:FALSE);
+			}
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			{
+				int cmp;
+				if(IsIString(op1) && IsIString(op2))
+				{
+					CString& t1=ReadIString(op1);
+					CString& t2=ReadIString(op2);
+					cmp=(t1<t2)?-1:((t1>t2)?1:0);
+				}
+				else if(op1.vt==VT_R8 || op2.vt==VT_R8)
+				{
+					op1.ChangeType(VT_R8);
+					op2.ChangeType(VT_R8);
+					cmp=(op1.dblVal<op2.dblVal)?-1:((op1.dblVal>op2.dblVal)?1:0);
+				}
+				else
+					cmp=(op1.lVal<op2.lVal)?-1:((op1.lVal>op2.lVal)?1:0);
+				bool r;
+				if(op==OP_LT)
+					r=(cmp<0);
+				else if(op==OP_GT)
+					r=(cmp>0);
+				else if(op==OP_LE)
+					r=(cmp<=0);
+				else
+					r=(cmp>=0);
+				return CComVariant(r?TRUE:FALSE);
+			}
+		}
+		return CComVariant(0);
+	}
+	//һԪͨʵ
+	static inline CComVariant CalcUnary(int op,CComVariant op1)
+	{
+		switch(op)
+		{
+		case OP_NEG:
+			if(op1.vt==VT_R8)
+				op1.dblVal=(DOUBLE)(~((unsigned __int64)op1.dblVal));
+			else
+				op1.ulVal=~op1.ulVal;
+			return op1;
+		case OP_NOT:
+			return CComVariant((!op1.boolVal)?TRUE:FALSE);
+		case OP_USUB:
+			if(op1.vt==VT_R8)
+				op1.dblVal=-op1.dblVal;
+			else
+				op1.lVal=-op1.lVal;
+			return op1;
+		}
+		return op1;
+	}
+	//ֵĶԪ㣬븡ԭؼ㣬תΪVARIANTͨʵ֣дop1
+	static inline void CalcBinary(int op,TaggedValue& op1,const TaggedValue& op2)
+	{
+		bool done=false;
+		switch(op)
+		{
+		case OP_ADD:
+			done=TaggedArith::Add(op1,op2);
+			break;
+		case OP_SUB:
+			done=TaggedArith::Sub(op1,op2);
+			break;
+		case OP_MUL:
+			done=TaggedArith::Mul(op1,op2);
+			break;
+		case OP_DIV:
+			done=TaggedArith::Div(op1,op2);
+			break;
+		case OP_MOD:
+			done=TaggedArith::Bits(0,op1,op2);
+			break;
+		case OP_AND:
+			done=TaggedArith::Bits(1,op1,op2);
+			break;
+		case OP_OR:
+			done=TaggedArith::Bits(2,op1,op2);
+			break;
+		case OP_XOR:
+			done=TaggedArith::Bits(3,op1,op2);
+			break;
+		case OP_LS:
+			done=TaggedArith::Shl(op1,op2);
+			break;
+		case OP_RS:
+			done=TaggedArith::Shr(op1,op2);
+			break;
+		case OP_ANDAND:
+			done=TaggedArith::AndAnd(op1,op2);
+			break;
+		case OP_OROR:
+			done=TaggedArith::OrOr(op1,op2);
+			break;
+		case OP_EQ:
+		case OP_NE:
+			done=TaggedArith::Equal(op1,op2,op==OP_NE);
+			break;
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			done=TaggedArith::Compare(op-OP_LT,op1,op2);
+			break;
+		}
+		if(done)
+			return;
+		CComVariant v1,v2;
+		MoveToVariant(op1,v1);
+		ToVariant(op2,v2);
+		CComVariant res=CalcBinary(op,v1,v2);
+		MoveToValue(res,op1);
+	}
+	//ֵһԪ
+	static inline void CalcUnary(int op,TaggedValue& op1)
+	{
+		bool done=false;
+		switch(op)
+		{
+		case OP_NEG:
+			done=TaggedArith::Neg(op1);
+			break;
+		case OP_NOT:
+			done=TaggedArith::Not(op1);
+			break;
+		case OP_USUB:
+			done=TaggedArith::USub(op1);
+			break;
+		}
+		if(done)
+			return;
+		CComVariant v1;
+		MoveToVariant(op1,v1);
+		CComVariant res=CalcUnary(op,v1);
+		MoveToValue(res,op1);
+	}
+	//ԼĲ븡ʱԭѭķʽ޸lVal
+	static inline void StepOther(TaggedValue& val,int delta)
+	{
+		CComVariant v;
+		MoveToVariant(val,v);
+		v.lVal+=delta;
+		MoveToValue(v,val);
+	}
+	inline double DoubleConstant(int index)
+	{
+		return doubleConstants[index];
+	}
+	//ǿתͨʵ֣sizeͬԭѭOP_CAST
+	static inline void CalcCast(CComVariant& res,int size)
+	{
+		switch(size)
+		{
+		case 1:
+			res.ChangeType(VT_UI1);
+			break;
+		case 2:
+			res.ChangeType(VT_I2);
+			break;
+		case 3:
+			res.ChangeType(VT_UI2);
+			break;
+		case 4:
+			res.ChangeType(VT_I4);
+			break;
+		case 5:
+			res.ChangeType(VT_UI4);
+			break;
+		case 8:
+			res.ChangeType(VT_R8);
+			break;
+		case 9:
+			res=BuildIString(ScriptToString(res));
+			break;
+		case 11:
+			res.ChangeType(VT_DISPATCH);
+			break;
+		}
+	}
+private:
+	//ָϢ32λΪʹС32λΪַȡڴеֵ
+	static inline CComVariant ReadPointer(double ptr)
+	{
+		__int64 ptrinfo=(__int64)ptr;
+		int addr=int(ptrinfo & 0x00000000ffffffff);
+		int size=int((ptrinfo & 0xffffffff00000000)>>32);
+		switch(size)
 		{
-			FromList::iterator it=std::find(oqls[index]->fromList.begin(),oqls[index]->fromList.end(),oqls[index]->selectList[i]);
-			int d=std::distance(oqls[index]->fromList.begin(),it);
-			Objects& objs=(*pObjList)[d];
-			Objects::iterator oit=objs.begin();
-			while(oit!=objs.end())
+		case 1:
+			{
+				return CComVariant(*(BYTE*)addr);
+			}
+		case 2:
+			{	
+				return CComVariant(*(SHORT*)addr);
+			}
+		case 3:
+			{	
+				return CComVariant(*(USHORT*)addr);
+			}
+		case 4:
+			{
+				return CComVariant(*(LONG*)addr);
+			}
+		case 5:
+			{
+				return CComVariant(*(ULONG*)addr);
+			}
+		case 8:
+			{
+				return CComVariant(*(double*)addr);
+			}
+		case 9:
+			{
+				return BuildIString(CString((BSTR)addr));
+			}
+		case 10:
+			{
+				return BuildIString((const char*)addr);
+			}
+		case 11:
+			{
+				return CComVariant(*(IDispatch**)addr);
+			}
+		case 12:
 			{
-				objects.push_back(*oit);
-				oit++;
+				return *(CComVariant*)addr;
 			}
 		}
-		int len=objects.size();
-		//ʵORDER BYӾĹ
-		if(oqls[index]->sort!=-1 && len>0)
+		return CComVariant(0);
+	}
+	//ָϢڴдֵ
+	static inline void WritePointer(double ptr,const CComVariant& newVal)
+	{
+		__int64 ptrinfo=(__int64)ptr;
+		int addr=int(ptrinfo & 0x00000000ffffffff);
+		int size=int((ptrinfo & 0xffffffff00000000)>>32);
+		switch(size)
 		{
-			Objects::iterator it;
-			int order=(oqls[index]->sort & 0xFF000000)>>24;
-			switch(order)
+		case 1:
 			{
-			case 0:
-				//std::stable_sort(objects.begin(),objects.end(),CompareT<true>(&orders));
-				objects.sort(CompareT<true>(&orders));
-				break;
-			case 1:
-				//std::stable_sort(objects.begin(),objects.end(),CompareT<false>(&orders));
-				objects.sort(CompareT<false>(&orders));
-				break;
-			case 2:
+				*(BYTE*)addr=newVal.bVal;
+			}
+			break;
+		case 2:
+			{	
+				*(SHORT*)addr=newVal.iVal;
+			}
+			break;
+		case 3:
+			{	
+				*(USHORT*)addr=newVal.iVal;
+			}
+			break;
+		case 4:
+			{
+				*(LONG*)addr=newVal.lVal;
+			}
+			break;
+		case 5:
+			{
+				*(LONG*)addr=newVal.lVal;
+			}
+			break;
+		case 8:
+			{
+				*(DOUBLE*)addr=newVal.dblVal;
+			}
+			break;
+		case 9:
+			{
+				if(IsIString(newVal))
 				{
-					it=std::max_element(objects.begin(),objects.end(),CompareT<true>(&orders));
-					Objects::iterator fit=objects.begin();
-					CComVariant obj=*it;
-					*it=*fit;
-					*fit=obj;
+					CString& t=ReadIString(newVal);
+					BSTR bstr=t.AllocSysString();
+					int len=::SysStringLen(bstr)*2+2;//BSTR 2ֽ0βÿĸռ2ֽ
+					::memcpy((void*)(addr-4),(void*)((int)bstr-4),len+4);//BSTR 4ֽǰ
+					::SysFreeString(bstr);
 				}
-				break;
-			case 3:
+			}
+			break;
+		case 10:
+			{
+				if(IsIString(newVal))
 				{
-					it=std::min_element(objects.begin(),objects.end(),CompareT<true>(&orders));
-					Objects::iterator fit=objects.begin();
-					CComVariant obj=*it;
-					*it=*fit;
-					*fit=obj;
-				}
-				break;
+					CString& t=ReadIString(newVal);
+					::strcpy((char*)addr,t);
+				}					
 			}
-		}
-		if(objnum==1)
-		{
-			if(len<=0)
-				return 0;		
-			*result=objects.front();
-			return 1;
-		}
-		else
-		{
-			//objnum<=0ʱȡѯȫ󣬷ȡǰnum
-			if(objnum>1 && objnum<len)
-				len=objnum;
-			SAFEARRAY* psa=::SafeArrayCreateVector(VT_VARIANT,0,len);
-			Objects::iterator it=objects.begin();
-			for(LONG ii=0;ii<len && it!=objects.end();ii++,it++)
-			{			
-				::SafeArrayPutElement(psa,&ii,&(*it));
-			}			
-			VARIANT var;
-			::VariantInit(&var);
-			var.vt=VT_ARRAY|VT_VARIANT;
-			var.parray=psa;
-			*result=var;
-			::SafeArrayDestroy(psa);
-			return len;
+			break;
+		case 11:
+			{
+				*(IDispatch**)addr=newVal.pdispVal;
+				newVal.pdispVal->AddRef();
+			}
+			break;
+		case 12:
+			{
+				*(CComVariant*)addr=newVal;
+			}
+			break;
 		}
 	}
-	inline CComVariant CalcExpression(int oqlix,int index,Variables& localVariables,CComVariant* externArgs,int argnum,const Objects* pobjects)
-	{
-		Instructions& ins=oqls[oqlix]->GetExpression(index);		
-		return Exec(ins,localVariables,externArgs,argnum,pobjects);
-	}
-private:
 	inline CComVariant GetLValue(Variables& localVariables,CComVariant* externArgs,int argnum,const CComVariant& vop)
 	{
 		if(vop.vt==VT_I4)
@@ -2796,57 +6449,16 @@ private:
 					return externArgs[index];
 				}
 			case 5://ȫֱ
-				return globalVariables[index];
+				{
+					SharedLock lock(program,program->globalCriticalSection);
+					CComVariant val=globalVariables[index];
+					return val;
+				}
 			}
 		}
 		else if(vop.vt==VT_R8)
 		{
-			__int64 ptrinfo=(__int64)vop.dblVal;
-			int addr=int(ptrinfo & 0x00000000ffffffff);
-			int size=int((ptrinfo & 0xffffffff00000000)>>32);
-			switch(size)
-			{
-			case 1:
-				{
-					return CComVariant(*(BYTE*)addr);
-				}
-			case 2:
-				{	
-					return CComVariant(*(SHORT*)addr);
-				}
-			case 3:
-				{	
-					return CComVariant(*(USHORT*)addr);
-				}
-			case 4:
-				{
-					return CComVariant(*(LONG*)addr);
-				}
-			case 5:
-				{
-					return CComVariant(*(ULONG*)addr);
-				}
-			case 8:
-				{
-					return CComVariant(*(double*)addr);
-				}
-			case 9:
-				{
-					return BuildIString(CString((BSTR)addr));
-				}
-			case 10:
-				{
-					return BuildIString((const char*)addr);
-				}
-			case 11:
-				{
-					return CComVariant(*(IDispatch**)addr);
-				}
-			case 12:
-				{
-					return *(CComVariant*)addr;
-				}
-			}
+			return ReadPointer(vop.dblVal);
 		}
 		return CComVariant(0);
 	}
@@ -2870,81 +6482,81 @@ private:
 				}
 				break;
 			case 5://ȫֱ
-				globalVariables[index]=newVal;
+				{
+					SharedLock lock(program,program->globalCriticalSection);
+					globalVariables[index]=newVal;
+				}
 				break;
 			}		
 		}
 		else if(vop.vt==VT_R8)
 		{
-			__int64 ptrinfo=(__int64)vop.dblVal;
-			int addr=int(ptrinfo & 0x00000000ffffffff);
-			int size=int((ptrinfo & 0xffffffff00000000)>>32);
-			switch(size)
+			WritePointer(vop.dblVal,newVal);
+		}
+	}
+	//Ԥ·ֵдֲΪֵȫֱָڱ߽紦ת
+	inline void GetLValue(TaggedValue* locals,TaggedValue* args,int argnum,const TaggedValue& vop,TaggedValue& r)
+	{
+		if(vop.tag==TAG_INT)
+		{
+			int type=(vop.i & 0x0f0000)>>16;
+			int index=(vop.i & 0x00ffff);
+			switch(type)
 			{
-			case 1:
-				{
-					*(BYTE*)addr=newVal.bVal;
-				}
-				break;
-			case 2:
-				{	
-					*(SHORT*)addr=newVal.iVal;
-				}
-				break;
-			case 3:
-				{	
-					*(USHORT*)addr=newVal.iVal;
-				}
-				break;
-			case 4:
-				{
-					*(LONG*)addr=newVal.lVal;
-				}
-				break;
-			case 5:
-				{
-					*(LONG*)addr=newVal.lVal;
-				}
-				break;
-			case 8:
-				{
-					*(DOUBLE*)addr=newVal.dblVal;
-				}
-				break;
-			case 9:
-				{
-					if(IsIString(newVal))
-					{
-						CString& t=ReadIString(newVal);
-						BSTR bstr=t.AllocSysString();
-						int len=::SysStringLen(bstr)*2+2;//BSTR 2ֽ0βÿĸռ2ֽ
-						::memcpy((void*)(addr-4),(void*)((int)bstr-4),len+4);//BSTR 4ֽǰ
-						::SysFreeString(bstr);
-					}
-				}
-				break;
-			case 10:
+			case 0://ֲ
+				r=locals[index];
+				return;
+			case 4://
+				if(index<0 || index>=argnum)
+					break;
+				r=args[index];
+				return;
+			case 5://ȫֱ
 				{
-					if(IsIString(newVal))
-					{
-						CString& t=ReadIString(newVal);
-						::strcpy((char*)addr,t);
-					}					
+					SharedLock lock(program,program->globalCriticalSection);
+					ToValue(globalVariables[index],r);
 				}
+				return;
+			}
+		}
+		else if(vop.tag==TAG_DOUBLE)
+		{
+			CComVariant v=ReadPointer(vop.d);
+			MoveToValue(v,r);
+			return;
+		}
+		r.SetInt(0);
+	}
+	inline void SetLValue(TaggedValue* locals,TaggedValue* args,int argnum,const TaggedValue& vop,const TaggedValue& newVal)
+	{
+		if(vop.tag==TAG_INT)
+		{
+			int type=(vop.i & 0x0f0000)>>16;
+			int index=(vop.i & 0x00ffff);
+			switch(type)
+			{
+			case 0://ֲ
+				locals[index]=newVal;
 				break;
-			case 11:
-				{
-					*(IDispatch**)addr=newVal.pdispVal;
-					newVal.pdispVal->AddRef();
-				}
+			case 4://
+				if(index<0 || index>=argnum)
+					return;
+				args[index]=newVal;
 				break;
-			case 12:
+			case 5://ȫֱ
 				{
-					*(CComVariant*)addr=newVal;
+					SharedLock lock(program,program->globalCriticalSection);
+					ToVariant(newVal,globalVariables[index]);
 				}
 				break;
 			}
 		}
+		else if(vop.tag==TAG_DOUBLE)
+		{
+			CComVariant v;
+			ToVariant(newVal,v);
+			WritePointer(vop.d,v);
+		}
 	}
 	inline CComVariant Exec(Instructions& ins,Variables& localVariables,CComVariant* externArgs,int argnum,const Objects* pobjects=NULL)
 	{
@@ -2967,6 +6579,8 @@ private:
 #endif
 			int op=(code&0xff000000)>>24;
 			int operand=(code&0x00ffffff);
+			if(profiler)
+				profiler->Step(op);
 			switch(op)
 			{
 			case OP_PUSH:
@@ -2997,34 +6611,7 @@ private:
 						}
 						break;
 					case 3:
-						{
-							if(istrConstants.size()<=0)
-							{
-								for(UINT ci=0;ci<strConstants.size();ci++)
-									istrConstants.push_back(CComVariant(0));
-							}
-							CComVariant& str=istrConstants[index];
-							if(str.vt!=VT_DISPATCH || !str.lVal)
-							{
-#ifdef ENCODE_STRING
-								CString& d=strConstants[index];
-								int len=d.GetLength();
-								char* buf=constStringBuffer;
-								ScriptFile::MemCpy(buf,d,len+1);
-								ScriptFile::UnRotateKey((UCHAR*)buf);
-								
-								str=BuildIString(buf);
-								runtimeStack.push(str);
-#else
-								str=BuildIString((LPCSTR)strConstants[index]);
-								runtimeStack.push(str);
-#endif						
-							}
-							else
-							{								
-								runtimeStack.push(str);
-							}
-						}
+						runtimeStack.push(StrConstant(index));
 						break;
 					case 4:
 						{
@@ -3044,14 +6631,15 @@ private:
 							if(lv>0)								
 								runtimeStack.push(CComVariant(operand&0x0fffff));
 							else
+							{
+								SharedLock lock(program,program->globalCriticalSection);
 								runtimeStack.push(globalVariables[index]);
+							}
 						}
 						break;
 					case 6:
 						{							
-							Objects::const_iterator it=pobjects->begin();
-							std::advance(it,index);
-							runtimeStack.push(*it);
+							runtimeStack.push((*pobjects)[index]);
 						}
 						break;
 					}
@@ -3139,16 +6727,12 @@ private:
 					SwitchInfo& info=switchInfos[operand];
 					CComVariant op1=runtimeStack.top();
 					runtimeStack.pop();
-					Cases::iterator cit=info.cases.find(op1.lVal);
-					if(cit!=info.cases.end())
-						it+=cit->second;
-					else
-						it+=info.def;
+					it+=SwitchTarget(info,op1.lVal);
 				}
 				break;
 			case OP_CALL:
 				{
-					CComVariant* args=new CComVariant[operand];
+					CComVariant* args=AllocArgs(operand);
 					for(int i=0;i<operand;i++)
 					{
 						args[operand-i-1]=runtimeStack.top();
@@ -3167,7 +6751,7 @@ private:
 						CComVariant res=CallFunction(func,args,operand);
 						runtimeStack.push(res);
 					}
-					delete[] args;
+					FreeArgs(args);
 				}
 				break;	
 			case OP_RETURN:
@@ -3179,7 +6763,7 @@ private:
 				break;
 			case OP_OBJCALL:
 				{
-					CComVariant* args=new CComVariant[operand];
+					CComVariant* args=AllocArgs(operand);
 					for(int i=0;i<operand;i++)
 					{
 						args[operand-i-1]=runtimeStack.top();
@@ -3192,7 +6776,7 @@ private:
 					//ִж
 					CComVariant res=CallObject(obj,func,args,operand);
 					runtimeStack.push(res);
-					delete[] args;
+					FreeArgs(args);
 				}
 				break;	
 			case OP_OBJGETATTR:
@@ -4058,6 +7642,219 @@ funcexit:
 #endif
 		return popVal;
 	}
+	//ԤִָѭװʱֵջΪԤĹ̶顣
+	//ֵջֲǴֵ븡㲻VARIANT
+	//ֻڵⲿ󷽷ԡִвѯʱڱ߽紦ת
+	//ÿķǰѾֲջָͬstack.top
+	inline void ExecDecoded(DecodedCode& code,TaggedValue* locals,TaggedValue* args,int argnum,const Objects* pobjects,TaggedValue& result)
+	{
+		ExecDecoded(valueStack,code,locals,args,argnum,pobjects,result);
+	}
+	//stackǽֵջʱڲй˵Ĺִ߳УֻParallelSafeָ
+	inline void ExecDecoded(ValueStack& stack,DecodedCode& code,TaggedValue* locals,TaggedValue* args,int argnum,const Objects* pobjects,TaggedValue& result)
+	{
+		int num=code.ins.size();
+		if(num<=0)
+			return;
+		const DecodedIns* pins=&code.ins[0];
+		TaggedValue* base=stack.top;
+		TaggedValue* sp=base;
+		ScriptProfiler* prof=(&stack==&valueStack)?profiler:NULL;
+		int pc=0;
+		if(code.jit && !prof && &stack==&valueStack)
+		{
+			//ִʱ-1ȥŻʱӷصλüִ
+			JitFrame frame;
+			frame.locals=locals;
+			frame.args=args;
+			frame.argnum=argnum;
+			frame.sp=sp;
+			frame.result=&result;
+			pc=code.jit(&frame);
+			sp=frame.sp;
+			if(pc<0)
+				pc=num;
+		}
+		while(pc<num)
+		{
+			const DecodedIns& d=pins[pc++];
+			if(prof)
+				prof->Step(d.op);
+			//ģ帲ǵָDecodedExecִУﴦ
+			if(DecodedExec::Step(*this,pins,d,pc,sp,locals,args,argnum,result))
+				continue;
+			switch(d.op)
+			{
+			case DOP_PUSH_STR:
+				ToValue(StrConstant(d.index),*sp++);
+				break;
+			case DOP_PUSH_GLOBAL:
+				{
+					SharedLock lock(program,program->globalCriticalSection);
+					ToValue(globalVariables[d.index],*sp++);
+				}
+				break;
+			case DOP_PUSH_OBJECT:
+				ToValue((*pobjects)[d.index],*sp++);
+				break;
+			case OP_TABLE_JMP:
+				{
+					SwitchInfo& info=switchInfos[d.operand];
+					--sp;
+					int v=sp->Low32();
+					sp->Clear();
+					pc+=SwitchTarget(info,v);
+				}
+				break;
+			case OP_CALL:
+				{
+					int n=d.operand;
+					int f=sp[-n-1].Low32();
+					TaggedValue res;
+					if(f>0 && f<=USER_FUNCTION_NUM)
+					{
+						//ԭֵջΪĲ֡Ϸʼ
+						TaggedValue* cargs=sp-n;
+						stack.top=sp;
+						CallScript(f-1,cargs,n,res);
+						//뺯ֵ
+						while(sp>cargs-1)
+							(--sp)->Clear();
+					}
+					else if(&stack!=&valueStack)
+					{
+						//ѯḶ́߳ջʱھֲУֻlikein
+						CComVariant local[16];
+						CComVariant* vargs=(n<=16)?local:new CComVariant[n];
+						for(int i=n-1;i>=0;i--)
+							MoveToVariant(*--sp,vargs[i]);
+						(--sp)->Clear();
+						stack.top=sp;
+						CComVariant r=CallPure(f,vargs,n);
+						if(vargs!=local)
+							delete[] vargs;
+						MoveToValue(r,res);
+					}
+					else
+					{
+						CComVariant* vargs=AllocArgs(n);
+						for(int i=n-1;i>=0;i--)
+							MoveToVariant(*--sp,vargs[i]);
+						CComVariant func;
+						MoveToVariant(*--sp,func);
+						stack.top=sp;
+						CComVariant r=CallFunction(func,vargs,n);
+						FreeArgs(vargs);
+						MoveToValue(r,res);
+					}
+					(sp++)->MoveFrom(res);
+				}
+				break;
+			case OP_RETURN:
+				result.MoveFrom(*--sp);
+				goto funcexit;
+			case OP_OBJCALL:
+				{
+					int n=d.operand;
+					CComVariant* vargs=AllocArgs(n);
+					for(int i=n-1;i>=0;i--)
+						MoveToVariant(*--sp,vargs[i]);
+					CComVariant func;
+					MoveToVariant(*--sp,func);
+					CComVariant obj;
+					MoveToVariant(*--sp,obj);
+					stack.top=sp;
+					CComVariant res=CallObject(obj,func,vargs,n,&code.caches[d.index]);
+					FreeArgs(vargs);
+					MoveToValue(res,*sp++);
+				}
+				break;
+			case OP_OBJGETATTR:
+				{
+					CComVariant attr;
+					MoveToVariant(*--sp,attr);
+					CComVariant obj;
+					MoveToVariant(*--sp,obj);
+					stack.top=sp;
+					CComVariant res=(&stack==&valueStack)?GetAttr(obj,attr,&code.caches[d.index]):GetAttrShared(obj,attr);
+					MoveToValue(res,*sp++);
+				}
+				break;
+			case OP_OBJSETATTR:
+				{
+					CComVariant val;
+					MoveToVariant(*--sp,val);
+					CComVariant attr;
+					MoveToVariant(*--sp,attr);
+					CComVariant obj;
+					MoveToVariant(*--sp,obj);
+					stack.top=sp;
+					SetAttr(obj,attr,val,&code.caches[d.index]);
+					MoveToValue(val,*sp++);
+				}
+				break;
+			case OP_EXECQUERY:
+				{
+					int objnum=sp[-1].Low32();
+					(--sp)->Clear();
+					stack.top=sp;
+					CComVariant res;
+					ExecQuery(d.operand,objnum,locals,args,argnum,&res);
+					MoveToValue(res,*sp++);
+				}
+				break;
+			case OP_PTRINFO:
+			case OP_PTRCALC:
+				{
+					__int64 addr=sp[-2].Low32();
+					__int64 size=sp[-1].Low32();
+					__int64 ptrinfo=(size<<32)+addr;
+					(--sp)->Clear();
+					if(d.op==OP_PTRCALC)
+					{
+						CComVariant res=ReadPointer((double)ptrinfo);
+						MoveToValue(res,sp[-1]);
+					}
+					else
+						sp[-1].SetDouble((double)ptrinfo);
+				}
+				break;
+			case OP_ADDR:
+				//ԾֲȡַָԤ룬ֻȫֱ
+				(sp++)->SetInt((long)&(globalVariables[d.operand & 0x00ffff]));
+				break;
+			case OP_CAST:
+				{
+					int size=sp[-1].Low32();
+					(--sp)->Clear();
+					CComVariant res;
+					MoveToVariant(sp[-1],res);
+					CalcCast(res,size);
+					MoveToValue(res,sp[-1]);
+				}
+				break;
+			case OP_ARG:
+				{
+					int type=(d.operand&0x0f0000)>>16;
+					int index=sp[-1].Low32();
+					if(type==0)
+					{
+						if(index<0 || index>=argnum)
+							sp[-1].SetInt(0);
+						else
+							sp[-1]=args[index];
+					}
+					else
+						sp[-1].SetInt(0x040000+(index&0x0ffff));
+				}
+				break;
+			}
+		}
+funcexit:
+		while(sp>base)
+			(--sp)->Clear();
+		stack.top=base;
+	}
 };
 
 
@@ -0,0 +1,447 @@
+#pragma once
+//űӳ.scbʽļͷ֮Ϊɰ8ֽڶĶĩβĶαɣ
+//ȫֵСšδѹӳӳ䵽ڴֱӶȡָ鸴ƣ
+//ѹǿѡģѹʱļͷ֮LZARILZFastѹĶ
+//ڵƫƶڶʼλãַַеƫãָڴе±á
+#include "lzari.h"
+#include "lzfast.h"
+
+#define SCB_VERSION			1
+#define SCB_ALIGN			8
+#define SCB_COMPRESSED		0x0001
+#define SCB_LZFAST			0x0002		//SCB_COMPRESSEDͬʱãLZFastѹ
+
+//ӳűѹʽSCB_PACK_LZARIΪ1ԭtrueʾѹĵò
+#define SCB_PACK_NONE		0
+#define SCB_PACK_LZARI		1
+#define SCB_PACK_LZFAST		2
+
+enum ScriptImageSectionType
+{
+	SCB_SEC_OUTERFUNC=1,	//ⲿ뺯ֵССַ
+	SCB_SEC_SWITCH,			//֧ȱʡֵ֧֧֧ƫ
+	SCB_SEC_INT,			//
+	SCB_SEC_DOUBLE,			//㳣
+	SCB_SEC_STRING,			//ַ
+	SCB_SEC_FUNCTION,		//ֲָڴе±
+	SCB_SEC_GLOBAL,			//ȫֱֵ16λΪͣ16λΪ
+	SCB_SEC_OQL,			//OQLѯ
+	SCB_SEC_CODE,			//OQLʽȫָ
+	SCB_SEC_STRPOOL,		//0βַ
+	SCB_SEC_SWITCHKIND		//֧ʱѡȡıʾʽȱʱװʱѡȡ
+};
+
+struct ScriptImageHeader
+{
+	char tag[4];			//'S','C','B','1'
+	WORD version;
+	WORD flags;
+	UINT size;				//ĴС
+	UINT packedSize;		//ӳеĴСδѹʱsizeͬ
+	UINT tableOffset;		//αƫ
+	UINT sectionNum;
+	UINT reserved[2];
+};
+
+struct ScriptImageSection
+{
+	UINT type;
+	UINT offset;
+	UINT size;
+	UINT count;				//ڵ
+};
+
+struct ScriptImageFunction
+{
+	int varnum;
+	UINT offset;
+	UINT num;
+};
+
+class ScriptImage
+{
+public:
+	static inline bool IsImage(const char* p,int size)
+	{
+		if(size<(int)sizeof(ScriptImageHeader))
+			return false;
+		const ScriptImageHeader* ph=(const ScriptImageHeader*)p;
+		return ph->tag[0]=='S' && ph->tag[1]=='C' && ph->tag[2]=='B' && ph->tag[3]=='1';
+	}
+	static inline UINT AlignUp(UINT v)
+	{
+		return (v+SCB_ALIGN-1)&~(SCB_ALIGN-1);
+	}
+	//ѹĶѹoutoutheader.sizeֽ
+	static inline bool Unpack(const char* p,const ScriptImageHeader& header,char* out)
+	{
+		int size;
+		if(header.flags&SCB_LZFAST)
+		{
+			size=LZFast::Decompress((const BYTE*)p,header.packedSize,(BYTE*)out,header.size);
+		}
+		else
+		{
+			LZARI lzari;
+			size=lzari.DecompressTo((const BYTE*)p,header.packedSize,(BYTE*)out,header.size);
+		}
+		return size==(int)header.size;
+	}
+};
+
+//ӳĶַFinishʱΪд
+class ScriptImageWriter
+{
+	typedef std::vector<ScriptImageSection> Sections;
+	std::vector<char> data;
+	std::vector<int> code;
+	std::vector<char> strpool;
+	Sections sections;
+public:
+	inline void BeginSection(UINT type)
+	{
+		Align();
+		ScriptImageSection sec;
+		sec.type=type;
+		sec.offset=data.size();
+		sec.size=0;
+		sec.count=0;
+		sections.push_back(sec);
+	}
+	inline void EndSection(UINT count)
+	{
+		ScriptImageSection& sec=sections.back();
+		sec.size=data.size()-sec.offset;
+		sec.count=count;
+	}
+	template<typename T>
+		inline void Put(const T& v)
+	{
+		PutBlock(&v,sizeof(T));
+	}
+	inline void PutBlock(const void* p,UINT size)
+	{
+		if(size==0)
+			return;
+		UINT pos=data.size();
+		data.resize(pos+size);
+		::memcpy(&data[pos],p,size);
+	}
+	//ָڴеʼ±
+	inline UINT AddCode(const int* p,UINT num)
+	{
+		UINT pos=code.size();
+		if(num>0)
+			code.insert(code.end(),p,p+num);
+		return pos;
+	}
+	//ַַеƫ
+	inline UINT AddString(const char* s)
+	{
+		UINT pos=strpool.size();
+		UINT len=::strlen(s);
+		strpool.insert(strpool.end(),s,s+len+1);
+		return pos;
+	}
+	//дӳpackΪѹʽ
+	inline void Finish(std::vector<char>& image,int pack)
+	{
+		BeginSection(SCB_SEC_CODE);
+		PutBlock(code.empty()?NULL:&code[0],code.size()*sizeof(int));
+		EndSection(code.size());
+		BeginSection(SCB_SEC_STRPOOL);
+		PutBlock(strpool.empty()?NULL:&strpool[0],strpool.size());
+		EndSection(strpool.size());
+		Align();
+		ScriptImageHeader header;
+		::memset(&header,0,sizeof(header));
+		header.tag[0]='S';
+		header.tag[1]='C';
+		header.tag[2]='B';
+		header.tag[3]='1';
+		header.version=SCB_VERSION;
+		header.tableOffset=data.size();
+		header.sectionNum=sections.size();
+		PutBlock(&sections[0],sections.size()*sizeof(ScriptImageSection));
+		header.size=data.size();
+		header.packedSize=header.size;
+		if(pack==SCB_PACK_NONE)
+		{
+			image.resize(sizeof(header)+data.size());
+			::memcpy(&image[0],&header,sizeof(header));
+			::memcpy(&image[sizeof(header)],&data[0],data.size());
+			return;
+		}
+		//ֱѹӳļͷ֮λãѹٽȥĲ
+		int size;
+		header.flags|=SCB_COMPRESSED;
+		if(pack==SCB_PACK_LZFAST)
+		{
+			header.flags|=SCB_LZFAST;
+			image.resize(sizeof(header)+LZFast::Bound(data.size()));
+			LZFast lzfast;
+			size=lzfast.Compress((const BYTE*)&data[0],data.size(),(BYTE*)&image[sizeof(header)],image.size()-sizeof(header));
+		}
+		else
+		{
+			LZARI lzari;
+			int capacity=data.size()+data.size()/8+64;
+			image.resize(sizeof(header)+capacity);
+			size=lzari.CompressTo((const BYTE*)&data[0],data.size(),(BYTE*)&image[sizeof(header)],capacity);
+			if(size<0)
+			{
+				BYTE* packed=lzari.Compress((const BYTE*)&data[0],data.size(),size);
+				image.resize(sizeof(header)+size);
+				::memcpy(&image[sizeof(header)],packed,size);
+				delete[] packed;
+			}
+		}
+		header.packedSize=size;
+		image.resize(sizeof(header)+size);
+		::memcpy(&image[0],&header,sizeof(header));
+	}
+private:
+	inline void Align(void)
+	{
+		data.resize(ScriptImage::AlignUp(data.size()),0);
+	}
+};
+
+//˳ȡ䳤ɵĶ
+class ScriptImageCursor
+{
+	const char* p;
+	const char* end;
+public:
+	ScriptImageCursor(const char* base,const ScriptImageSection* sec)
+	{
+		p=NULL;
+		end=NULL;
+		if(sec)
+		{
+			p=base+sec->offset;
+			end=p+sec->size;
+		}
+	}
+	template<typename T>
+		inline bool Read(T& v)
+	{
+		if(end-p<(int)sizeof(T))
+			return false;
+		::memcpy(&v,p,sizeof(T));
+		p+=sizeof(T);
+		return true;
+	}
+};
+
+//ζȡӳĶзʶ߽
+class ScriptImageReader
+{
+	const char* base;
+	UINT size;
+	const ScriptImageSection* table;
+	UINT sectionNum;
+	const char* strpool;
+	UINT strpoolSize;
+public:
+	ScriptImageReader(void)
+	{
+		base=NULL;
+		size=0;
+		table=NULL;
+		sectionNum=0;
+		strpool=NULL;
+		strpoolSize=0;
+	}
+	inline bool Open(const char* p,const ScriptImageHeader& header)
+	{
+		if(header.version!=SCB_VERSION)
+			return false;
+		if(header.tableOffset>header.size || header.sectionNum>(header.size-header.tableOffset)/sizeof(ScriptImageSection))
+			return false;
+		base=p;
+		size=header.size;
+		table=(const ScriptImageSection*)(p+header.tableOffset);
+		sectionNum=header.sectionNum;
+		for(UINT i=0;i<sectionNum;i++)
+		{
+			if(table[i].offset>size || table[i].size>size-table[i].offset)
+				return false;
+		}
+		const ScriptImageSection* sec=Find(SCB_SEC_STRPOOL);
+		if(!sec)
+			return false;
+		strpool=base+sec->offset;
+		strpoolSize=sec->size;
+		return true;
+	}
+	inline const ScriptImageSection* Find(UINT type) const
+	{
+		for(UINT i=0;i<sectionNum;i++)
+		{
+			if(table[i].type==type)
+				return &table[i];
+		}
+		return NULL;
+	}
+	inline UINT Count(UINT type) const
+	{
+		const ScriptImageSection* sec=Find(type);
+		return sec?sec->count:0;
+	}
+	//ȡɵĶΣȱʧʱcountΪ0εĴСʱfalse
+	template<typename T>
+		inline bool Array(UINT type,const T*& p,UINT& count) const
+	{
+		p=NULL;
+		count=0;
+		const ScriptImageSection* sec=Find(type);
+		if(!sec)
+			return true;
+		if(sec->count>sec->size/sizeof(T))
+			return false;
+		p=(const T*)(base+sec->offset);
+		count=sec->count;
+		return true;
+	}
+	inline ScriptImageCursor Cursor(UINT type) const
+	{
+		return ScriptImageCursor(base,Find(type));
+	}
+	//ȡַеַƫԽַδʱNULL
+	inline const char* String(UINT offset) const
+	{
+		if(offset>=strpoolSize)
+			return NULL;
+		if(!::memchr(strpool+offset,0,strpoolSize-offset))
+			return NULL;
+		return strpool+offset;
+	}
+};
+
+//ʱ޹صĸڶеĶд֧ʾʽ븡㳣ַ
+//SaveImage/LoadSectionstest/ScriptImageTest.cppĴ롣
+//SwitchInfosṩdefkindcasesֵ֧ƫƣStrConstantsconst char*졢תΪconst char*
+//FunctionsΪintvector
+class ScriptImageTables
+{
+public:
+	template<typename SwitchInfos,typename StrConstants,typename Functions>
+		static inline void Save(ScriptImageWriter& w,const SwitchInfos& switchInfos,const std::vector<int>& intConstants,
+			const std::vector<double>& doubleConstants,const StrConstants& strConstants,const Functions& functions,const std::vector<int>& funcVarNum)
+	{
+		//֧
+		w.BeginSection(SCB_SEC_SWITCH);
+		for(UINT i=0;i<switchInfos.size();i++)
+		{
+			w.Put(switchInfos[i].def);
+			PutCases(w,switchInfos[i].cases);
+		}
+		w.EndSection(switchInfos.size());
+		w.BeginSection(SCB_SEC_SWITCHKIND);
+		for(UINT i=0;i<switchInfos.size();i++)
+			w.Put(switchInfos[i].kind);
+		w.EndSection(switchInfos.size());
+		//
+		w.BeginSection(SCB_SEC_INT);
+		w.PutBlock(intConstants.empty()?NULL:&intConstants[0],intConstants.size()*sizeof(int));
+		w.EndSection(intConstants.size());
+		w.BeginSection(SCB_SEC_DOUBLE);
+		w.PutBlock(doubleConstants.empty()?NULL:&doubleConstants[0],doubleConstants.size()*sizeof(double));
+		w.EndSection(doubleConstants.size());
+		w.BeginSection(SCB_SEC_STRING);
+		for(UINT i=0;i<strConstants.size();i++)
+			w.Put(w.AddString(strConstants[i]));
+		w.EndSection(strConstants.size());
+		//
+		w.BeginSection(SCB_SEC_FUNCTION);
+		for(UINT i=0;i<functions.size();i++)
+		{
+			const std::vector<int>& ins=functions[i];
+			ScriptImageFunction func;
+			func.varnum=funcVarNum[i];
+			func.offset=w.AddCode(ins.empty()?NULL:&ins[0],ins.size());
+			func.num=ins.size();
+			w.Put(func);
+		}
+		w.EndSection(functions.size());
+	}
+	//֧밴ֵĸ֧
+	template<typename Cases>
+		static inline void PutCases(ScriptImageWriter& w,const Cases& cases)
+	{
+		w.Put((UINT)cases.size());
+		typename Cases::const_iterator it=cases.begin();
+		for(;it!=cases.end();it++)
+		{
+			w.Put(it->first);
+			w.Put(it->second);
+		}
+	}
+	//׷ӵߴУһʱfalse
+	template<typename SwitchInfos,typename StrConstants,typename Functions>
+		static inline bool Load(const ScriptImageReader& r,SwitchInfos& switchInfos,std::vector<int>& intConstants,
+			std::vector<double>& doubleConstants,StrConstants& strConstants,Functions& functions,std::vector<int>& funcVarNum)
+	{
+		//֧
+		ScriptImageCursor c=r.Cursor(SCB_SEC_SWITCH);
+		UINT len=r.Count(SCB_SEC_SWITCH);
+		switchInfos.resize(len);
+		for(UINT i=0;i<len;i++)
+		{
+			UINT cnum;
+			if(!c.Read(switchInfos[i].def) || !c.Read(cnum))
+				return false;
+			for(UINT j=0;j<cnum;j++)
+			{
+				int s,d;
+				if(!c.Read(s) || !c.Read(d))
+					return false;
+				switchInfos[i].cases[s]=d;
+			}
+		}
+		const int* kinds;
+		if(!r.Array(SCB_SEC_SWITCHKIND,kinds,len))
+			return false;
+		for(UINT i=0;i<len && i<switchInfos.size();i++)
+			switchInfos[i].kind=kinds[i];
+		//븡㳣
+		const int* ints;
+		if(!r.Array(SCB_SEC_INT,ints,len))
+			return false;
+		intConstants.assign(ints,ints+len);
+		const double* doubles;
+		if(!r.Array(SCB_SEC_DOUBLE,doubles,len))
+			return false;
+		doubleConstants.assign(doubles,doubles+len);
+		//ַ
+		const UINT* strs;
+		if(!r.Array(SCB_SEC_STRING,strs,len))
+			return false;
+		for(UINT i=0;i<len;i++)
+		{
+			const char* s=r.String(strs[i]);
+			if(!s)
+				return false;
+			strConstants.push_back(typename StrConstants::value_type(s));
+		}
+		//
+		const int* code;
+		UINT codeNum;
+		if(!r.Array(SCB_SEC_CODE,code,codeNum))
+			return false;
+		const ScriptImageFunction* funcs;
+		if(!r.Array(SCB_SEC_FUNCTION,funcs,len))
+			return false;
+		functions.resize(len);
+		for(UINT i=0;i<len;i++)
+		{
+			const ScriptImageFunction& func=funcs[i];
+			if(func.offset>codeNum || func.num>codeNum-func.offset)
+				return false;
+			functions[i].assign(code+func.offset,code+func.offset+func.num);
+			funcVarNum.push_back(func.varnum);
+		}
+		return true;
+	}
+};
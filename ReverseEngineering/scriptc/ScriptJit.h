@@ -0,0 +1,760 @@
+#pragma once
+//߼ʱʹõĻ뻺ģĿΪx8632λx86-64
+//ֻṩģõļѰַָʽڴһΪ[ַĴ+λ]
+//ַespebpתĿñűʾFinishʱ32λƫơ
+//ֵһ32λģָֻ루ֵջջֲȣĶдӼPtrϵеķx86-64¼REX.Wǰ׺
+//ƵִڴУڴʱԤʱһͷš
+//ļWindowsVirtualAllocִڴ棬ϵͳmmapԵԡ
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include <string.h>
+#include <stddef.h>
+#include <vector>
+#include "ScriptOpcode.h"
+#include "TaggedValue.h"
+
+#define JIT_CHUNKSIZE		64*1024
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define JIT_X64
+#endif
+#if defined(_M_IX86) || defined(__i386__) || defined(JIT_X64)
+#define JIT_SUPPORTED
+#endif
+#ifdef _MSC_VER
+#define JIT_CALL	__cdecl
+#else
+#define JIT_CALL
+#endif
+
+enum JitReg
+{
+	JIT_EAX=0,
+	JIT_ECX,
+	JIT_EDX,
+	JIT_EBX,
+	JIT_ESP,
+	JIT_EBP,
+	JIT_ESI,
+	JIT_EDI
+};
+
+//תsetcc
+enum JitCond
+{
+	JIT_B=0x2,
+	JIT_AE=0x3,
+	JIT_E=0x4,
+	JIT_NE=0x5,
+	JIT_L=0xC,
+	JIT_GE=0xD,
+	JIT_LE=0xE,
+	JIT_G=0xF
+};
+
+//ִڴ棺ϵͳ룬˳䣬ֻͷ
+class JitMemory
+{
+	struct Chunk
+	{
+		unsigned char* base;
+		unsigned int used;
+		unsigned int size;
+	};
+	std::vector<Chunk> chunks;
+public:
+	JitMemory(void)
+	{
+	}
+	~JitMemory()
+	{
+		Clear();
+	}
+	//һλ벢ڣڴʧʱNULL
+	inline void* Add(const unsigned char* p,unsigned int size)
+	{
+		if(chunks.empty() || chunks.back().size-chunks.back().used<size)
+		{
+			Chunk c;
+			c.size=(size>JIT_CHUNKSIZE)?size:JIT_CHUNKSIZE;
+			c.used=0;
+			c.base=Allocate(c.size);
+			if(!c.base)
+				return NULL;
+			chunks.push_back(c);
+		}
+		Chunk& c=chunks.back();
+		unsigned char* entry=c.base+c.used;
+		::memcpy(entry,p,size);
+		c.used+=(size+15)&~15;
+		if(c.used>c.size)
+			c.used=c.size;
+#ifdef _WIN32
+		::FlushInstructionCache(::GetCurrentProcess(),entry,size);
+#endif
+		return entry;
+	}
+	inline void Clear(void)
+	{
+		for(unsigned int i=0;i<chunks.size();i++)
+			Free(chunks[i].base,chunks[i].size);
+		chunks.clear();
+	}
+private:
+	static inline unsigned char* Allocate(unsigned int size)
+	{
+#ifdef _WIN32
+		return (unsigned char*)::VirtualAlloc(NULL,size,MEM_COMMIT|MEM_RESERVE,PAGE_EXECUTE_READWRITE);
+#else
+		void* p=::mmap(NULL,size,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+		return (p==MAP_FAILED)?NULL:(unsigned char*)p;
+#endif
+	}
+	static inline void Free(unsigned char* p,unsigned int size)
+	{
+#ifdef _WIN32
+		::VirtualFree(p,0,MEM_RELEASE);
+#else
+		::munmap(p,size);
+#endif
+	}
+private:
+	JitMemory(const JitMemory&);
+	JitMemory& operator=(const JitMemory&);
+};
+
+class JitAssembler
+{
+	struct Fixup
+	{
+		int pos;		//32λƫڵλ
+		int label;
+	};
+	std::vector<unsigned char> code;
+	std::vector<int> labels;	//Ű󶨵λãС0ʾδ
+	std::vector<Fixup> fixups;
+public:
+	inline int NewLabel(void)
+	{
+		labels.push_back(-1);
+		return labels.size()-1;
+	}
+	inline void Bind(int label)
+	{
+		labels[label]=code.size();
+	}
+	inline void Byte(int b)
+	{
+		code.push_back((unsigned char)b);
+	}
+	inline void Dword(int d)
+	{
+		Byte(d);
+		Byte(d>>8);
+		Byte(d>>16);
+		Byte(d>>24);
+	}
+	//ModRMλƣ[base+disp]λһֽʱ8λλ
+	inline void Mem(int reg,int base,int disp)
+	{
+		if(disp>=-128 && disp<=127)
+		{
+			Byte(0x40|(reg<<3)|base);
+			Byte(disp);
+		}
+		else
+		{
+			Byte(0x80|(reg<<3)|base);
+			Dword(disp);
+		}
+	}
+	inline void Load(int reg,int base,int disp)
+	{
+		Byte(0x8B);//mov reg,[base+disp]
+		Mem(reg,base,disp);
+	}
+	inline void LoadWord(int reg,int base,int disp)
+	{
+		Byte(0x0F);//movzx reg,word ptr [base+disp]
+		Byte(0xB7);
+		Mem(reg,base,disp);
+	}
+	inline void Store(int base,int disp,int reg)
+	{
+		Byte(0x89);//mov [base+disp],reg
+		Mem(reg,base,disp);
+	}
+	inline void StoreImm(int base,int disp,int imm)
+	{
+		Byte(0xC7);//mov dword ptr [base+disp],imm32
+		Mem(0,base,disp);
+		Dword(imm);
+	}
+	inline void CmpImm(int base,int disp,int imm)
+	{
+		if(imm>=-128 && imm<=127)
+		{
+			Byte(0x83);//cmp dword ptr [base+disp],imm8
+			Mem(7,base,disp);
+			Byte(imm);
+		}
+		else
+		{
+			Byte(0x81);//cmp dword ptr [base+disp],imm32
+			Mem(7,base,disp);
+			Dword(imm);
+		}
+	}
+	//opΪadd(0x03)or(0x0B)and(0x23)sub(0x2B)xor(0x33)cmp(0x3B)op reg,[base+disp]
+	inline void Alu(int op,int reg,int base,int disp)
+	{
+		Byte(op);
+		Mem(reg,base,disp);
+	}
+	//extΪ/2not/3negop dword ptr [base+disp]
+	inline void Unary(int ext,int base,int disp)
+	{
+		Byte(0xF7);
+		Mem(ext,base,disp);
+	}
+	inline void AddMemImm(int base,int disp,int imm)
+	{
+		Byte(0x83);//add dword ptr [base+disp],imm8
+		Mem(0,base,disp);
+		Byte(imm);
+	}
+	inline void Imul(int reg,int base,int disp)
+	{
+		Byte(0x0F);//imul reg,[base+disp]
+		Byte(0xAF);
+		Mem(reg,base,disp);
+	}
+	inline void AndImm(int reg,int imm)
+	{
+		Byte(0x81);//and reg,imm32
+		Byte(0xE0|reg);
+		Dword(imm);
+	}
+	inline void TestImm(int reg,int imm)
+	{
+		Byte(0xF7);//test reg,imm32
+		Byte(0xC0|reg);
+		Dword(imm);
+	}
+	inline void Shl(int reg,int n)
+	{
+		Byte(0xC1);//shl reg,imm8
+		Byte(0xE0|reg);
+		Byte(n);
+	}
+	//extΪ/4shl/5shrop reg,cl
+	inline void ShiftCl(int ext,int reg)
+	{
+		Byte(0xD3);
+		Byte(0xC0|(ext<<3)|reg);
+	}
+	inline void TestReg(int reg)
+	{
+		Byte(0x85);//test reg,reg
+		Byte(0xC0|(reg<<3)|reg);
+	}
+	inline void MovImm(int reg,int imm)
+	{
+		Byte(0xB8|reg);//mov reg,imm32
+		Dword(imm);
+	}
+	//eax=cond?1:0
+	inline void SetCond(int cond)
+	{
+		Byte(0x0F);//setcc al
+		Byte(0x90|cond);
+		Byte(0xC0);
+		Byte(0x0F);//movzx eax,al
+		Byte(0xB6);
+		Byte(0xC0);
+	}
+	//mov reg,[base+disp]ȡָ
+	inline void LoadPtr(int reg,int base,int disp)
+	{
+		Rex();
+		Load(reg,base,disp);
+	}
+	//mov [base+disp],regдָ
+	inline void StorePtr(int base,int disp,int reg)
+	{
+		Rex();
+		Store(base,disp,reg);
+	}
+	//add reg,immimmΪʱΪ
+	inline void AddPtrImm(int reg,int imm)
+	{
+		Rex();
+		if(imm>=-128 && imm<=127)
+		{
+			Byte(0x83);
+			Byte(0xC0|reg);
+			Byte(imm);
+		}
+		else
+		{
+			Byte(0x81);
+			Byte(0xC0|reg);
+			Dword(imm);
+		}
+	}
+	inline void MovPtrReg(int dst,int src)
+	{
+		Rex();
+		Byte(0x8B);//mov dst,src
+		Byte(0xC0|(dst<<3)|src);
+	}
+	inline void AddPtrReg(int dst,int src)
+	{
+		Rex();
+		Byte(0x03);//add dst,src
+		Byte(0xC0|(dst<<3)|src);
+	}
+	//ѹջջx86-64ĬϾ64λ
+	inline void Push(int reg)
+	{
+		Byte(0x50|reg);
+	}
+	inline void Pop(int reg)
+	{
+		Byte(0x58|reg);
+	}
+	inline void Ret(void)
+	{
+		Byte(0xC3);
+	}
+	inline void Jmp(int label)
+	{
+		Byte(0xE9);//jmp rel32
+		Rel(label);
+	}
+	inline void Jcc(int cond,int label)
+	{
+		Byte(0x0F);//jcc rel32
+		Byte(0x80|cond);
+		Rel(label);
+	}
+	//ȫתδ󶨵ıʱfalse
+	inline bool Finish(void)
+	{
+		for(unsigned int i=0;i<fixups.size();i++)
+		{
+			int target=labels[fixups[i].label];
+			if(target<0)
+				return false;
+			int pos=fixups[i].pos;
+			int rel=target-(pos+4);
+			::memcpy(&code[pos],&rel,4);
+		}
+		return true;
+	}
+	inline const unsigned char* Code(void) const
+	{
+		return code.empty()?NULL:&code[0];
+	}
+	inline unsigned int Size(void) const
+	{
+		return code.size();
+	}
+private:
+	inline void Rex(void)
+	{
+#ifdef JIT_X64
+		Byte(0x48);//REX.W
+#endif
+	}
+	inline void Rel(int label)
+	{
+		Fixup f;
+		f.pos=code.size();
+		f.label=label;
+		fixups.push_back(f);
+		Dword(0);
+	}
+};
+
+//ʱĺڵĲʱspΪֵջջ
+template<typename Value>
+	struct JitFrameT
+{
+	Value* locals;
+	Value* args;
+	int argnum;
+	Value* sp;
+	Value* result;
+};
+
+//ԤָûģΪ뺯ģֻǾֲ볣㡢Ƚϡת
+//ԼԾֲĸֵԤִѭʹͬһֵջ֣esiΪջediΪֲ
+//ÿָȼҪѹ븳ֵҪ󲻺áʱκ޸ģ
+//ظָλִѭִУȥŻ˱ֵջϵֵãʱͷš
+//ValueΪֵʵҪ16ֽڡڵ0ֽڡڵ8ֽڡ
+template<typename Value>
+	class DecodedJitT
+{
+public:
+	typedef JitFrameT<Value> Frame;
+	//-1ʾִ꣬ΪҪԤִѭִеָλ
+	typedef int (JIT_CALL *Entry)(Frame* frame);
+private:
+	JitAssembler a;
+	std::vector<int> labels;	//ÿָıţһΪĩβ
+	std::vector<int> deopts;	//ÿָȥŻڣС0ʾδ
+	int exit;
+	enum
+	{
+		VS=16,
+		TAG=0,
+		VAL=8,
+		PS=sizeof(void*)
+	};
+public:
+	static inline bool Supported(int op)
+	{
+		switch(op)
+		{
+		case DOP_PUSH_LOCAL:
+		case DOP_LOCAL_INT_OP:
+		case DOP_LOCAL_LOCAL_OP:
+		case DOP_PUSH_INT:
+		case DOP_PUSH_LVALUE:
+		case DOP_PUSH_DOUBLE:
+		case DOP_PUSH_ARG:
+		case DOP_NOP:
+		case OP_POP:
+		case OP_RETURN:
+		case OP_JMP:
+		case OP_JZ:
+		case OP_JNZ:
+		case DOP_JZ_KEEP:
+		case DOP_JNZ_KEEP:
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_LS:
+		case OP_RS:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+		case OP_NEG:
+		case OP_NOT:
+		case OP_USUB:
+		case OP_INC:
+		case OP_DEC:
+		case OP_ASSIGN:
+		case OP_ADD_ASSIGN:
+		case OP_SUB_ASSIGN:
+		case OP_COMMA:
+			return true;
+		}
+		return false;
+	}
+	//ֵĲģļһ
+	static inline bool LayoutMatches(void)
+	{
+		Value v;
+		return sizeof(Value)==VS && (char*)&v.tag-(char*)&v==TAG && (char*)&v.l-(char*)&v==VAL;
+	}
+	//ɹʱظƵmemoryеڣвֵָ֧ʱNULL
+	inline Entry Compile(const DecodedInstructions& ins,const std::vector<double>& doubles,JitMemory& memory)
+	{
+		int num=ins.size();
+		if(num==0 || !LayoutMatches())
+			return NULL;
+		for(int pc=0;pc<num;pc++)
+		{
+			if(!Supported(ins[pc].op))
+				return NULL;
+		}
+		labels.resize(num+1);
+		for(int pc=0;pc<=num;pc++)
+			labels[pc]=a.NewLabel();
+		deopts.assign(num,-1);
+		exit=a.NewLabel();
+		//ebxΪframeesiΪֵջջediΪֲ⼸ĴڸԼжɱ߱
+		a.Push(JIT_EBP);
+		a.MovPtrReg(JIT_EBP,JIT_ESP);
+		a.Push(JIT_EBX);
+		a.Push(JIT_ESI);
+		a.Push(JIT_EDI);
+#if !defined(JIT_X64)
+		a.LoadPtr(JIT_EBX,JIT_EBP,8);
+#elif defined(_WIN32)
+		a.MovPtrReg(JIT_EBX,JIT_ECX);
+#else
+		a.MovPtrReg(JIT_EBX,JIT_EDI);
+#endif
+		a.LoadPtr(JIT_ESI,JIT_EBX,offsetof(Frame,sp));
+		a.LoadPtr(JIT_EDI,JIT_EBX,offsetof(Frame,locals));
+		for(int pc=0;pc<num;pc++)
+		{
+			a.Bind(labels[pc]);
+			Emit(pc,ins[pc],doubles);
+		}
+		a.Bind(labels[num]);
+		a.MovImm(JIT_EAX,-1);
+		a.Bind(exit);
+		a.StorePtr(JIT_EBX,offsetof(Frame,sp),JIT_ESI);
+		a.Pop(JIT_EDI);
+		a.Pop(JIT_ESI);
+		a.Pop(JIT_EBX);
+		a.Pop(JIT_EBP);
+		a.Ret();
+		for(int pc=0;pc<num;pc++)
+		{
+			if(deopts[pc]<0)
+				continue;
+			a.Bind(deopts[pc]);
+			a.MovImm(JIT_EAX,pc);
+			a.Jmp(exit);
+		}
+		if(!a.Finish())
+			return NULL;
+		return (Entry)memory.Add(a.Code(),a.Size());
+	}
+private:
+	inline void Emit(int pc,const DecodedIns& d,const std::vector<double>& doubles)
+	{
+		switch(d.op)
+		{
+		case DOP_PUSH_LOCAL:
+		case DOP_LOCAL_INT_OP:
+		case DOP_LOCAL_LOCAL_OP:
+			//ϲָԱԭֻѹֲ
+			CheckPlain(pc,JIT_EDI,d.index*VS);
+			Copy(JIT_ESI,0,JIT_EDI,d.index*VS);
+			a.AddPtrImm(JIT_ESI,VS);
+			break;
+		case DOP_PUSH_INT:
+		case DOP_PUSH_LVALUE:
+			PushInt(d.index);
+			break;
+		case DOP_PUSH_DOUBLE:
+			{
+				int v[2];
+				::memcpy(v,&doubles[d.index],sizeof(v));
+				a.StoreImm(JIT_ESI,TAG,TAG_DOUBLE);
+				a.StoreImm(JIT_ESI,VAL,v[0]);
+				a.StoreImm(JIT_ESI,VAL+4,v[1]);
+				a.AddPtrImm(JIT_ESI,VS);
+			}
+			break;
+		case DOP_PUSH_ARG:
+			{
+				int has=a.NewLabel();
+				int done=a.NewLabel();
+				a.CmpImm(JIT_EBX,offsetof(Frame,argnum),d.index);
+				a.Jcc(JIT_G,has);
+				PushInt(0);
+				a.Jmp(done);
+				a.Bind(has);
+				a.LoadPtr(JIT_EDX,JIT_EBX,offsetof(Frame,args));
+				CheckPlain(pc,JIT_EDX,d.index*VS);
+				Copy(JIT_ESI,0,JIT_EDX,d.index*VS);
+				a.AddPtrImm(JIT_ESI,VS);
+				a.Bind(done);
+			}
+			break;
+		case OP_POP:
+		case OP_RETURN:
+			a.LoadPtr(JIT_EDX,JIT_EBX,offsetof(Frame,result));
+			CheckPlain(pc,JIT_EDX,0);
+			a.AddPtrImm(JIT_ESI,-VS);
+			Copy(JIT_EDX,0,JIT_ESI,0);
+			a.StoreImm(JIT_ESI,TAG,TAG_EMPTY);
+			if(d.op==OP_RETURN)
+				a.Jmp(labels[labels.size()-1]);
+			break;
+		case OP_JMP:
+			a.Jmp(labels[d.index]);
+			break;
+		case OP_JZ:
+		case OP_JNZ:
+			a.AddPtrImm(JIT_ESI,-VS);
+			a.CmpImm(JIT_ESI,VAL,0);
+			a.StoreImm(JIT_ESI,TAG,TAG_EMPTY);
+			a.Jcc((d.op==OP_JZ)?JIT_E:JIT_NE,labels[d.index]);
+			break;
+		case DOP_JZ_KEEP:
+		case DOP_JNZ_KEEP:
+			a.CmpImm(JIT_ESI,-VS+VAL,0);
+			a.Jcc((d.op==DOP_JZ_KEEP)?JIT_E:JIT_NE,labels[d.index]);
+			break;
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_LS:
+		case OP_RS:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			CheckInt(pc,JIT_ESI,-2*VS);
+			CheckInt(pc,JIT_ESI,-VS);
+			a.Load(JIT_EAX,JIT_ESI,-2*VS+VAL);
+			Binary(d.op);
+			a.Store(JIT_ESI,-2*VS+VAL,JIT_EAX);
+			Pop();
+			break;
+		case OP_NEG:
+		case OP_USUB:
+			CheckInt(pc,JIT_ESI,-VS);
+			a.Unary((d.op==OP_NEG)?2:3,JIT_ESI,-VS+VAL);
+			break;
+		case OP_NOT:
+			CheckInt(pc,JIT_ESI,-VS);
+			a.LoadWord(JIT_EAX,JIT_ESI,-VS+VAL);
+			a.TestReg(JIT_EAX);
+			a.SetCond(JIT_E);
+			a.Store(JIT_ESI,-VS+VAL,JIT_EAX);
+			a.StoreImm(JIT_ESI,-VS+VAL+4,0);
+			break;
+		case OP_INC:
+		case OP_DEC:
+			LocalLValue(pc,-VS);
+			CheckInt(pc,JIT_EAX,0);
+			a.AddMemImm(JIT_EAX,VAL,(d.op==OP_INC)?1:-1);
+			Copy(JIT_ESI,-VS,JIT_EAX,0);
+			break;
+		case OP_ASSIGN:
+			LocalLValue(pc,-2*VS);
+			CheckPlain(pc,JIT_EAX,0);
+			Copy(JIT_EAX,0,JIT_ESI,-VS);
+			Copy(JIT_ESI,-2*VS,JIT_ESI,-VS);
+			Pop();
+			break;
+		case OP_ADD_ASSIGN:
+		case OP_SUB_ASSIGN:
+			LocalLValue(pc,-2*VS);
+			CheckInt(pc,JIT_EAX,0);
+			CheckInt(pc,JIT_ESI,-VS);
+			a.Load(JIT_EDX,JIT_EAX,VAL);
+			a.Alu((d.op==OP_ADD_ASSIGN)?0x03:0x2B,JIT_EDX,JIT_ESI,-VS+VAL);
+			a.Store(JIT_EAX,VAL,JIT_EDX);
+			Copy(JIT_ESI,-2*VS,JIT_EAX,0);
+			Pop();
+			break;
+		case OP_COMMA:
+			Copy(JIT_ESI,-2*VS,JIT_ESI,-VS);
+			Pop();
+			break;
+		}
+	}
+	//eaxΪsp[-2]sp[-1]ΪҲeaxУȽϵĽͬʱѸ32λ0
+	inline void Binary(int op)
+	{
+		const int r=-VS+VAL;
+		switch(op)
+		{
+		case OP_ADD:
+			a.Alu(0x03,JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_SUB:
+			a.Alu(0x2B,JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_MUL:
+			a.Imul(JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_AND:
+			a.Alu(0x23,JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_OR:
+			a.Alu(0x0B,JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_XOR:
+			a.Alu(0x33,JIT_EAX,JIT_ESI,r);
+			break;
+		case OP_LS:
+		case OP_RS:
+			a.Load(JIT_ECX,JIT_ESI,r);
+			a.ShiftCl((op==OP_LS)?4:5,JIT_EAX);
+			break;
+		default:
+			{
+				int cond;
+				switch(op)
+				{
+				case OP_EQ:cond=JIT_E;break;
+				case OP_NE:cond=JIT_NE;break;
+				case OP_LT:cond=JIT_L;break;
+				case OP_GT:cond=JIT_G;break;
+				case OP_LE:cond=JIT_LE;break;
+				default:cond=JIT_GE;break;
+				}
+				a.Alu(0x3B,JIT_EAX,JIT_ESI,r);
+				a.SetCond(cond);
+				a.StoreImm(JIT_ESI,-2*VS+VAL+4,0);
+			}
+			break;
+		}
+	}
+	inline void PushInt(int v)
+	{
+		a.StoreImm(JIT_ESI,TAG,TAG_INT);
+		a.StoreImm(JIT_ESI,VAL,v);
+		a.StoreImm(JIT_ESI,VAL+4,0);
+		a.AddPtrImm(JIT_ESI,VS);
+	}
+	//ջԭѭֵ
+	inline void Pop(void)
+	{
+		a.AddPtrImm(JIT_ESI,-VS);
+		a.StoreImm(JIT_ESI,TAG,TAG_EMPTY);
+	}
+	//ecxתһֵ
+	inline void Copy(int dst,int dstDisp,int src,int srcDisp)
+	{
+		for(int k=0;k<VS;k+=4)
+		{
+			a.Load(JIT_ECX,src,srcDisp+k);
+			a.Store(dst,dstDisp+k,JIT_ECX);
+		}
+	}
+	inline int Deopt(int pc)
+	{
+		if(deopts[pc]<0)
+			deopts[pc]=a.NewLabel();
+		return deopts[pc];
+	}
+	inline void CheckInt(int pc,int base,int disp)
+	{
+		a.CmpImm(base,disp+TAG,TAG_INT);
+		a.Jcc(JIT_NE,Deopt(pc));
+	}
+	//õֵֵ븡԰ڴֱӸ븲
+	inline void CheckPlain(int pc,int base,int disp)
+	{
+		a.CmpImm(base,disp+TAG,TAG_OBJECT);
+		a.Jcc(JIT_AE,Deopt(pc));
+	}
+	//λdispֵǾֲʱeaxΪþֲĵַȥŻ
+	//andshlд32λĴʱx86-64Ѹ32λ0ָ֮edi
+	inline void LocalLValue(int pc,int disp)
+	{
+		CheckInt(pc,JIT_ESI,disp);
+		a.Load(JIT_EAX,JIT_ESI,disp+VAL);
+		a.TestImm(JIT_EAX,0x0f0000);
+		a.Jcc(JIT_NE,Deopt(pc));
+		a.AndImm(JIT_EAX,0x00ffff);
+		a.Shl(JIT_EAX,4);
+		a.AddPtrReg(JIT_EAX,JIT_EDI);
+	}
+};
@@ -0,0 +1,81 @@
+#pragma once
+//űָĲԤָļWindowsͷļʱĲԿ롣
+#include <vector>
+
+#define OP_PUSH			1
+#define OP_POP			2
+#define OP_JMP			3
+#define OP_JZ			4
+#define OP_JNZ			5
+#define OP_TABLE_JMP	6
+#define OP_CALL			7
+#define OP_RETURN		8
+#define OP_OBJCALL		9
+#define OP_OBJGETATTR	10
+#define OP_OBJSETATTR	11
+#define OP_ADD			12
+#define OP_SUB			13
+#define OP_MUL			14
+#define OP_DIV			15
+#define OP_MOD			16
+#define OP_AND			17
+#define OP_OR			18
+#define OP_NEG			19
+#define OP_XOR			20
+#define OP_ANDAND		21
+#define OP_OROR			22
+#define OP_NOT			23
+#define OP_EQ			24
+#define OP_NE			25
+#define OP_LS			26
+#define OP_RS			27
+#define OP_LT			28
+#define OP_GT			29
+#define OP_LE			30
+#define OP_GE			31
+#define OP_INC			32
+#define OP_DEC			33
+#define OP_USUB			34
+#define OP_ASSIGN		35
+#define OP_ADD_ASSIGN	36
+#define OP_SUB_ASSIGN	37
+#define OP_MUL_ASSIGN	38
+#define OP_DIV_ASSIGN	39
+#define OP_MOD_ASSIGN	40
+#define OP_AND_ASSIGN	41
+#define OP_OR_ASSIGN	42
+#define OP_XOR_ASSIGN	43
+#define OP_LS_ASSIGN	44
+#define OP_RS_ASSIGN	45
+#define OP_COMMA		46
+#define OP_EXECQUERY	47
+#define OP_PTRINFO		48
+#define OP_PTRCALC		49
+#define OP_ADDR			50
+#define OP_CAST			51
+#define OP_ARG			52
+
+//ΪԤʹõչ룬DecodedInstructionsУдűļ
+#define DOP_PUSH_LOCAL		64
+#define DOP_PUSH_INT		65
+#define DOP_PUSH_DOUBLE		66
+#define DOP_PUSH_STR		67
+#define DOP_PUSH_ARG		68
+#define DOP_PUSH_GLOBAL		69
+#define DOP_PUSH_OBJECT		70
+#define DOP_PUSH_LVALUE		71
+#define DOP_JZ_KEEP			72
+#define DOP_JNZ_KEEP		73
+#define DOP_NOP				74
+#define DOP_LOCAL_INT_OP	75		//ѹֲѹԪָĺϲ
+#define DOP_LOCAL_LOCAL_OP	76		//ѹֲԪָĺϲ
+
+//Ԥָװʱop<<24|operandָһԲ⣬PUSHԴΪչ룬
+//תƫƽΪԵִַʱҪλ֧
+struct DecodedIns
+{
+	int op;			//루DOP_չ룩
+	int index;		//ѽתĿִ꣨걾ָһַָ
+	int operand;	//ԭʼ
+};
+typedef std::vector<DecodedIns> DecodedInstructions;
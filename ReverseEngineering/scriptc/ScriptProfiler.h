@@ -0,0 +1,202 @@
+#pragma once
+//űͳִдڣͳƽűOQLѯⲿ
+//ôڣɵͼʹõ۵ջı
+//ȡԴʱ̰߳ȫģֻڽ߳ʹá
+#include <intrin.h>
+
+#define PROFILE_OPCODES		256
+#define PROFILE_FUNCTION	0x00000000		//Ŀļ8λΪ𣬵24λΪѯⲿ
+#define PROFILE_QUERY		0x01000000
+#define PROFILE_API			0x02000000
+
+class ScriptProfiler
+{
+	typedef unsigned __int64 Cycles;
+	//Ľڵ㣬ͬһĿڲͬĵ·ǲͬĽڵ
+	struct Node
+	{
+		int key;
+		int parent;
+		std::map<int,int> children;
+		Cycles calls;
+		Cycles total;
+		Cycles self;
+	};
+	struct Frame
+	{
+		int node;
+		Cycles start;
+		Cycles child;		//ռõ
+	};
+	typedef std::vector<Node> Nodes;
+	typedef std::vector<Frame> Frames;
+	typedef std::map<int,CString> Names;
+public:
+	ScriptProfiler(void)
+	{
+		Reset();
+	}
+	inline void Reset(void)
+	{
+		for(int i=0;i<PROFILE_OPCODES;i++)
+		{
+			opCounts[i]=0;
+			opCycles[i]=0;
+		}
+		lastOp=-1;
+		lastTime=0;
+		nodes.clear();
+		frames.clear();
+		Node root;
+		root.key=-1;
+		root.parent=-1;
+		root.calls=0;
+		root.total=0;
+		root.self=0;
+		nodes.push_back(root);
+	}
+	static inline Cycles Now(void)
+	{
+		return __rdtsc();
+	}
+	//¼һָһָڼΪΪֹʱ䣬
+	//˵ⲿ󷽷ָ˱ߵĿýűָֻ뱻ǰĿ
+	inline void Step(int op)
+	{
+		Cycles now=Now();
+		if(lastOp>=0)
+			opCycles[lastOp]+=now-lastTime;
+		opCounts[op&(PROFILE_OPCODES-1)]++;
+		lastOp=op&(PROFILE_OPCODES-1);
+		lastTime=now;
+	}
+	inline bool HasName(int key)
+	{
+		return names.find(key)!=names.end();
+	}
+	inline void SetName(int key,const CString& name)
+	{
+		names[key]=name;
+	}
+	inline void Enter(int key)
+	{
+		int parent=frames.empty()?0:frames.back().node;
+		int node;
+		std::map<int,int>::iterator it=nodes[parent].children.find(key);
+		if(it==nodes[parent].children.end())
+		{
+			Node n;
+			n.key=key;
+			n.parent=parent;
+			n.calls=0;
+			n.total=0;
+			n.self=0;
+			node=nodes.size();
+			nodes.push_back(n);
+			nodes[parent].children[key]=node;
+		}
+		else
+			node=it->second;
+		nodes[node].calls++;
+		Frame f;
+		f.node=node;
+		f.child=0;
+		f.start=Now();
+		frames.push_back(f);
+	}
+	inline void Leave(void)
+	{
+		if(frames.empty())
+			return;
+		Cycles now=Now();
+		Frame f=frames.back();
+		frames.pop_back();
+		Cycles elapsed=now-f.start;
+		nodes[f.node].total+=elapsed;
+		nodes[f.node].self+=elapsed-f.child;
+		if(!frames.empty())
+		{
+			frames.back().child+=elapsed;
+		}
+		else if(lastOp>=0)
+		{
+			//صʱһָε֮ʱ䲻
+			opCycles[lastOp]+=now-lastTime;
+			lastOp=-1;
+		}
+	}
+	//۵ջÿԷֺӵĵ··ϵڣֱӽflamegraph.pl
+	inline CString CollapsedStacks(void)
+	{
+		CString out;
+		for(UINT i=1;i<nodes.size();i++)
+		{
+			if(nodes[i].self==0)
+				continue;
+			CString path=Name(nodes[i].key);
+			for(int p=nodes[i].parent;p>0;p=nodes[p].parent)
+				path=Name(nodes[p].key)+";"+path;
+			CString line;
+			line.Format("%s %I64u\n",(LPCSTR)path,nodes[i].self);
+			out+=line;
+		}
+		return out;
+	}
+	//Ŀܵı棬Ŀڵݹʱظ
+	inline CString Report(void)
+	{
+		CString out="[opcode] [count] [cycles]\n";
+		CString line;
+		for(int i=0;i<PROFILE_OPCODES;i++)
+		{
+			if(opCounts[i]==0)
+				continue;
+			line.Format("%d %I64u %I64u\n",i,opCounts[i],opCycles[i]);
+			out+=line;
+		}
+		std::map<int,Node> targets;
+		for(UINT i=1;i<nodes.size();i++)
+		{
+			std::map<int,Node>::iterator it=targets.find(nodes[i].key);
+			if(it==targets.end())
+			{
+				Node n;
+				n.key=nodes[i].key;
+				n.parent=0;
+				n.calls=0;
+				n.total=0;
+				n.self=0;
+				it=targets.insert(std::make_pair(n.key,n)).first;
+			}
+			it->second.calls+=nodes[i].calls;
+			it->second.total+=nodes[i].total;
+			it->second.self+=nodes[i].self;
+		}
+		out+="[target] [calls] [total cycles] [self cycles]\n";
+		std::map<int,Node>::iterator it=targets.begin();
+		for(;it!=targets.end();it++)
+		{
+			line.Format("%s %I64u %I64u %I64u\n",(LPCSTR)Name(it->first),it->second.calls,it->second.total,it->second.self);
+			out+=line;
+		}
+		return out;
+	}
+private:
+	inline CString Name(int key)
+	{
+		Names::iterator it=names.find(key);
+		if(it!=names.end())
+			return it->second;
+		CString name;
+		name.Format("#%X",key);
+		return name;
+	}
+private:
+	Cycles opCounts[PROFILE_OPCODES];
+	Cycles opCycles[PROFILE_OPCODES];
+	int lastOp;
+	Cycles lastTime;
+	Nodes nodes;
+	Frames frames;
+	Names names;
+};
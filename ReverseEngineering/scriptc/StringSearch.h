@@ -0,0 +1,287 @@
+#pragma once
+//ַңӴSSE2βֽڳɸѡѡλúٱȽм䲿֣
+//ӴAho-CorasickԶԱҵַֻɨһ顣
+//ƥжCString::Find_mbsstrһ£ֽڴҳֻдַ߽翪ʼƥЧ
+//CStringⲻWindowsͷļϵͳֽڴҳԵԡ
+#include <string.h>
+#include <vector>
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <mbctype.h>
+#define STRINGSEARCH_LEAD(c)	_ismbblead(c)
+#else
+#include <cpuid.h>
+#define STRINGSEARCH_LEAD(c)	((void)(c),0)	//ֽڴҳûǰֽڣֵδʹõľ
+#endif
+
+#define MULTISEARCH_MAXSTATES	4096		//Զ״̬ӴʱΪ
+
+class StringSearch
+{
+public:
+	//s[0,len)дstartʼneedleƥλãûҵʱ-1
+	static inline int Find(const char* s,int len,int start,const char* needle,int nlen)
+	{
+		if(start<0)
+			start=0;
+		if(start>len)
+			return -1;
+		if(nlen==0)
+			return start;
+		int cursor=start;
+		int pos=start;
+		for(;;)
+		{
+			pos=FindBytes(s,len,pos,needle,nlen);
+			if(pos<0)
+				return -1;
+			if(AtBoundary(s,cursor,pos))
+				return pos;
+			pos++;
+		}
+	}
+#ifdef _WIN32
+	static inline int Find(const CString& s,const CString& needle,int start=0)
+	{
+		return Find((LPCSTR)s,s.GetLength(),start,(LPCSTR)needle,needle.GetLength());
+	}
+#endif
+	//cursorΪposַ߽磬ַƽposԽposposǷΪַ߽
+	static inline bool AtBoundary(const char* s,int& cursor,int pos)
+	{
+		while(cursor<pos)
+			cursor+=STRINGSEARCH_LEAD((unsigned char)s[cursor])?2:1;
+		return cursor==pos;
+	}
+	//ֽڲңַ߽
+	static inline int FindBytes(const char* s,int len,int start,const char* needle,int nlen)
+	{
+		int last=len-nlen;
+		int mid=(nlen>2)?nlen-2:0;
+		int i=start;
+		if(HasSSE2())
+		{
+			__m128i first=_mm_set1_epi8(needle[0]);
+			__m128i tail=_mm_set1_epi8(needle[nlen-1]);
+			for(;i+15<=last;i+=16)
+			{
+				__m128i a=_mm_loadu_si128((const __m128i*)(s+i));
+				__m128i b=_mm_loadu_si128((const __m128i*)(s+i+nlen-1));
+				int mask=_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a,first),_mm_cmpeq_epi8(b,tail)));
+				while(mask)
+				{
+					unsigned long bit=LowestBit(mask);
+					if(::memcmp(s+i+bit+1,needle+1,mid)==0)
+						return i+bit;
+					mask&=mask-1;
+				}
+			}
+		}
+		for(;i<=last;i++)
+		{
+			if(s[i]==needle[0] && ::memcmp(s+i+1,needle+1,nlen-1)==0)
+				return i;
+		}
+		return -1;
+	}
+	static inline bool HasSSE2(void)
+	{
+		static int sse2=-1;
+		if(sse2<0)
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info,1);
+			sse2=(info[3]&(1<<26))?1:0;
+#else
+			unsigned int a,b,c,d;
+			sse2=(__get_cpuid(1,&a,&b,&c,&d) && (d&(1<<26)))?1:0;
+#endif
+		}
+		return sse2!=0;
+	}
+	static inline unsigned long LowestBit(int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanForward(&bit,mask);
+		return bit;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+};
+
+//ӴAho-CorasickԶֻӴгֵֽڸռһֽֽ࣬ڹ0
+//תƱ״ֽ̬չΪȷԶɨʱÿֻֽһα
+class MultiSearch
+{
+	unsigned char classes[256];
+	int classNum;
+	std::vector<int> delta;					//delta[state*classNum+class]Ϊһ״̬ףBuild
+	std::vector<std::vector<int> > outputs;	//״̬ʱӴʧϵ
+	std::vector<int> lengths;
+	int maxLength;
+public:
+	MultiSearch(void)
+	{
+		::memset(classes,0,sizeof(classes));
+		classNum=1;
+		maxLength=0;
+	}
+#ifdef _WIN32
+	inline bool Build(const std::vector<CString>& needles)
+	{
+		std::vector<const char*> texts;
+		std::vector<int> lens;
+		for(size_t i=0;i<needles.size();i++)
+		{
+			texts.push_back((LPCSTR)needles[i]);
+			lens.push_back(needles[i].GetLength());
+		}
+		return Build(texts.empty()?NULL:&texts[0],lens.empty()?NULL:&lens[0],(int)texts.size());
+	}
+#endif
+	//nӴneedles[i]Ϊlens[i]״̬MULTISEARCH_MAXSTATESʱfalse
+	inline bool Build(const char* const* needles,const int* lens,int n)
+	{
+		int total=1;
+		::memset(classes,0,sizeof(classes));
+		classNum=1;
+		maxLength=0;
+		lengths.clear();
+		for(int i=0;i<n;i++)
+		{
+			const unsigned char* p=(const unsigned char*)needles[i];
+			int len=lens[i];
+			for(int j=0;j<len;j++)
+			{
+				if(!classes[p[j]])
+					classes[p[j]]=classNum++;
+			}
+			lengths.push_back(len);
+			if(len>maxLength)
+				maxLength=len;
+			total+=len;
+		}
+		if(total>MULTISEARCH_MAXSTATES)
+			return false;
+		delta.assign(classNum,-1);
+		outputs.clear();
+		outputs.resize(1);
+		for(int i=0;i<n;i++)
+		{
+			const unsigned char* p=(const unsigned char*)needles[i];
+			int state=0;
+			for(int j=0;j<lengths[i];j++)
+			{
+				int k=state*classNum+classes[p[j]];
+				if(delta[k]<0)
+				{
+					delta[k]=outputs.size();
+					delta.resize(delta.size()+classNum,-1);
+					outputs.resize(outputs.size()+1);
+				}
+				state=delta[k];
+			}
+			if(lengths[i]>0)
+				outputs[state].push_back(i);
+		}
+		//ȼʧתƲȫתƱ
+		std::vector<int> fail(outputs.size(),0);
+		std::vector<int> queue;
+		for(int c=0;c<classNum;c++)
+		{
+			int next=delta[c];
+			if(next<0)
+				delta[c]=0;
+			else
+				queue.push_back(next);
+		}
+		for(size_t q=0;q<queue.size();q++)
+		{
+			int state=queue[q];
+			for(int c=0;c<classNum;c++)
+			{
+				int& next=delta[state*classNum+c];
+				int alt=delta[fail[state]*classNum+c];
+				if(next<0)
+				{
+					next=alt;
+					continue;
+				}
+				fail[next]=alt;
+				outputs[next].insert(outputs[next].end(),outputs[alt].begin(),outputs[alt].end());
+				queue.push_back(next);
+			}
+		}
+		//תƱĴһ״̬ףӴ״̬ȡɨʱسclassNumҲֽڲoutputs
+		for(size_t k=0;k<delta.size();k++)
+		{
+			int next=delta[k];
+			delta[k]=outputs[next].empty()?next*classNum:~(next*classNum);
+		}
+		return true;
+	}
+	//ÿӴǷs[0,len)г
+	inline bool ContainsAll(const char* s,int len) const
+	{
+		int n=lengths.size();
+		char local[64];
+		std::vector<char> heap;
+		char* found=local;
+		if(n>(int)sizeof(local))
+		{
+			heap.resize(n);
+			found=&heap[0];
+		}
+		::memset(found,0,n);
+		int remain=n;
+		for(int i=0;i<n;i++)
+		{
+			if(lengths[i]==0)
+			{
+				found[i]=1;
+				remain--;
+			}
+		}
+		if(remain==0)
+			return true;
+		int row=0;
+		int cursor=0;
+		for(int i=0;i<len;i++)
+		{
+			int next=delta[row+classes[(unsigned char)s[i]]];
+			if(next>=0)
+			{
+				row=next;
+				continue;
+			}
+			row=~next;
+			//cursorƽΪ˴κƥַ߽
+			int low=i+1-maxLength;
+			while(cursor<low)
+			{
+				int step=STRINGSEARCH_LEAD((unsigned char)s[cursor])?2:1;
+				if(cursor+step>low)
+					break;
+				cursor+=step;
+			}
+			const std::vector<int>& out=outputs[row/classNum];
+			for(size_t k=0;k<out.size();k++)
+			{
+				int id=out[k];
+				if(found[id])
+					continue;
+				int c=cursor;
+				if(!StringSearch::AtBoundary(s,c,i-lengths[id]+1))
+					continue;
+				found[id]=1;
+				if(--remain==0)
+					return true;
+			}
+		}
+		return false;
+	}
+};
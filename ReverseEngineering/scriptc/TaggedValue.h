@@ -0,0 +1,405 @@
+#pragma once
+//ű·ʹõ16ֽڴֵ
+//븡ֱӴֵڣVARIANTķ䡢VariantCopyVariantClear
+//ָֻ벢άüټװ䱣档
+//ļWindowsͷļװ͵ĹPolicyṩ˿COMԡ
+
+#ifdef _MSC_VER
+typedef __int64 TaggedInt64;
+typedef unsigned __int64 TaggedUInt64;
+#else
+typedef long long TaggedInt64;
+typedef unsigned long long TaggedUInt64;
+#endif
+
+enum TaggedValueTag
+{
+	TAG_EMPTY=0,	//ֵΪ0
+	TAG_INT,		//32λӦVT_I4
+	TAG_DOUBLE,		//˫ȸӦVT_R8
+	TAG_OBJECT,		//ָ루һãӦVT_DISPATCH
+	TAG_BOXED		//ͣװ䱣
+};
+
+//PolicyҪṩ
+//	typedef ... Object;	ͣṩAddRef/Release
+//	typedef ... Boxed;	װ
+//	static Boxed* CloneBox(const Boxed*);
+//	static void FreeBox(Boxed*);
+//	static int BoxLow32(const Boxed*);	װֵ32λʱֵ
+template<typename Policy>
+	class TaggedValueT
+{
+public:
+	typedef typename Policy::Object Object;
+	typedef typename Policy::Boxed Boxed;
+public:
+	int tag;
+	int reserved;
+	//طڵ8ֽ˫ȵ32λصVARIANTlValdblValĲһ£
+	//ԭlValȡ32λΪԱ֡
+	union
+	{
+		int i;
+		unsigned int u;
+		double d;
+		TaggedInt64 l;
+		Object* o;
+		Boxed* b;
+	};
+public:
+	TaggedValueT(void)
+	{
+		tag=TAG_EMPTY;
+		reserved=0;
+		l=0;
+	}
+	TaggedValueT(const TaggedValueT& v)
+	{
+		tag=TAG_EMPTY;
+		reserved=0;
+		l=0;
+		CopyFrom(v);
+	}
+	~TaggedValueT()
+	{
+		Clear();
+	}
+	inline TaggedValueT& operator=(const TaggedValueT& v)
+	{
+		if(this!=&v)
+		{
+			Clear();
+			CopyFrom(v);
+		}
+		return *this;
+	}
+	inline void Clear(void)
+	{
+		if(tag==TAG_OBJECT)
+		{
+			if(o)
+				o->Release();
+		}
+		else if(tag==TAG_BOXED)
+		{
+			Policy::FreeBox(b);
+		}
+		tag=TAG_EMPTY;
+		l=0;
+	}
+	//vֵƵֵvΪֵıü
+	inline void MoveFrom(TaggedValueT& v)
+	{
+		if(this==&v)
+			return;
+		Clear();
+		tag=v.tag;
+		l=v.l;
+		v.tag=TAG_EMPTY;
+		v.l=0;
+	}
+	inline void SetInt(int v)
+	{
+		if(tag>=TAG_OBJECT)
+			Clear();
+		tag=TAG_INT;
+		l=0;
+		i=v;
+	}
+	inline void SetDouble(double v)
+	{
+		if(tag>=TAG_OBJECT)
+			Clear();
+		tag=TAG_DOUBLE;
+		d=v;
+	}
+	//ӹһõĶָ
+	inline void AttachObject(Object* v)
+	{
+		Clear();
+		tag=TAG_OBJECT;
+		o=v;
+	}
+	//ӹһװֵ
+	inline void AttachBox(Boxed* v)
+	{
+		Clear();
+		tag=TAG_BOXED;
+		b=v;
+	}
+	//ָ루ͬãֵΪֵ
+	inline Object* DetachObject(void)
+	{
+		Object* v=o;
+		tag=TAG_EMPTY;
+		l=0;
+		return v;
+	}
+	//װֵֵΪֵ
+	inline Boxed* DetachBox(void)
+	{
+		Boxed* v=b;
+		tag=TAG_EMPTY;
+		l=0;
+		return v;
+	}
+	inline bool IsInt(void) const
+	{
+		return tag==TAG_INT;
+	}
+	inline bool IsDouble(void) const
+	{
+		return tag==TAG_DOUBLE;
+	}
+	//򸡵
+	inline bool IsNumber(void) const
+	{
+		return tag==TAG_INT || tag==TAG_DOUBLE;
+	}
+	//32λ͵ֵȼVARIANTlVal
+	inline int Low32(void) const
+	{
+		if(tag==TAG_BOXED)
+			return Policy::BoxLow32(b);
+		return i;
+	}
+	//VARIANT_BOOL͵ֵȼVARIANTboolVal
+	inline short Low16(void) const
+	{
+		return (short)Low32();
+	}
+	//תΪ븡
+	inline double ToDouble(void) const
+	{
+		if(tag==TAG_DOUBLE)
+			return d;
+		return (double)i;
+	}
+private:
+	inline void CopyFrom(const TaggedValueT& v)
+	{
+		tag=v.tag;
+		if(tag==TAG_OBJECT)
+		{
+			o=v.o;
+			if(o)
+				o->AddRef();
+		}
+		else if(tag==TAG_BOXED)
+		{
+			b=Policy::CloneBox(v.b);
+		}
+		else
+		{
+			l=v.l;
+		}
+	}
+};
+
+//ֵԭ㣬ԭеVARIANTһ¡
+//븡falseʾҪɵͨã٣·ʱ޸ġ
+template<typename V>
+	struct TaggedArithT
+{
+	static inline bool Add(V& a,const V& c)
+	{
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			a.i+=c.i;
+			return true;
+		}
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetDouble(a.ToDouble()+c.ToDouble());
+		return true;
+	}
+	static inline bool Sub(V& a,const V& c)
+	{
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			a.i-=c.i;
+			return true;
+		}
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetDouble(a.ToDouble()-c.ToDouble());
+		return true;
+	}
+	static inline bool Mul(V& a,const V& c)
+	{
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			a.i*=c.i;
+			return true;
+		}
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetDouble(a.ToDouble()*c.ToDouble());
+		return true;
+	}
+	//00x80000000-1ͨ·ԭһVARIANT쳣
+	static inline bool Div(V& a,const V& c)
+	{
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			if(c.i==0 || (c.i==-1 && a.u==0x80000000))
+				return false;
+			a.i/=c.i;
+			return true;
+		}
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetDouble(a.ToDouble()/c.ToDouble());
+		return true;
+	}
+	//OP_MODOP_ANDOP_OROP_XOR޷㣬ʱתΪ64λ޷㣬
+	//0ȡģͬͨ·
+	static inline bool Bits(int op,V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			unsigned int v1=a.u,v2=c.u;
+			if(op==0 && v2==0)
+				return false;
+			switch(op)
+			{
+			case 0:a.u=v1%v2;break;
+			case 1:a.u=v1&v2;break;
+			case 2:a.u=v1|v2;break;
+			default:a.u=v1^v2;break;
+			}
+			return true;
+		}
+		TaggedUInt64 v1=(TaggedUInt64)a.ToDouble();
+		TaggedUInt64 v2=(TaggedUInt64)c.ToDouble();
+		if(op==0 && v2==0)
+			return false;
+		TaggedUInt64 r;
+		switch(op)
+		{
+		case 0:r=v1%v2;break;
+		case 1:r=v1&v2;break;
+		case 2:r=v1|v2;break;
+		default:r=v1^v2;break;
+		}
+		a.SetDouble((double)r);
+		return true;
+	}
+	static inline bool Shl(V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		if(a.tag==TAG_DOUBLE)
+			a.d=(double)(((TaggedUInt64)a.d)<<c.u);
+		else
+			a.u<<=c.u;
+		return true;
+	}
+	static inline bool Shr(V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		if(a.tag==TAG_DOUBLE)
+			a.d=(double)(((TaggedInt64)a.d)>>c.u);
+		else
+			a.u>>=c.u;
+		return true;
+	}
+	//OP_ANDANDOP_OROR16λVARIANT_BOOLж
+	static inline bool AndAnd(V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetInt((a.Low16() && c.Low16())?1:0);
+		return true;
+	}
+	static inline bool OrOr(V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		a.SetInt((a.Low16() || c.Low16())?1:0);
+		return true;
+	}
+	//OP_EQOP_NE߶ǸʱȽϣ򰴵32λȽ
+	static inline bool Equal(V& a,const V& c,bool ne)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		bool eq;
+		if(a.tag==TAG_DOUBLE && c.tag==TAG_DOUBLE)
+			eq=(a.d==c.d);
+		else
+			eq=(a.i==c.i);
+		if(ne)
+			eq=!eq;
+		a.SetInt(eq?1:0);
+		return true;
+	}
+	//OP_LTOP_GTOP_LEOP_GEopΪ03һǸʱȽ
+	static inline bool Compare(int op,V& a,const V& c)
+	{
+		if(!a.IsNumber() || !c.IsNumber())
+			return false;
+		int cmp;
+		if(a.tag==TAG_INT && c.tag==TAG_INT)
+		{
+			cmp=(a.i<c.i)?-1:((a.i>c.i)?1:0);
+		}
+		else
+		{
+			double v1=a.ToDouble(),v2=c.ToDouble();
+			cmp=(v1<v2)?-1:((v1>v2)?1:0);
+		}
+		bool r;
+		switch(op)
+		{
+		case 0:r=(cmp<0);break;
+		case 1:r=(cmp>0);break;
+		case 2:r=(cmp<=0);break;
+		default:r=(cmp>=0);break;
+		}
+		a.SetInt(r?1:0);
+		return true;
+	}
+	static inline bool Neg(V& a)
+	{
+		if(a.tag==TAG_INT)
+			a.u=~a.u;
+		else if(a.tag==TAG_DOUBLE)
+			a.d=(double)(~((TaggedUInt64)a.d));
+		else
+			return false;
+		return true;
+	}
+	static inline bool Not(V& a)
+	{
+		if(!a.IsNumber())
+			return false;
+		a.SetInt((!a.Low16())?1:0);
+		return true;
+	}
+	static inline bool USub(V& a)
+	{
+		if(a.tag==TAG_INT)
+			a.i=-a.i;
+		else if(a.tag==TAG_DOUBLE)
+			a.d=-a.d;
+		else
+			return false;
+		return true;
+	}
+	//OP_INCOP_DEC
+	static inline bool Step(V& a,int delta)
+	{
+		if(a.tag==TAG_INT)
+			a.i+=delta;
+		else if(a.tag==TAG_DOUBLE)
+			a.d+=delta;
+		else
+			return false;
+		return true;
+	}
+};
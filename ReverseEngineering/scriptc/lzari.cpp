@@ -35,16 +35,34 @@
 			vectorľʵˣ
 *********************************************************************/
 
+/********************************************************************
+	Ϊֱд뻺پvectorֽ׷Ӻ帴ƣ
+	CompressTo/DecompressToдṩĻʱ-1
+	Compress豶ԼĻDecompressͷ¼ĳһη䡣
+	ȡԽĩβʱ0λ𻵵ݲԽ硣
+*********************************************************************/
+
+#ifdef _WIN32
 #include "StdAfx.h"
-#include "Lzari.h"
+#else
+//Linuxtest/ScriptImageTest.cppһ룬ʹԤͷ
+#include <stdio.h>
+#include <string.h>
+typedef unsigned char BYTE;
+#endif
+#include "lzari.h"
 
 LZARI::LZARI()
 {
+	m_pOutBuffer = NULL;
+	m_bOutGrow = false;
 	Reset();
 }
 
 LZARI::~LZARI()
-{}
+{
+	Reset();
+}
 
 void LZARI::Error(char *message)
 {
@@ -55,12 +73,27 @@ void LZARI::Error(char *message)
 	throw e;
 }
 
+void LZARI::PutByte(BYTE c)
+{
+	if (m_nOutLength >= m_nOutCapacity)
+	{
+		if (!m_bOutGrow) Error("Output buffer overflow");
+		int capacity = m_nOutCapacity * 2 + 64;
+		BYTE *p = new BYTE[capacity];
+		if (m_nOutLength > 0) memcpy(p, m_pOutBuffer, m_nOutLength);
+		delete[] m_pOutBuffer;
+		m_pOutBuffer = p;
+		m_nOutCapacity = capacity;
+	}
+	m_pOutBuffer[m_nOutLength++] = c;
+}
+
 void LZARI::PutBit(int bit)  /* Output one bit (bit = 0,1) */
 {
 	if (bit) buffer_putbit |= mask_putbit;
 	if ((mask_putbit >>= 1) == 0) 
 	{
-		m_OutBuffer.push_back(buffer_putbit);
+		PutByte(buffer_putbit);
 		buffer_putbit = 0;  
 		mask_putbit = 128;  
 		codesize++;
@@ -78,7 +111,7 @@ int LZARI::GetBit(void)  /* Get one bit (0 or 1) */
 {	
 	if ((mask_getbit >>= 1) == 0) 
 	{
-		buffer_getbit = m_pInBuffer[m_nInCur++];
+		buffer_getbit = (m_nInCur < m_nInLength) ? m_pInBuffer[m_nInCur++] : 0;
 		mask_getbit = 128;
 	}
 	return ((buffer_getbit & mask_getbit) != 0);
@@ -384,8 +417,8 @@ void LZARI::Encode(void)
 	int  i, c, len, r, s, last_match_length;
 	
 	textsize = m_nInLength;
-	m_OutBuffer.resize(sizeof textsize);
-	memcpy(&m_OutBuffer[0],&textsize,sizeof textsize);
+	for (i = 0; i < (int)sizeof textsize; i++)
+		PutByte(((BYTE *)&textsize)[i]);
 	codesize += sizeof textsize;
 	if(textsize == 0) return;
 	m_nInCur = 0;
@@ -462,10 +495,11 @@ void LZARI::Decode(void)
 		Error("Read Error");
 	memcpy(&textsize,m_pInBuffer + m_nInCur,sizeof textsize);
 	
-	m_nOutLength = textsize;	
 	m_nInCur += sizeof textsize;
 	
 	if (textsize == 0) return;
+	if (textsize > (unsigned long)m_nOutCapacity)
+		Error("Output buffer overflow");
 	
 	StartDecode();
 	StartModel();
@@ -477,7 +511,7 @@ void LZARI::Decode(void)
 		c = DecodeChar();
 		if (c < 256) 
 		{
-			m_OutBuffer.push_back(c);
+			m_pOutBuffer[count] = c;
 			text_buf[r++] = c;
 			r &= (N - 1);
 			count++;
@@ -486,10 +520,11 @@ void LZARI::Decode(void)
 		{
 			i = (r - DecodePosition() - 1) & (N - 1);
 			j = c - 255 + THRESHOLD;
+			if ((unsigned long)j > textsize - count) Error("Data corrupt");
 			for (k = 0; k < j; k++) 
 			{
 				c = text_buf[(i + k) & (N - 1)];
-				m_OutBuffer.push_back(c);
+				m_pOutBuffer[count] = c;
 				text_buf[r++] = c;
 				r &= (N - 1);
 				count++;
@@ -507,6 +542,7 @@ void LZARI::Decode(void)
 #ifdef _OUTPUT_STATUS
 	printf("%12lu\n", count);
 #endif
+	m_nOutLength = count;
 }
 
 
@@ -516,33 +552,85 @@ BYTE* LZARI::Compress(const BYTE *pInBuffer,int nInLength,int &nOutLength)
 	m_pInBuffer = pInBuffer;
 	m_nInLength = nInLength;
 	m_nInCur = 0;
+	m_nOutCapacity = nInLength / 2 + 64;
+	m_pOutBuffer = new BYTE[m_nOutCapacity];
+	m_bOutGrow = true;
 
 	Encode();
-	nOutLength = m_OutBuffer.size();
-
-	BYTE* pOutBuffer=new BYTE[nOutLength];
-	for(int i=0;i<nOutLength;i++)
-		pOutBuffer[i]=m_OutBuffer[i];
+	nOutLength = m_nOutLength;
 
+	BYTE* pOutBuffer=m_pOutBuffer;
+	m_pOutBuffer = NULL;
 	Reset();
 	return pOutBuffer;
 }
 
 BYTE* LZARI::Decompress(const BYTE *pInBuffer,int nInLength,int &nOutLength)
 {
+	int size = DecompressedSize(pInBuffer,nInLength);
+	if (size < 0)
+		Error("Read Error");
+	BYTE* pOutBuffer=new BYTE[size > 0 ? size : 1];
+	nOutLength = DecompressTo(pInBuffer,nInLength,pOutBuffer,size);
+	if (nOutLength < 0)
+	{
+		delete[] pOutBuffer;
+		Error("Data corrupt");
+	}
+	return pOutBuffer;
+}
+
+int LZARI::CompressTo(const BYTE *pInBuffer,int nInLength,BYTE *pOutBuffer,int nOutCapacity)
+{
+	int nOutLength = -1;
+	Reset();
 	m_pInBuffer = pInBuffer;
 	m_nInLength = nInLength;
 	m_nInCur = 0;
+	m_pOutBuffer = pOutBuffer;
+	m_nOutCapacity = nOutCapacity;
+	try
+	{
+		Encode();
+		nOutLength = m_nOutLength;
+	}
+	catch(int)
+	{
+	}
+	m_pOutBuffer = NULL;
+	Reset();
+	return nOutLength;
+}
 
-	Decode();
-	nOutLength = m_OutBuffer.size();
-
-	BYTE* pOutBuffer=new BYTE[nOutLength];
-	for(int i=0;i<nOutLength;i++)
-		pOutBuffer[i]=m_OutBuffer[i];
-
+int LZARI::DecompressTo(const BYTE *pInBuffer,int nInLength,BYTE *pOutBuffer,int nOutCapacity)
+{
+	int nOutLength = -1;
 	Reset();
-	return pOutBuffer;
+	m_pInBuffer = pInBuffer;
+	m_nInLength = nInLength;
+	m_nInCur = 0;
+	m_pOutBuffer = pOutBuffer;
+	m_nOutCapacity = nOutCapacity;
+	try
+	{
+		Decode();
+		nOutLength = m_nOutLength;
+	}
+	catch(int)
+	{
+	}
+	m_pOutBuffer = NULL;
+	Reset();
+	return nOutLength;
+}
+
+int LZARI::DecompressedSize(const BYTE *pInBuffer,int nInLength)
+{
+	unsigned long size;
+	if (nInLength < (int)sizeof size)
+		return -1;
+	memcpy(&size,pInBuffer,sizeof size);
+	return (int)size;
 }
 
 void LZARI::Reset(void)
@@ -560,8 +648,11 @@ void LZARI::Reset(void)
 	m_nInLength = 0;
 	m_nInCur = 0;
 	
-	m_OutBuffer.clear();
+	if (m_bOutGrow) delete[] m_pOutBuffer;
+	m_pOutBuffer = NULL;
 	m_nOutLength = 0;
+	m_nOutCapacity = 0;
+	m_bOutGrow = false;
 
 	buffer_putbit = 0;
 	mask_putbit = 128;
@@ -72,8 +72,10 @@ protected:
 	unsigned int sym_cum[N_CHAR + 1];   /* cumulative freq for symbols */
 	unsigned int position_cum[N + 1];   /* cumulative freq for positions */
 
-	std::vector<BYTE> m_OutBuffer;
+	BYTE *m_pOutBuffer;
 	int m_nOutLength;
+	int m_nOutCapacity;
+	bool m_bOutGrow;	/* output buffer is ours and may be enlarged */
 
 	const BYTE *m_pInBuffer;
 	int m_nInLength;
@@ -84,6 +86,7 @@ protected:
 
 private:
 	void Error(char *message);
+	void PutByte(BYTE c);
 	void PutBit(int bit);  /* Output one bit (bit = 0,1) */
 	void FlushBitBuffer(void);  /* Send remaining bits */
 	int GetBit(void);  /* Get one bit (0 or 1) */
@@ -110,6 +113,12 @@ private:
 public:
 	BYTE* Compress(const BYTE *pInBuffer,int nInLength,int &nOutLength);
 	BYTE* Decompress(const BYTE *pInBuffer,int nInLength,int &nOutLength);
+	/* work on caller buffers without intermediate copies,
+	   return the output length or -1 when the buffer is too small or the data is corrupt */
+	int CompressTo(const BYTE *pInBuffer,int nInLength,BYTE *pOutBuffer,int nOutCapacity);
+	int DecompressTo(const BYTE *pInBuffer,int nInLength,BYTE *pOutBuffer,int nOutCapacity);
+	/* original length stored in the compressed data, -1 if too short */
+	static int DecompressedSize(const BYTE *pInBuffer,int nInLength);
 	void Reset(void);
 };
 
@@ -0,0 +1,227 @@
+#pragma once
+//ֽڶĿLZѹڽűӳĴѹٶԶLZARI
+//ѹɣÿΪ
+//	ֽڣ4λΪȣ4λΪƥ䳤ȼ4Ϊ15ʱչֽڣչֽΪ255ʱ
+//	
+//	ƥ루2ֽڣСˣƥ䳤ȵչֽ
+//һֻûƥ䲿֡ڵṩĻϣûм临ơ
+#include <string.h>
+
+#define LZFAST_TAG			0x31465A4C	//'L','Z','F','1'ݵͷ
+#define LZFAST_HASHLOG		13
+#define LZFAST_HASHSIZE		(1<<LZFAST_HASHLOG)
+#define LZFAST_MINMATCH		4
+#define LZFAST_MAXDISTANCE	65535
+#define LZFAST_LASTLITERALS	5			//ĩβٱΪֽ
+#define LZFAST_MFLIMIT		12			//ĩβʱٲƥ
+
+//ݵͷѹĴСΪѹ
+struct LZFastHeader
+{
+	unsigned int tag;
+	unsigned int size;
+};
+
+class LZFast
+{
+	int table[LZFAST_HASHSIZE];		//ɢֵֵλü10ʾû
+public:
+	//ѹlenֽС
+	static inline int Bound(int len)
+	{
+		return len+len/255+16;
+	}
+	//ѹoutѹĴСʱ-1
+	inline int Compress(const BYTE* in,int len,BYTE* out,int capacity)
+	{
+		::memset(table,0,sizeof(table));
+		const BYTE* ip=in;
+		const BYTE* anchor=in;
+		const BYTE* iend=in+len;
+		const BYTE* mflimit=iend-LZFAST_MFLIMIT;
+		const BYTE* matchlimit=iend-LZFAST_LASTLITERALS;
+		BYTE* op=out;
+		BYTE* oend=out+capacity;
+		if(len>=LZFAST_MFLIMIT)
+		{
+			int misses=0;
+			while(ip<mflimit)
+			{
+				unsigned int seq=Read32(ip);
+				int h=Hash(seq);
+				int ref=table[h]-1;
+				table[h]=(int)(ip-in)+1;
+				if(ref<0 || ip-(in+ref)>LZFAST_MAXDISTANCE || Read32(in+ref)!=seq)
+				{
+					//ҲƥʱӴ󲽳ѹ
+					ip+=1+(misses++>>6);
+					continue;
+				}
+				misses=0;
+				const BYTE* match=in+ref;
+				const BYTE* mp=ip+LZFAST_MINMATCH;
+				const BYTE* rp=match+LZFAST_MINMATCH;
+				while(mp<matchlimit && *mp==*rp)
+				{
+					mp++;
+					rp++;
+				}
+				op=PutSequence(op,oend,anchor,(int)(ip-anchor),(int)(ip-match),(int)(mp-ip));
+				if(!op)
+					return -1;
+				ip=mp;
+				anchor=ip;
+				//Ǽƥĩβλãһƥ
+				if(ip-2>=in && ip<mflimit)
+					table[Hash(Read32(ip-2))]=(int)(ip-2-in)+1;
+			}
+		}
+		op=PutSequence(op,oend,anchor,(int)(iend-anchor),0,0);
+		if(!op)
+			return -1;
+		return (int)(op-out);
+	}
+	//ѹoutؽѹĴС𻵻ʱ-1
+	static inline int Decompress(const BYTE* in,int len,BYTE* out,int capacity)
+	{
+		const BYTE* ip=in;
+		const BYTE* iend=in+len;
+		BYTE* op=out;
+		BYTE* oend=out+capacity;
+		while(ip<iend)
+		{
+			int token=*ip++;
+			int litlen=token>>4;
+			if(litlen==15 && !GetLength(ip,iend,litlen))
+				return -1;
+			if(litlen>iend-ip || litlen>oend-op)
+				return -1;
+			::memcpy(op,ip,litlen);
+			ip+=litlen;
+			op+=litlen;
+			if(ip>=iend)
+				break;
+			if(iend-ip<2)
+				return -1;
+			int offset=ip[0]|(ip[1]<<8);
+			ip+=2;
+			int matchlen=token&15;
+			if(matchlen==15 && !GetLength(ip,iend,matchlen))
+				return -1;
+			matchlen+=LZFAST_MINMATCH;
+			if(offset==0 || offset>op-out || matchlen>oend-op)
+				return -1;
+			const BYTE* match=op-offset;
+			if(offset>=matchlen)
+			{
+				::memcpy(op,match,matchlen);
+				op+=matchlen;
+			}
+			else
+			{
+				//صƥֽڸ
+				for(int i=0;i<matchlen;i++)
+					*op++=*match++;
+			}
+		}
+		return (int)(op-out);
+	}
+	//ͷشĴСʱ-1
+	inline int Pack(const BYTE* in,int len,BYTE* out,int capacity)
+	{
+		if(capacity<(int)sizeof(LZFastHeader))
+			return -1;
+		LZFastHeader header;
+		header.tag=LZFAST_TAG;
+		header.size=len;
+		::memcpy(out,&header,sizeof(header));
+		int size=Compress(in,len,out+sizeof(header),capacity-sizeof(header));
+		if(size<0)
+			return -1;
+		return size+sizeof(header);
+	}
+	static inline bool IsPacked(const BYTE* in,int len)
+	{
+		if(len<(int)sizeof(LZFastHeader))
+			return false;
+		LZFastHeader header;
+		::memcpy(&header,in,sizeof(header));
+		return header.tag==LZFAST_TAG;
+	}
+	//ݽѹĴСǴʱ-1
+	static inline int PackedSize(const BYTE* in,int len)
+	{
+		if(!IsPacked(in,len))
+			return -1;
+		LZFastHeader header;
+		::memcpy(&header,in,sizeof(header));
+		return (int)header.size;
+	}
+	static inline int Unpack(const BYTE* in,int len,BYTE* out,int capacity)
+	{
+		if(!IsPacked(in,len))
+			return -1;
+		return Decompress(in+sizeof(LZFastHeader),len-sizeof(LZFastHeader),out,capacity);
+	}
+private:
+	static inline unsigned int Read32(const BYTE* p)
+	{
+		unsigned int v;
+		::memcpy(&v,p,sizeof(v));
+		return v;
+	}
+	static inline int Hash(unsigned int seq)
+	{
+		return (int)((seq*2654435761U)>>(32-LZFAST_HASHLOG));
+	}
+	static inline bool GetLength(const BYTE*& ip,const BYTE* iend,int& len)
+	{
+		int b;
+		do
+		{
+			if(ip>=iend)
+				return false;
+			b=*ip++;
+			len+=b;
+		}while(b==255);
+		return true;
+	}
+	static inline BYTE* PutLength(BYTE* op,BYTE* oend,int len)
+	{
+		while(len>=255)
+		{
+			if(op>=oend)
+				return NULL;
+			*op++=255;
+			len-=255;
+		}
+		if(op>=oend)
+			return NULL;
+		*op++=(BYTE)len;
+		return op;
+	}
+	//дһУmatchlenΪ0ʱֻд
+	static inline BYTE* PutSequence(BYTE* op,BYTE* oend,const BYTE* literals,int litlen,int offset,int matchlen)
+	{
+		if(op>=oend)
+			return NULL;
+		BYTE* token=op++;
+		int ml=matchlen?matchlen-LZFAST_MINMATCH:0;
+		*token=(BYTE)(((litlen<15?litlen:15)<<4)|(ml<15?ml:15));
+		if(litlen>=15 && !(op=PutLength(op,oend,litlen-15)))
+			return NULL;
+		if(litlen>oend-op)
+			return NULL;
+		::memcpy(op,literals,litlen);
+		op+=litlen;
+		if(!matchlen)
+			return op;
+		if(oend-op<2)
+			return NULL;
+		*op++=(BYTE)(offset&0xff);
+		*op++=(BYTE)(offset>>8);
+		if(ml>=15 && !(op=PutLength(op,oend,ml-15)))
+			return NULL;
+		return op;
+	}
+};
@@ -0,0 +1,601 @@
+//.scbűӳԣLinuxg++룬Windowsͷļ
+//	g++ -O2 -fwrapv -o ScriptImageTest ScriptImageTest.cpp ../lzari.cpp
+//DecodeInstructionsڽATLﰴɵָָʽֱӹ򣺳ַ
+//֧гϡֲѡȡıʾʽѭϸֵ֧תɽSaveImage/LoadSections
+//ͬʹõScriptImageTablesдѹLZARILZFastַʽӳдļٶءѹװأ
+//ȽװǰĸԤִָнģ帲ǵָDecodedExecִС
+//װغĳٴдӦԭӳֽͬضϻдӳӦܾ
+//ʵWindowsϵtest.exe <script> -scb֤
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned int UINT;
+#include "../ScriptImage.h"
+#include "../DecodedExec.h"
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+//ֻ븡װͲ
+struct TestPolicy
+{
+	struct Object
+	{
+		void AddRef(void)
+		{
+		}
+		void Release(void)
+		{
+		}
+	};
+	struct Boxed
+	{
+		int v;
+	};
+	static Boxed* CloneBox(const Boxed* b)
+	{
+		return new Boxed(*b);
+	}
+	static void FreeBox(Boxed* b)
+	{
+		delete b;
+	}
+	static int BoxLow32(const Boxed* b)
+	{
+		return b->v;
+	}
+};
+
+typedef TaggedValueT<TestPolicy> Value;
+typedef TaggedArithT<Value> Arith;
+
+struct TestSwitch
+{
+	std::map<int,int> cases;
+	int def;
+	int kind;
+	TestSwitch(void)
+	{
+		def=0;
+		kind=-1;
+	}
+};
+
+struct TestString : public std::string
+{
+	TestString(const char* s):std::string(s)
+	{
+	}
+	operator const char*(void) const
+	{
+		return c_str();
+	}
+};
+
+//ProgramӦĸ
+struct TestProgram
+{
+	std::vector<TestSwitch> switchInfos;
+	std::vector<int> intConstants;
+	std::vector<double> doubleConstants;
+	std::vector<TestString> strConstants;
+	std::vector<std::vector<int> > functions;
+	std::vector<int> funcVarNum;
+};
+
+static inline int Ins(int op,int operand)
+{
+	return (op<<24)|(operand&0x00ffffff);
+}
+
+//PUSHĲlvΪ1ʱѹֵtypeΪ0ֲ12㳣3ַ4
+static inline int Push(int type,int index,int lv)
+{
+	return Ins(OP_PUSH,(lv?0x100000:0)|(type<<16)|index);
+}
+
+//תĿָǰΪ0Ϊ1
+static inline int Jump(int op,int pc,int target)
+{
+	if(target>pc)
+		return Ins(op,target-pc-1);
+	return Ins(op,0x010000|(pc+1-target));
+}
+
+//ָָʽɵĳ
+//0s=0.5;for(i=0;i<arg0;i++) s+=i*2.5; return s+0x12345678;
+//1switch(arg0)ַܷ֧ȱʡ-1
+//2switch(arg0)ϡ֧ظȱʡarg0
+static void BuildProgram(TestProgram& p)
+{
+	p.intConstants.push_back(0);
+	p.intConstants.push_back(0x12345678);
+	p.intConstants.push_back(-1);
+	p.intConstants.push_back(-2000000000);
+	p.doubleConstants.push_back(0.5);
+	p.doubleConstants.push_back(2.5);
+	p.doubleConstants.push_back(-1e300);
+	p.strConstants.push_back(TestString(""));
+	p.strConstants.push_back(TestString("hook"));
+	p.strConstants.push_back(TestString("kernel32.dll!CreateFileA"));
+	p.strConstants.push_back(TestString("ַ"));
+
+	std::vector<int> f;
+	f.push_back(Push(0,0,1));
+	f.push_back(Push(1,0,0));
+	f.push_back(Ins(OP_ASSIGN,0));
+	f.push_back(Ins(OP_POP,0));
+	f.push_back(Push(0,1,1));
+	f.push_back(Push(2,0,0));
+	f.push_back(Ins(OP_ASSIGN,0));
+	f.push_back(Ins(OP_POP,0));
+	int loop=f.size();
+	f.push_back(Push(0,0,0));
+	f.push_back(Push(4,0,0));
+	f.push_back(Ins(OP_LT,0));
+	int exit=f.size();
+	f.push_back(0);
+	f.push_back(Push(0,1,1));
+	f.push_back(Push(0,0,0));
+	f.push_back(Push(2,1,0));
+	f.push_back(Ins(OP_MUL,0));
+	f.push_back(Ins(OP_ADD_ASSIGN,0));
+	f.push_back(Ins(OP_POP,0));
+	f.push_back(Push(0,0,1));
+	f.push_back(Ins(OP_INC,0));
+	f.push_back(Ins(OP_POP,0));
+	f.push_back(Jump(OP_JMP,f.size(),loop));
+	f[exit]=Jump(OP_JZ,exit,f.size());
+	f.push_back(Push(0,1,0));
+	f.push_back(Push(1,1,0));
+	f.push_back(Ins(OP_ADD,0));
+	f.push_back(Ins(OP_RETURN,0));
+	p.functions.push_back(f);
+	p.funcVarNum.push_back(2);
+
+	//֧תƫһָȱʡ֧󣬸֧ѹ볣뷵ָ
+	for(int k=0;k<2;k++)
+	{
+		f.clear();
+		TestSwitch sw;
+		f.push_back(Push(4,0,0));
+		f.push_back(Ins(OP_TABLE_JMP,p.switchInfos.size()));
+		f.push_back((k==0)?Push(1,2,0):Push(4,0,0));
+		f.push_back(Ins(OP_RETURN,0));
+		sw.def=0;
+		static const int sparse[]={-2000000000,-5,3,77777,1<<20,0x7fffffff,12345};
+		int num=(k==0)?12:sizeof(sparse)/sizeof(sparse[0]);
+		for(int i=0;i<num;i++)
+		{
+			int v=(k==0)?i:sparse[i];
+			sw.cases[v]=f.size()-2;
+			switch(i%3)
+			{
+			case 0:
+				f.push_back(Push(1,i%p.intConstants.size(),0));
+				break;
+			case 1:
+				f.push_back(Push(2,i%p.doubleConstants.size(),0));
+				break;
+			default:
+				f.push_back(Push(3,i%p.strConstants.size(),0));
+				break;
+			}
+			f.push_back(Ins(OP_RETURN,0));
+		}
+		//ʾʽSwitchKindţһѡȡһװʱѡȡ
+		sw.kind=(k==0)?0:-1;
+		p.switchInfos.push_back(sw);
+		p.functions.push_back(f);
+		p.funcVarNum.push_back(0);
+	}
+}
+
+//ַFNVɢֵѹ룬ִнַݱ仯
+static inline int StringHash(const char* s)
+{
+	unsigned int h=2166136261u;
+	for(;*s;s++)
+		h=(h^(unsigned char)*s)*16777619u;
+	return (int)h;
+}
+
+//ִѭHostֻ븡ͨ·ȷĽ
+struct TestHost
+{
+	const TestProgram* program;
+	double DoubleConstant(int index)
+	{
+		return program->doubleConstants[index];
+	}
+	static void CalcBinary(int op,Value& a,const Value& c)
+	{
+		bool done=false;
+		switch(op)
+		{
+		case OP_ADD:done=Arith::Add(a,c);break;
+		case OP_SUB:done=Arith::Sub(a,c);break;
+		case OP_MUL:done=Arith::Mul(a,c);break;
+		}
+		if(!done)
+			a.SetInt(-op);
+	}
+	static void CalcUnary(int op,Value& a)
+	{
+		a.SetInt(-op);
+	}
+	static void StepOther(Value& val,int delta)
+	{
+		val.SetInt(val.Low32()+delta);
+	}
+	static void GetLValue(Value* locals,Value* args,int argnum,const Value& vop,Value& r)
+	{
+		int type=(vop.i & 0x0f0000)>>16;
+		int index=(vop.i & 0x00ffff);
+		if(vop.tag==TAG_INT && type==0)
+			r=locals[index];
+		else if(vop.tag==TAG_INT && type==4 && index<argnum)
+			r=args[index];
+		else
+			r.SetInt(0);
+	}
+	static void SetLValue(Value* locals,Value* args,int argnum,const Value& vop,const Value& newVal)
+	{
+		int type=(vop.i & 0x0f0000)>>16;
+		int index=(vop.i & 0x00ffff);
+		if(vop.tag==TAG_INT && type==0)
+			locals[index]=newVal;
+		else if(vop.tag==TAG_INT && type==4 && index<argnum)
+			args[index]=newVal;
+	}
+};
+
+typedef DecodedExecT<Value,TestHost> Exec;
+
+//DecodeInstructionsĹõָԽ֧ʱfalse
+static bool Decode(const TestProgram& p,const std::vector<int>& ins,DecodedInstructions& out)
+{
+	out.resize(ins.size());
+	for(int pc=0;pc<(int)ins.size();pc++)
+	{
+		DecodedIns& d=out[pc];
+		d.op=(ins[pc]>>24)&0xff;
+		d.operand=ins[pc]&0x00ffffff;
+		d.index=d.operand;
+		switch(d.op)
+		{
+		case OP_PUSH:
+			{
+				int lv=(d.operand&0xf00000)>>16;
+				int type=(d.operand&0x0f0000)>>16;
+				int index=(d.operand&0xffff);
+				d.index=index;
+				switch(type)
+				{
+				case 0:
+					d.op=DOP_PUSH_LOCAL;
+					break;
+				case 1:
+					if(index>=(int)p.intConstants.size())
+						return false;
+					d.op=DOP_PUSH_INT;
+					d.index=p.intConstants[index];
+					break;
+				case 2:
+					if(index>=(int)p.doubleConstants.size())
+						return false;
+					d.op=DOP_PUSH_DOUBLE;
+					break;
+				case 3:
+					if(index>=(int)p.strConstants.size())
+						return false;
+					d.op=DOP_PUSH_STR;
+					break;
+				case 4:
+					d.op=DOP_PUSH_ARG;
+					break;
+				default:
+					return false;
+				}
+				if(lv>0 && (type==0 || type==4))
+				{
+					d.op=DOP_PUSH_LVALUE;
+					d.index=d.operand&0x0fffff;
+				}
+			}
+			break;
+		case OP_JMP:
+		case OP_JZ:
+		case OP_JNZ:
+			{
+				int type=(d.operand&0x0f0000)>>16;
+				int offset=(d.operand&0xffff);
+				d.index=(type==0)?pc+offset+1:pc-offset+1;
+			}
+			break;
+		case OP_TABLE_JMP:
+			if(d.operand>=(int)p.switchInfos.size())
+				return false;
+			break;
+		}
+	}
+	return true;
+}
+
+static Value Run(const TestProgram& p,const DecodedInstructions& ins,int varnum,int arg)
+{
+	TestHost host;
+	host.program=&p;
+	std::vector<Value> locals(varnum+1);
+	Value args[1];
+	args[0].SetInt(arg);
+	Value stack[64];
+	Value* sp=stack;
+	Value result;
+	const DecodedIns* pins=&ins[0];
+	int pc=0;
+	int num=ins.size();
+	while(pc<num)
+	{
+		const DecodedIns& d=pins[pc++];
+		if(Exec::Step(host,pins,d,pc,sp,&locals[0],args,1,result))
+			continue;
+		if(d.op==DOP_PUSH_STR)
+		{
+			(sp++)->SetInt(StringHash(p.strConstants[d.index]));
+		}
+		else if(d.op==OP_TABLE_JMP)
+		{
+			const TestSwitch& sw=p.switchInfos[d.operand];
+			--sp;
+			std::map<int,int>::const_iterator it=sw.cases.find(sp->Low32());
+			sp->Clear();
+			pc+=(it!=sw.cases.end())?it->second:sw.def;
+		}
+		else if(d.op==OP_RETURN)
+		{
+			result.MoveFrom(*--sp);
+			break;
+		}
+		else
+		{
+			result.SetInt(0x7fffffff);
+			break;
+		}
+	}
+	while(sp>stack)
+		(--sp)->Clear();
+	return result;
+}
+
+static bool SameTables(const TestProgram& a,const TestProgram& b)
+{
+	if(a.switchInfos.size()!=b.switchInfos.size())
+		return false;
+	for(UINT i=0;i<a.switchInfos.size();i++)
+	{
+		const TestSwitch& x=a.switchInfos[i];
+		const TestSwitch& y=b.switchInfos[i];
+		if(x.def!=y.def || x.kind!=y.kind || x.cases!=y.cases)
+			return false;
+	}
+	if(a.doubleConstants.size()!=b.doubleConstants.size())
+		return false;
+	if(!a.doubleConstants.empty() && ::memcmp(&a.doubleConstants[0],&b.doubleConstants[0],a.doubleConstants.size()*sizeof(double))!=0)
+		return false;
+	return a.intConstants==b.intConstants && a.strConstants==b.strConstants
+		&& a.functions==b.functions && a.funcVarNum==b.funcVarNum;
+}
+
+static bool SameDecoded(const TestProgram& a,const TestProgram& b)
+{
+	for(UINT f=0;f<a.functions.size();f++)
+	{
+		DecodedInstructions x,y;
+		if(!Decode(a,a.functions[f],x) || !Decode(b,b.functions[f],y) || x.size()!=y.size())
+			return false;
+		for(UINT i=0;i<x.size();i++)
+		{
+			if(x[i].op!=y[i].op || x[i].index!=y[i].index || x[i].operand!=y[i].operand)
+				return false;
+		}
+	}
+	return true;
+}
+
+//һִУȽϱ븺
+static bool SameResults(const TestProgram& a,const TestProgram& b,int& runs)
+{
+	static const int argv[]={-2000000000,-5,-1,0,1,2,3,5,7,11,12,20,3,77777,1<<20,0x7fffffff,12345};
+	for(UINT f=0;f<a.functions.size();f++)
+	{
+		DecodedInstructions x,y;
+		if(!Decode(a,a.functions[f],x) || !Decode(b,b.functions[f],y))
+			return false;
+		for(UINT k=0;k<sizeof(argv)/sizeof(argv[0]);k++)
+		{
+			int arg=argv[k];
+			if(f==0 && (arg<0 || arg>100))
+				continue;
+			Value r1=Run(a,x,a.funcVarNum[f],arg);
+			Value r2=Run(b,y,b.funcVarNum[f],arg);
+			if(r1.tag!=r2.tag || r1.l!=r2.l || r1.tag==TAG_EMPTY)
+				return false;
+			runs++;
+		}
+	}
+	return true;
+}
+
+static bool SaveImage(const TestProgram& p,std::vector<char>& image,int pack)
+{
+	ScriptImageWriter w;
+	ScriptImageTables::Save(w,p.switchInfos,p.intConstants,p.doubleConstants,p.strConstants,p.functions,p.funcVarNum);
+	w.Finish(image,pack);
+	return !image.empty();
+}
+
+static bool WriteFile(const char* path,const std::vector<char>& image)
+{
+	FILE* fp=::fopen(path,"wb");
+	if(!fp)
+		return false;
+	bool ok=(::fwrite(&image[0],1,image.size(),fp)==image.size());
+	::fclose(fp);
+	return ok;
+}
+
+static bool ReadFile(const char* path,std::vector<char>& image)
+{
+	FILE* fp=::fopen(path,"rb");
+	if(!fp)
+		return false;
+	::fseek(fp,0,SEEK_END);
+	long size=::ftell(fp);
+	::fseek(fp,0,SEEK_SET);
+	image.resize(size);
+	bool ok=(size>0 && ::fread(&image[0],1,size,fp)==(size_t)size);
+	::fclose(fp);
+	return ok;
+}
+
+//LoadImageMemoryͬδѹʱֱӳ϶ȡѹʱѹ
+static bool LoadImage(const std::vector<char>& image,TestProgram& p)
+{
+	if(!ScriptImage::IsImage(&image[0],image.size()))
+		return false;
+	ScriptImageHeader header;
+	::memcpy(&header,&image[0],sizeof(header));
+	if(header.packedSize>image.size()-sizeof(header))
+		return false;
+	const char* sections=&image[sizeof(header)];
+	std::vector<char> unpacked;
+	if(header.flags&SCB_COMPRESSED)
+	{
+		unpacked.resize(header.size+1);
+		if(!ScriptImage::Unpack(sections,header,&unpacked[0]))
+			return false;
+		sections=&unpacked[0];
+	}
+	else if(header.size!=header.packedSize)
+		return false;
+	ScriptImageReader r;
+	if(!r.Open(sections,header))
+		return false;
+	return ScriptImageTables::Load(r,p.switchInfos,p.intConstants,p.doubleConstants,p.strConstants,p.functions,p.funcVarNum);
+}
+
+static void TestRoundTrip(const TestProgram& p)
+{
+	static const char* names[]={"ѹ","LZARI","LZFast"};
+	const char* path="ScriptImageTest.scb";
+	for(int pack=SCB_PACK_NONE;pack<=SCB_PACK_LZFAST;pack++)
+	{
+		char what[256];
+		std::vector<char> image;
+		bool ok=SaveImage(p,image,pack) && WriteFile(path,image);
+		std::vector<char> read;
+		TestProgram q;
+		ok=ok && ReadFile(path,read) && read==image && LoadImage(read,q);
+		::sprintf(what,"%sӳдļزװأ%dֽ",names[pack],(int)image.size());
+		Check(ok,what);
+		::sprintf(what,"%sӳװغĳ֧뺯",names[pack]);
+		Check(ok && SameTables(p,q),what);
+		::sprintf(what,"%sӳװغԤָ",names[pack]);
+		Check(ok && SameDecoded(p,q),what);
+		int runs=0;
+		bool same=ok && SameResults(p,q,runs);
+		::sprintf(what,"%sӳװǰ%dִнͬ",names[pack],runs);
+		Check(same && runs>0,what);
+		std::vector<char> again;
+		Check(ok && SaveImage(q,again,pack) && again==image,"װغĳٴдԭӳֽͬ");
+	}
+	::remove(path);
+}
+
+//ضϻдӳӦܾԽ
+static void TestCorrupt(const TestProgram& p)
+{
+	std::vector<char> image;
+	SaveImage(p,image,SCB_PACK_NONE);
+	bool rejected=true;
+	for(UINT len=0;len<image.size();len+=7)
+	{
+		std::vector<char> cut(image.begin(),image.begin()+len);
+		TestProgram q;
+		if(!cut.empty() && LoadImage(cut,q))
+			rejected=false;
+	}
+	Check(rejected,"ضϵӳ񱻾ܾ");
+
+	ScriptImageHeader header;
+	::memcpy(&header,&image[0],sizeof(header));
+	std::vector<char> bad=image;
+	((ScriptImageHeader*)&bad[0])->sectionNum=0x10000000;
+	TestProgram q1;
+	Check(!LoadImage(bad,q1),"ӳ񱻾ܾ");
+	bad=image;
+	((ScriptImageHeader*)&bad[0])->version=SCB_VERSION+1;
+	TestProgram q2;
+	Check(!LoadImage(bad,q2),"汾ӳ񱻾ܾ");
+
+	//еһָΪ
+	const char* base=&image[sizeof(header)];
+	ScriptImageReader r;
+	r.Open(base,header);
+	const ScriptImageSection* sec=r.Find(SCB_SEC_FUNCTION);
+	bool found=(sec && sec->count>0);
+	if(found)
+	{
+		bad=image;
+		ScriptImageFunction* func=(ScriptImageFunction*)&bad[sizeof(header)+sec->offset];
+		func->num=0x7fffffff;
+		TestProgram q3;
+		found=!LoadImage(bad,q3);
+	}
+	Check(found,"ָεӳ񱻾ܾ");
+	//ַƫƸΪַ
+	sec=r.Find(SCB_SEC_STRING);
+	found=(sec && sec->count>0);
+	if(found)
+	{
+		bad=image;
+		UINT* strs=(UINT*)&bad[sizeof(header)+sec->offset];
+		strs[0]=0xfffffff0;
+		TestProgram q4;
+		found=!LoadImage(bad,q4);
+	}
+	Check(found,"ַƫƳַصӳ񱻾ܾ");
+}
+
+int main(void)
+{
+	TestProgram p;
+	BuildProgram(p);
+	bool decoded=true;
+	for(UINT f=0;f<p.functions.size();f++)
+	{
+		DecodedInstructions d;
+		if(!Decode(p,p.functions[f],d))
+			decoded=false;
+	}
+	Check(decoded,"ĳԽ");
+	DecodedInstructions d0;
+	Decode(p,p.functions[0],d0);
+	Value r=Run(p,d0,p.funcVarNum[0],4);
+	Check(r.tag==TAG_DOUBLE && r.d==0.5+(0+1+2+3)*2.5+0x12345678,"ѭִнȷ");
+	TestRoundTrip(p);
+	TestCorrupt(p);
+	return failures?1:0;
+}
@@ -0,0 +1,891 @@
+//߼ʱԤִѭĲԣLinuxg++루x86-64x86Windowsͷļ
+//	g++ -O2 -fwrapv -o ScriptJitTest ScriptJitTest.cpp
+//DecodedRunΪգģǵָInterpreter.hExecDecodedͬõDecodedExec.hִСÿɱִУ
+//ȥŻʱӷصλýDecodedRunȫDecodedRunִеĽȽֵջֲ뷵ֵ
+//ָ֤벻ȥŻԸֵ֤ȥŻCheckPlain
+//ȫģת-benchȽһѭڱDecodedRunеִʱ䡣
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "../ScriptJit.h"
+#include "../DecodedExec.h"
+
+#define LOCAL_NUM		8
+#define ARG_NUM			4
+#define STACK_SIZE		256
+#define LOOP_LOCAL		7			//ѭõľֲΪֵĿ
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+//ֻĶ󣬲ԽʱӦص0
+struct TestObject
+{
+	int refs;
+	void AddRef(void)
+	{
+		refs++;
+	}
+	void Release(void)
+	{
+		refs--;
+	}
+};
+
+struct TestBox
+{
+	int v;
+};
+
+struct TestPolicy
+{
+	typedef TestObject Object;
+	typedef TestBox Boxed;
+	static Boxed* CloneBox(const Boxed* b)
+	{
+		return new TestBox(*b);
+	}
+	static void FreeBox(Boxed* b)
+	{
+		delete b;
+	}
+	static int BoxLow32(const Boxed* b)
+	{
+		return b->v;
+	}
+};
+
+typedef TaggedValueT<TestPolicy> Value;
+typedef TaggedArithT<Value> Arith;
+typedef DecodedJitT<Value> Jit;
+
+static TestObject objects[2];
+
+//ִѭHostͨ·VARIANTԷֵȷĽɣ߶DecodedRunִ
+struct TestHost
+{
+	const std::vector<double>* doubles;
+	double DoubleConstant(int index)
+	{
+		return (*doubles)[index];
+	}
+	static void CalcBinary(int op,Value& a,const Value& c)
+	{
+		bool done=false;
+		switch(op)
+		{
+		case OP_ADD:done=Arith::Add(a,c);break;
+		case OP_SUB:done=Arith::Sub(a,c);break;
+		case OP_MUL:done=Arith::Mul(a,c);break;
+		case OP_AND:done=Arith::Bits(1,a,c);break;
+		case OP_OR:done=Arith::Bits(2,a,c);break;
+		case OP_XOR:done=Arith::Bits(3,a,c);break;
+		case OP_LS:done=Arith::Shl(a,c);break;
+		case OP_RS:done=Arith::Shr(a,c);break;
+		case OP_EQ:
+		case OP_NE:
+			done=Arith::Equal(a,c,op==OP_NE);
+			break;
+		case OP_LT:
+		case OP_GT:
+		case OP_LE:
+		case OP_GE:
+			done=Arith::Compare(op-OP_LT,a,c);
+			break;
+		}
+		if(!done)
+			a.SetInt(-op);
+	}
+	static void CalcUnary(int op,Value& a)
+	{
+		bool done=false;
+		switch(op)
+		{
+		case OP_NEG:done=Arith::Neg(a);break;
+		case OP_NOT:done=Arith::Not(a);break;
+		case OP_USUB:done=Arith::USub(a);break;
+		}
+		if(!done)
+			a.SetInt(-op);
+	}
+	static void StepOther(Value& val,int delta)
+	{
+		val.SetInt(val.Low32()+delta);
+	}
+	static void GetLValue(Value* locals,Value* args,int argnum,const Value& vop,Value& r)
+	{
+		if(vop.tag==TAG_INT)
+		{
+			int type=(vop.i & 0x0f0000)>>16;
+			int index=(vop.i & 0x00ffff);
+			if(type==0)
+			{
+				r=locals[index];
+				return;
+			}
+			if(type==4 && index<argnum)
+			{
+				r=args[index];
+				return;
+			}
+		}
+		r.SetInt(0);
+	}
+	static void SetLValue(Value* locals,Value* args,int argnum,const Value& vop,const Value& newVal)
+	{
+		if(vop.tag!=TAG_INT)
+			return;
+		int type=(vop.i & 0x0f0000)>>16;
+		int index=(vop.i & 0x00ffff);
+		if(type==0)
+			locals[index]=newVal;
+		else if(type==4 && index<argnum)
+			args[index]=newVal;
+	}
+};
+
+typedef DecodedExecT<Value,TestHost> Exec;
+
+//pcʼִУִʱջָɽExecDecodedͬʹõDecodedExecִ
+static Value* DecodedRun(const DecodedInstructions& ins,const std::vector<double>& doubles,int pc,
+	Value* locals,Value* args,int argnum,Value* sp,Value& result)
+{
+	TestHost host;
+	host.doubles=&doubles;
+	int num=ins.size();
+	const DecodedIns* pins=&ins[0];
+	while(pc<num)
+	{
+		const DecodedIns& d=pins[pc++];
+		if(Exec::Step(host,pins,d,pc,sp,locals,args,argnum,result))
+			continue;
+		if(d.op==OP_RETURN)
+		{
+			result.MoveFrom(*--sp);
+			return sp;
+		}
+	}
+	return sp;
+}
+
+//һִеȫ״̬߸һ
+struct Machine
+{
+	Value locals[LOCAL_NUM];
+	Value args[ARG_NUM];
+	Value stack[STACK_SIZE];
+	Value result;
+	Value* sp;
+	int argnum;
+};
+
+static bool Same(const Value& x,const Value& y)
+{
+	return x.tag==y.tag && x.l==y.l;
+}
+
+static bool SameMachine(const Machine& x,const Machine& y)
+{
+	if(x.sp-x.stack!=y.sp-y.stack || x.argnum!=y.argnum || !Same(x.result,y.result))
+		return false;
+	for(int k=0;k<LOCAL_NUM;k++)
+	{
+		if(!Same(x.locals[k],y.locals[k]))
+			return false;
+	}
+	for(int k=0;k<ARG_NUM;k++)
+	{
+		if(!Same(x.args[k],y.args[k]))
+			return false;
+	}
+	for(const Value* p=x.stack;p<x.sp;p++)
+	{
+		if(!Same(*p,y.stack[p-x.stack]))
+			return false;
+	}
+	//Ĳλ߶Ӧǿֵ뵯ʱֻд
+	for(int k=x.sp-x.stack;k<STACK_SIZE;k++)
+	{
+		if(x.stack[k].tag!=TAG_EMPTY || y.stack[k].tag!=TAG_EMPTY)
+			return false;
+	}
+	return true;
+}
+
+static void CopyMachine(Machine& dst,const Machine& src)
+{
+	for(int k=0;k<LOCAL_NUM;k++)
+		dst.locals[k]=src.locals[k];
+	for(int k=0;k<ARG_NUM;k++)
+		dst.args[k]=src.args[k];
+	for(int k=0;k<STACK_SIZE;k++)
+		dst.stack[k].Clear();
+	dst.result=src.result;
+	dst.sp=dst.stack;
+	dst.argnum=src.argnum;
+}
+
+static void ClearMachine(Machine& m)
+{
+	for(int k=0;k<LOCAL_NUM;k++)
+		m.locals[k].Clear();
+	for(int k=0;k<ARG_NUM;k++)
+		m.args[k].Clear();
+	for(int k=0;k<STACK_SIZE;k++)
+		m.stack[k].Clear();
+	m.result.Clear();
+}
+
+//ִб룬ȥŻʱDecodedRunرķֵ
+static int RunJit(Jit::Entry entry,const DecodedInstructions& ins,const std::vector<double>& doubles,Machine& m)
+{
+	JitFrameT<Value> frame;
+	frame.locals=m.locals;
+	frame.args=m.args;
+	frame.argnum=m.argnum;
+	frame.sp=m.sp;
+	frame.result=&m.result;
+	int pc=entry(&frame);
+	m.sp=frame.sp;
+	if(pc>=0)
+		m.sp=DecodedRun(ins,doubles,pc,m.locals,m.args,m.argnum,m.sp,m.result);
+	return pc;
+}
+
+static void RunRef(const DecodedInstructions& ins,const std::vector<double>& doubles,Machine& m)
+{
+	m.sp=DecodedRun(ins,doubles,0,m.locals,m.args,m.argnum,m.sp,m.result);
+}
+
+static void SetObject(Value& v,int k)
+{
+	objects[k].AddRef();
+	v.AttachObject(&objects[k]);
+}
+
+//Ƚһ򣬷رķֵʧܻһʱ-2
+static int Compare(const DecodedInstructions& ins,const std::vector<double>& doubles,const Machine& init)
+{
+	JitMemory memory;
+	Jit compiler;
+	Jit::Entry entry=compiler.Compile(ins,doubles,memory);
+	if(!entry)
+		return -2;
+	Machine ref,jit;
+	CopyMachine(ref,init);
+	CopyMachine(jit,init);
+	RunRef(ins,doubles,ref);
+	int pc=RunJit(entry,ins,doubles,jit);
+	bool same=SameMachine(ref,jit);
+	ClearMachine(ref);
+	ClearMachine(jit);
+	return same?pc:-2;
+}
+
+struct Builder
+{
+	DecodedInstructions ins;
+	inline int Add(int op,int index=0)
+	{
+		DecodedIns d;
+		d.op=op;
+		d.index=index;
+		d.operand=index;
+		ins.push_back(d);
+		return ins.size()-1;
+	}
+	inline int Here(void) const
+	{
+		return ins.size();
+	}
+	inline void Patch(int at,int target)
+	{
+		ins[at].index=target;
+	}
+};
+
+static const int binaryOps[]={OP_ADD,OP_SUB,OP_MUL,OP_AND,OP_OR,OP_XOR,OP_LS,OP_RS,OP_EQ,OP_NE,OP_LT,OP_GT,OP_LE,OP_GE};
+static const int fusedOps[]={OP_ADD,OP_SUB,OP_EQ,OP_NE,OP_LT,OP_GT,OP_LE,OP_GE};
+static const int unaryOps[]={OP_NEG,OP_NOT,OP_USUB};
+static const int assignOps[]={OP_ASSIGN,OP_ADD_ASSIGN,OP_SUB_ASSIGN};
+#define COUNTOF(a)	(int)(sizeof(a)/sizeof((a)[0]))
+
+//ֲ01ȡֵϣkindΪ󡢿ֵ
+enum
+{
+	K_INT,
+	K_DOUBLE,
+	K_OBJECT,
+	K_EMPTY
+};
+
+static void SetKind(Value& v,int kind,int n)
+{
+	switch(kind)
+	{
+	case K_INT:v.SetInt(n);break;
+	case K_DOUBLE:v.SetDouble(n+0.5);break;
+	case K_OBJECT:SetObject(v,0);break;
+	default:v.Clear();break;
+	}
+}
+
+struct CaseStats
+{
+	int cases;
+	int bad;
+	int compiledWhole;		//ɱִĸ
+	int intCases;
+	int deopted;			//ȥŻĸ
+	int otherCases;
+};
+
+//ڸֲ²ȽһӦȫɱִ꣬ӦȥŻ
+static void RunCase(const Builder& b,const std::vector<double>& doubles,bool expectDeoptOnOther,CaseStats& st)
+{
+	static const int values[]={0,1,-1,5,31,0x7fffffff,(int)0x80000000,-7};
+	for(int k0=0;k0<4;k0++)
+	{
+		for(int k1=0;k1<4;k1++)
+		{
+			for(int v=0;v<COUNTOF(values);v++)
+			{
+				Machine init;
+				SetKind(init.locals[0],k0,values[v]);
+				SetKind(init.locals[1],k1,values[(v+3)%COUNTOF(values)]);
+				init.args[0].SetInt(values[v]);
+				init.argnum=1;
+				init.sp=init.stack;
+				int pc=Compare(b.ins,doubles,init);
+				ClearMachine(init);
+				st.cases++;
+				if(pc==-2)
+				{
+					st.bad++;
+					continue;
+				}
+				if(k0==K_INT && k1==K_INT)
+				{
+					st.intCases++;
+					if(pc==-1)
+						st.compiledWhole++;
+				}
+				else if(expectDeoptOnOther && k0!=K_INT)
+				{
+					st.otherCases++;
+					if(pc>=0)
+						st.deopted++;
+				}
+			}
+		}
+	}
+}
+
+//ָģȡԾֲ01
+static void TestTemplates(void)
+{
+	std::vector<double> doubles;
+	doubles.push_back(2.5);
+	CaseStats st={0,0,0,0,0,0};
+	CaseStats extra={0,0,0,0,0,0};
+	for(int k=0;k<COUNTOF(binaryOps);k++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LOCAL,0);
+		if(binaryOps[k]==OP_LS || binaryOps[k]==OP_RS)
+			b.Add(DOP_PUSH_INT,5);
+		else
+			b.Add(DOP_PUSH_LOCAL,1);
+		b.Add(binaryOps[k]);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+	}
+	for(int k=0;k<COUNTOF(fusedOps);k++)
+	{
+		Builder b;
+		b.Add(DOP_LOCAL_INT_OP,0);
+		b.Add(DOP_PUSH_INT,7);
+		b.Add(fusedOps[k]);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+		Builder c;
+		c.Add(DOP_LOCAL_LOCAL_OP,0);
+		c.Add(DOP_PUSH_LOCAL,1);
+		c.Add(fusedOps[k]);
+		c.Add(OP_RETURN);
+		RunCase(c,doubles,false,st);
+	}
+	for(int k=0;k<COUNTOF(unaryOps);k++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LOCAL,0);
+		b.Add(unaryOps[k]);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+	}
+	for(int op=OP_INC;op<=OP_DEC;op++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LVALUE,0);
+		b.Add(op);
+		b.Add(OP_POP);
+		b.Add(DOP_PUSH_LOCAL,0);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+	}
+	for(int k=0;k<COUNTOF(assignOps);k++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LVALUE,0);
+		b.Add(DOP_PUSH_LOCAL,1);
+		b.Add(assignOps[k]);
+		b.Add(OP_POP);
+		b.Add(DOP_PUSH_LOCAL,0);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+	}
+	//תšָ볣ѹ
+	static const int jumps[]={OP_JZ,OP_JNZ,DOP_JZ_KEEP,DOP_JNZ_KEEP};
+	for(int k=0;k<COUNTOF(jumps);k++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LOCAL,0);
+		int j=b.Add(jumps[k]);
+		b.Add(DOP_PUSH_INT,1);
+		if(jumps[k]==DOP_JZ_KEEP || jumps[k]==DOP_JNZ_KEEP)
+			b.Add(OP_COMMA);
+		b.Add(OP_RETURN);
+		b.Patch(j,b.Here());
+		b.Add(DOP_NOP);
+		b.Add(DOP_PUSH_DOUBLE,0);
+		b.Add(DOP_PUSH_ARG,0);
+		b.Add(DOP_PUSH_ARG,2);
+		b.Add(OP_COMMA);
+		b.Add(OP_COMMA);
+		int m=b.Add(OP_JMP);
+		b.Add(DOP_PUSH_INT,9);
+		b.Patch(m,b.Here());
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,false,st);
+	}
+	Check(st.bad==0,"ģֵDecodedRunһ");
+	Check(st.compiledWhole==st.intCases,"ģȫɱִ");
+	printf("ģ%d%d\n",st.cases,st.intCases);
+
+	//ʱȥŻѹ봦ֵڶԪ㴦
+	for(int k=0;k<COUNTOF(binaryOps);k++)
+	{
+		Builder b;
+		b.Add(DOP_PUSH_INT,3);
+		b.Add(DOP_PUSH_INT,4);
+		b.Add(OP_COMMA);
+		b.Add(DOP_PUSH_LOCAL,0);
+		b.Add(DOP_PUSH_INT,2);
+		b.Add(binaryOps[k]);
+		b.Add(OP_COMMA);
+		b.Add(OP_RETURN);
+		RunCase(b,doubles,true,extra);
+	}
+	Check(extra.bad==0 && extra.deopted==extra.otherCases,"ֵڶԪ㴦ȥŻ");
+
+	//CheckPlainѹֲǶֲжķֵ
+	int bad=0,deopted=0,runs=0;
+	for(int which=0;which<4;which++)
+	{
+		Builder b;
+		switch(which)
+		{
+		case 0:
+			b.Add(DOP_PUSH_LOCAL,2);
+			b.Add(OP_RETURN);
+			break;
+		case 1:
+			b.Add(DOP_PUSH_ARG,1);
+			b.Add(OP_RETURN);
+			break;
+		case 2:
+			b.Add(DOP_PUSH_LVALUE,2);
+			b.Add(DOP_PUSH_INT,5);
+			b.Add(OP_ASSIGN);
+			b.Add(OP_RETURN);
+			break;
+		default:
+			b.Add(DOP_PUSH_INT,5);
+			b.Add(OP_POP);
+			b.Add(DOP_PUSH_INT,6);
+			b.Add(OP_RETURN);
+			break;
+		}
+		Machine init;
+		SetObject(init.locals[2],1);
+		SetObject(init.args[1],1);
+		SetObject(init.result,1);
+		init.argnum=2;
+		init.sp=init.stack;
+		int pc=Compare(b.ins,doubles,init);
+		ClearMachine(init);
+		runs++;
+		if(pc==-2)
+			bad++;
+		else if(pc>=0)
+			deopted++;
+	}
+	Check(bad==0 && deopted==runs,"õľֲ뷵ֵCheckPlainȥŻ");
+
+	//ֵֻDecodedRun޸
+	{
+		Builder b;
+		b.Add(DOP_PUSH_LVALUE,0x040000);
+		b.Add(OP_INC);
+		b.Add(DOP_PUSH_LVALUE,0x040001);
+		b.Add(DOP_PUSH_INT,4);
+		b.Add(OP_ADD_ASSIGN);
+		b.Add(OP_ADD);
+		b.Add(OP_RETURN);
+		Machine init;
+		init.args[0].SetInt(10);
+		init.args[1].SetInt(20);
+		init.argnum=2;
+		init.sp=init.stack;
+		int pc=Compare(b.ins,doubles,init);
+		ClearMachine(init);
+		Check(pc==1,"ֵڸָȥŻ");
+	}
+	Check(objects[0].refs==0 && objects[1].refs==0,"ڲԺ");
+}
+
+//ΪʽPOP֧ѭ򷵻أʽȫģ
+struct Generator
+{
+	Builder b;
+	std::vector<double>& doubles;
+	unsigned int seed;
+	int loops;
+	Generator(std::vector<double>& d,unsigned int s):doubles(d),seed(s),loops(0)
+	{
+	}
+	inline int Rand(int n)
+	{
+		seed=seed*1103515245+12345;
+		return (int)((seed>>8)%(unsigned int)n);
+	}
+	inline int Target(void)
+	{
+		return Rand(LOOP_LOCAL);
+	}
+	void Expr(int depth)
+	{
+		int choice=(depth<=0)?Rand(4):Rand(14);
+		switch(choice)
+		{
+		case 0:
+			b.Add(DOP_PUSH_LOCAL,Rand(LOCAL_NUM));
+			break;
+		case 1:
+			b.Add(DOP_PUSH_INT,Rand(200)-100);
+			break;
+		case 2:
+			if(Rand(4)==0)
+			{
+				doubles.push_back(Rand(100)*0.25);
+				b.Add(DOP_PUSH_DOUBLE,doubles.size()-1);
+			}
+			else
+				b.Add(DOP_PUSH_INT,Rand(5));
+			break;
+		case 3:
+			b.Add(DOP_PUSH_ARG,Rand(ARG_NUM+1));
+			break;
+		case 4:
+		case 5:
+			{
+				int op=binaryOps[Rand(COUNTOF(binaryOps))];
+				Expr(depth-1);
+				if(op==OP_LS || op==OP_RS)
+					b.Add(DOP_PUSH_INT,Rand(32));
+				else
+					Expr(depth-1);
+				b.Add(op);
+			}
+			break;
+		case 6:
+			Expr(depth-1);
+			b.Add(unaryOps[Rand(COUNTOF(unaryOps))]);
+			break;
+		case 7:
+			b.Add(DOP_PUSH_LVALUE,Target());
+			b.Add(OP_INC+Rand(2));
+			break;
+		case 8:
+			b.Add(DOP_PUSH_LVALUE,Target());
+			Expr(depth-1);
+			b.Add(assignOps[Rand(COUNTOF(assignOps))]);
+			break;
+		case 9:
+			{
+				int op=fusedOps[Rand(COUNTOF(fusedOps))];
+				if(Rand(2))
+				{
+					b.Add(DOP_LOCAL_INT_OP,Rand(LOCAL_NUM));
+					b.Add(DOP_PUSH_INT,Rand(20)-10);
+				}
+				else
+				{
+					b.Add(DOP_LOCAL_LOCAL_OP,Rand(LOCAL_NUM));
+					b.Add(DOP_PUSH_LOCAL,Rand(LOCAL_NUM));
+				}
+				b.Add(op);
+			}
+			break;
+		case 10:
+			Expr(depth-1);
+			Expr(depth-1);
+			b.Add(OP_COMMA);
+			break;
+		case 11:
+			{
+				Expr(depth-1);
+				int j=b.Add(Rand(2)?DOP_JZ_KEEP:DOP_JNZ_KEEP);
+				Expr(depth-1);
+				b.Add(OP_COMMA);
+				b.Patch(j,b.Here());
+			}
+			break;
+		case 12:
+			//ֵDecodedRunִ
+			b.Add(DOP_PUSH_LVALUE,0x040000+Rand(ARG_NUM));
+			if(Rand(2))
+				b.Add(OP_INC+Rand(2));
+			else
+			{
+				Expr(depth-1);
+				b.Add(assignOps[Rand(COUNTOF(assignOps))]);
+			}
+			break;
+		default:
+			b.Add(DOP_NOP);
+			Expr(depth-1);
+			break;
+		}
+	}
+	void Statement(int depth)
+	{
+		int choice=Rand(10);
+		if(choice<5 || depth<=0)
+		{
+			Expr(3);
+			b.Add(OP_POP);
+		}
+		else if(choice<8)
+		{
+			Expr(2);
+			int jz=b.Add(Rand(2)?OP_JZ:OP_JNZ);
+			Statement(depth-1);
+			int jmp=b.Add(OP_JMP);
+			b.Patch(jz,b.Here());
+			Statement(depth-1);
+			b.Patch(jmp,b.Here());
+		}
+		else if(choice==8 && loops==0)
+		{
+			//LOOP_LOCAL=n; while(LOOP_LOCAL){...; LOOP_LOCAL--;}
+			loops++;
+			b.Add(DOP_PUSH_LVALUE,LOOP_LOCAL);
+			b.Add(DOP_PUSH_INT,Rand(6));
+			b.Add(OP_ASSIGN);
+			b.Add(OP_POP);
+			int top=b.Here();
+			b.Add(DOP_PUSH_LOCAL,LOOP_LOCAL);
+			int jz=b.Add(OP_JZ);
+			Statement(depth-1);
+			Statement(depth-1);
+			b.Add(DOP_PUSH_LVALUE,LOOP_LOCAL);
+			b.Add(OP_DEC);
+			b.Add(OP_POP);
+			b.Add(OP_JMP,top);
+			b.Patch(jz,b.Here());
+			loops--;
+		}
+		else
+		{
+			Expr(2);
+			b.Add(OP_RETURN);
+		}
+	}
+};
+
+static void RandomValue(Generator& g,Value& v)
+{
+	switch(g.Rand(10))
+	{
+	case 0:
+		v.SetDouble(g.Rand(100)*0.5-20);
+		break;
+	case 1:
+		SetObject(v,g.Rand(2));
+		break;
+	case 2:
+		v.Clear();
+		break;
+	default:
+		v.SetInt(g.Rand(40)-20);
+		break;
+	}
+}
+
+static void TestRandom(int count)
+{
+	int bad=0,whole=0,deopted=0;
+	std::vector<int> seen(DOP_LOCAL_LOCAL_OP+1,0);
+	for(int n=0;n<count;n++)
+	{
+		std::vector<double> doubles;
+		Generator g(doubles,n*2654435761u+1);
+		int statements=1+g.Rand(6);
+		for(int k=0;k<statements;k++)
+			g.Statement(2);
+		if(g.Rand(2))
+		{
+			g.Expr(2);
+			g.b.Add(OP_RETURN);
+		}
+		for(unsigned int k=0;k<g.b.ins.size();k++)
+			seen[g.b.ins[k].op]++;
+		Machine init;
+		//ľֲ븡ֵ
+		bool plain=g.Rand(3)!=0;
+		for(int k=0;k<LOCAL_NUM;k++)
+		{
+			if(plain)
+				init.locals[k].SetInt(g.Rand(40)-20);
+			else
+				RandomValue(g,init.locals[k]);
+		}
+		init.argnum=g.Rand(ARG_NUM+1);
+		for(int k=0;k<init.argnum;k++)
+		{
+			if(plain)
+				init.args[k].SetInt(g.Rand(40)-20);
+			else
+				RandomValue(g,init.args[k]);
+		}
+		init.sp=init.stack;
+		int pc=Compare(g.b.ins,doubles,init);
+		ClearMachine(init);
+		if(pc==-2)
+		{
+			bad++;
+			if(bad<=5)
+				printf("һ£%d%dָ\n",n,(int)g.b.ins.size());
+		}
+		else if(pc==-1)
+			whole++;
+		else
+			deopted++;
+	}
+	bool all=true;
+	for(int op=0;op<(int)seen.size();op++)
+	{
+		if(Jit::Supported(op) && seen[op]==0)
+		{
+			printf("ûõָ%d\n",op);
+			all=false;
+		}
+	}
+	printf("%dִ%dȥŻDecodedRun%d\n",count,whole,deopted);
+	Check(all,"򸲸ȫģ");
+	Check(bad==0,"DecodedRunһ");
+	Check(whole>0 && deopted>0,"ͬʱִȥŻ");
+	Check(objects[0].refs==0 && objects[1].refs==0,"Ժ");
+}
+
+static double Now(void)
+{
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+//s=0; i=n; while(i){ s+=(i*3)&255; s^=i<<2; i--; } return s;
+static void Bench(int n)
+{
+	Builder b;
+	std::vector<double> doubles;
+	b.Add(DOP_PUSH_LVALUE,0);
+	b.Add(DOP_PUSH_INT,0);
+	b.Add(OP_ASSIGN);
+	b.Add(OP_POP);
+	int top=b.Here();
+	b.Add(DOP_PUSH_LOCAL,1);
+	int jz=b.Add(OP_JZ);
+	b.Add(DOP_PUSH_LVALUE,0);
+	b.Add(DOP_PUSH_LOCAL,1);
+	b.Add(DOP_PUSH_INT,3);
+	b.Add(OP_MUL);
+	b.Add(DOP_PUSH_INT,255);
+	b.Add(OP_AND);
+	b.Add(OP_ADD_ASSIGN);
+	b.Add(OP_POP);
+	b.Add(DOP_PUSH_LVALUE,0);
+	b.Add(DOP_PUSH_LOCAL,0);
+	b.Add(DOP_PUSH_LOCAL,1);
+	b.Add(DOP_PUSH_INT,2);
+	b.Add(OP_LS);
+	b.Add(OP_XOR);
+	b.Add(OP_ASSIGN);
+	b.Add(OP_POP);
+	b.Add(DOP_PUSH_LVALUE,1);
+	b.Add(OP_DEC);
+	b.Add(OP_POP);
+	b.Add(OP_JMP,top);
+	int body=b.Here()-top;
+	b.Patch(jz,b.Here());
+	b.Add(DOP_PUSH_LOCAL,0);
+	b.Add(OP_RETURN);
+
+	JitMemory memory;
+	Jit compiler;
+	Jit::Entry entry=compiler.Compile(b.ins,doubles,memory);
+	Machine ref,jit;
+	ref.argnum=jit.argnum=0;
+	ref.sp=ref.stack;
+	jit.sp=jit.stack;
+	ref.locals[1].SetInt(n);
+	jit.locals[1].SetInt(n);
+	double start=Now();
+	RunRef(b.ins,doubles,ref);
+	double refTime=Now()-start;
+	start=Now();
+	int pc=entry?RunJit(entry,b.ins,doubles,jit):-2;
+	double jitTime=Now()-start;
+	printf("%dѭÿ%dָDecodedRun %.2f/Σ %.2f/Σ%.1f\n",
+		n,body,refTime*1e9/n,jitTime*1e9/n,refTime/jitTime);
+	Check(pc==-1 && Same(ref.result,jit.result),"ִҽһ");
+	ClearMachine(ref);
+	ClearMachine(jit);
+}
+
+int main(int argc,char* argv[])
+{
+	if(!Jit::LayoutMatches())
+	{
+		Check(false,"ֵĲģһ");
+		return 1;
+	}
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench((argc>2)?::atoi(argv[2]):10000000);
+		return failures?1:0;
+	}
+	TestTemplates();
+	TestRandom((argc>1)?::atoi(argv[1]):20000);
+	return failures?1:0;
+}
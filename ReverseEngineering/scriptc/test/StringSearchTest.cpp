@@ -0,0 +1,204 @@
+//StringSearchMultiSearchĲԣLinuxg++룬ֽڴҳ
+//	g++ -O2 -o StringSearchTest StringSearchTest.cpp
+//СĸַӴFindֽڱȽϵĽȽϣContainsAllӴҵĽȽϣ
+//ӴƥλøSSE2ÿ16ֽһı߽硣-benchȽFindstrstrֽڲҵٶȣ
+//ԼӴʱContainsAllӴFindٶȡ
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include "../StringSearch.h"
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+static double Now(void)
+{
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+//Ϊյֽڲ
+static int NaiveFind(const char* s,int len,int start,const char* needle,int nlen)
+{
+	if(start<0)
+		start=0;
+	if(start>len)
+		return -1;
+	for(int i=start;i+nlen<=len;i++)
+	{
+		if(::memcmp(s+i,needle,nlen)==0)
+			return i;
+	}
+	return -1;
+}
+
+static std::string RandomText(int len,int alphabet)
+{
+	std::string s;
+	for(int i=0;i<len;i++)
+		s+=(char)('a'+::rand()%alphabet);
+	return s;
+}
+
+static void TestFind(int rounds)
+{
+	int bad=0;
+	for(int r=0;r<rounds;r++)
+	{
+		int alphabet=2+r%4;
+		std::string s=RandomText(::rand()%80,alphabet);
+		std::string needle=RandomText(::rand()%20,alphabet);
+		//һӴŵλã֤ƥ
+		if(r%2 && needle.size()<=s.size())
+		{
+			int at=::rand()%(s.size()-needle.size()+1);
+			s.replace(at,needle.size(),needle);
+		}
+		int start=::rand()%(s.size()+3)-1;
+		if(StringSearch::Find(s.data(),s.size(),start,needle.data(),needle.size())!=NaiveFind(s.data(),s.size(),start,needle.data(),needle.size()))
+			bad++;
+	}
+	Check(bad==0,"ַFindֽڲһ");
+	const char* s="0123456789abcdef0123456789ABCDEFxyz";
+	int len=::strlen(s);
+	Check(StringSearch::Find(s,len,0,"",0)==0 && StringSearch::Find(s,len,len,"",0)==len,"Ӵƥ");
+	Check(StringSearch::Find(s,len,len+1,"",0)==-1 && StringSearch::Find(s,len,0,s,len+1)==-1,"ԽӴʱҲ");
+	Check(StringSearch::Find(s,len,0,"fxyz",4)==-1 && StringSearch::Find(s,len,0,"Fxyz",4)==len-4,"ĩβƥ");
+	Check(StringSearch::Find(s,len,1,"0123",4)==16 && StringSearch::Find(s,len,0,"f0",2)==15,"16ֽڱ߽ƥ");
+}
+
+static void TestMulti(int rounds)
+{
+	int bad=0,built=0;
+	for(int r=0;r<rounds;r++)
+	{
+		int alphabet=2+r%5;
+		std::string s=RandomText(::rand()%120,alphabet);
+		int n=1+::rand()%6;
+		std::vector<std::string> needles;
+		std::vector<const char*> texts;
+		std::vector<int> lens;
+		for(int i=0;i<n;i++)
+			needles.push_back(RandomText(::rand()%6,alphabet));
+		for(int i=0;i<n;i++)
+		{
+			texts.push_back(needles[i].data());
+			lens.push_back(needles[i].size());
+		}
+		MultiSearch ms;
+		if(!ms.Build(&texts[0],&lens[0],n))
+			continue;
+		built++;
+		bool expect=true;
+		for(int i=0;i<n;i++)
+			expect=expect && NaiveFind(s.data(),s.size(),0,texts[i],lens[i])>=0;
+		if(ms.ContainsAll(s.data(),s.size())!=expect)
+			bad++;
+	}
+	Check(built==rounds,"Ӵ϶ܽԶ");
+	Check(bad==0,"ContainsAllӴһ");
+	std::string big(MULTISEARCH_MAXSTATES,'a');
+	const char* text=big.data();
+	int len=big.size();
+	MultiSearch ms;
+	Check(!ms.Build(&text,&len,1),"״̬ʱԶ");
+}
+
+static void Bench(int runs)
+{
+	//64KBıӴֻĩβֽıƵ
+	std::string s=RandomText(64*1024,16);
+	const char* needle="alpha_beta_gamma";
+	int nlen=::strlen(needle);
+	s+=needle;
+	int len=s.size();
+	double mb=(double)len*runs/(1024*1024);
+	long sum=0;
+	double start=Now();
+	for(int i=0;i<runs;i++)
+		sum+=StringSearch::Find(s.data(),len,0,needle,nlen);
+	double fast=Now()-start;
+	start=Now();
+	const char* volatile text=s.c_str();
+	for(int i=0;i<runs;i++)
+		sum+=::strstr(text,needle)-text;
+	double libc=Now()-start;
+	start=Now();
+	for(int i=0;i<runs;i++)
+		sum+=NaiveFind(s.data(),len,0,needle,nlen);
+	double naive=Now()-start;
+	printf("ӴFind %.0fMB/룬strstr %.0fMB/룬ֽ %.0fMB/\n",mb/fast,mb/libc,mb/naive);
+	//LIKEĶӴÿַıΰȫӴ
+	const int maxWords=128;
+	std::string words[maxWords];
+	const char* texts[maxWords];
+	int lens[maxWords];
+	for(int k=0;k<maxWords;k++)
+	{
+		words[k]=RandomText(5+k%4,26);
+		texts[k]=words[k].data();
+		lens[k]=words[k].size();
+	}
+	int counts[]={2,8,32,64,128};
+	std::vector<std::string> lines;
+	for(int i=0;i<200;i++)
+	{
+		std::string line;
+		for(int k=0;k<maxWords;k++)
+			line+=RandomText(::rand()%16,26)+words[k];
+		lines.push_back(line);
+	}
+	for(int c=0;c<5;c++)
+	{
+		int n=counts[c];
+		MultiSearch ms;
+		ms.Build(texts,lens,n);
+		long hits=0;
+		start=Now();
+		for(int r=0;r<runs;r++)
+		{
+			for(size_t i=0;i<lines.size();i++)
+				hits+=ms.ContainsAll(lines[i].data(),lines[i].size());
+		}
+		double multi=Now()-start;
+		start=Now();
+		for(int r=0;r<runs;r++)
+		{
+			for(size_t i=0;i<lines.size();i++)
+			{
+				bool all=true;
+				for(int k=0;k<n && all;k++)
+					all=StringSearch::Find(lines[i].data(),lines[i].size(),0,texts[k],lens[k])>=0;
+				hits+=all;
+			}
+		}
+		double each=Now()-start;
+		double calls=(double)runs*lines.size();
+		printf("%dӴContainsAll %.0f/ΣFind %.0f/\n",n,multi*1e9/calls,each*1e9/calls);
+		Check(hits==2*calls,"׼еַȫӴ");
+	}
+	if(sum==0)
+		printf("\n");
+}
+
+int main(int argc,char* argv[])
+{
+	::srand(1);
+	if(argc>1 && ::strcmp(argv[1],"-bench")==0)
+	{
+		Bench((argc>2)?::atoi(argv[2]):100);
+		return failures?1:0;
+	}
+	TestFind(200000);
+	TestMulti(50000);
+	return failures?1:0;
+}
@@ -0,0 +1,289 @@
+//TaggedValueTaggedArith㡢ȽתԣLinuxCOM룺
+//	g++ -O2 -fwrapv -o TaggedValueTest TaggedValueTest.cpp
+//ֵԭVARIANT븡ʱ㣬ȱȽϻʱ32λ
+//00ȡģڿ·ϼ㣬falseͨ·ֲ䡣
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../TaggedValue.h"
+
+static int failures=0;
+
+static void Check(bool ok,const char* what)
+{
+	printf("%s %s\n",ok?"ͨ":"ʧ",what);
+	if(!ok)
+		failures++;
+}
+
+struct MockObject
+{
+	int refs;
+	void AddRef(void)
+	{
+		refs++;
+	}
+	void Release(void)
+	{
+		refs--;
+	}
+};
+
+struct MockBox
+{
+	int value;
+};
+
+static int liveBoxes=0;
+
+struct MockPolicy
+{
+	typedef MockObject Object;
+	typedef MockBox Boxed;
+	static Boxed* CloneBox(const Boxed* b)
+	{
+		liveBoxes++;
+		Boxed* r=new Boxed;
+		r->value=b->value;
+		return r;
+	}
+	static void FreeBox(Boxed* b)
+	{
+		liveBoxes--;
+		delete b;
+	}
+	static int BoxLow32(const Boxed* b)
+	{
+		return b->value;
+	}
+};
+
+typedef TaggedValueT<MockPolicy> Value;
+typedef TaggedArithT<Value> Arith;
+
+static Value Int(int v)
+{
+	Value r;
+	r.SetInt(v);
+	return r;
+}
+
+static Value Double(double v)
+{
+	Value r;
+	r.SetDouble(v);
+	return r;
+}
+
+static bool IsInt(const Value& v,int expect)
+{
+	return v.tag==TAG_INT && v.i==expect;
+}
+
+static bool IsDouble(const Value& v,double expect)
+{
+	return v.tag==TAG_DOUBLE && v.d==expect;
+}
+
+//˫ĵ32λϵȱȽLow32˽
+static int DoubleLow32(double d)
+{
+	int r;
+	::memcpy(&r,&d,sizeof(r));
+	return r;
+}
+
+static void TestArithmetic(void)
+{
+	Value a=Int(7);
+	Check(Arith::Add(a,Int(5)) && IsInt(a,12),"ӷ");
+	a=Int(7);
+	Check(Arith::Sub(a,Int(9)) && IsInt(a,-2),"");
+	a=Int(-7);
+	Check(Arith::Mul(a,Int(6)) && IsInt(a,-42),"˷");
+	a=Int(-7);
+	Check(Arith::Div(a,Int(2)) && IsInt(a,-3),"0ض");
+	a=Int(0x7fffffff);
+	Check(Arith::Add(a,Int(1)) && IsInt(a,(int)0x80000000),"ӷ32λ");
+	a=Int(0x10000);
+	Check(Arith::Mul(a,Int(0x10000)) && IsInt(a,0),"˷32λ");
+
+	a=Int(1);
+	Check(Arith::Add(a,Double(0.5)) && IsDouble(a,1.5),"Ӹø");
+	a=Double(0.5);
+	Check(Arith::Sub(a,Int(2)) && IsDouble(a,-1.5),"ø");
+	a=Int(3);
+	Check(Arith::Mul(a,Double(0.5)) && IsDouble(a,1.5),"˸ø");
+	a=Int(7);
+	Check(Arith::Div(a,Double(2)) && IsDouble(a,3.5),"Ըض");
+	a=Double(7);
+	Check(Arith::Div(a,Int(2)) && IsDouble(a,3.5),"ض");
+}
+
+static void TestDivideByZero(void)
+{
+	Value a=Int(7);
+	Check(!Arith::Div(a,Int(0)) && IsInt(a,7),"0ͨ·Ҳ");
+	a=Int((int)0x80000000);
+	Check(!Arith::Div(a,Int(-1)) && IsInt(a,(int)0x80000000),"0x80000000-1ͨ·");
+	a=Int((int)0x80000000);
+	Check(Arith::Div(a,Int(1)) && IsInt(a,(int)0x80000000),"0x800000001ڿ·");
+	a=Int(7);
+	Check(!Arith::Bits(0,a,Int(0)) && IsInt(a,7),"0ȡģͨ·");
+	a=Double(7.5);
+	Check(!Arith::Bits(0,a,Double(0.5)) && IsDouble(a,7.5),"ԽضΪ0ȡģͨ·");
+	a=Int(7);
+	Check(Arith::Div(a,Double(0)) && a.tag==TAG_DOUBLE && isinf(a.d) && a.d>0,"Ը0");
+	a=Int(0);
+	Check(Arith::Div(a,Double(0)) && a.tag==TAG_DOUBLE && isnan(a.d),"0Ը0NaN");
+	a=Double(-1);
+	Check(Arith::Div(a,Int(0)) && a.tag==TAG_DOUBLE && isinf(a.d) && a.d<0,"0ø");
+}
+
+static void TestBits(void)
+{
+	Value a=Int(-1);
+	Check(Arith::Bits(0,a,Int(10)) && IsInt(a,5),"ȡģ޷ż");
+	a=Int(0x0ff0);
+	Check(Arith::Bits(1,a,Int(0x00ff)) && IsInt(a,0x00f0),"λ");
+	a=Int(0x0ff0);
+	Check(Arith::Bits(2,a,Int(0x000f)) && IsInt(a,0x0fff),"λ");
+	a=Int(0x0ff0);
+	Check(Arith::Bits(3,a,Int(0x00ff)) && IsInt(a,0x0f0f),"λ");
+	a=Double(7.9);
+	Check(Arith::Bits(0,a,Int(4)) && IsDouble(a,3),"ȡģȽضΪ64λ޷");
+	a=Int(6);
+	Check(Arith::Bits(1,a,Double(3.7)) && IsDouble(a,2),"İλø");
+
+	a=Int(1);
+	Check(Arith::Shl(a,Int(31)) && IsInt(a,(int)0x80000000),"");
+	a=Int(-8);
+	Check(Arith::Shr(a,Int(1)) && IsInt(a,0x7ffffffc),"Ϊ߼");
+	a=Double(1);
+	Check(Arith::Shl(a,Int(40)) && IsDouble(a,1099511627776.0),"64λ");
+	a=Double(-8);
+	Check(Arith::Shr(a,Int(1)) && IsDouble(a,-4),"64λ");
+}
+
+static void TestCompare(void)
+{
+	Value a=Int(3);
+	Check(Arith::Equal(a,Int(3),false) && IsInt(a,1),"");
+	a=Int(3);
+	Check(Arith::Equal(a,Int(4),true) && IsInt(a,1),"");
+	a=Double(0.5);
+	Check(Arith::Equal(a,Double(0.5),false) && IsInt(a,1),"");
+	a=Int(1);
+	Check(Arith::Equal(a,Double(1),false) && IsInt(a,0),"븡32λȽϣ11.0");
+	a=Int(DoubleLow32(1.1));
+	Check(Arith::Equal(a,Double(1.1),false) && IsInt(a,1),"32λͬ");
+	a=Double(1);
+	Check(Arith::Equal(a,Double(1.0000000001),false) && IsInt(a,0),"ֵȽ");
+
+	static const int expect[3][4]={{1,0,1,0},{0,0,1,1},{0,1,0,1}};
+	int ints[3][2]={{1,2},{2,2},{3,2}};
+	bool ok=true;
+	for(int k=0;k<3;k++)
+	{
+		for(int op=0;op<4;op++)
+		{
+			a=Int(ints[k][0]);
+			ok=ok && Arith::Compare(op,a,Int(ints[k][1])) && IsInt(a,expect[k][op]);
+			a=Int(ints[k][0]);
+			ok=ok && Arith::Compare(op,a,Double(ints[k][1])) && IsInt(a,expect[k][op]);
+			a=Double(ints[k][0]);
+			ok=ok && Arith::Compare(op,a,Int(ints[k][1])) && IsInt(a,expect[k][op]);
+		}
+	}
+	Check(ok,"СȽ븡һ");
+	a=Int(1);
+	Check(Arith::Compare(0,a,Double(1.5)) && IsInt(a,1),"ϴСȽϰ1<1.5");
+	a=Int(-1);
+	Check(Arith::Compare(0,a,Int(1)) && IsInt(a,1),"СȽΪзűȽ");
+	a=Double(NAN);
+	Check(Arith::Compare(2,a,Double(0)) && IsInt(a,1),"NaNȲСҲڣ<=");
+
+	a=Int(0x10000);
+	Check(Arith::AndAnd(a,Int(1)) && IsInt(a,0),"&&16λжϣ0x10000Ϊ");
+	a=Int(0x10000);
+	Check(Arith::OrOr(a,Int(0x20000)) && IsInt(a,0),"||16λж");
+	a=Int(0x10000);
+	Check(Arith::Not(a) && IsInt(a,1),"!16λж");
+	a=Double(1);
+	Check(Arith::Not(a) && IsInt(a,1),"1.0ĵ16λΪ0!Ϊ1");
+}
+
+static void TestUnary(void)
+{
+	Value a=Int(5);
+	Check(Arith::Neg(a) && IsInt(a,-6),"λȡ");
+	a=Double(5);
+	Check(Arith::Neg(a) && IsDouble(a,(double)(~(TaggedUInt64)5)),"64λ޷ȡ");
+	a=Int(5);
+	Check(Arith::USub(a) && IsInt(a,-5),"ȡ");
+	a=Int((int)0x80000000);
+	Check(Arith::USub(a) && IsInt(a,(int)0x80000000),"0x80000000ȡ");
+	a=Double(0.25);
+	Check(Arith::USub(a) && IsDouble(a,-0.25),"ȡ");
+	a=Int(1);
+	Check(Arith::Step(a,-1) && IsInt(a,0),"Լ");
+	a=Double(0.5);
+	Check(Arith::Step(a,1) && IsDouble(a,1.5),"ָ");
+}
+
+static void TestConversion(void)
+{
+	Value a=Int(-3);
+	Check(a.ToDouble()==-3 && a.Low32()==-3 && a.Low16()==-3,"ת");
+	a=Double(2.5);
+	Check(a.ToDouble()==2.5 && a.Low32()==DoubleLow32(2.5),"Low32Ϊ32λ");
+	a=Int(0x12345678);
+	Check(a.Low16()==0x5678,"Low16ȡ16λ");
+	a.SetDouble(1.5);
+	a.SetInt(2);
+	Check(IsInt(a,2) && a.l==2,"ɸΪʱ32λ");
+
+	MockBox* box=new MockBox;
+	box->value=0x1234;
+	liveBoxes++;
+	Value b;
+	b.AttachBox(box);
+	Check(b.Low32()==0x1234 && !b.IsNumber(),"װֵLow32Policy");
+	Value c=Int(1);
+	Check(!Arith::Add(c,b) && IsInt(c,1),"װֵ㽻ͨ·");
+	Check(!Arith::Compare(0,b,c) && b.tag==TAG_BOXED,"װֵȽϽͨ·Ҳ޸");
+	{
+		Value copy=b;
+		Check(liveBoxes==2 && copy.b!=b.b,"װֵװ");
+	}
+	b.Clear();
+	Check(liveBoxes==0,"װֵȫͷ");
+
+	MockObject obj={1};
+	{
+		Value o;
+		o.AttachObject(&obj);
+		Value copy=o;
+		Check(obj.refs==2,"ƶֵ");
+		Value moved;
+		moved.MoveFrom(copy);
+		Check(obj.refs==2 && copy.tag==TAG_EMPTY,"ƶֵı");
+		moved.SetInt(3);
+		Check(obj.refs==1 && IsInt(moved,3),"ֵΪʱͷ");
+		Value n=Int(1);
+		Check(!Arith::Add(n,o) && !Arith::USub(o) && !Arith::Step(o,1),"㽻ͨ·");
+	}
+	Check(obj.refs==0,"ͷ");
+}
+
+int main(void)
+{
+	Check(sizeof(Value)==16,"ֵΪ16ֽ");
+	TestArithmetic();
+	TestDivideByZero();
+	TestBits();
+	TestCompare();
+	TestUnary();
+	TestConversion();
+	return failures?1:0;
+}
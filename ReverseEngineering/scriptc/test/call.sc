@@ -0,0 +1,27 @@
+//ΪĻ׼űݹfib밴±ʽʾؽűĵô
+//÷test call.sc -bench [ִд]ÿÿô
+const FIB=22;
+const DEPTH=16;
+
+function fib(n)
+{
+	if(n<2)
+		return 1;
+	return fib(n-1)+fib(n-2);
+}
+
+//kΪΪdepthؽڵ
+function walk(k,depth)
+{
+	if(depth==0)
+		return 1;
+	return walk(k*2,depth-1)+walk(k*2+1,depth-1)+1;
+}
+
+function main()
+{
+	//fib(n)صn+1쳲f2f-1Σwalk2^(DEPTH+1)-1
+	var calls=fib(FIB)*2-1;
+	calls+=walk(1,DEPTH);
+	return calls+1;
+}
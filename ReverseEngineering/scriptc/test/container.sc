@@ -0,0 +1,95 @@
+//Ļ׼űlistdequevectorsetobjScriptC.HashSetScriptC.HashMap1e31e6Ԫ
+//ֱʱ롢λûֵ밴λñÿԪصƽ÷test container.sc -run
+extern "kernel32.dll" 4 GetTickCount();
+
+function report(name,n,op,ticks)
+{
+	output(name,"\t",n,"\t",op,"\t",ticks*1000000.0/n," ns\n");
+}
+
+//λöȡ˳7919Ϊnȡģң791910ݻأnλøȡһ
+function benchList(name,c,n)
+{
+	var i=0;
+	var p=0;
+	var s=0;
+	var t=GetTickCount();
+	for(i=0;i<n;i++)
+		c.push(i);
+	report(name,n,"push",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+	{
+		s+=c[p];
+		p=(p+7919)%n;
+	}
+	report(name,n,"get(pos)",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+		s+=c[i];
+	report(name,n,"iterate",GetTickCount()-t);
+	return s;
+}
+
+function benchSet(name,c,n)
+{
+	var i=0;
+	var p=0;
+	var s=0;
+	var t=GetTickCount();
+	for(i=0;i<n;i++)
+	{
+		c.insert(p);
+		p=(p+7919)%n;
+	}
+	report(name,n,"insert",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+		s+=c.exist(i*2);
+	report(name,n,"exist",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+		s+=c[i];
+	report(name,n,"iterate",GetTickCount()-t);
+	return s;
+}
+
+function benchMap(name,c,n)
+{
+	var i=0;
+	var p=0;
+	var s=0;
+	var t=GetTickCount();
+	for(i=0;i<n;i++)
+	{
+		c.insert(p,i);
+		p=(p+7919)%n;
+	}
+	report(name,n,"insert",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+		s+=c.lookup(i);
+	report(name,n,"lookup",GetTickCount()-t);
+	t=GetTickCount();
+	for(i=0;i<n;i++)
+		s+=c.valueAt(i);
+	report(name,n,"iterate",GetTickCount()-t);
+	return s;
+}
+
+function main()
+{
+	var n=0;
+	clearoutput();
+	output("container\tn\top\tns/element\n");
+	for(n=1000;n<=1000000;n*=10)
+	{
+		benchList("list",list(),n);
+		benchList("deque",deque(),n);
+		benchList("vector",vector(),n);
+		benchSet("setobj",setobj(),n);
+		benchSet("HashSet",activex("ScriptC.HashSet"),n);
+		benchMap("HashMap",activex("ScriptC.HashMap"),n);
+	}
+	return getoutput();
+}
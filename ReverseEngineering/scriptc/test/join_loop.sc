@@ -0,0 +1,28 @@
+//OQLӵĻ׼űjoin.scͬдA.id-B.id==0ܲΪFROMԴԵӱʽ
+//ǶѭN*NԪֵNΪ10000ʱһִҪֵһڴΣȸСN
+//÷test join_loop.sc -bench 1ֵΪÿFROMԴĶ
+const N=10000;
+
+function main()
+{
+	var i=0;
+	var o=0;
+	var a=oqlclass("A");
+	var b=oqlclass("B");
+	a.clear();
+	b.clear();
+	for(i=0;i<N;i++)
+	{
+		o=object();
+		o.id=i;
+		a.push(o);
+		o=object();
+		o.id=N-1-i;
+		b.push(o);
+	}
+	defquery(1,select A,B from A,B join on A.id-B.id==0);
+	o=execquery(1,1);
+	if(o.id!=0)
+		return 0;
+	return N;
+}
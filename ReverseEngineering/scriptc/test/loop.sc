@@ -0,0 +1,23 @@
+//ѭΪĻ׼ű㡢Ƚתڲѭܴ
+//÷test loop.sc -bench [ִд]
+const OUTER=1000;
+const INNER=1000;
+
+function main()
+{
+	var i=0;
+	var j=0;
+	var s=0;
+	for(i=0;i<OUTER;i++)
+	{
+		j=0;
+		while(j<INNER)
+		{
+			s+=(i^j)&7;
+			if(s>100000)
+				s-=100000;
+			j++;
+		}
+	}
+	return OUTER*INNER;
+}
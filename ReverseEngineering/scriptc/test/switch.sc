@@ -0,0 +1,371 @@
+//switchΪĻ׼űswitchֱֱɢִУ
+//denseϢŷ֧sparse16ɢŷ֧large96ɢֵ֧
+//ֵΪִswitchܴ÷test switch.sc -bench [ִд]
+const N=100000;
+
+function dense(v)
+{
+	switch(v)
+	{
+	case 0x100:
+		return 1;
+	case 0x101:
+		return 2;
+	case 0x102:
+		return 3;
+	case 0x103:
+		return 4;
+	case 0x104:
+		return 5;
+	case 0x105:
+		return 6;
+	case 0x106:
+		return 7;
+	case 0x107:
+		return 1;
+	case 0x108:
+		return 2;
+	case 0x109:
+		return 3;
+	case 0x10A:
+		return 4;
+	case 0x10B:
+		return 5;
+	case 0x10C:
+		return 6;
+	case 0x10D:
+		return 7;
+	case 0x10E:
+		return 1;
+	case 0x10F:
+		return 2;
+	case 0x110:
+		return 3;
+	case 0x111:
+		return 4;
+	case 0x112:
+		return 5;
+	case 0x113:
+		return 6;
+	case 0x114:
+		return 7;
+	case 0x115:
+		return 1;
+	case 0x116:
+		return 2;
+	case 0x117:
+		return 3;
+	case 0x118:
+		return 4;
+	case 0x119:
+		return 5;
+	case 0x11A:
+		return 6;
+	case 0x11B:
+		return 7;
+	case 0x11C:
+		return 1;
+	case 0x11D:
+		return 2;
+	case 0x11E:
+		return 3;
+	case 0x11F:
+		return 4;
+	case 0x120:
+		return 5;
+	case 0x121:
+		return 6;
+	case 0x122:
+		return 7;
+	case 0x123:
+		return 1;
+	case 0x124:
+		return 2;
+	case 0x125:
+		return 3;
+	case 0x126:
+		return 4;
+	case 0x127:
+		return 5;
+	case 0x128:
+		return 6;
+	case 0x129:
+		return 7;
+	case 0x12A:
+		return 1;
+	case 0x12B:
+		return 2;
+	case 0x12C:
+		return 3;
+	case 0x12D:
+		return 4;
+	case 0x12E:
+		return 5;
+	case 0x12F:
+		return 6;
+	default:
+		return 0;
+	}
+	return 0;
+}
+
+function sparse(v)
+{
+	switch(v)
+	{
+	case 0x3B67178:
+		return 1;
+	case 0x20B26C1D:
+		return 2;
+	case 0x2DE47DDF:
+		return 3;
+	case 0x3B9985EE:
+		return 4;
+	case 0x43D85893:
+		return 5;
+	case 0x4FBB3E23:
+		return 6;
+	case 0x5375C650:
+		return 7;
+	case 0x58608FF0:
+		return 1;
+	case 0x5EB4FF15:
+		return 2;
+	case 0x5EF2E04D:
+		return 3;
+	case 0x63529C3C:
+		return 4;
+	case 0x65C8E71C:
+		return 5;
+	case 0x6B908700:
+		return 6;
+	case 0x6BB6A199:
+		return 7;
+	case 0x760EBED1:
+		return 1;
+	case 0x78A235F6:
+		return 2;
+	default:
+		return 0;
+	}
+	return 0;
+}
+
+function large(v)
+{
+	switch(v)
+	{
+	case 0x3A2899:
+		return 1;
+	case 0x6EDBA7:
+		return 2;
+	case 0xAE19DA:
+		return 3;
+	case 0x1ADB9CD:
+		return 4;
+	case 0x2C2D00F:
+		return 5;
+	case 0x6A3209D:
+		return 6;
+	case 0x8567F81:
+		return 7;
+	case 0x8736C74:
+		return 1;
+	case 0x9350F25:
+		return 2;
+	case 0xD0D7F44:
+		return 3;
+	case 0xE7D887C:
+		return 4;
+	case 0x1037AE34:
+		return 5;
+	case 0x10ED44BD:
+		return 6;
+	case 0x11C32176:
+		return 7;
+	case 0x12A65C33:
+		return 1;
+	case 0x1413B447:
+		return 2;
+	case 0x146DE930:
+		return 3;
+	case 0x153AC8AD:
+		return 4;
+	case 0x153E0C41:
+		return 5;
+	case 0x154F5D07:
+		return 6;
+	case 0x1740EB37:
+		return 7;
+	case 0x174E4159:
+		return 1;
+	case 0x17A6A644:
+		return 2;
+	case 0x1933551E:
+		return 3;
+	case 0x19753495:
+		return 4;
+	case 0x1A363716:
+		return 5;
+	case 0x1ACF777E:
+		return 6;
+	case 0x1B94E30D:
+		return 7;
+	case 0x1BBDCD52:
+		return 1;
+	case 0x1F8FB2D5:
+		return 2;
+	case 0x1FE0F51C:
+		return 3;
+	case 0x1FEA11AD:
+		return 4;
+	case 0x21C496FF:
+		return 5;
+	case 0x23C6140F:
+		return 6;
+	case 0x2507F3AF:
+		return 7;
+	case 0x263EB6F9:
+		return 1;
+	case 0x2692EF5A:
+		return 2;
+	case 0x272D1D14:
+		return 3;
+	case 0x27ACB394:
+		return 4;
+	case 0x2825BA5E:
+		return 5;
+	case 0x286BE8A0:
+		return 6;
+	case 0x2A7A3535:
+		return 7;
+	case 0x2B40345D:
+		return 1;
+	case 0x2D7C2736:
+		return 2;
+	case 0x2E3B78C6:
+		return 3;
+	case 0x2F96ECC0:
+		return 4;
+	case 0x30BCACE8:
+		return 5;
+	case 0x310D77AC:
+		return 6;
+	case 0x31D914F9:
+		return 7;
+	case 0x343E4B37:
+		return 1;
+	case 0x351BA9C9:
+		return 2;
+	case 0x38F06040:
+		return 3;
+	case 0x3C0A7452:
+		return 4;
+	case 0x3C7C22FB:
+		return 5;
+	case 0x3D890EE3:
+		return 6;
+	case 0x3D989070:
+		return 7;
+	case 0x4505464C:
+		return 1;
+	case 0x4599F4B5:
+		return 2;
+	case 0x4976E7A3:
+		return 3;
+	case 0x4B06AD48:
+		return 4;
+	case 0x4C4909CC:
+		return 5;
+	case 0x4D32B558:
+		return 6;
+	case 0x4F08AF26:
+		return 7;
+	case 0x4F18348F:
+		return 1;
+	case 0x5017ED51:
+		return 2;
+	case 0x5311992B:
+		return 3;
+	case 0x56C32623:
+		return 4;
+	case 0x56C68CA6:
+		return 5;
+	case 0x5866F48C:
+		return 6;
+	case 0x592448C9:
+		return 7;
+	case 0x5A9521D6:
+		return 1;
+	case 0x5D976D91:
+		return 2;
+	case 0x6186C5BC:
+		return 3;
+	case 0x62034AA3:
+		return 4;
+	case 0x63051E56:
+		return 5;
+	case 0x6608E9AC:
+		return 6;
+	case 0x68A092C3:
+		return 7;
+	case 0x68C5334E:
+		return 1;
+	case 0x6F08E64F:
+		return 2;
+	case 0x6F293881:
+		return 3;
+	case 0x6F8A30D6:
+		return 4;
+	case 0x6FAB0EC1:
+		return 5;
+	case 0x7024AA48:
+		return 6;
+	case 0x7266209A:
+		return 7;
+	case 0x7350B51E:
+		return 1;
+	case 0x754ACE11:
+		return 2;
+	case 0x77C80DCA:
+		return 3;
+	case 0x7871E6CC:
+		return 4;
+	case 0x78BFE9BB:
+		return 5;
+	case 0x7AE571E0:
+		return 6;
+	case 0x7B11B5FA:
+		return 7;
+	case 0x7B88474C:
+		return 1;
+	case 0x7BB86114:
+		return 2;
+	case 0x7BF9AB1B:
+		return 3;
+	case 0x7C758C5D:
+		return 4;
+	case 0x7DBFF99C:
+		return 5;
+	default:
+		return 0;
+	}
+	return 0;
+}
+
+function main()
+{
+	var i=0;
+	var s=0;
+	var d=vector(0x3B67178,0x20B26C1D,0x2DE47DDF,0x3B9985EE,0x43D85893,0x4FBB3E23,0x5375C650,0x58608FF0,0x5EB4FF15,0x5EF2E04D,0x63529C3C,0x65C8E71C,0x6B908700,0x6BB6A199,0x760EBED1,0x78A235F6);
+	var g=vector(0x3A2899,0x6EDBA7,0xAE19DA,0x1ADB9CD,0x2C2D00F,0x6A3209D,0x8567F81,0x8736C74,0x9350F25,0xD0D7F44,0xE7D887C,0x1037AE34,0x10ED44BD,0x11C32176,0x12A65C33,0x1413B447,0x146DE930,0x153AC8AD,0x153E0C41,0x154F5D07,0x1740EB37,0x174E4159,0x17A6A644,0x1933551E,0x19753495,0x1A363716,0x1ACF777E,0x1B94E30D,0x1BBDCD52,0x1F8FB2D5,0x1FE0F51C,0x1FEA11AD,0x21C496FF,0x23C6140F,0x2507F3AF,0x263EB6F9,0x2692EF5A,0x272D1D14,0x27ACB394,0x2825BA5E,0x286BE8A0,0x2A7A3535,0x2B40345D,0x2D7C2736,0x2E3B78C6,0x2F96ECC0,0x30BCACE8,0x310D77AC,0x31D914F9,0x343E4B37,0x351BA9C9,0x38F06040,0x3C0A7452,0x3C7C22FB,0x3D890EE3,0x3D989070,0x4505464C,0x4599F4B5,0x4976E7A3,0x4B06AD48,0x4C4909CC,0x4D32B558,0x4F08AF26,0x4F18348F,0x5017ED51,0x5311992B,0x56C32623,0x56C68CA6,0x5866F48C,0x592448C9,0x5A9521D6,0x5D976D91,0x6186C5BC,0x62034AA3,0x63051E56,0x6608E9AC,0x68A092C3,0x68C5334E,0x6F08E64F,0x6F293881,0x6F8A30D6,0x6FAB0EC1,0x7024AA48,0x7266209A,0x7350B51E,0x754ACE11,0x77C80DCA,0x7871E6CC,0x78BFE9BB,0x7AE571E0,0x7B11B5FA,0x7B88474C,0x7BB86114,0x7BF9AB1B,0x7C758C5D,0x7DBFF99C);
+	for(i=0;i<N;i++)
+	{
+		s+=dense(0x100+i%64);
+		s+=sparse(d[i%20]);
+		s+=large(g[i%100]);
+	}
+	if(s<=0)
+		return 0;
+	return N*3;
+}
@@ -22,6 +22,304 @@
 #endif
 
 static char stdinbuf[1024*1024]={""};
+
+#ifdef INCLUDE_COMPILE
+//ȽϹر뿪Żʱִָʱ䣬÷test űļ -opt
+static int CompareOptimize(const char* buf)
+{
+	int before=0,after=0;
+	DWORD ticks[2];
+	for(int opt=0;opt<2;opt++)
+	{
+		ScriptcRuntime vm;
+		vm.SetOptimize(opt!=0);
+		CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+		if(err.GetLength()>0)
+		{
+			std::cout<<err<<std::endl;
+			return -1;
+		}
+		vm.GetOptimizeStats(before,after);
+		vm.LoadLibrary();
+		DWORD start=::GetTickCount();
+		vm.ExecScript();
+		ticks[opt]=::GetTickCount()-start;
+		vm.UnloadLibrary();
+	}
+	printf("ָŻǰ%dŻ%d\n",before,after);
+	printf("ִʱ䣺δŻ%u룬Ż%u\n",ticks[0],ticks[1]);
+	return 0;
+}
+
+struct StressArg
+{
+	ScriptcRuntime* context;
+	int rounds;
+	CComVariant expect;
+	int mismatches;
+};
+
+static unsigned __stdcall StressThread(void* param)
+{
+	StressArg* a=(StressArg*)param;
+	::CoInitialize(NULL);
+	for(int i=0;i<a->rounds;i++)
+	{
+		if(a->context->ExecScript()!=a->expect)
+			a->mismatches++;
+	}
+	::CoUninitialize();
+	return 0;
+}
+
+//̸߳Լִķִͬһݱֵ뵥ִ߳ʱͬ
+//űӦȫֱĶд÷test űļ -threads ߳ ÿ̴߳
+static int StressContexts(const char* buf,int threads,int rounds)
+{
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	vm.LoadLibrary();
+	CComVariant expect=vm.ExecScript();
+	std::vector<StressArg> args(threads);
+	std::vector<HANDLE> handles(threads);
+	DWORD start=::GetTickCount();
+	for(int t=0;t<threads;t++)
+	{
+		args[t].context=vm.CreateContext();
+		args[t].rounds=rounds;
+		args[t].expect=expect;
+		args[t].mismatches=0;
+		handles[t]=(HANDLE)::_beginthreadex(NULL,0,StressThread,&args[t],0,NULL);
+	}
+	::WaitForMultipleObjects(threads,&handles[0],TRUE,INFINITE);
+	DWORD ticks=::GetTickCount()-start;
+	int bad=0;
+	for(int t=0;t<threads;t++)
+	{
+		bad+=args[t].mismatches;
+		::CloseHandle(handles[t]);
+		delete args[t].context;
+	}
+	vm.UnloadLibrary();
+	printf("%d̸ִ߳%dΣʱ%u룬ÿ%.1fΣһ%d\n",
+		threads,rounds,ticks,threads*rounds*1000.0/(ticks?ticks:1),bad);
+	return bad?1:0;
+}
+
+//.scbӳԣ󰴸ѹʽӳӳװغٴαõͬӳ
+//ִнֱִͬ÷test űļ -scb
+static int RoundTripImage(const char* buf)
+{
+	const char* paths[3]={"ss_none.scb","ss_lzari.scb","ss_lzfast.scb"};
+	std::vector<char> images[3];
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	for(int pack=SCB_PACK_NONE;pack<=SCB_PACK_LZFAST;pack++)
+	{
+		vm.SaveImage(images[pack],pack);
+		if(!vm.SaveImageFile(paths[pack],pack))
+		{
+			printf("д%sʧ\n",paths[pack]);
+			return -1;
+		}
+	}
+	vm.LoadLibrary();
+	CComVariant expect=vm.ExecScript();
+	vm.UnloadLibrary();
+	int bad=0;
+	for(int pack=SCB_PACK_NONE;pack<=SCB_PACK_LZFAST;pack++)
+	{
+		ScriptcRuntime loaded;
+		bool ok=loaded.LoadImageFile(paths[pack]);
+		bool same=false,equal=false;
+		if(ok)
+		{
+			std::vector<char> again;
+			loaded.SaveImage(again,pack);
+			same=again==images[pack];
+			loaded.LoadLibrary();
+			DWORD start=::GetTickCount();
+			equal=loaded.ExecScript()==expect;
+			DWORD ticks=::GetTickCount()-start;
+			loaded.UnloadLibrary();
+			printf("%s%uֽڣװسɹٴα%sִн%sʱ%u\n",paths[pack],images[pack].size(),
+				same?"ͬ":"ͬ",equal?"һ":"һ",ticks);
+		}
+		else
+			printf("%s%uֽڣװʧ\n",paths[pack],images[pack].size());
+		if(!ok || !same || !equal)
+			bad++;
+		::DeleteFile(paths[pack]);
+	}
+	return bad?1:0;
+}
+
+//ȽԭѭԤ·ִͬһűʱ䡣űķֵΪһִɵĲѭ
+//ôȣݴ˻ÿ·ķֵͬ÷test űļ -bench [ִд]
+static int CompareFastExec(const char* buf,int runs)
+{
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	const char* names[2]={"ԭѭ","Ԥ·"};
+	CComVariant results[2];
+	DWORD ticks[2];
+	vm.LoadLibrary();
+	for(int fast=0;fast<2;fast++)
+	{
+		vm.SetFastExec(fast!=0);
+		DWORD start=::GetTickCount();
+		for(int i=0;i<runs;i++)
+			results[fast]=vm.ExecScript();
+		ticks[fast]=::GetTickCount()-start;
+	}
+	vm.UnloadLibrary();
+	double ops=runs;
+	if(results[1].vt==VT_I4 && results[1].lVal>0)
+		ops*=results[1].lVal;
+	for(int fast=0;fast<2;fast++)
+	{
+		DWORD t=ticks[fast]?ticks[fast]:1;
+		printf("%sִ%dʱ%u룬ÿ%.0fβ\n",names[fast],runs,ticks[fast],ops*1000/t);
+	}
+	bool same=(results[0]==results[1]);
+	printf("%.2fֵ%s\n",(double)(ticks[0]?ticks[0]:1)/(ticks[1]?ticks[1]:1),same?"ͬ":"ͬ");
+	return same?0:1;
+}
+
+//ͬĲѯִ߳ͬһűԴй˵ļٱȡűķֵΪһִ
+//˵Ķ߳·ֵͬ÷test űļ -workers [ִд] [߳]
+static int CompareQueryWorkers(const char* buf,int runs,int maxWorkers)
+{
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	SYSTEM_INFO si;
+	::GetSystemInfo(&si);
+	printf("%u\n",si.dwNumberOfProcessors);
+	vm.LoadLibrary();
+	//һִнʱ
+	CComVariant expect=vm.ExecScript();
+	double ops=runs;
+	if(expect.vt==VT_I4 && expect.lVal>0)
+		ops*=expect.lVal;
+	DWORD serial=0;
+	int bad=0;
+	for(int workers=0;workers<=maxWorkers;workers=workers?workers*2:1)
+	{
+		vm.SetQueryWorkers(workers);
+		CComVariant r;
+		DWORD start=::GetTickCount();
+		for(int i=0;i<runs;i++)
+			r=vm.ExecScript();
+		DWORD ticks=::GetTickCount()-start;
+		if(!ticks)
+			ticks=1;
+		if(workers==0)
+			serial=ticks;
+		if(r!=expect)
+			bad++;
+		printf("%ḍ߳ʱ%u룬ÿ%.0f󣬼%.2f%s\n",workers,ticks,ops*1000/ticks,
+			(double)serial/ticks,(r==expect)?"":"ֵͬ");
+	}
+	vm.SetQueryWorkers(0);
+	vm.UnloadLibrary();
+	return bad?1:0;
+}
+
+//ִһνűֵмʱgetoutput()رĻ׼ű÷test űļ -run
+static int RunAndPrint(const char* buf)
+{
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	vm.LoadLibrary();
+	CComVariant r=vm.ExecScript();
+	IString* pstr=IString::GetIString(r);
+	if(pstr)
+		std::cout<<(LPCSTR)pstr->Ref()<<std::endl;
+	else if(SUCCEEDED(r.ChangeType(VT_BSTR)))
+		std::cout<<CString(r.bstrVal)<<std::endl;
+	vm.UnloadLibrary();
+	return 0;
+}
+
+//ѹʽűδѹ.scbӳ񣬱ÿ봦MBѹʣ
+//ԭӳͬ÷test űļ -pack []
+static int ComparePack(const char* buf,int runs)
+{
+	ScriptcRuntime vm;
+	CString err=vm.Compile(buf,ScriptFile::ConvertPath("main.sc"));
+	if(err.GetLength()>0)
+	{
+		std::cout<<err<<std::endl;
+		return -1;
+	}
+	std::vector<char> image;
+	vm.SaveImage(image,SCB_PACK_NONE);
+	const BYTE* data=(const BYTE*)&image[0];
+	int size=image.size();
+	std::vector<BYTE> packed(LZFast::Bound(size)+size/8+64);
+	std::vector<BYTE> unpacked(size);
+	int bad=0;
+	double mb=(double)size*runs/(1024*1024);
+	printf("δѹӳ%dֽڣִ%d\n",size,runs);
+	for(int method=SCB_PACK_LZARI;method<=SCB_PACK_LZFAST;method++)
+	{
+		LZARI lzari;
+		LZFast lzfast;
+		int len=0;
+		DWORD start=::GetTickCount();
+		for(int i=0;i<runs;i++)
+		{
+			if(method==SCB_PACK_LZARI)
+				len=lzari.CompressTo(data,size,&packed[0],packed.size());
+			else
+				len=lzfast.Pack(data,size,&packed[0],packed.size());
+		}
+		DWORD packTicks=::GetTickCount()-start;
+		start=::GetTickCount();
+		int r=-1;
+		for(int i=0;i<runs;i++)
+		{
+			if(method==SCB_PACK_LZARI)
+				r=lzari.DecompressTo(&packed[0],len,&unpacked[0],size);
+			else
+				r=LZFast::Unpack(&packed[0],len,&unpacked[0],size);
+		}
+		DWORD unpackTicks=::GetTickCount()-start;
+		bool same=(len>0 && r==size && ::memcmp(&unpacked[0],data,size)==0);
+		if(!same)
+			bad++;
+		printf("%sѹ%dֽڣ%.1f%%%.1fMB/룬%.1fMB/%s\n",(method==SCB_PACK_LZARI)?"LZARI":"LZFast",
+			len,100.0*len/size,mb*1000/(packTicks?packTicks:1),mb*1000/(unpackTicks?unpackTicks:1),same?"":"ͬ");
+	}
+	return bad?1:0;
+}
+#endif
+
 int _tmain(int argc, _TCHAR* argv[])
 {
 #ifdef _DEBUG
@@ -48,6 +346,60 @@ int _tmain(int argc, _TCHAR* argv[])
 		buf[file.gcount()]=0;
 	}
 #ifdef INCLUDE_COMPILE	
+	if(argc>2 && ::_tcscmp(argv[2],_T("-opt"))==0)
+	{
+		::CoInitialize(NULL);
+		int r=CompareOptimize(buf);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-threads"))==0)
+	{
+		::CoInitialize(NULL);
+		int threads=(argc>3)?::_ttoi(argv[3]):4;
+		int r=StressContexts(buf,(threads>0 && threads<=MAXIMUM_WAIT_OBJECTS)?threads:4,(argc>4)?::_ttoi(argv[4]):100);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-bench"))==0)
+	{
+		::CoInitialize(NULL);
+		int runs=(argc>3)?::_ttoi(argv[3]):10;
+		int r=CompareFastExec(buf,(runs>0)?runs:10);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-workers"))==0)
+	{
+		::CoInitialize(NULL);
+		int runs=(argc>3)?::_ttoi(argv[3]):10;
+		int workers=(argc>4)?::_ttoi(argv[4]):8;
+		int r=CompareQueryWorkers(buf,(runs>0)?runs:10,(workers>0)?workers:8);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-run"))==0)
+	{
+		::CoInitialize(NULL);
+		int r=RunAndPrint(buf);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-pack"))==0)
+	{
+		::CoInitialize(NULL);
+		int runs=(argc>3)?::_ttoi(argv[3]):20;
+		int r=ComparePack(buf,(runs>0)?runs:20);
+		::CoUninitialize();
+		return r;
+	}
+	if(argc>2 && ::_tcscmp(argv[2],_T("-scb"))==0)
+	{
+		::CoInitialize(NULL);
+		int r=RoundTripImage(buf);
+		::CoUninitialize();
+		return r;
+	}
 	printf("ʼ...\n");
 	ScriptcRuntime vmachine;
 	CString err=vmachine.Compile(buf,ScriptFile::ConvertPath("main.sc"));
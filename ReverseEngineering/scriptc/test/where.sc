@@ -0,0 +1,33 @@
+//WHERE˵Ļ׼űANWHEREӾֻԲ㣬ڹ߳зֵֿ
+//ֻڵһִʱ֮ÿִвѯROUNDSΣֵΪ˵Ķ
+//÷test where.sc -workers [ִд] [߳]
+const N=200000;
+const ROUNDS=10;
+var built=0;
+
+function main()
+{
+	var i=0;
+	var o=0;
+	if(!built)
+	{
+		var a=oqlclass("A");
+		a.clear();
+		for(i=0;i<N;i++)
+		{
+			o=object();
+			o.id=i;
+			o.v=(i*7919)%10007;
+			a.push(o);
+		}
+		built=1;
+	}
+	defquery(1,select A from A where (A.v*3)%7==1 && A.id%5!=0 order by A.id);
+	for(i=0;i<ROUNDS;i++)
+	{
+		o=execquery(1,1);
+		if(o.id<0)
+			return 0;
+	}
+	return N*ROUNDS;
+}